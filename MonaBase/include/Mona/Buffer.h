@@ -20,6 +20,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #include "Mona/Binary.h"
 #include <thread>
 #include <atomic>
+#include <map>
 
 namespace Mona {
 
@@ -51,20 +52,53 @@ struct Buffer : Binary, virtual Object {
 	static Buffer&   Null() { static Buffer Null(0, nullptr); return Null; } // usefull for Writer Serializer for example (and can't be encapsulate in a shared<Buffer>)
 
 
+	/*!
+	Buffer allocator, each capacity class (16 << index bytes) can have a thread magazine (cache) in front of the allocator,
+	alloc and free are served by the magazine of the calling thread without lock, the allocator is locked just to refill or release half a magazine */
 	struct Allocator : virtual Object {
 		template<typename AllocatorType=Allocator, typename ...Args>
-		static void   Set(Args&&... args) { Lock(); _PAllocator.set<AllocatorType>(std::forward<Args>(args)...); Unlock(); }
+		static void   Set(Args&&... args) { Lock(); _PAllocator.set<AllocatorType>(std::forward<Args>(args)...); SetMagazines(); Unlock(); }
 		static UInt8* Alloc(UInt32& size);
 		static void	  Free(UInt8* buffer, UInt32 size);
 		static UInt32 ComputeCapacity(UInt32 size);
+
+		static const UInt8 CLASSES = 28; // 16 bytes to 2GB
+		struct Stats {
+			Stats() : hits(0), misses(0), held(0) {}
+			UInt64 hits; // allocations served by a thread magazine
+			UInt64 misses; // allocations which have required the allocator
+			UInt64 held; // bytes kept in magazines (and in allocator for class stats)
+		};
+		/*!
+		Stats of the capacity class 16 << index */
+		static Stats  ClassStats(UInt8 index);
+		/*!
+		Stats of magazines by thread id */
+		static void   ThreadStats(std::map<UInt32, Stats>& stats);
 	protected:
 		virtual UInt8* alloc(UInt32& capacity) { return new UInt8[capacity]; }
 		virtual void   free(UInt8* buffer, UInt32 capacity) { delete[] buffer; }
+		/*!
+		Size of the thread magazine for this capacity, 0 to disable it */
+		virtual UInt16 magazine(UInt32 capacity) const { return 0; }
+		/*!
+		Refill a magazine, returns the count of buffers set (can be less than count) */
+		virtual UInt16 refill(UInt32 capacity, UInt8** buffers, UInt16 count) { return 0; }
+		/*!
+		Release buffers of a magazine */
+		virtual void   release(UInt32 capacity, UInt8** buffers, UInt16 count) { while (count--) free(buffers[count], capacity); }
+		/*!
+		Bytes kept by the allocator for this capacity */
+		virtual UInt64 held(UInt32 capacity) const { return 0; }
 
 		static void Lock() { while (!TryLock()) std::this_thread::yield(); }
 		static void Unlock() { _Mutex.clear(std::memory_order_release); }
 	private:
 		static bool TryLock() { return !_Mutex.test_and_set(std::memory_order_acquire); }
+		static void SetMagazines();
+
+		struct Magazines;
+		static Magazines* CurrentMagazines();
 
 		static std::atomic_flag  _Mutex;
 		static unique<Allocator> _PAllocator;
@@ -33,15 +33,24 @@ private:
 		return buffer ? buffer : new UInt8[capacity];
 	}
 	void   free(UInt8* buffer, UInt32 capacity) { _buffers[computeIndex(capacity)].push(buffer); }
+	/*!
+	Thread magazines for buffers until 64KB, with a maximum of 64KB by magazine */
+	UInt16 magazine(UInt32 capacity) const { return capacity > 0x10000 ? 0 : UInt16(std::min(0x10000u / capacity, 32u)); }
+	UInt16 refill(UInt32 capacity, UInt8** buffers, UInt16 count) { return _buffers[computeIndex(capacity)].pop(buffers, count); }
+	void   release(UInt32 capacity, UInt8** buffers, UInt16 count) { _buffers[computeIndex(capacity)].push(buffers, count); }
+	UInt64 held(UInt32 capacity) const { return UInt64(_buffers[computeIndex(capacity)].count()) * capacity; }
 
 	bool run(Exception& ex, const volatile bool& requestStop);
-	UInt8 computeIndex(UInt32 capacity);
+	static UInt8 computeIndex(UInt32 capacity);
 
 	struct Buffers : private std::vector<UInt8*>, virtual Object {
 		Buffers() : _minSize(0), _maxSize(0) {}
 		~Buffers() { for (UInt8* buffer : self) delete[] buffer; }
+		UInt32 count() const { return size(); }
 		UInt8* pop();
+		UInt16 pop(UInt8** buffers, UInt16 count);
 		void   push(UInt8* buffer);
+		void   push(UInt8** buffers, UInt16 count);
 		void manage(std::vector<UInt8*>& gc);
 	private:
 		UInt32 _minSize;
@@ -0,0 +1,74 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+
+namespace Mona {
+
+/*!
+Byte kernels of hot protocol and media loops (WebSocket masking, TS sync, NAL start code, CRC32),
+vectorized with SSE2, AVX2 or AVX-512 selected on startup according to the CPU, with a portable fallback */
+struct Bytes : virtual Static {
+	enum Kernel {
+		KERNEL_SCALAR = 0,
+		KERNEL_SSE2,
+		KERNEL_AVX2,
+		KERNEL_AVX512
+	};
+	static const char*	KernelToString(Kernel kernel);
+
+	/*!
+	Kernel used currently (the best one supported by the CPU by default) */
+	static Kernel		Current() { return _PKernels->kernel; }
+	/*!
+	Select an other kernel to test or benchmark it, returns false if unsupported by the CPU.
+	/!\ Not thread-safe, call it before to use Bytes functions from others threads */
+	static bool			Select(Kernel kernel);
+
+	/*!
+	XOR data with the 4 bytes mask repeated (WebSocket masking) */
+	static void			Mask(UInt8* data, UInt32 size, const UInt8* mask) { _PKernels->mask(data, size, mask); }
+	/*!
+	Returns the first byte equals to value, or NULL if not found (MPEG-TS 0x47 sync byte) */
+	static const UInt8*	Find(const UInt8* data, UInt32 size, UInt8 value) { return _PKernels->find(data, size, value); }
+	/*!
+	Returns the first 00 00 01 start code (H264/HEVC byte stream), or NULL if not found */
+	static const UInt8*	FindStartCode(const UInt8* data, UInt32 size) { return _PKernels->findStartCode(data, size); }
+	/*!
+	CRC32 MPEG-2 (polynomial 0x04C11DB7 not reflected, as PSI tables), computed with slice-by-8,
+	crc argument allows to continue a previous computation */
+	static UInt32		CRC32(const UInt8* data, UInt32 size, UInt32 crc = 0xFFFFFFFF);
+	/*!
+	Structural index of a JSON text (first stage of a two-stage parsing): positions of unescaped quotes,
+	of {}[]:, out of strings and of the first character of others values (numbers, true, false, null).
+	indexes must be able to contain size positions, returns false if a string is not terminated */
+	static bool			IndexJSON(const UInt8* data, UInt32 size, UInt32* indexes, UInt32& count);
+
+private:
+	struct Kernels {
+		Kernel			kernel;
+		void			(*mask)(UInt8* data, UInt32 size, const UInt8* mask);
+		const UInt8*	(*find)(const UInt8* data, UInt32 size, UInt8 value);
+		const UInt8*	(*findStartCode)(const UInt8* data, UInt32 size);
+		void			(*classifyJSON)(const UInt8* data, UInt64* masks); // 64 bytes in quotes, backslashes, operators and spaces bit masks
+	};
+	static const Kernels  _Kernels[];
+	static const Kernels* _PKernels;
+};
+
+} // namespace Mona
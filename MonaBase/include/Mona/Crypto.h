@@ -80,6 +80,46 @@ struct Crypto : virtual Static {
 		static UInt8* Compute(const EVP_MD* evp, const void* key, int keySize, const void* data, size_t size, UInt8* value);
 	};
 
+	/*!
+	AES-128 CBC with key schedules expanded once on construction (a copy doesn't expand them again),
+	accelerated by AES-NI when the CPU supports it, OpenSSL otherwise.
+	/!\ OpenSSL fallback keeps its context, use one instance by thread */
+	struct AES : virtual Object {
+		enum {
+			KEY_SIZE = 16,
+			BLOCK_SIZE = 16,
+			LANES = 4 // buffers encrypted together by Encrypt
+		};
+		struct Job {
+			AES*	pAES;
+			UInt8*	data;
+			UInt32	size;
+		};
+		AES(const UInt8* key);
+		AES(const AES& aes);
+		~AES();
+		AES& operator=(const AES& aes) = delete; // owns its OpenSSL contexts
+
+		/*!
+		Encrypt or decrypt in place with iv (zero if NULL), size must be a multiple of BLOCK_SIZE */
+		void encrypt(UInt8* data, UInt32 size, const UInt8* iv = NULL);
+		void decrypt(UInt8* data, UInt32 size, const UInt8* iv = NULL);
+		/*!
+		Multi-buffer encryption of independent buffers with zero IV (keys can differ).
+		CBC encryption chains each block to the previous one and so waits the AES latency,
+		AES-NI interleaves LANES buffers at the same time to fill the pipeline */
+		static void Encrypt(Job* jobs, UInt32 count);
+		/*!
+		True if AES-NI is used */
+		static bool Accelerated();
+	private:
+		UInt8			_encryptKeys[11 * BLOCK_SIZE];
+		UInt8			_decryptKeys[11 * BLOCK_SIZE];
+		// OpenSSL fallback
+		EVP_CIPHER_CTX*	_pEncryptor;
+		EVP_CIPHER_CTX*	_pDecryptor;
+	};
+
 };
 
 
@@ -120,6 +120,7 @@ private:
 	UInt16						_decodingTrack;
 	const Handler*				_pHandler; // to diminue size of Action+Handle
 	friend struct IOFile;
+	friend struct Socket; // to send file without copy
 };
 
 
@@ -17,16 +17,16 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #pragma once
 
 #include "Mona/Mona.h"
-#include "Mona/Runner.h"
+#include "Mona/RunnerQueue.h"
+#include "Mona/Slab.h"
 #include "Mona/Event.h"
 #include "Mona/Signal.h"
-#include <deque>
 
 namespace Mona {
 
 struct Handler : virtual Object {
-	Handler(Signal& signal) : _pSignal(&signal) {}
-	Handler() : _pSignal(NULL) {}
+	Handler(Signal& signal) : _pSignal(&signal), _producing(0) {}
+	Handler() : _pSignal(NULL), _producing(0) {}
 
 	void	 reset(Signal& signal);
 	UInt32	 flush(bool last=false);
@@ -36,17 +36,19 @@ struct Handler : virtual Object {
 	template<typename RunnerType, typename = typename std::enable_if<std::is_constructible<shared<Runner>, RunnerType>::value>::type>
 	bool tryQueue(RunnerType&& pRunner) const {
 		DEBUG_ASSERT(pRunner); // more easy to debug that if it fails in the thread!
-		std::lock_guard<std::mutex> lock(_mutex);
-		if (!_pSignal)
-			return false;
-		_runners.emplace_back(std::forward<RunnerType>(pRunner));
-		_pSignal->set();
-		return true;
+		++_producing; // flush(true) waits the end of this queueing operation
+		Signal* pSignal(_pSignal);
+		if (pSignal) {
+			_runners.push(std::forward<RunnerType>(pRunner));
+			pSignal->set();
+		}
+		--_producing;
+		return pSignal ? true : false;
 	}
 	/*!
 	Try to build and queue a RunnerType, returns false if failed */
 	template <typename RunnerType, typename ...Args>
-	bool tryQueue(Args&&... args) const { return tryQueue(std::make_shared<RunnerType>(std::forward<Args>(args)...)); }
+	bool tryQueue(Args&&... args) const { return tryQueue(Slab::MakeShared<RunnerType>(std::forward<Args>(args)...)); }
 	/*!
 	Try to queue an event with arguments call, returns false if failed */
 	template<typename ResultType, typename ...Args>
@@ -58,7 +60,7 @@ struct Handler : virtual Object {
 			Event<void(ResultType)>								_onResult;
 			typename std::remove_reference<ResultType>::type	_result;
 		};
-		return tryQueue(std::make_shared<Result>(onResult, std::forward<Args>(args)...));
+		return tryQueue(Slab::MakeShared<Result>(onResult, std::forward<Args>(args)...));
 	}
 	/*!
 	Try to queue an event without argument, returns false if failed */
@@ -74,7 +76,7 @@ struct Handler : virtual Object {
 	Build and queue a RunnerType, returns false if failed */
 	template <typename RunnerType, typename ...Args>
 	void queue(Args&&... args) const {
-		if(!tryQueue(std::make_shared<RunnerType>(std::forward<Args>(args)...)))
+		if(!tryQueue(Slab::MakeShared<RunnerType>(std::forward<Args>(args)...)))
 			FATAL_ERROR("Impossible to queue ", TypeOf<RunnerType>());
 	}
 	/*!
@@ -93,9 +95,9 @@ struct Handler : virtual Object {
 
 private:
 
-	mutable std::mutex					_mutex;
-	mutable std::deque<shared<Runner>>	_runners;
-	Signal*								_pSignal;
+	mutable RunnerQueue					_runners;
+	std::atomic<Signal*>				_pSignal;
+	mutable std::atomic<UInt32>			_producing;
 };
 
 
@@ -0,0 +1,153 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Util.h"
+#include <vector>
+
+namespace Mona {
+
+/*!
+Open addressing hash table for hot indexes: linear probing, backward shift deletion, capacity power of 2 growing at 75% of load.
+HasherType gives a 64 bits hash of the key, mixed with a random seed by table to resist to hash flooding,
+each entry keeps its 32 bits hash to skip most of key comparisons and to grow without rehashing.
+Pointers returned are invalidated by any insertion or deletion */
+template<typename KeyType, typename ValueType, typename HasherType = std::hash<KeyType>, typename EqualType = std::equal_to<KeyType>>
+struct HashMap : virtual Object {
+	HashMap() : _size(0), _seed(Util::Random<UInt64>()) {}
+
+	UInt32		size() const { return _size; }
+	bool		empty() const { return !_size; }
+	UInt32		capacity() const { return UInt32(_entries.size()); }
+
+	ValueType*	find(const KeyType& key) {
+		if (!_size)
+			return NULL;
+		UInt32 hash = this->hash(key);
+		UInt32 mask = capacity() - 1;
+		for (UInt32 i = hash & mask;; i = (i + 1) & mask) {
+			Entry& entry = _entries[i];
+			if (!entry.hash)
+				return NULL;
+			if (entry.hash == hash && _equal(entry.key, key))
+				return &entry.value;
+		}
+	}
+	const ValueType* find(const KeyType& key) const { return ((HashMap*)this)->find(key); }
+
+	/*!
+	Insert if key is not present, otherwise returns the existing value with false */
+	std::pair<ValueType*, bool> emplace(const KeyType& key, const ValueType& value) {
+		if ((_size + 1) > (capacity() >> 2) * 3)
+			grow();
+		UInt32 hash = this->hash(key);
+		UInt32 mask = capacity() - 1;
+		for (UInt32 i = hash & mask;; i = (i + 1) & mask) {
+			Entry& entry = _entries[i];
+			if (!entry.hash) {
+				entry.hash = hash;
+				entry.key = key;
+				entry.value = value;
+				++_size;
+				return std::make_pair(&entry.value, true);
+			}
+			if (entry.hash == hash && _equal(entry.key, key))
+				return std::make_pair(&entry.value, false);
+		}
+	}
+
+	bool erase(const KeyType& key) {
+		if (!_size)
+			return false;
+		UInt32 hash = this->hash(key);
+		UInt32 mask = capacity() - 1;
+		UInt32 i = hash & mask;
+		for (;; i = (i + 1) & mask) {
+			Entry& entry = _entries[i];
+			if (!entry.hash)
+				return false;
+			if (entry.hash == hash && _equal(entry.key, key))
+				break;
+		}
+		// backward shift: move up following entries of the cluster which can take the hole, no tombstone
+		for (UInt32 j = i;;) {
+			j = (j + 1) & mask;
+			Entry& entry = _entries[j];
+			if (!entry.hash)
+				break;
+			if (((j - entry.hash) & mask) < ((j - i) & mask))
+				continue; // its ideal place is between the hole and it
+			_entries[i] = std::move(entry);
+			i = j;
+		}
+		_entries[i] = Entry(); // release key and value
+		--_size;
+		return true;
+	}
+
+	void clear() {
+		_entries.clear();
+		_size = 0;
+	}
+
+	/*!
+	Call function(key, value) for each entry, stops when it returns false (entries must not be inserted or erased meanwhile) */
+	template<typename FunctionType>
+	void forEach(const FunctionType& function) {
+		for (Entry& entry : _entries) {
+			if (entry.hash && !function((const KeyType&)entry.key, entry.value))
+				return;
+		}
+	}
+
+private:
+	struct Entry {
+		Entry() : hash(0), key(), value() {}
+		UInt32		hash; // 0 = empty
+		KeyType		key;
+		ValueType	value;
+	};
+
+	UInt32 hash(const KeyType& key) const {
+		UInt32 hash = UInt32(((_hasher(key) ^ _seed) * 0x9E3779B97F4A7C15ull) >> 32);
+		return hash ? hash : 1;
+	}
+
+	void grow() {
+		std::vector<Entry> entries(_entries.empty() ? 16 : (_entries.size() << 1));
+		UInt32 mask = UInt32(entries.size()) - 1;
+		for (Entry& entry : _entries) {
+			if (!entry.hash)
+				continue;
+			UInt32 i = entry.hash & mask;
+			while (entries[i].hash)
+				i = (i + 1) & mask;
+			entries[i] = std::move(entry);
+		}
+		_entries = std::move(entries);
+	}
+
+	std::vector<Entry>	_entries;
+	UInt32				_size;
+	const UInt64		_seed;
+	HasherType			_hasher;
+	EqualType			_equal;
+};
+
+
+} // namespace Mona
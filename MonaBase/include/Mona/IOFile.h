@@ -30,7 +30,8 @@ IOFile performs asynchrone writing and reading operation,
 It uses a Thread::ProcessorCount() threads with low priority to load/read/write files
 Indeed even if SSD drive allows parallel reading and writing operation every operation sollicate too the CPU,
 so it's useless to try to exceeds number of CPU core (Thread::ProcessorCount() has been tested and approved with file load)
-Trick: shared<File> pFile becomes "unique" when there is no more usage by parallel thread */
+Trick: shared<File> pFile becomes "unique" when there is no more usage by parallel thread.
+On Linux with IOUring::Enable() writings are submitted to io_uring, several packets queued are grouped in one vectored write */
 struct IOFile : virtual Object, Thread { // Thread is for file watching!
 
 	IOFile(const Handler& handler, const ThreadPool& threadPool, UInt16 cores=0);
@@ -93,9 +94,13 @@ private:
 	struct Action;
 	struct WAction;
 	struct SAction;
+	struct Ring;
 
+	Ring*	ring();
 
 	ThreadPool								_threadPool; // Pool of threads for writing/reading disk operation
+	unique<Ring>							_pRing;
+	std::once_flag							_ringOnce;
 	std::vector<shared<const FileWatcher>>	_watchers;
 	std::mutex								_mutexWatchers;
 };
@@ -25,14 +25,25 @@ details (or else see http://mozilla.org/MPL/2.0/).
 namespace Mona {
 
 struct IOSRTSocket;
+struct IOUring;
+/*!
+Sockets event loop, with reactors>1 sockets are spread between several event loops (one system instance by reactor, 0 = one by threadPool thread),
+a socket stays on the same reactor and is read always by the same thread of threadPool.
+On Linux the event loop uses io_uring multishot polls rather epoll when IOUring::Enable() has been called before its start,
+then TCP sockets without TLS are received by io_uring in buffers provided to the kernel (kernel 5.19+) rather than by recv calls,
+sendings stay direct system calls of the sending thread */
 struct IOSocket : protected Thread, virtual Object {
-	IOSocket(const Handler& handler, const ThreadPool& threadPool, const char* name = "IOSocket");
+	IOSocket(const Handler& handler, const ThreadPool& threadPool, const char* name = "IOSocket", UInt16 reactors = 1);
 	~IOSocket();
 
 	const Handler&			handler;
 	const ThreadPool&		threadPool;
 
-	UInt32					subscribers() const { return _subscribers; }
+	UInt32					subscribers() const;
+	UInt16					reactors() const { return _reactors.empty() ? 1 : UInt16(_reactors.size()); }
+	/*!
+	Assign the reactor of a socket not already subscribed (modulo reactors()), allows to spread SO_REUSEPORT sockets bound on the same address */
+	void					setReactor(Socket& socket, UInt16 reactor);
 
 	bool					subscribe(Exception& ex, const shared<Socket>& pSocket,
 								const Socket::OnReceived& onReceived,
@@ -62,7 +73,9 @@ protected:
 	Signal					_initSignal;
 	std::atomic<UInt32>		_subscribers;
 
-	void			read(const shared<Socket>& pSocket, int error);
+	/*!
+	ppBuffer is the data already received by io_uring to decode on the receiving thread */
+	void			read(const shared<Socket>& pSocket, int error, shared<Buffer>* ppBuffer = NULL);
 	void			write(const shared<Socket>& pSocket, int error);
 	void			close(const shared<Socket>& pSocket, int error);
 
@@ -102,11 +115,26 @@ private:
 	std::mutex									_mutexSockets;
 #else
 	int											_eventFD;
+#if !defined(_BSD)
+	bool					runRing(Exception& ex);
+	void					process(const shared<Socket>& pSocket, UInt32 events);
+	/*!
+	Arm an io_uring reception of the socket, submitted now if submit (else on the next reactor wait),
+	returns false on error (unsubscribed socket is not an error) */
+	bool					receive(const shared<Socket>& pSocket, bool submit = true);
+	unique<IOUring>								_pRing;
+	UInt32										_polleds; // Polled not deleted, protected by _mutex
+	struct Polled;
+#endif
 #endif
 
 	NET_SYSTEM									_system;
 	shared<IOSRTSocket>							_pIOSRTSocket;
 
+	IOSocket&									reactor(Socket& socket);
+	std::vector<unique<IOSocket>>				_reactors;
+	std::atomic<UInt16>							_nextThread;
+
 	struct Action;
 };
 
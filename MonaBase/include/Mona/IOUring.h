@@ -0,0 +1,130 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include <mutex>
+
+struct iovec;
+
+namespace Mona {
+
+/*!
+Linux io_uring instance driven by raw system calls (no liburing dependency).
+Operations can be prepared from any thread, they are submitted on flush() or with the next wait(),
+completions have to be reaped by one unique thread.
+On system without io_uring (or kernel older than 5.13) the instance is null and IOSocket/IOFile keep epoll and blocking calls.
+Receptions are done in buffers provided to the kernel (kernel 5.19+, see provide), sendings stay direct system calls of the caller thread */
+struct IOUring : virtual Object {
+	NULLABLE(_fd < 0)
+
+	struct Completion {
+		void*	pData;
+		int		result; // >=0 on success, -errno on failure
+		bool	more; // true if a multishot operation stays armed after this completion
+		Int32	buffer; // provided buffer which contains the data received, -1 if none
+	};
+
+	IOUring(UInt32 entries = 256);
+	~IOUring();
+
+	int		id() const { return _fd; }
+
+	/*!
+	True if the system supports io_uring with required features */
+	static bool Available();
+	/*!
+	Allow IOSocket and IOFile to use io_uring for next started reactors and file writings,
+	returns false if enable is requested but io_uring is not available */
+	static bool Enable(bool enable = true);
+	static bool Enabled() { return _Enabled; }
+
+	/*!
+	Multishot edge-triggered poll, each readiness change gives a completion with EPOLL events in result */
+	bool	poll(int fd, UInt32 events, void* pData);
+	/*!
+	Cancel the poll identified by pData, its last completion comes with more=false,
+	the cancellation result comes with pResult (-EALREADY if the poll was arming, to retry) */
+	bool	cancel(void* pData, void* pResult = NULL);
+	/*!
+	Write buffers at the current file position, iovecs must stay valid until submission */
+	bool	write(int fd, const iovec* iovecs, UInt32 count, void* pData);
+	/*!
+	Receive in the next provided buffer available (see provide), result is the size received,
+	0 on disconnection and -ENOBUFS if all the provided buffers are in use */
+	bool	receive(int fd, void* pData);
+	/*!
+	Cancel the operation identified by pData (not a poll, see cancel) */
+	bool	abort(void* pData);
+	/*!
+	No operation, just to wake up a wait() with a pData completion */
+	bool	wakeUp(void* pData);
+
+	/*!
+	Submit operations prepared */
+	bool	flush();
+	/*!
+	Submit operations prepared and wait at least one completion during timeout ms (-1 without timeout, 0 to get immediately the ones available),
+	returns completions count, 0 on timeout, or -1 on error */
+	int		wait(Completion* completions, UInt32 size, Int32 timeout = -1);
+
+	/*!
+	Register count buffers of size bytes (count power of 2) where receive() operations write,
+	returns false if the system doesn't support provided buffer rings (kernel 5.19) */
+	bool			provide(UInt16 count, UInt32 size);
+	UInt16			buffers() const { return _bufCount; }
+	const UInt8*	buffer(UInt16 id) const { return _pBuffers + UInt32(id) * _bufSize; }
+	/*!
+	Give back to the kernel a provided buffer got in a completion, to call by the thread which reaps completions */
+	void			release(UInt16 id);
+
+private:
+	void*	prepare(UInt8 opcode, int fd, void* pData);
+	bool	commit();
+	bool	submit();
+
+	int				_fd;
+	std::mutex		_mutex;
+	UInt32			_toSubmit;
+	UInt32			_sqTail;
+
+	UInt8*			_pSQ;
+	UInt32			_sqSize;
+	UInt8*			_pCQ;
+	UInt32			_cqSize;
+	void*			_pSQEs;
+	UInt32			_sqesSize;
+	UInt32			_sqEntries;
+	UInt32			_sqMask;
+	UInt32			_cqMask;
+	UInt32*			_pSQHead;
+	UInt32*			_pSQTail;
+	UInt32*			_pSQArray;
+	UInt32*			_pCQHead;
+	UInt32*			_pCQTail;
+	void*			_pCQEs;
+
+	void*			_pBufRing;
+	UInt8*			_pBuffers;
+	UInt16			_bufCount;
+	UInt32			_bufSize;
+	UInt16			_bufTail;
+
+	static bool		_Enabled;
+};
+
+} // namespace Mona
@@ -70,27 +70,46 @@ struct Logs : virtual Static {
 	
 	static bool			LastCritic(std::string& critic);
 
+	enum Overflow : UInt8 {
+		OVERFLOW_DROP = 0, // log dropped and counted, see Dropped()
+		OVERFLOW_BLOCK // caller waits free room
+	};
+	/*!
+	Asynchronous mode: callers copy logs and raw dumps in a lock-free ring buffer by thread (bufferSize bytes),
+	then a "Logs" thread formats and writes them to loggers by batch. FATAL and CRITIC logs stay synchronous (after pending logs) */
+	static void			SetAsync(bool async, UInt32 bufferSize = 0x10000, Overflow overflow = OVERFLOW_DROP);
+	static bool			Async() { return _Async; }
+	/*!
+	Allow at most count logs by second for the same file line and thread (0 = no limit),
+	the first log allowed after a suppression indicates the number of similar logs suppressed. FATAL and CRITIC logs are never limited */
+	static void			SetRateLimit(UInt16 count) { _RateLimit = count; }
+	/*!
+	Count of logs dropped on asynchronous buffer overflow */
+	static UInt64		Dropped();
+	/*!
+	Write now pending asynchronous logs */
+	static void			Flush();
+	/*!
+	Thread id and time of the log being written, Logger implementations have to use them rather than Thread::CurrentId() or Time::Now() to support asynchronous mode */
+	static UInt32		CurrentThreadId() { return _ThreadId; }
+	static Int64		CurrentTime() { return _Time; }
+
 	template <typename ...Args>
     static void	Log(LOG_LEVEL level, const char* file, long line, Args&&... args) {
 		if (_Logging || _Level < level)
 			return;
 		_Logging = true;
-		std::lock_guard<std::mutex> lock(_Mutex);
-		static Path File;
-		static String Message;
-		File.set(file);
-		String::Assign(Message, std::forward<Args>(args)...);
-		if (level <= LOG_CRITIC)
-			_Critic.assign(Message.empty() ? "unknown" : Message.c_str());
-		for (auto& it : _Loggers) {
-			if (*it.second && !it.second->log(level, File, line, Message))
-				_Loggers.fail(*it.second);
+		UInt32 suppressed(0);
+		if (level <= LOG_CRITIC || !_RateLimit || RateLimit(file, line, suppressed)) {
+			String::Assign(_Message, std::forward<Args>(args)...);
+			if (suppressed)
+				String::Append(_Message, " (", suppressed, " similar logs suppressed)");
+			Write(level, file, line, _Message);
+			if (_Message.size() > 0xFF) {
+				_Message.resize(0xFF);
+				_Message.shrink_to_fit();
+			}
 		}
-		if(Message.size()>0xFF) {
-			Message.resize(0xFF);
-			Message.shrink_to_fit();
-		}
-		_Loggers.flush();
 		_Logging = false;
 	}
 
@@ -99,8 +118,7 @@ struct Logs : virtual Static {
 		if (!_Dump || _Dumping)
 			return;
 		_Dumping = true;
-		std::lock_guard<std::mutex> lock(_Mutex);
-		if (_DumpFilter.empty() || String::ICompare(_DumpFilter, name) == 0)
+		if (Dumpable(name))
 			Dump(String(std::forward<Args>(args)...), data, size);
 		_Dumping = false;
 	}
@@ -129,7 +147,6 @@ struct Logs : virtual Static {
 		if (_Dumping)
 			return;
 		_Dumping = true;
-		std::lock_guard<std::mutex> lock(_Mutex);
 		Dump(String::Empty(), data, size);
 		_Dumping = false;
 	}
@@ -144,13 +161,37 @@ struct Logs : virtual Static {
 	};
 
 private:
+	struct Ring;
+	struct Writer;
+
+	static void		Write(LOG_LEVEL level, const char* file, long line, const std::string& message);
+	/*!
+	Copy a log (or a dump if level is 0) in the thread ring buffer, returns false if it has to be written synchronously */
+	static bool		Push(LOG_LEVEL level, const char* header, UInt32 headerSize, long line, const UInt8* data, UInt32 size);
 	static void		Dump(const std::string& header, const UInt8* data, UInt32 size);
+	static bool		Dumpable(const char* name);
+	static bool		RateLimit(const char* file, long line, UInt32& suppressed);
+	/*!
+	Dispatch to loggers, _Mutex must be locked */
+	static void		Dispatch(LOG_LEVEL level, const char* file, long line, const std::string& message);
+	static void		Dispatch(const std::string& header, const UInt8* data, UInt32 size);
+	/*!
+	Dispatch pending asynchronous logs, _Mutex must be locked */
+	static void		Drain();
+	static Ring*	ThreadRing();
 
 	static std::mutex				_Mutex;
 	static std::string				_Critic;
 
 	static thread_local bool		_Logging;
 	static thread_local bool		_Dumping;
+	static thread_local String		_Message;
+
+	static std::atomic<bool>		_Async;
+	static std::atomic<UInt16>		_RateLimit;
+	static UInt32					_ThreadId;
+	static Int64					_Time;
+	static Writer					_Writer;
 
 	static std::atomic<LOG_LEVEL>	_Level;
 	static struct Loggers : std::map<std::string, unique<Logger>, String::IComparator>, virtual Object {
@@ -0,0 +1,150 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Buffer.h"
+#include <functional>
+
+namespace Mona {
+
+/*!
+Low-overhead metrics: histograms, counters and gauges.
+Recording is lock-free, each thread increments its own slot (relaxed atomic) and slots are merged on read.
+A metric registers itself on construction, declare it static in the module to measure,
+a NULL name makes a local metric which is not registered (not written by Metrics::Write).
+Collection is disabled by default, instrumentation points have to check Metrics::Enabled() before to measure */
+struct Metrics : virtual Static {
+	enum Format {
+		FORMAT_PROMETHEUS = 0,
+		FORMAT_JSON
+	};
+	enum {
+		SLOTS = 8 // recording slots, threads share a slot beyond
+	};
+
+	struct Metric : virtual Object {
+		const char* name;
+		const char* help;
+		virtual ~Metric();
+	protected:
+		Metric(const char* name, const char* help);
+	private:
+		virtual void write(Buffer& buffer, Format format) const = 0;
+		friend struct Metrics;
+	};
+
+	/*!
+	HDR style histogram, log-linear buckets: exact until 16, then 8 buckets by power of 2 (12.5% of precision),
+	values beyond 2^36 are clamped to the last bucket */
+	struct Histogram : Metric, virtual Object {
+		enum {
+			BUCKETS = 272
+		};
+		struct Snapshot {
+			Snapshot() : count(0), sum(0), max(0) { memset(counts, 0, sizeof(counts)); }
+			UInt64 count;
+			UInt64 sum;
+			UInt64 max;
+			UInt64 counts[BUCKETS];
+			/*!
+			Value under which rate (0 to 1) of values are, returns the highest equivalent value of its bucket */
+			UInt64 percentile(double rate) const;
+		};
+		Histogram(const char* name, const char* help);
+
+		void	add(UInt64 value);
+		/*!
+		Merge slots */
+		Snapshot& snapshot(Snapshot& snapshot) const;
+
+		static UInt16 Bucket(UInt64 value);
+		static UInt64 BucketMax(UInt16 bucket);
+	private:
+		void write(Buffer& buffer, Format format) const;
+
+		struct Slot {
+			std::atomic<UInt64> counts[BUCKETS];
+			std::atomic<UInt64> sum;
+			std::atomic<UInt64> max;
+		};
+		Slot _slots[SLOTS];
+	};
+
+	struct Counter : Metric, virtual Object {
+		Counter(const char* name, const char* help);
+
+		void	add(UInt64 count = 1) { _slots[Metrics::Slot()].value.fetch_add(count, std::memory_order_relaxed); }
+		UInt64	value() const;
+	private:
+		void write(Buffer& buffer, Format format) const;
+
+		struct alignas(64) Slot { // one cache line by slot
+			std::atomic<UInt64> value;
+		};
+		Slot _slots[SLOTS];
+	};
+
+	/*!
+	Current value, set by the module or computed on read by a probe */
+	struct Gauge : Metric, virtual Object {
+		typedef std::function<Int64()> Probe;
+		Gauge(const char* name, const char* help, Probe&& probe = nullptr) : Metric(name, help), _probe(std::move(probe)), _value(0) {}
+
+		void	set(Int64 value) { _value.store(value, std::memory_order_relaxed); }
+		void	add(Int64 value) { _value.fetch_add(value, std::memory_order_relaxed); }
+		Int64	value() const { return _probe ? _probe() : _value.load(std::memory_order_relaxed); }
+	private:
+		void write(Buffer& buffer, Format format) const;
+
+		const Probe			_probe;
+		std::atomic<Int64>	_value;
+	};
+
+	/*!
+	Gauges (or counters) by label value, computed on read by a probe which adds each series,
+	ex: Series("mona_buffers_held_bytes", "class", help, [](const Series::Add& add) { add("16", 1024); }) */
+	struct Series : Metric, virtual Object {
+		typedef std::function<void(const std::string& value, Int64 metric)>	Add;
+		typedef std::function<void(const Add& add)>							Probe;
+		Series(const char* name, const char* label, const char* help, Probe&& probe, bool counter = false) : Metric(name, help), label(label), _probe(std::move(probe)), _counter(counter) {}
+
+		const char* label;
+	private:
+		void write(Buffer& buffer, Format format) const;
+
+		const Probe	_probe;
+		const bool	_counter;
+	};
+
+	static bool		Enabled() { return _Enabled; }
+	static void		Enable(bool enable = true) { _Enabled = enable; }
+	/*!
+	Monotonic clock in microseconds to measure durations */
+	static Int64	Clock();
+	/*!
+	Write all the metrics registered, Prometheus text exposition format or JSON object */
+	static Buffer&	Write(Buffer& buffer, Format format = FORMAT_PROMETHEUS);
+
+private:
+	static UInt8	Slot();
+
+	static bool		_Enabled;
+};
+
+
+} // namespace Mona
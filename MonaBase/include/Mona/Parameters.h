@@ -109,8 +109,10 @@ struct Parameters : String::Object<Parameters> {
 	Just to match STD container (see MapWriter) */
 	template<typename ValueType>
 	std::pair<const_iterator, bool> emplace(const std::string& key, ValueType&& value) {
-		if (!_pMap)
+		if (!_pMap) {
 			_pMap.set();
+			onParamInit(); // materialize parameters before to add (map already built to not recall onParamInit while filling)
+		}
 		const auto& it = _pMap->emplace(key, std::string());
 		if (it.second || it.first->second.compare(value) != 0) {
 			it.first->second = std::forward<ValueType>(value);
@@ -0,0 +1,67 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Runner.h"
+#include "Mona/Metrics.h"
+
+namespace Mona {
+
+/*!
+Lock-free multiple producers/single consumer queue of runners (D. Vyukov intrusive MPSC algorithm),
+- push is wait-free and can be called by any thread
+- pop must be called by one consumer thread, it can return null while a producer is pushing,
+in this case the producer has to signal the consumer after its push (see Handler and ThreadQueue)
+Nodes are allocated on the Slab of the producer thread */
+struct RunnerQueue : virtual Object {
+	RunnerQueue();
+	~RunnerQueue() { clear(); }
+
+	/*!
+	Count of runners queued (can include runners which are pushing) */
+	UInt32			size() const { return _size; }
+	bool			empty() const { return !_size; }
+
+	void			push(shared<Runner>&& pRunner);
+	void			push(const shared<Runner>& pRunner) { push(shared<Runner>(pRunner)); }
+	shared<Runner>	pop() { Int64 queued; return pop(queued); }
+	/*!
+	Pop and get the Metrics::Clock() time of its push, 0 if Metrics were disabled */
+	shared<Runner>	pop(Int64& queued);
+	/*!
+	Consumer side, remove all */
+	void			clear() { while (pop() || !empty()); }
+
+private:
+	struct Node {
+		Node() : pNext(NULL), queued(0) {}
+		Node(shared<Runner>&& pRunner) : pRunner(std::move(pRunner)), pNext(NULL), queued(Metrics::Enabled() ? Metrics::Clock() : 0) {}
+		shared<Runner>		pRunner;
+		Int64				queued;
+		std::atomic<Node*>	pNext;
+	};
+	void push(Node* pNode);
+
+	std::atomic<Node*>		_pHead; // producers side
+	Node*					_pTail; // consumer side
+	Node					_stub;
+	std::atomic<UInt32>		_size;
+};
+
+
+} // namespace Mona
@@ -0,0 +1,63 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+
+namespace Mona {
+
+/*!
+Per-thread slab allocator for small and short-lived objects (runners, queue nodes),
+- a thread allocates from its own free lists without lock
+- a block released by an other thread goes back to its allocator thread with a lock-free push (remote free list)
+- a size greater than 1024 bytes uses malloc */
+struct Slab : virtual Static {
+	static void* Allocate(std::size_t size);
+	static void  Deallocate(void* pData);
+
+	/*!
+	STL allocator to use with std::allocate_shared */
+	template<typename Type>
+	struct Allocator {
+		typedef Type value_type;
+
+		Allocator() {}
+		template<typename OtherType>
+		Allocator(const Allocator<OtherType>& other) {}
+
+		Type* allocate(std::size_t count) { return (Type*)Slab::Allocate(count * sizeof(Type)); }
+		void  deallocate(Type* pData, std::size_t count) { Slab::Deallocate(pData); }
+
+		template<typename OtherType>
+		bool operator==(const Allocator<OtherType>& other) const { return true; }
+		template<typename OtherType>
+		bool operator!=(const Allocator<OtherType>& other) const { return false; }
+	};
+
+	/*!
+	Replace std::make_shared, object and its control block are allocated on the slab */
+	template<typename Type, typename ...Args>
+	static shared<Type> MakeShared(Args&&... args) { return std::allocate_shared<Type>(Allocator<Type>(), std::forward<Args>(args)...); }
+
+private:
+	struct Cache;
+	struct Block;
+	static Cache* CurrentCache();
+};
+
+
+} // namespace Mona
@@ -0,0 +1,138 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include <vector>
+
+namespace Mona {
+
+/*!
+Dense storage of values identified by generational ids.
+An id is a slot index (24 bits) with the generation of the slot (8 bits) incremented on every reuse, so a stale id doesn't find the new value.
+Free slots are reused in FIFO order, 0 is never a valid id.
+Values are contiguous to iterate fast by index: a removal moves the last value to the place of the removed one */
+template<typename ValueType>
+struct SlotMap : virtual Object {
+	enum : UInt32 {
+		INDEX_BITS = 24,
+		INDEX_MASK = (1 << INDEX_BITS) - 1,
+		MAX_SIZE = INDEX_MASK // slot 0 is reserved
+	};
+
+	SlotMap() : _slots(1), _freeHead(0), _freeTail(0) {}
+
+	UInt32		size() const { return UInt32(_values.size()); }
+	bool		empty() const { return _values.empty(); }
+
+	/*!
+	Value by position, from 0 to size()-1 */
+	ValueType&			operator[](UInt32 index) { return _values[index]; }
+	const ValueType&	operator[](UInt32 index) const { return _values[index]; }
+	/*!
+	Id of the value at this position */
+	UInt32				id(UInt32 index) const { const Slot& slot = _slots[_slotIndexes[index]]; return (UInt32(slot.generation) << INDEX_BITS) | _slotIndexes[index]; }
+
+	typename std::vector<ValueType>::iterator		begin() { return _values.begin(); }
+	typename std::vector<ValueType>::iterator		end() { return _values.end(); }
+	typename std::vector<ValueType>::const_iterator	begin() const { return _values.begin(); }
+	typename std::vector<ValueType>::const_iterator	end() const { return _values.end(); }
+
+	ValueType* find(UInt32 id) {
+		UInt32 slotIndex = id & INDEX_MASK;
+		if (!slotIndex || slotIndex >= _slots.size())
+			return NULL;
+		const Slot& slot = _slots[slotIndex];
+		if (slot.free || slot.generation != (id >> INDEX_BITS))
+			return NULL;
+		return &_values[slot.index];
+	}
+	const ValueType* find(UInt32 id) const { return ((SlotMap*)this)->find(id); }
+
+	/*!
+	Returns the id of the value added, or 0 if MAX_SIZE is reached */
+	template<typename ArgType>
+	UInt32 add(ArgType&& value) {
+		UInt32 slotIndex = _freeHead;
+		if (slotIndex) {
+			_freeHead = _slots[slotIndex].index;
+			if (!_freeHead)
+				_freeTail = 0;
+		} else {
+			if (_slots.size() > MAX_SIZE)
+				return 0;
+			slotIndex = UInt32(_slots.size());
+			_slots.emplace_back();
+		}
+		Slot& slot = _slots[slotIndex];
+		slot.free = false;
+		slot.index = UInt32(_values.size());
+		_values.emplace_back(std::forward<ArgType>(value));
+		_slotIndexes.emplace_back(slotIndex);
+		return (UInt32(slot.generation) << INDEX_BITS) | slotIndex;
+	}
+
+	bool remove(UInt32 id) {
+		if (!find(id))
+			return false;
+		UInt32 slotIndex = id & INDEX_MASK;
+		Slot& slot = _slots[slotIndex];
+		// move the last value in the hole
+		UInt32 last = UInt32(_values.size()) - 1;
+		if (slot.index != last) {
+			_values[slot.index] = std::move(_values[last]);
+			_slotIndexes[slot.index] = _slotIndexes[last];
+			_slots[_slotIndexes[last]].index = slot.index;
+		}
+		_values.pop_back();
+		_slotIndexes.pop_back();
+		// free slot in FIFO
+		slot.free = true;
+		++slot.generation;
+		slot.index = 0;
+		if (_freeTail)
+			_slots[_freeTail].index = slotIndex;
+		else
+			_freeHead = slotIndex;
+		_freeTail = slotIndex;
+		return true;
+	}
+
+	void clear() {
+		_slots.resize(1);
+		_values.clear();
+		_slotIndexes.clear();
+		_freeHead = _freeTail = 0;
+	}
+
+private:
+	struct Slot {
+		Slot() : index(0), generation(0), free(true) {}
+		UInt32	index; // value index if used, otherwise next free slot (0 = none)
+		UInt8	generation;
+		bool	free;
+	};
+
+	std::vector<ValueType>	_values;
+	std::vector<UInt32>		_slotIndexes; // slot of each value
+	std::vector<Slot>		_slots;
+	UInt32					_freeHead;
+	UInt32					_freeTail;
+};
+
+
+} // namespace Mona
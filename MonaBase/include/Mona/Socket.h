@@ -22,6 +22,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #include "Mona/Packet.h"
 #include "Mona/Handler.h"
 #include "Mona/Parameters.h"
+#include "Mona/File.h"
 #include <deque>
 
 namespace Mona {
@@ -136,9 +137,17 @@ struct Socket : virtual Object, Net::Stats {
 	
 	int			 receive(Exception& ex, void* buffer, UInt32 size, int flags = 0) { return receive(ex, buffer, size, flags, NULL); }
 	int			 receiveFrom(Exception& ex, void* buffer, UInt32 size, SocketAddress& address, int flags = 0)  { return receive(ex, buffer, size, flags, &address); }
+	/*!
+	Receive count datagrams at the most in one system call when possible (recvmmsg), each buffer is resized to the datagram received
+	Returns the count of datagrams received (or -1 if error), a truncated datagram is dropped and sets ex to NET_EMSGSIZE */
+	virtual int	 receiveFrom(Exception& ex, shared<Buffer>* pBuffers, SocketAddress* pAddresses, UInt32 count, int flags = 0);
 
 	int			 send(Exception& ex, const void* data, UInt32 size, int flags = 0) { return sendTo(ex, data, size, SocketAddress::Wildcard(), flags); }
 	virtual int	 sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags=0);
+	/*!
+	Gather count packets in one system call (writev/sendmsg, IOV_MAX packets at the most), for a datagram socket it makes one datagram
+	Returns size of data sent (or -1 if error) */
+	virtual int	 gather(Exception& ex, const Packet* const* packets, UInt32 count, const SocketAddress& address, int flags = 0);
 
 	/*!
 	Sequential and safe writing, can queue data if can't send immediatly (flush required on onFlush event)
@@ -146,6 +155,19 @@ struct Socket : virtual Object, Net::Stats {
 	int			 write(Exception& ex, const Packet& packet, int flags = 0) { return write(ex, packet, SocketAddress::Wildcard(), flags); }
 	int			 write(Exception& ex, const Packet& packet, const SocketAddress& address, int flags = 0);
 	/*!
+	Write count packets in a row with one system call when possible (sendmmsg for a datagram socket, writev for a stream socket)
+	Returns count of packets sent or queued (or -1 if error), with a datagram socket the packets following a datagram in error are not queued */
+	int			 write(Exception& ex, const Packet* const* packets, UInt32 count, int flags = 0) { return write(ex, packets, count, SocketAddress::Wildcard(), flags); }
+	int			 write(Exception& ex, const Packet* const* packets, UInt32 count, const SocketAddress& address, int flags = 0);
+	/*!
+	Send size bytes of file from its reading position, without copy in user space if zeroCopy() (sendfile),
+	waits that nothing is queueing before to send to keep the order (flush required on onFlush event)
+	Returns size of data sent immediatly, less than size means wait onFlush (or -1 if error, for TCP socket a SHUTDOWN_SEND is done) */
+	int			 sendFile(Exception& ex, File& file, UInt32 size);
+	/*!
+	True if sendFile works without copy in user space */
+	virtual bool zeroCopy() const;
+	/*!
 	Flush packets, return false on socket error */
 	bool		 flush(Exception& ex) { return flush(ex, false); }
 
@@ -168,6 +190,15 @@ protected:
 	virtual int		receive(Exception& ex, void* buffer, UInt32 size, int flags, SocketAddress* pAddress);
 
 
+	/*!
+	Send file data from its reading position, returns size of data sent (or -1 if error) */
+	virtual int		transferFile(Exception& ex, File& file, UInt32 size);
+	// transferFile fallback with a copy (read + sendTo)
+	int				copyFile(Exception& ex, File& file, UInt32 size);
+#if !defined(_WIN32)
+	static int		FileDescriptor(const File& file) { return int(file._handle); }
+#endif
+
 	void			send(UInt32 count) { _sendTime = Time::Now(); _sendByteRate += count; }
 	void			receive(UInt32 count) { _recvTime = Time::Now(); _recvByteRate += count; }
 	virtual bool	flush(Exception& ex, bool deleting);
@@ -233,6 +264,11 @@ private:
 		const int			flags;
 	};
 
+	// _mutexSending must be locked, returns size of data sent (or -1 if error and socket closed)
+	int	flushSendings(Exception& ex, bool deleting);
+	// send the first packets of _sendings in one system call, returns count of packets completly sent (or -1 if error)
+	int	sendSendings(Exception& ex, UInt32& written);
+
 	Exception					_ex;
 	mutable std::mutex			_mutexSending;
 	std::deque<Sending>			_sendings;
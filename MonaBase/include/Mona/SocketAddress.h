@@ -94,6 +94,11 @@ struct SocketAddress : private IPAddress, virtual Object {
 	bool operator >  (const SocketAddress& address) const { return !operator<=(address); }
 	bool operator >= (const SocketAddress& address) const { return operator==(address) || operator>(address); }
 
+	/*!
+	64 bits hash of host and port, see HashMap */
+	UInt64 hash() const;
+	struct Hasher { UInt64 operator()(const SocketAddress& address) const { return address.hash(); } };
+
 	// Returns a wildcard IPv4 or IPv6 address (0.0.0.0) with port to 0
 	static const SocketAddress& Wildcard(IPAddress::Family family = IPAddress::IPv4);
 
@@ -577,16 +577,17 @@ struct String : std::string {
 		return Append<OutType>(out, std::forward<Args>(args)...);
 	}
 	struct Log : virtual Mona::Object {
-		Log(const char* level, const std::string& file, long line, const std::string& message, UInt32 threadId = 0) : threadId(threadId), level(level), file(file), line(line), message(message) {}
+		Log(const char* level, const std::string& file, long line, const std::string& message, UInt32 threadId = 0, Int64 time = 0) : threadId(threadId), time(time), level(level), file(file), line(line), message(message) {}
 		const char*			level;
 		const std::string&	file;
 		const long			line;
 		const std::string&	message;
 		const UInt32		threadId;
+		const Int64			time; // 0 = now
 	};
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, const Log& log, Args&&... args) {
-		UInt32 size = Mona::Date().format("%d/%m %H:%M:%S.%c  ", out).size();
+		UInt32 size = Mona::Date(log.time ? log.time : Mona::Time::Now()).format("%d/%m %H:%M:%S.%c  ", out).size();
 		out.append(7 - (Append<OutType>(out,log.level).size() - size), ' ');
 		if (log.threadId) {
 			Append<OutType>(out, log.threadId);
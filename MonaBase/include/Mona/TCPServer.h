@@ -38,6 +38,9 @@ struct TCPServer : virtual Object {
 	Socket*				  operator->() { return socket().get(); }
 
 
+	/*!
+	Start to listen, with several io reactors the address is listened by one socket by reactor (SO_REUSEPORT),
+	the system distributes then connections between reactors */
 	bool		start(Exception& ex, const SocketAddress& address);
 	bool		start(Exception& ex, const IPAddress& ip=IPAddress::Wildcard()) { return start(ex, SocketAddress(ip, 0)); }
 	bool		running() const { return _pSocket && _pSocket->listening();  }
@@ -47,6 +50,7 @@ protected:
 
 private:
 	shared<Socket>		_pSocket;
+	std::vector<shared<Socket>>	_sockets; // listeners on others reactors
 	shared<TLS>			_pTLS;
 	bool				_subscribed;
 };
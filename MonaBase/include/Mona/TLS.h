@@ -48,11 +48,18 @@ struct TLS : virtual Object {
 		bool connect(Exception& ex, const SocketAddress& address, UInt16 timeout = 0);
 		int	 receive(Exception& ex, void* buffer, UInt32 size, int flags = 0) { return Mona::Socket::receive(ex, buffer, size, flags); }
 		int	 sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags = 0);
+		/*!
+		Coalesce small packets to write one TLS record */
+		int	 gather(Exception& ex, const Packet* const* packets, UInt32 count, const SocketAddress& address, int flags = 0);
+		/*!
+		True if kernel TLS sends records (kTLS), sendFile works then without copy in user space */
+		bool zeroCopy() const;
 		bool flush(Exception& ex) { return Mona::Socket::flush(ex); }
 
 	private:
 		int	 receive(Exception& ex, void* buffer, UInt32 size, int flags, SocketAddress* pAddress);
 		bool flush(Exception& ex, bool deleting) override;
+		int	 transferFile(Exception& ex, File& file, UInt32 size) override;
 		bool close(Socket::ShutdownType type = SHUTDOWN_BOTH);
 
 		Mona::Socket* newSocket(Exception& ex, NET_SOCKET sockfd, const sockaddr& addr);
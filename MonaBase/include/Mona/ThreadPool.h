@@ -17,38 +17,103 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #pragma once
 
 #include "Mona/Mona.h"
-#include "Mona/ThreadQueue.h"
+#include "Mona/Thread.h"
+#include "Mona/RunnerQueue.h"
+#include "Mona/Slab.h"
+#include <deque>
 #include <vector>
 
 namespace Mona {
 
+/*!
+Work-stealing thread pool,
+runners are queued on strands (track number) which keep their execution order (a socket is always queued on the same strand),
+a strand is scheduled on the worker thread which has run it the last time, and an idle worker can steal it if this worker is busy */
 struct ThreadPool : virtual Object {
 	ThreadPool(UInt16 threads = 0) : _current(0) { init(threads); }
 	ThreadPool(Thread::Priority priority, UInt16 threads = 0) : _current(0) { init(threads, priority); }
+	virtual ~ThreadPool() { while (join()); }
+
+	static const UInt16 STRANDS_PER_THREAD = 16;
+
+	/*!
+	Current thread pool, NULL if caller is not a worker thread */
+	static const ThreadPool* Current() { return _PCurrent; }
 
 	UInt16	threads() const { return _size; }
+	UInt16	strands() const { return UInt16(_strands.size()); }
 
 	UInt16	join();
 
+	struct Stats {
+		Stats() : queueing(0), runs(0), steals(0) {}
+		UInt32	queueing; // strands waiting in the worker queue
+		UInt64	runs; // runners executed
+		UInt64	steals; // strands stolen from other workers
+	};
+	/*!
+	Stats of the worker thread, index from 0 to threads(), to watch imbalance */
+	Stats	stats(UInt16 thread) const;
+
+	/*!
+	Queue runner on strand "thread", if thread is 0 a strand is assigned to it (round-robin) */
 	template<typename RunnerType>
 	void queue(UInt16& thread, RunnerType&& pRunner) const {
-		if (thread)
-			return _threads[thread - 1]->queue(std::forward<RunnerType>(pRunner));
-		_threads[thread = (_current++%_size)]->queue(std::forward<RunnerType>(pRunner));
-		++thread;
+		DEBUG_ASSERT(pRunner); // more easy to debug that if it fails in the thread!
+		if (!thread)
+			thread = (_current++ % _strands.size()) + 1;
+		Strand& strand = *_strands[thread - 1];
+		strand.runners.push(std::forward<RunnerType>(pRunner));
+		if (!strand.scheduled.exchange(true))
+			schedule(strand);
 	}
 	template<typename RunnerType>
 	void queue(std::nullptr_t, RunnerType&& pRunner) const { UInt16 thread(0); queue<RunnerType>(thread, std::forward<RunnerType>(pRunner)); }
 	template <typename RunnerType, typename ...Args>
-	void queue(UInt16& thread, Args&&... args) const { queue(thread, std::make_shared<RunnerType>(std::forward<Args>(args)...)); }
+	void queue(UInt16& thread, Args&&... args) const { queue(thread, Slab::MakeShared<RunnerType>(std::forward<Args>(args)...)); }
 	template <typename RunnerType, typename ...Args>
 	void queue(std::nullptr_t, Args&&... args) const { UInt16 thread(0); queue<RunnerType>(thread, std::forward<Args>(args)...); }
 private:
+	struct Strand : virtual Object {
+		Strand(UInt16 worker) : scheduled(false), worker(worker) {}
+		RunnerQueue				runners;
+		std::atomic<bool>		scheduled; // in a worker queue or running
+		std::atomic<UInt16>		worker; // last worker which has run it
+	};
+	struct Worker : Thread, virtual Object {
+		Worker(const ThreadPool& pool, UInt16 index, Thread::Priority priority) : Thread("ThreadPool"), index(index), idle(false), queueing(0), runs(0), steals(0), _pool(pool), _priority(priority) {}
+		~Worker() { stop(); }
+
+		const UInt16				index;
+		std::atomic<bool>			idle;
+		std::atomic<UInt32>			queueing;
+		std::atomic<UInt64>			runs;
+		std::atomic<UInt64>			steals;
+
+		void	 push(Strand& strand);
+		Strand*  pop();
+		Strand*  steal();
+		void	 wake();
+	private:
+		bool run(Exception& ex, const volatile bool& requestStop);
+
+		const ThreadPool&			_pool;
+		std::deque<Strand*>			_strands;
+		std::mutex					_mutex; // protect _strands
+		std::mutex					_mutexStart;
+		Thread::Priority			_priority;
+	};
+
 	void init(UInt16 threads, Thread::Priority priority = Thread::PRIORITY_NORMAL);
+	void schedule(Strand& strand) const;
+	Strand* steal(Worker& thief) const;
 
-	mutable std::vector<unique<ThreadQueue>>	_threads;
+	std::vector<unique<Strand>>					_strands; // before _workers to be deleted after
+	std::vector<unique<Worker>>					_workers;
 	mutable std::atomic<UInt16>					_current;
 	UInt16										_size;
+
+	static thread_local const ThreadPool*		_PCurrent;
 };
 
 
@@ -18,8 +18,8 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 #include "Mona/Mona.h"
 #include "Mona/Thread.h"
-#include "Mona/Runner.h"
-#include <deque>
+#include "Mona/RunnerQueue.h"
+#include "Mona/Slab.h"
 
 namespace Mona {
 
@@ -32,19 +32,23 @@ struct ThreadQueue : Thread, virtual Object {
 	template<typename RunnerType>
 	void queue(RunnerType&& pRunner) {
 		DEBUG_ASSERT(pRunner); // more easy to debug that if it fails in the thread!
-		std::lock_guard<std::mutex> lock(_mutex);
-		start(_priority);
-		_runners.emplace_back(std::forward<RunnerType>(pRunner));
+		_runners.push(std::forward<RunnerType>(pRunner));
+		// push before to check running, see ThreadQueue::run which stops before to check _runners
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!running()) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			start(_priority);
+		}
 		wakeUp.set();
 	}
 	template <typename RunnerType, typename ...Args>
-	void queue(Args&&... args) { queue(std::make_shared<RunnerType>(std::forward<Args>(args)...)); }
+	void queue(Args&&... args) { queue(Slab::MakeShared<RunnerType>(std::forward<Args>(args)...)); }
 
 private:
 	bool run(Exception& ex, const volatile bool& requestStop);
 
-	std::deque<shared<Runner>>			_runners;
-	std::mutex							_mutex;
+	RunnerQueue							_runners;
+	std::mutex							_mutex; // protect start
 	static thread_local ThreadQueue*	_PCurrent;
 	Priority							_priority;
 };
@@ -24,21 +24,26 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 namespace Mona {
 
-
+/*!
+Hierarchical timing wheel with a 1ms tick: 256 slots for the next 256ms, then 4 levels of 64 slots
+cascaded on the previous level (up to 2^32ms). OnTimer is chained intrusively in its slot,
+so set/remove/re-arm are O(1) without any allocation */
 struct Timer : virtual Object {
-	Timer() : _count(0) {}
+	Timer();
 	~Timer();
 
+	struct Slot;
+
 /*!
 	OnTimer is a function which returns the timeout in ms of next call, or 0 to stop the timer.
 	"count" parameter informs on the number of raised time */
 	struct OnTimer : std::function<UInt32(UInt32 delay)>, virtual Object {
 		NULLABLE(!_nextRaising)
 
-		OnTimer() : _nextRaising(0), count(0) {}
+		OnTimer() : _nextRaising(0), count(0), _pSlot(NULL), _pPrev(NULL), _pNext(NULL) {}
 		// explicit to forbid to pass in "const OnTimer" parameter directly a lambda function
 		template<typename FunctionType>
-		explicit OnTimer(FunctionType&& function) : _nextRaising(0), count(0), std::function<UInt32(UInt32)>(std::move(function)) {}
+		explicit OnTimer(FunctionType&& function) : _nextRaising(0), count(0), _pSlot(NULL), _pPrev(NULL), _pNext(NULL), std::function<UInt32(UInt32)>(std::move(function)) {}
 
 		~OnTimer() { if (_nextRaising) FATAL_ERROR("OnTimer function deleting while running"); }
 
@@ -56,11 +61,23 @@ struct Timer : virtual Object {
 
 		const UInt32 count;
 	private:
-		mutable Time	_nextRaising;
+		mutable Time			_nextRaising;
+		// intrusive chaining in the wheel slot
+		mutable Slot*			_pSlot;
+		mutable const OnTimer*	_pPrev;
+		mutable const OnTimer*	_pNext;
 
 		friend struct Timer;
 	};
 
+	struct Slot : virtual Object {
+		Slot() : pFirst(NULL), pLast(NULL), pBits(NULL), mask(0) {}
+		const OnTimer*	pFirst;
+		const OnTimer*	pLast;
+		UInt64*			pBits; // occupancy bit of the first level, to find quickly the next raising
+		UInt64			mask;
+	};
+
 	UInt32 count() const { return _count; }
 
 /*!
@@ -73,11 +90,27 @@ struct Timer : virtual Object {
 	UInt32 raise();
 
 private:
-	void add(const OnTimer& onTimer,  UInt32 timeout) const;
-	bool remove(const OnTimer& onTimer, shared<std::set<const OnTimer*>>& pMove) const;
+	enum {
+		FIRST_BITS = 8,
+		LEVEL_BITS = 6,
+		LEVELS = 4,
+		FIRST_SLOTS = 1 << FIRST_BITS,
+		LEVEL_SLOTS = 1 << LEVEL_BITS,
+		SLOTS = FIRST_SLOTS + LEVELS*LEVEL_SLOTS
+	};
 
-	mutable	UInt32												_count;
-	mutable std::map<Int64, shared<std::set<const OnTimer*>>>	_timers;
+	void add(const OnTimer& onTimer, Int64 time) const;
+	void remove(const OnTimer& onTimer) const;
+	void cascade(UInt8 level) const;
+	/*!
+	Next first level slot used after index, FIRST_SLOTS if none */
+	UInt16 next(UInt16 index) const;
+
+	mutable	UInt32			_count;
+	mutable Int64			_current; // next tick to raise
+	bool					_raising;
+	mutable Slot			_slots[SLOTS];
+	mutable UInt64			_bits[FIRST_SLOTS / 64];
 };
 
 
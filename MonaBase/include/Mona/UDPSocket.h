@@ -32,13 +32,16 @@ struct UDPSocket : virtual Object {
 
 	IOSocket&	io;
 
-	const shared<Socket>& socket();
+	const shared<Socket>& socket() { return socket(false); }
 	Socket&			      operator*() { return *socket(); }
 	Socket*				  operator->() { return socket().get(); }
 
 	bool		connect(Exception& ex, const SocketAddress& address);
 	bool		connected() const { return _pSocket && _pSocket->peerAddress().operator bool(); }
 
+	/*!
+	Bind the socket, with several io reactors a fixed port is bound by one socket by reactor (SO_REUSEPORT) to spread receptions,
+	excepting if a decoder is used (its decoding state can't be split between sockets), sending uses always socket() */
 	bool		bind(Exception& ex, const SocketAddress& address);
 	bool		bind(Exception& ex, const IPAddress& ip = IPAddress::Wildcard()) { return bind(ex, SocketAddress(ip, 0)); }
 	bool		bound() { return _pSocket && _pSocket->address().operator bool();  }
@@ -70,7 +73,10 @@ struct UDPSocket : virtual Object {
 private:
 	virtual Socket::Decoder* newDecoder() { return NULL; }
 
+	const shared<Socket>& socket(bool reusePort);
+
 	shared<Socket>		_pSocket;
+	std::vector<shared<Socket>>	_sockets; // receivers on others reactors
 	bool				_subscribed;
 	UInt16				_sendingTrack;
 };
@@ -128,6 +128,15 @@ bool Application::init(int argc, const char* argv[]) {
 		if (!Logs::AddLogger<FileLogger>(String("file!", name(), " already running?"), move(logDir), sizeByFile, rotation))
 			FATAL_ERROR(name(), " initLogs can't override file logger");
 	}
+	UInt16 rateLimit(0);
+	if (getNumber("logs.rateLimit", rateLimit))
+		Logs::SetRateLimit(rateLimit);
+	if (getBoolean("logs.async")) {
+		UInt32 bufferSize(0x10000);
+		getNumber("logs.buffer", bufferSize);
+		const char* overflow = getString("logs.overflow");
+		Logs::SetAsync(true, bufferSize, overflow && String::ICompare(overflow, "block") == 0 ? Logs::OVERFLOW_BLOCK : Logs::OVERFLOW_DROP);
+	}
 
 	// 4 - first logs
 	if (_version)
@@ -16,14 +16,168 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 #include "Mona/Buffer.h"
 #include "Mona/Exceptions.h"
+#include "Mona/Thread.h"
+#include "Mona/Metrics.h"
+#include <mutex>
+#include <vector>
 
 using namespace std;
 
 namespace Mona {
 
+#define MAGAZINE_MAX	32
+
 atomic_flag Buffer::Allocator::_Mutex = ATOMIC_FLAG_INIT;
 unique<Buffer::Allocator>	Buffer::Allocator::_PAllocator(SET);
 
+static atomic<UInt16>	_Magazines[Buffer::Allocator::CLASSES]; // magazine size by class, 0 if disabled
+// magazines of running threads + stats of ended threads
+static mutex&			Mutex() { static mutex& Mutex(*new mutex()); return Mutex; }
+static vector<Object*>&	Actives() { static vector<Object*>& Actives(*new vector<Object*>()); return Actives; }
+static Buffer::Allocator::Stats* Ended() { static Buffer::Allocator::Stats* Ended(new Buffer::Allocator::Stats[Buffer::Allocator::CLASSES]); return Ended; }
+// trivial thread_local variables to stay valid during thread_local destructions
+static thread_local Object*	_PMagazines(NULL);
+static thread_local bool	_Exited(false);
+
+static thread_local struct MagazinesHolder {
+	~MagazinesHolder() {
+		_Exited = true;
+		Object* pMagazines(_PMagazines);
+		_PMagazines = NULL;
+		delete pMagazines;
+	}
+} _Holder;
+
+static void Increment(atomic<UInt64>& counter) { counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed); }
+
+static UInt8 ClassIndex(UInt32 capacity) {
+	// capacity is a power of two >= 16, log2 with a De Bruijn sequence
+	static const UInt8 Log2[32] = { 0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8, 31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9 };
+	return Log2[(capacity * 0x077CB531u) >> 27] - 4;
+}
+
+struct Buffer::Allocator::Magazines : Object { // not virtual to be cast from Object*
+	// counters are atomic just to be read by an other thread (stats), only the owner thread writes it
+	struct Magazine {
+		Magazine() : count(0), hits(0), misses(0) {}
+		UInt8*				buffers[MAGAZINE_MAX];
+		atomic<UInt16>		count;
+		atomic<UInt64>		hits;
+		atomic<UInt64>		misses;
+	};
+
+	Magazines() : id(Thread::CurrentId()) {
+		lock_guard<mutex> lock(Mutex());
+		Actives().emplace_back(this);
+	}
+	~Magazines() {
+		{
+			lock_guard<mutex> lock(Mutex());
+			vector<Object*>& actives(Actives());
+			for (auto it = actives.begin(); it != actives.end(); ++it) {
+				if (*it != this)
+					continue;
+				actives.erase(it);
+				break;
+			}
+			Stats* ended(Ended());
+			for (UInt8 i = 0; i < CLASSES; ++i) {
+				ended[i].hits += classes[i].hits;
+				ended[i].misses += classes[i].misses;
+			}
+		}
+		// give back the buffers to the allocator
+		Lock();
+		for (UInt8 i = 0; i < CLASSES; ++i) {
+			if (classes[i].count)
+				_PAllocator->release(16u << i, classes[i].buffers, classes[i].count);
+		}
+		Unlock();
+	}
+
+	const UInt32	id;
+	Magazine		classes[CLASSES];
+};
+
+void Buffer::Allocator::SetMagazines() {
+	for (UInt8 i = 0; i < CLASSES; ++i)
+		_Magazines[i] = min<UInt16>(_PAllocator->magazine(16u << i), MAGAZINE_MAX);
+}
+
+Buffer::Allocator::Magazines* Buffer::Allocator::CurrentMagazines() {
+	if (!_PMagazines && !_Exited) {
+		(void)&_Holder; // build the holder to release the magazines on thread exit
+		_PMagazines = new Magazines();
+	}
+	return (Magazines*)_PMagazines;
+}
+
+Buffer::Allocator::Stats Buffer::Allocator::ClassStats(UInt8 index) {
+	Stats stats;
+	if (index >= CLASSES)
+		return stats;
+	UInt32 capacity(16u << index);
+	lock_guard<mutex> lock(Mutex());
+	stats = Ended()[index];
+	for (Object* pObject : Actives()) {
+		const Magazines::Magazine& magazine(((Magazines*)pObject)->classes[index]);
+		stats.hits += magazine.hits;
+		stats.misses += magazine.misses;
+		stats.held += UInt64(magazine.count) * capacity;
+	}
+	Lock();
+	stats.held += _PAllocator->held(capacity);
+	Unlock();
+	return stats;
+}
+
+static void ClassSeries(const Metrics::Series::Add& add, UInt64 Buffer::Allocator::Stats::*pValue) {
+	for (UInt8 i = 0; i < Buffer::Allocator::CLASSES; ++i) {
+		Buffer::Allocator::Stats stats = Buffer::Allocator::ClassStats(i);
+		if (stats.hits || stats.misses || stats.held) // capacity class used
+			add(String(16u << i), Int64(stats.*pValue));
+	}
+}
+static void ThreadSeries(const Metrics::Series::Add& add, UInt64 Buffer::Allocator::Stats::*pValue) {
+	map<UInt32, Buffer::Allocator::Stats> stats;
+	Buffer::Allocator::ThreadStats(stats);
+	for (const auto& it : stats)
+		add(String(it.first), Int64(it.second.*pValue));
+}
+// by capacity class (bytes) and by thread id
+static Metrics::Series Hits("mona_buffers_hits", "class", "Buffer allocations served by a thread magazine", [](const Metrics::Series::Add& add) {
+	ClassSeries(add, &Buffer::Allocator::Stats::hits);
+}, true);
+static Metrics::Series Misses("mona_buffers_misses", "class", "Buffer allocations which have not been served by pools", [](const Metrics::Series::Add& add) {
+	ClassSeries(add, &Buffer::Allocator::Stats::misses);
+}, true);
+static Metrics::Series Held("mona_buffers_held_bytes", "class", "Bytes of free buffers held by allocator pools", [](const Metrics::Series::Add& add) {
+	ClassSeries(add, &Buffer::Allocator::Stats::held);
+});
+static Metrics::Series ThreadHits("mona_buffers_thread_hits", "thread", "Buffer allocations served by the magazines of a running thread", [](const Metrics::Series::Add& add) {
+	ThreadSeries(add, &Buffer::Allocator::Stats::hits);
+}, true);
+static Metrics::Series ThreadMisses("mona_buffers_thread_misses", "thread", "Buffer allocations of a running thread which have not been served by its magazines", [](const Metrics::Series::Add& add) {
+	ThreadSeries(add, &Buffer::Allocator::Stats::misses);
+}, true);
+static Metrics::Series ThreadHeld("mona_buffers_thread_held_bytes", "thread", "Bytes of free buffers held by the magazines of a running thread", [](const Metrics::Series::Add& add) {
+	ThreadSeries(add, &Buffer::Allocator::Stats::held);
+});
+
+void Buffer::Allocator::ThreadStats(map<UInt32, Stats>& stats) {
+	lock_guard<mutex> lock(Mutex());
+	for (Object* pObject : Actives()) {
+		const Magazines& magazines(*(Magazines*)pObject);
+		Stats& result(stats[magazines.id]);
+		for (UInt8 i = 0; i < CLASSES; ++i) {
+			const Magazines::Magazine& magazine(magazines.classes[i]);
+			result.hits += magazine.hits;
+			result.misses += magazine.misses;
+			result.held += UInt64(magazine.count) * (16u << i);
+		}
+	}
+}
+
 UInt32 Buffer::Allocator::ComputeCapacity(UInt32 size) {
 	if (size <= 16) // at minimum allocate 16 bytes!
 		return 16;
@@ -38,14 +192,64 @@ UInt32 Buffer::Allocator::ComputeCapacity(UInt32 size) {
 }
 UInt8* Buffer::Allocator::Alloc(UInt32& size) {
 	size = ComputeCapacity(size);
-	if (size>0x80000000 || !TryLock())
+	if (size>0x80000000)
+		return new UInt8[size];
+	UInt8 index(ClassIndex(size));
+	UInt16 magazine(_Magazines[index]);
+	Magazines* pMagazines(magazine ? CurrentMagazines() : NULL);
+	if (pMagazines) {
+		Magazines::Magazine& current(pMagazines->classes[index]);
+		UInt16 count(current.count.load(memory_order_relaxed));
+		if (count) {
+			Increment(current.hits);
+		} else {
+			// refill the half of the magazine
+			Increment(current.misses);
+			if (!TryLock())
+				return new UInt8[size];
+			count = _PAllocator->refill(size, current.buffers, max<UInt16>(magazine / 2, 1));
+			Unlock();
+			if (!count)
+				return new UInt8[size];
+		}
+		current.count.store(--count, memory_order_relaxed);
+		return current.buffers[count];
+	}
+	if (!TryLock())
 		return new UInt8[size];
 	UInt8* buffer = _PAllocator->alloc(size);
 	Unlock();
 	return buffer;
 }
 void Buffer::Allocator::Free(UInt8* buffer, UInt32 size) {
-	if ((!size || (size & (size - 1))) || !TryLock())  // check than we have a size create with Alloc (capacity log2) + TryLock working!
+	if (!size || (size & (size - 1)))  // check than we have a size create with Alloc (capacity log2)
+		return delete[] buffer;
+	UInt8 index(ClassIndex(size));
+	UInt16 magazine(_Magazines[index]);
+	// if magazine is disabled, release the buffers always in the magazine
+	Magazines* pMagazines(magazine ? CurrentMagazines() : (Magazines*)_PMagazines);
+	if (pMagazines) {
+		Magazines::Magazine& current(pMagazines->classes[index]);
+		UInt16 count(current.count.load(memory_order_relaxed));
+		if (count >= magazine && count) {
+			// full, release the half of the magazine
+			UInt16 keep(magazine / 2);
+			if (TryLock()) {
+				_PAllocator->release(size, current.buffers + keep, count - keep);
+				Unlock();
+			} else {
+				while (count > keep)
+					delete[] current.buffers[--count];
+			}
+			current.count.store(count = keep, memory_order_relaxed);
+		}
+		if (count < magazine) {
+			current.buffers[count] = buffer;
+			current.count.store(++count, memory_order_relaxed);
+			return;
+		}
+	}
+	if (!TryLock()) // TryLock working, else delete
 		return delete[] buffer;
 	_PAllocator->free(buffer, size);
 	Unlock();
@@ -31,11 +31,25 @@ UInt8* BufferPool::Buffers::pop() {
 		_minSize = size();
 	return buffer;
 }
+UInt16 BufferPool::Buffers::pop(UInt8** buffers, UInt16 count) {
+	if (count > size())
+		count = UInt16(size());
+	memcpy(buffers, data() + size() - count, count * sizeof(UInt8*));
+	resize(size() - count);
+	if (size() < _minSize)
+		_minSize = size();
+	return count;
+}
 void BufferPool::Buffers::push(UInt8* buffer) {
 	emplace_back(buffer);
 	if (size() > _maxSize)
 		_maxSize = size();
 }
+void BufferPool::Buffers::push(UInt8** buffers, UInt16 count) {
+	insert(end(), buffers, buffers + count);
+	if (size() > _maxSize)
+		_maxSize = size();
+}
 void BufferPool::Buffers::manage(vector<UInt8*>& gc) {
 	// pickUp
 	UInt32 position = gc.size();
@@ -0,0 +1,425 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/Bytes.h"
+#include <cstring>
+#if defined(_M_X64) || defined(__x86_64__)
+#define MONA_BYTES_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET(FEATURES)
+#else
+#define TARGET(FEATURES) __attribute__((target(FEATURES)))
+#endif
+#endif
+
+using namespace std;
+
+namespace Mona {
+
+static inline UInt8 FirstBit(UInt64 value) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return UInt8(index);
+#else
+	return UInt8(__builtin_ctzll(value));
+#endif
+}
+
+////////////////////////////// SCALAR //////////////////////////////
+
+static void ScalarMask(UInt8* data, UInt32 size, const UInt8* mask) {
+	UInt32 i = 0;
+	if (size >= 8) {
+		UInt64 mask64;
+		memcpy(&mask64, mask, 4);
+		memcpy((UInt8*)&mask64 + 4, mask, 4);
+		for (; (i + 8) <= size; i += 8) {
+			UInt64 value;
+			memcpy(&value, data + i, 8);
+			value ^= mask64;
+			memcpy(data + i, &value, 8);
+		}
+	}
+	for (; i < size; ++i)
+		data[i] ^= mask[i & 3];
+}
+
+static const UInt8* ScalarFind(const UInt8* data, UInt32 size, UInt8 value) {
+	return (const UInt8*)memchr(data, value, size);
+}
+
+static const UInt8* ScalarFindStartCode(const UInt8* data, UInt32 size) {
+	// test the third byte in first to jump of 3 bytes in the most frequent case
+	UInt32 i = 0;
+	while ((i + 2) < size) {
+		if (data[i + 2] > 1)
+			i += 3;
+		else if (data[i + 2] == 1 && !data[i + 1] && !data[i])
+			return data + i;
+		else
+			++i;
+	}
+	return NULL;
+}
+
+enum {
+	JSON_QUOTES = 0,
+	JSON_BACKSLASHES,
+	JSON_OPERATORS,
+	JSON_SPACES
+};
+
+static void ScalarClassifyJSON(const UInt8* data, UInt64* masks) {
+	memset(masks, 0, 4 * sizeof(UInt64));
+	for (UInt8 i = 0; i < 64; ++i) {
+		UInt64 bit = 1ull << i;
+		switch (data[i]) {
+			case '"':
+				masks[JSON_QUOTES] |= bit;
+				break;
+			case '\\':
+				masks[JSON_BACKSLASHES] |= bit;
+				break;
+			case '{': case '}': case '[': case ']': case ':': case ',':
+				masks[JSON_OPERATORS] |= bit;
+				break;
+			case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+				masks[JSON_SPACES] |= bit;
+				break;
+			default:;
+		}
+	}
+}
+
+#if defined(MONA_BYTES_X86)
+
+////////////////////////////// SSE2 //////////////////////////////
+
+static void SSE2Mask(UInt8* data, UInt32 size, const UInt8* mask) {
+	UInt32 mask32;
+	memcpy(&mask32, mask, 4);
+	__m128i mask128 = _mm_set1_epi32(mask32);
+	UInt32 i = 0;
+	for (; (i + 16) <= size; i += 16)
+		_mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data + i)), mask128));
+	ScalarMask(data + i, size - i, mask); // i is multiple of 4, mask stays aligned
+}
+
+static const UInt8* SSE2Find(const UInt8* data, UInt32 size, UInt8 value) {
+	__m128i value128 = _mm_set1_epi8(value);
+	UInt32 i = 0;
+	for (; (i + 16) <= size; i += 16) {
+		UInt32 bits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), value128));
+		if (bits)
+			return data + i + FirstBit(bits);
+	}
+	return ScalarFind(data + i, size - i, value);
+}
+
+static const UInt8* SSE2FindStartCode(const UInt8* data, UInt32 size) {
+	// compare 00 on i and i+1 and 01 on i+2 for 16 positions in a row
+	__m128i zero = _mm_setzero_si128();
+	__m128i one = _mm_set1_epi8(1);
+	UInt32 i = 0;
+	for (; (i + 18) <= size; i += 16) {
+		__m128i found = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), zero), _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + 1)), zero));
+		UInt32 bits = _mm_movemask_epi8(_mm_and_si128(found, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + 2)), one)));
+		if (bits)
+			return data + i + FirstBit(bits);
+	}
+	return ScalarFindStartCode(data + i, size - i);
+}
+
+static void SSE2ClassifyJSON(const UInt8* data, UInt64* masks) {
+	// {}[] by pairs thanks to the 0x20 bit: '[' | 0x20 = '{' and ']' | 0x20 = '}'
+	__m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), bit5 = _mm_set1_epi8(0x20);
+	__m128i open = _mm_set1_epi8('{'), close = _mm_set1_epi8('}'), colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(',');
+	__m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'), cr = _mm_set1_epi8('\r');
+	memset(masks, 0, 4 * sizeof(UInt64));
+	for (UInt8 i = 0; i < 64; i += 16) {
+		__m128i value = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i lower = _mm_or_si128(value, bit5);
+		masks[JSON_QUOTES] |= UInt64(UInt16(_mm_movemask_epi8(_mm_cmpeq_epi8(value, quote)))) << i;
+		masks[JSON_BACKSLASHES] |= UInt64(UInt16(_mm_movemask_epi8(_mm_cmpeq_epi8(value, backslash)))) << i;
+		masks[JSON_OPERATORS] |= UInt64(UInt16(_mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(lower, open), _mm_cmpeq_epi8(lower, close)),
+			_mm_or_si128(_mm_cmpeq_epi8(value, colon), _mm_cmpeq_epi8(value, comma)))))) << i;
+		// 0x09 to 0x0D range with unsigned min/max
+		__m128i control = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(value, tab), value), _mm_cmpeq_epi8(_mm_min_epu8(value, cr), value));
+		masks[JSON_SPACES] |= UInt64(UInt16(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(value, space), control)))) << i;
+	}
+}
+
+////////////////////////////// AVX2 //////////////////////////////
+
+TARGET("avx2") static void AVX2Mask(UInt8* data, UInt32 size, const UInt8* mask) {
+	UInt32 mask32;
+	memcpy(&mask32, mask, 4);
+	__m256i mask256 = _mm256_set1_epi32(mask32);
+	UInt32 i = 0;
+	for (; (i + 32) <= size; i += 32)
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i)), mask256));
+	SSE2Mask(data + i, size - i, mask);
+}
+
+TARGET("avx2") static const UInt8* AVX2Find(const UInt8* data, UInt32 size, UInt8 value) {
+	__m256i value256 = _mm256_set1_epi8(value);
+	UInt32 i = 0;
+	// 4x unrolled, just one test by 128 bytes
+	for (; (i + 128) <= size; i += 128) {
+		__m256i found = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), value256), _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 32)), value256)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 64)), value256), _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 96)), value256)));
+		if (_mm256_movemask_epi8(found))
+			break;
+	}
+	for (; (i + 32) <= size; i += 32) {
+		UInt32 bits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), value256));
+		if (bits)
+			return data + i + FirstBit(bits);
+	}
+	return SSE2Find(data + i, size - i, value);
+}
+
+TARGET("avx2") static const UInt8* AVX2FindStartCode(const UInt8* data, UInt32 size) {
+	__m256i zero = _mm256_setzero_si256();
+	__m256i one = _mm256_set1_epi8(1);
+	UInt32 i = 0;
+	for (; (i + 34) <= size; i += 32) {
+		__m256i found = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), zero), _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 1)), zero));
+		UInt32 bits = _mm256_movemask_epi8(_mm256_and_si256(found, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 2)), one)));
+		if (bits)
+			return data + i + FirstBit(bits);
+	}
+	return SSE2FindStartCode(data + i, size - i);
+}
+
+TARGET("avx2") static void AVX2ClassifyJSON(const UInt8* data, UInt64* masks) {
+	__m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\'), bit5 = _mm256_set1_epi8(0x20);
+	__m256i open = _mm256_set1_epi8('{'), close = _mm256_set1_epi8('}'), colon = _mm256_set1_epi8(':'), comma = _mm256_set1_epi8(',');
+	__m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t'), cr = _mm256_set1_epi8('\r');
+	memset(masks, 0, 4 * sizeof(UInt64));
+	for (UInt8 i = 0; i < 64; i += 32) {
+		__m256i value = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i lower = _mm256_or_si256(value, bit5);
+		masks[JSON_QUOTES] |= UInt64(UInt32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(value, quote)))) << i;
+		masks[JSON_BACKSLASHES] |= UInt64(UInt32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(value, backslash)))) << i;
+		masks[JSON_OPERATORS] |= UInt64(UInt32(_mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(lower, open), _mm256_cmpeq_epi8(lower, close)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(value, colon), _mm256_cmpeq_epi8(value, comma)))))) << i;
+		__m256i control = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(value, tab), value), _mm256_cmpeq_epi8(_mm256_min_epu8(value, cr), value));
+		masks[JSON_SPACES] |= UInt64(UInt32(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(value, space), control)))) << i;
+	}
+}
+
+////////////////////////////// AVX-512 //////////////////////////////
+
+TARGET("avx512f,avx512bw") static void AVX512Mask(UInt8* data, UInt32 size, const UInt8* mask) {
+	UInt32 mask32;
+	memcpy(&mask32, mask, 4);
+	__m512i mask512 = _mm512_set1_epi32(mask32);
+	UInt32 i = 0;
+	for (; (i + 64) <= size; i += 64)
+		_mm512_storeu_si512((void*)(data + i), _mm512_xor_si512(_mm512_loadu_si512((const void*)(data + i)), mask512));
+	AVX2Mask(data + i, size - i, mask);
+}
+
+TARGET("avx512f,avx512bw") static const UInt8* AVX512Find(const UInt8* data, UInt32 size, UInt8 value) {
+	__m512i value512 = _mm512_set1_epi8(value);
+	UInt32 i = 0;
+	// 4x unrolled, just one test by 256 bytes
+	for (; (i + 256) <= size; i += 256) {
+		__mmask64 found = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i)), value512) |
+			_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i + 64)), value512) |
+			_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i + 128)), value512) |
+			_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i + 192)), value512);
+		if (found)
+			break;
+	}
+	for (; (i + 64) <= size; i += 64) {
+		UInt64 bits = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i)), value512);
+		if (bits)
+			return data + i + FirstBit(bits);
+	}
+	return AVX2Find(data + i, size - i, value);
+}
+
+TARGET("avx512f,avx512bw") static const UInt8* AVX512FindStartCode(const UInt8* data, UInt32 size) {
+	__m512i zero = _mm512_setzero_si512();
+	__m512i one = _mm512_set1_epi8(1);
+	UInt32 i = 0;
+	for (; (i + 66) <= size; i += 64) {
+		UInt64 bits = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i)), zero) &
+			_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i + 1)), zero) &
+			_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(data + i + 2)), one);
+		if (bits)
+			return data + i + FirstBit(bits);
+	}
+	return AVX2FindStartCode(data + i, size - i);
+}
+
+TARGET("avx512f,avx512bw") static void AVX512ClassifyJSON(const UInt8* data, UInt64* masks) {
+	__m512i value = _mm512_loadu_si512((const void*)data);
+	__m512i lower = _mm512_or_si512(value, _mm512_set1_epi8(0x20));
+	masks[JSON_QUOTES] = _mm512_cmpeq_epi8_mask(value, _mm512_set1_epi8('"'));
+	masks[JSON_BACKSLASHES] = _mm512_cmpeq_epi8_mask(value, _mm512_set1_epi8('\\'));
+	masks[JSON_OPERATORS] = _mm512_cmpeq_epi8_mask(lower, _mm512_set1_epi8('{')) | _mm512_cmpeq_epi8_mask(lower, _mm512_set1_epi8('}')) |
+		_mm512_cmpeq_epi8_mask(value, _mm512_set1_epi8(':')) | _mm512_cmpeq_epi8_mask(value, _mm512_set1_epi8(','));
+	masks[JSON_SPACES] = _mm512_cmpeq_epi8_mask(value, _mm512_set1_epi8(' ')) |
+		(_mm512_cmpge_epu8_mask(value, _mm512_set1_epi8('\t')) & _mm512_cmple_epu8_mask(value, _mm512_set1_epi8('\r')));
+}
+
+static bool Supports(Bytes::Kernel kernel) {
+	if (kernel <= Bytes::KERNEL_SSE2)
+		return true; // SSE2 is x86-64 baseline
+#if defined(_MSC_VER)
+	int infos[4];
+	__cpuid(infos, 1);
+	if (!(infos[2] & (1 << 27))) // OSXSAVE
+		return false;
+	UInt64 xcr0 = _xgetbv(0);
+	__cpuidex(infos, 7, 0);
+	if (kernel == Bytes::KERNEL_AVX2)
+		return (xcr0 & 0x06) == 0x06 && (infos[1] & (1 << 5));
+	return (xcr0 & 0xE6) == 0xE6 && (infos[1] & (1 << 16)) && (infos[1] & (1 << 30));
+#else
+	__builtin_cpu_init();
+	if (kernel == Bytes::KERNEL_AVX2)
+		return __builtin_cpu_supports("avx2");
+	return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+}
+
+#else
+
+static bool Supports(Bytes::Kernel kernel) { return kernel == Bytes::KERNEL_SCALAR; }
+
+#endif
+
+const Bytes::Kernels Bytes::_Kernels[] = {
+	{ Bytes::KERNEL_SCALAR, ScalarMask, ScalarFind, ScalarFindStartCode, ScalarClassifyJSON },
+#if defined(MONA_BYTES_X86)
+	{ Bytes::KERNEL_SSE2, SSE2Mask, SSE2Find, SSE2FindStartCode, SSE2ClassifyJSON },
+	{ Bytes::KERNEL_AVX2, AVX2Mask, AVX2Find, AVX2FindStartCode, AVX2ClassifyJSON },
+	{ Bytes::KERNEL_AVX512, AVX512Mask, AVX512Find, AVX512FindStartCode, AVX512ClassifyJSON },
+#endif
+};
+
+// scalar until the static initialization which selects the best kernel
+const Bytes::Kernels* Bytes::_PKernels(&_Kernels[0]);
+static const bool _Selected = Bytes::Select(Bytes::KERNEL_AVX512) || Bytes::Select(Bytes::KERNEL_AVX2) || Bytes::Select(Bytes::KERNEL_SSE2);
+
+const char* Bytes::KernelToString(Kernel kernel) {
+	static const char* Strings[] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+	return Strings[kernel];
+}
+
+bool Bytes::Select(Kernel kernel) {
+	if (kernel >= (sizeof(_Kernels) / sizeof(_Kernels[0])) || !Supports(kernel))
+		return false;
+	_PKernels = &_Kernels[kernel];
+	return true;
+}
+
+////////////////////////////// JSON //////////////////////////////
+
+static inline UInt64 PrefixXOR(UInt64 bits) {
+	// each bit becomes the XOR of all the previous ones (included), carry-less multiplication by all ones
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+bool Bytes::IndexJSON(const UInt8* data, UInt32 size, UInt32* indexes, UInt32& count) {
+	static const UInt64 Evens = 0x5555555555555555ull;
+	UInt64 masks[4];
+	UInt8  last[64];
+	UInt64 escaped = 0, inString = 0, scalar = 0; // carries from the previous block
+	count = 0;
+	for (UInt32 position = 0; position < size; position += 64) {
+		const UInt8* block = data + position;
+		if ((size - position) < 64) {
+			// last partial block padded with spaces
+			memcpy(last, block, size - position);
+			memset(last + size - position, ' ', 64 - (size - position));
+			block = last;
+		}
+		_PKernels->classifyJSON(block, masks);
+
+		// escaped characters, backslashes sequences starting on odd bits escape on even bits and inversely
+		UInt64 backslashes = masks[JSON_BACKSLASHES] & ~escaped;
+		UInt64 followsEscape = (backslashes << 1) | escaped;
+		UInt64 oddStarts = backslashes & ~Evens & ~followsEscape;
+		UInt64 evenStarts = oddStarts + backslashes;
+		escaped = evenStarts < oddStarts ? 1 : 0; // overflow, the next block starts escaped
+		UInt64 quotes = masks[JSON_QUOTES] & ~((Evens ^ (evenStarts << 1)) & followsEscape);
+
+		// string content from an opening quote (included) to the closing quote (excluded)
+		UInt64 strings = PrefixXOR(quotes) ^ inString;
+		inString = UInt64(Int64(strings) >> 63);
+
+		// first character of numbers, true, false and null
+		UInt64 scalars = ~(masks[JSON_OPERATORS] | masks[JSON_SPACES] | quotes | strings);
+		UInt64 structurals = (masks[JSON_OPERATORS] & ~strings) | quotes | (scalars & ~((scalars << 1) | scalar));
+		scalar = scalars >> 63;
+
+		while (structurals) {
+			indexes[count++] = position + FirstBit(structurals);
+			structurals &= structurals - 1;
+		}
+	}
+	return !inString;
+}
+
+////////////////////////////// CRC32 //////////////////////////////
+
+static const struct CRC32Tables {
+	CRC32Tables() {
+		for (UInt32 i = 0; i < 256; ++i) {
+			UInt32 crc = i << 24;
+			for (UInt8 bit = 0; bit < 8; ++bit)
+				crc = (crc << 1) ^ (crc & 0x80000000 ? 0x04C11DB7 : 0);
+			values[0][i] = crc;
+		}
+		// values[k][i] = CRC of byte i followed by k zero bytes
+		for (UInt8 k = 1; k < 8; ++k) {
+			for (UInt32 i = 0; i < 256; ++i)
+				values[k][i] = (values[k - 1][i] << 8) ^ values[0][values[k - 1][i] >> 24];
+		}
+	}
+	UInt32 values[8][256];
+} _CRC32;
+
+UInt32 Bytes::CRC32(const UInt8* data, UInt32 size, UInt32 crc) {
+	const UInt32 (&table)[8][256] = _CRC32.values;
+	for (; size >= 8; size -= 8, data += 8) {
+		crc ^= (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+		crc = table[7][crc >> 24] ^ table[6][(crc >> 16) & 0xFF] ^ table[5][(crc >> 8) & 0xFF] ^ table[4][crc & 0xFF] ^
+			table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
+	}
+	while (size--)
+		crc = (crc << 8) ^ table[0][(crc >> 24) ^ *data++];
+	return crc;
+}
+
+} // namespace Mona
@@ -15,6 +15,19 @@ details (or else see http://mozilla.org/MPL/2.0/).
 */
 
 #include "Mona/Crypto.h"
+#include "Mona/Bytes.h"
+#include OpenSSL(evp.h)
+#if defined(_M_X64) || defined(__x86_64__)
+#define MONA_AESNI
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET(FEATURES)
+#else
+#include <cpuid.h>
+#define TARGET(FEATURES) __attribute__((target(FEATURES)))
+#endif
+#endif
 
 using namespace std;
 
@@ -157,14 +170,227 @@ UInt32 Crypto::ComputeCRC32(const UInt8* data, UInt32 size, ROTATE_OPTIONS optio
 	};
 
     UInt32 crc(0xffffffff);
-	for (UInt32 i = 0; i < size; ++i) {
-		if (options&ROTATE_INPUT)
+	if (options&ROTATE_INPUT) {
+		for (UInt32 i = 0; i < size; ++i)
 			crc = (crc << 8) ^ CRC32[(crc >> 24) ^ Rotate8(*data++)];
-		else
-			crc = (crc << 8) ^ CRC32[(crc >> 24) ^ *data++];
-	}
+	} else
+		crc = Bytes::CRC32(data, size, crc); // slice-by-8
     return options&ROTATE_OUTPUT ? Rotate32(crc) : crc;
 }
 
+////////////////////////////// AES //////////////////////////////
+
+#if defined(MONA_AESNI)
+
+bool Crypto::AES::Accelerated() {
+	static const bool Accelerated([]() {
+#if defined(_MSC_VER)
+		int infos[4];
+		__cpuid(infos, 1);
+		return (infos[2] & (1 << 25)) ? true : false;
+#else
+		unsigned int eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES);
+#endif
+	}());
+	return Accelerated;
+}
+
+template<int RCON>
+TARGET("aes") static __m128i AESNIExpand(__m128i key) {
+	__m128i generated = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, RCON), 0xFF);
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, generated);
+}
+
+TARGET("aes") static void AESNIExpand(const UInt8* key, UInt8* encryptKeys, UInt8* decryptKeys) {
+	__m128i keys[11];
+	keys[0] = _mm_loadu_si128((const __m128i*)key);
+	keys[1] = AESNIExpand<0x01>(keys[0]);
+	keys[2] = AESNIExpand<0x02>(keys[1]);
+	keys[3] = AESNIExpand<0x04>(keys[2]);
+	keys[4] = AESNIExpand<0x08>(keys[3]);
+	keys[5] = AESNIExpand<0x10>(keys[4]);
+	keys[6] = AESNIExpand<0x20>(keys[5]);
+	keys[7] = AESNIExpand<0x40>(keys[6]);
+	keys[8] = AESNIExpand<0x80>(keys[7]);
+	keys[9] = AESNIExpand<0x1B>(keys[8]);
+	keys[10] = AESNIExpand<0x36>(keys[9]);
+	for (UInt8 i = 0; i < 11; ++i) {
+		_mm_storeu_si128((__m128i*)encryptKeys + i, keys[i]);
+		// equivalent inverse cipher: reversed keys with InvMixColumns on middle rounds
+		_mm_storeu_si128((__m128i*)decryptKeys + i, (i && i < 10) ? _mm_aesimc_si128(keys[10 - i]) : keys[10 - i]);
+	}
+}
+
+template<typename KeysType>
+TARGET("aes") static void AESNIEncrypt(Crypto::AES::Job* jobs, UInt32 count, __m128i iv, const KeysType& getKeys) {
+	enum { LANES = Crypto::AES::LANES };
+	static const __m128i IdleKeys[11] = {}; // keys of a lane without job
+	__m128i idle[LANES] = {}; // output of a lane without job
+	const __m128i* keys[LANES];
+	__m128i* blocks[LANES];
+	UInt32 counts[LANES] = { 0 };
+	UInt8 strides[LANES];
+	__m128i chains[LANES] = {};
+	for (;;) {
+		// give a job to free lanes
+		UInt32 steps = 0xFFFFFFFF;
+		for (UInt8 i = 0; i < LANES; ++i) {
+			if (!counts[i]) {
+				while (count && jobs->size < Crypto::AES::BLOCK_SIZE) {
+					++jobs;
+					--count;
+				}
+				if (count) {
+					keys[i] = (const __m128i*)getKeys(*jobs->pAES);
+					blocks[i] = (__m128i*)jobs->data;
+					counts[i] = jobs->size / Crypto::AES::BLOCK_SIZE;
+					strides[i] = 1;
+					chains[i] = iv;
+					++jobs;
+					--count;
+				} else {
+					keys[i] = IdleKeys;
+					blocks[i] = &idle[i];
+					strides[i] = 0;
+				}
+			}
+			if (counts[i] && counts[i] < steps)
+				steps = counts[i];
+		}
+		if (steps == 0xFFFFFFFF)
+			return;
+		for (UInt8 i = 0; i < LANES; ++i) {
+			if (counts[i])
+				counts[i] -= steps;
+		}
+		// one block by lane at each step, lanes are independent and so their rounds fill the AES pipeline
+		while (steps--) {
+			__m128i states[LANES];
+			for (UInt8 i = 0; i < LANES; ++i)
+				states[i] = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(blocks[i]), chains[i]), _mm_loadu_si128(keys[i]));
+			for (UInt8 round = 1; round < 10; ++round) {
+				for (UInt8 i = 0; i < LANES; ++i)
+					states[i] = _mm_aesenc_si128(states[i], _mm_loadu_si128(keys[i] + round));
+			}
+			for (UInt8 i = 0; i < LANES; ++i) {
+				_mm_storeu_si128(blocks[i], chains[i] = _mm_aesenclast_si128(states[i], _mm_loadu_si128(keys[i] + 10)));
+				blocks[i] += strides[i];
+			}
+		}
+	}
+}
+
+TARGET("aes") static void AESNIDecrypt(const UInt8* decryptKeys, UInt8* data, UInt32 size, __m128i iv) {
+	// CBC decryption is parallel, 4 blocks at the same time to fill the AES pipeline
+	__m128i keys[11];
+	for (UInt8 i = 0; i < 11; ++i)
+		keys[i] = _mm_loadu_si128((const __m128i*)decryptKeys + i);
+	__m128i* blocks = (__m128i*)data;
+	UInt32 count = size / Crypto::AES::BLOCK_SIZE;
+	for (; count >= 4; count -= 4, blocks += 4) {
+		__m128i in[4], out[4];
+		for (UInt8 i = 0; i < 4; ++i)
+			out[i] = _mm_xor_si128(in[i] = _mm_loadu_si128(blocks + i), keys[0]);
+		for (UInt8 round = 1; round < 10; ++round) {
+			for (UInt8 i = 0; i < 4; ++i)
+				out[i] = _mm_aesdec_si128(out[i], keys[round]);
+		}
+		for (UInt8 i = 0; i < 4; ++i)
+			_mm_storeu_si128(blocks + i, _mm_xor_si128(_mm_aesdeclast_si128(out[i], keys[10]), i ? in[i - 1] : iv));
+		iv = in[3];
+	}
+	for (; count; --count, ++blocks) {
+		__m128i in = _mm_loadu_si128(blocks);
+		__m128i out = _mm_xor_si128(in, keys[0]);
+		for (UInt8 round = 1; round < 10; ++round)
+			out = _mm_aesdec_si128(out, keys[round]);
+		_mm_storeu_si128(blocks, _mm_xor_si128(_mm_aesdeclast_si128(out, keys[10]), iv));
+		iv = in;
+	}
+}
+
+static __m128i AESNIIV(const UInt8* iv) { return iv ? _mm_loadu_si128((const __m128i*)iv) : _mm_setzero_si128(); }
+
+#else
+
+bool Crypto::AES::Accelerated() { return false; }
+
+#endif
+
+Crypto::AES::AES(const UInt8* key) : _pEncryptor(NULL), _pDecryptor(NULL) {
+#if defined(MONA_AESNI)
+	if (Accelerated()) {
+		AESNIExpand(key, _encryptKeys, _decryptKeys);
+		return;
+	}
+#endif
+	static const UInt8 IV[BLOCK_SIZE] = { 0 };
+	_pEncryptor = EVP_CIPHER_CTX_new();
+	EVP_CipherInit_ex(_pEncryptor, EVP_aes_128_cbc(), NULL, key, IV, 1);
+	EVP_CIPHER_CTX_set_padding(_pEncryptor, 0);
+	_pDecryptor = EVP_CIPHER_CTX_new();
+	EVP_CipherInit_ex(_pDecryptor, EVP_aes_128_cbc(), NULL, key, IV, 0);
+	EVP_CIPHER_CTX_set_padding(_pDecryptor, 0);
+}
+
+Crypto::AES::AES(const AES& aes) : _pEncryptor(NULL), _pDecryptor(NULL) {
+	if (!aes._pEncryptor) {
+		memcpy(_encryptKeys, aes._encryptKeys, sizeof(_encryptKeys));
+		memcpy(_decryptKeys, aes._decryptKeys, sizeof(_decryptKeys));
+		return;
+	}
+	// copy the OpenSSL key schedules rather than to expand them again
+	EVP_CIPHER_CTX_copy(_pEncryptor = EVP_CIPHER_CTX_new(), aes._pEncryptor);
+	EVP_CIPHER_CTX_copy(_pDecryptor = EVP_CIPHER_CTX_new(), aes._pDecryptor);
+}
+
+Crypto::AES::~AES() {
+	if (_pEncryptor)
+		EVP_CIPHER_CTX_free(_pEncryptor);
+	if (_pDecryptor)
+		EVP_CIPHER_CTX_free(_pDecryptor);
+}
+
+void Crypto::AES::encrypt(UInt8* data, UInt32 size, const UInt8* iv) {
+	size -= size % BLOCK_SIZE;
+#if defined(MONA_AESNI)
+	if (!_pEncryptor) {
+		Job job = { this, data, size };
+		return AESNIEncrypt(&job, 1, AESNIIV(iv), [](const AES& aes) { return aes._encryptKeys; });
+	}
+#endif
+	static const UInt8 IV[BLOCK_SIZE] = { 0 };
+	int temp;
+	EVP_CipherInit_ex(_pEncryptor, NULL, NULL, NULL, iv ? iv : IV, -1); // just reset IV, key schedule is kept
+	EVP_CipherUpdate(_pEncryptor, data, &temp, data, size);
+}
+
+void Crypto::AES::decrypt(UInt8* data, UInt32 size, const UInt8* iv) {
+	size -= size % BLOCK_SIZE;
+#if defined(MONA_AESNI)
+	if (!_pDecryptor)
+		return AESNIDecrypt(_decryptKeys, data, size, AESNIIV(iv));
+#endif
+	static const UInt8 IV[BLOCK_SIZE] = { 0 };
+	int temp;
+	EVP_CipherInit_ex(_pDecryptor, NULL, NULL, NULL, iv ? iv : IV, -1); // just reset IV, key schedule is kept
+	EVP_CipherUpdate(_pDecryptor, data, &temp, data, size);
+}
+
+void Crypto::AES::Encrypt(Job* jobs, UInt32 count) {
+#if defined(MONA_AESNI)
+	if (Accelerated())
+		return AESNIEncrypt(jobs, count, _mm_setzero_si128(), [](const AES& aes) { return aes._encryptKeys; });
+#endif
+	while (count--) {
+		jobs->pAES->encrypt(jobs->data, jobs->size);
+		++jobs;
+	}
+}
+
 
 } // namespace Mona
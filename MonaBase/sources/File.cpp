@@ -190,13 +190,15 @@ bool File::reset(UInt64 position) {
 	Exception ex;
 	if(!load(ex))
 		return position ? true : false;
+	// move relating APPEND possible mode, and relating current reading position in READ mode
+	Int64 offset = Int64(position) - Int64(mode ? _written.exchange(position) : _readen.load());
 	_readen = position;
 #if defined(_WIN32)
-	LARGE_INTEGER offset;
-	offset.QuadPart = -(LONGLONG)_written.exchange(position) + position; // move relating APPEND possible mode!
-	SetFilePointerEx((HANDLE)_handle, offset, NULL, FILE_CURRENT);
+	LARGE_INTEGER distance;
+	distance.QuadPart = offset;
+	SetFilePointerEx((HANDLE)_handle, distance, NULL, FILE_CURRENT);
 #else
-	lseek64(_handle, -(off64_t )_written.exchange(position) + position, SEEK_CUR);
+	lseek64(_handle, offset, SEEK_CUR);
 #endif
 	return true;
 }
@@ -30,7 +30,7 @@ FileLogger::FileLogger(string&& dir, UInt32 sizeByFile, UInt16 rotation) : _size
 bool FileLogger::log(LOG_LEVEL level, const Path& file, long line, const string& message) {
 	static string Buffer; // max size controlled by Logs system!
 	static Exception Ex;
-	String::Assign(Buffer, String::Log(Logs::LevelToString(level), file, line, message, Thread::CurrentId()));
+	String::Assign(Buffer, String::Log(Logs::LevelToString(level), file, line, message, Logs::CurrentThreadId(), Logs::CurrentTime()));
 	if (!_pFile->write(Ex, Buffer.data(), Buffer.size())) {
 		_pFile.reset();
 		return false;
@@ -40,7 +40,7 @@ bool FileLogger::log(LOG_LEVEL level, const Path& file, long line, const string&
 }
 
 bool FileLogger::dump(const string& header, const UInt8* data, UInt32 size) {
-	String buffer(String::Date("%d/%m %H:%M:%S.%c  "), header, '\n');
+	String buffer(String::Date(Date(Logs::CurrentTime()), "%d/%m %H:%M:%S.%c  "), header, '\n');
 	Exception ex;
 	if (!_pFile->write(ex, buffer.data(), buffer.size()) || !_pFile->write(ex, data, size)) {
 		_pFile.reset();
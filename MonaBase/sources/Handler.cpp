@@ -22,27 +22,36 @@ using namespace std;
 
 namespace Mona {
 
+static Metrics::Histogram Waits("mona_handler_wait_us", "Waiting time of runners in Handler queue before flush (microseconds)");
+
 void Handler::reset(Signal& signal) {
-	std::lock_guard<std::mutex> lock(_mutex);
+	_pSignal = NULL;
+	while (_producing) // wait the end of queueing operations
+		this_thread::yield();
 	_runners.clear();
 	_pSignal = &signal;
 }
 
 UInt32 Handler::flush(bool last) {
+	if (last) {
+		_pSignal = NULL;
+		while (_producing) // wait the end of queueing operations
+			this_thread::yield();
+	}
 	// Flush all what is possible now, and not dynamically in real-time (in rechecking _runners)
 	// to keep the possibility to do something else between two flushs!
-	deque<shared<Runner>> runners;
-	{
-		lock_guard<mutex> lock(_mutex);
-		if(last)
-			_pSignal = NULL;
-		runners = move(_runners);
-	}
-	for (shared<Runner>& pRunner : runners) {
+	UInt32 count(_runners.size()), flushed(0);
+	Int64 queued;
+	while (flushed < count) {
+		shared<Runner> pRunner(_runners.pop(queued));
+		if (!pRunner)
+			break; // a producer is pushing, it will signal it!
+		if (queued)
+			Waits.add(Metrics::Clock() - queued);
 		pRunner->run('.', pRunner->name); // '.' to signal that its a sub-runner, wait the name of the thread in htop
-		pRunner.reset(); // release resources
-	}
-	return runners.size();
+		++flushed;
+	} // pRunner released here (resources)
+	return flushed;
 }
 
 bool Handler::tryQueue(const Event<void()>& onResult) const {
@@ -15,7 +15,14 @@ details (or else see http://mozilla.org/MPL/2.0/).
 */
 
 #include "Mona/IOFile.h"
+#include "Mona/IOUring.h"
+#include "Mona/Logs.h"
 #include <list>
+#include <deque>
+#include <errno.h>
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
 
 using namespace std;
 
@@ -41,6 +48,26 @@ struct IOFile::Action : Runner, virtual Object {
 		virtual void handle(File& file) = 0;
 		weak<File>	_weakFile;
 	};
+	struct FlushHandle : Handle, virtual Object {
+		FlushHandle(const char* name, shared<File>& pFile) : Handle(name, pFile) {}
+	private:
+		void handle(File& file) {
+			if (!--file._flushing)
+				file._onFlush(!file.loaded());
+		}
+	};
+	// ErrorHandle has to keep a handler on pFile to avoid main thread to continue operation
+	// (shared<File> must stay not unique until main thread error reception)
+	struct ErrorHandle : Runner, virtual Object {
+		ErrorHandle(const char* name, shared<File>& pFile, Exception& ex) : Runner(name), _pFile(move(pFile)), _ex(move(ex)) {}
+	private:
+		bool run(Exception& ex) {
+			_pFile->_onError(_ex);
+			return true;
+		}
+		shared<File>	_pFile;
+		Exception		_ex;
+	};
 
 protected:
 	template<typename HandleType, typename ...Args>
@@ -53,18 +80,6 @@ private:
 	bool run(Exception& ex) {
 		if (process(ex, _pFile) || !_pFile)
 			return true;
-		// ErrorHandle has to keep a handler on pFile to avoid main thread to continue operation
-		// (shared<File> must stay not unique until main thread error reception)
-		struct ErrorHandle : Runner, virtual Object {
-			ErrorHandle(const char* name, shared<File>& pFile, Exception& ex) : Runner(name), _pFile(move(pFile)), _ex(move(ex)) {}
-		private:
-			bool run(Exception& ex) {
-				_pFile->_onError(_ex);
-				return true;
-			}
-			shared<File>	_pFile;
-			Exception		_ex;
-		};
 		handle<ErrorHandle>(ex);
 		return true;
 	}
@@ -81,6 +96,165 @@ private:
 	shared<File> _pFile;
 };
 
+/*!
+io_uring writings, packets of a same file are chained: one vectored write at a time by file (to keep order with the current file position),
+packets queued meanwhile are grouped in the next write submitted by the completion thread */
+struct IOFile::Ring : Thread, virtual Object {
+	Ring() : Thread("IOFileRing"), _ring(64), _failed(false) {
+		if (_ring)
+			start(Thread::PRIORITY_LOW);
+	}
+	~Ring() {
+		{
+			// wait end of writings before to stop the completion thread, else their chains (and files) leak
+			unique_lock<mutex> lock(_mutex);
+			_condition.wait(lock, [this]() { return _chains.empty() || _failed; });
+		}
+		if (_ring.wakeUp(this))
+			_ring.flush();
+		stop();
+	}
+	NULLABLE(!_ring)
+
+	/*!
+	Returns false if the writing has to be done with a blocking call */
+	bool write(const shared<File>& pFile, Packet& packet) {
+		unique_lock<mutex> lock(_mutex);
+		auto it = _chains.find(pFile.get());
+		if (it != _chains.end()) {
+			// writing running, wait its end to chain packet
+			if (packet)
+				it->second.packets.emplace_back(move(packet));
+			return true;
+		}
+		if (!packet || pFile->_path.isFolder() || (pFile->mode != File::MODE_WRITE && pFile->mode != File::MODE_APPEND))
+			return false;
+		Exception ignore;
+		if (!pFile->load(ignore))
+			return false; // blocking call will report the error
+		Chain& chain = _chains.emplace(SET, forward_as_tuple(pFile.get()), forward_as_tuple(pFile)).first->second;
+		chain.packets.emplace_back(move(packet));
+		if (submit(chain)) {
+			_ring.flush(); // on failure the ring thread will submit it on its next wait
+			return true;
+		}
+		packet = move(chain.writing.front());
+		_chains.erase(pFile.get());
+		return false;
+	}
+	/*!
+	Wait end of file writings */
+	void join(File& file) {
+		unique_lock<mutex> lock(_mutex);
+		_condition.wait(lock, [this, &file]() { return !_chains.count(&file); });
+	}
+	/*!
+	Wait end of all writings, returns true if has waited */
+	bool join() {
+		unique_lock<mutex> lock(_mutex);
+		if (_chains.empty())
+			return false;
+		_condition.wait(lock, [this]() { return _chains.empty(); });
+		return true;
+	}
+
+private:
+	struct Chain : virtual Object {
+		Chain(const shared<File>& pFile) : pFile(pFile) {}
+		shared<File>		pFile;
+		std::deque<Packet>	packets; // waiting
+		std::vector<Packet>	writing;
+#if !defined(_WIN32)
+		std::vector<iovec>	iovecs;
+#endif
+	};
+
+	bool submit(Chain& chain) {
+		// _mutex locked by caller
+#if defined(_WIN32)
+		return false;
+#else
+		while (!chain.packets.empty() && chain.writing.size() < 64) {
+			chain.writing.emplace_back(move(chain.packets.front()));
+			chain.packets.pop_front();
+		}
+		chain.iovecs.resize(chain.writing.size());
+		for (UInt32 i = 0; i < chain.writing.size(); ++i) {
+			chain.iovecs[i].iov_base = (void*)chain.writing[i].data();
+			chain.iovecs[i].iov_len = chain.writing[i].size();
+		}
+		return _ring.write(chain.pFile->_handle, chain.iovecs.data(), chain.iovecs.size(), &chain);
+#endif
+	}
+
+	void complete(Chain& chain, int result) {
+		unique_lock<mutex> lock(_mutex);
+		shared<File> pFile(chain.pFile);
+		UInt32 size = 0;
+		for (const Packet& packet : chain.writing)
+			size += packet.size();
+		if (result > 0)
+			pFile->_written += result;
+		Exception ex;
+		if (result < 0)
+			ex.set<Ex::System::File>("Impossible to write ", pFile->path(), " (size=", size, ", error ", -result, ")");
+		else if (UInt32(result) < size)
+			ex.set<Ex::System::File>("No more disk space to write ", pFile->path(), " (size=", size, ")");
+		else {
+			chain.writing.clear();
+			UInt64 queueing = (pFile->_queueing -= size);
+			if (!chain.packets.empty()) {
+				if (submit(chain))
+					return; // submitted on next wait
+				ex.set<Ex::System::File>("Impossible to write ", pFile->path(), " (error ", errno, ")");
+			} else {
+				_chains.erase(pFile.get());
+				_condition.notify_all();
+				// To signal end of write!
+				if (!queueing && !pFile.unique()) {
+					if (!pFile->_flushing++)
+						pFile->_pHandler->queue<Action::FlushHandle>("WriteFile", pFile);
+					else
+						--pFile->_flushing;
+				}
+				return;
+			}
+		}
+		// error, cancel writings
+		for (const Packet& packet : chain.packets)
+			size += packet.size();
+		pFile->_queueing -= size;
+		_chains.erase(pFile.get());
+		_condition.notify_all();
+		if (!pFile.unique())
+			pFile->_pHandler->queue<Action::ErrorHandle>("WriteFile", pFile, ex);
+	}
+
+	bool run(Exception& ex, const volatile bool& requestStop) {
+		IOUring::Completion completions[64];
+		int result;
+		while ((result = _ring.wait(completions, 64)) >= 0) {
+			for (int i = 0; i < result; ++i) {
+				if (completions[i].pData == this)
+					return true; // termination signal
+				complete(*(Chain*)completions[i].pData, completions[i].result);
+			}
+		}
+		ex.set<Ex::System::File>("impossible to manage file writings (error ", errno, ")");
+		unique_lock<mutex> lock(_mutex);
+		_failed = true; // no more completion
+		_condition.notify_all();
+		return false;
+	}
+
+	IOUring						_ring;
+	bool						_failed;
+	std::mutex					_mutex;
+	std::condition_variable		_condition;
+	std::map<File*, Chain>		_chains;
+};
+
+
 IOFile::IOFile(const Handler& handler, const ThreadPool& threadPool, UInt16 cores) :
 	handler(handler), threadPool(threadPool), _threadPool(Thread::PRIORITY_LOW, cores*2), Thread("FileWatching") { // 2*CPU => because disk speed can be at maximum 2x more than memory, and Low priority to not impact main thread pool
 }
@@ -90,11 +264,21 @@ IOFile::~IOFile() {
 	stop(); // file watchers!
 }
 
+IOFile::Ring* IOFile::ring() {
+	call_once(_ringOnce, [this]() {
+		if (!IOUring::Enabled() || _pRing.set())
+			return;
+		WARN("io_uring unavailable for file writings, blocking calls used");
+		_pRing.reset();
+	});
+	return _pRing.get();
+}
+
 void IOFile::join() {
 	// join devices (reading and writing operation)	
 	do {
 		((ThreadPool&)threadPool).join(); // wait possible decoding (can cast because IOFile constructor takes a non-const threadPool object)
-	} while(_threadPool.join()); // while reading/writing operation
+	} while(_threadPool.join() || (_pRing && _pRing->join())); // while reading/writing operation
 }
 
 void IOFile::subscribe(const shared<File>& pFile, const File::OnError& onError, const File::OnFlush& onFlush) {
@@ -137,7 +321,7 @@ void IOFile::read(const shared<File>& pFile, UInt32 size) {
 			if (pFile->_pDecoder) {
 				struct Decoding : Action, virtual Object {
 					Decoding(shared<File>& pFile, const ThreadPool& threadPool, shared<Buffer>& pBuffer, bool end) :
-						_pThread(ThreadQueue::Current()), _threadPool(threadPool), _end(end), Action("DecodingFile", *pFile->_pHandler, pFile), _pBuffer(move(pBuffer)) {
+						_pThreadPool(ThreadPool::Current()), _threadPool(threadPool), _end(end), Action("DecodingFile", *pFile->_pHandler, pFile), _pBuffer(move(pBuffer)) {
 						pFile.reset();
 					}
 				private:
@@ -147,7 +331,7 @@ void IOFile::read(const shared<File>& pFile, UInt32 size) {
 						UInt32 decoded = pFile->_pDecoder->decode(_pBuffer, _end);
 						// decoded=wantToRead!
 						if(decoded && !_end)
-							_pThread->queue<ReadFile>(*pFile->_pHandler, pFile, _threadPool, decoded);
+							_pThreadPool->queue<ReadFile>(pFile->_ioTrack, *pFile->_pHandler, pFile, _threadPool, decoded);
 						if (_pBuffer)
 							handle<ReadFile::Handle>(_pBuffer, _end);
 						return true;
@@ -155,7 +339,7 @@ void IOFile::read(const shared<File>& pFile, UInt32 size) {
 					shared<Buffer>		_pBuffer;
 					bool				_end;
 					const ThreadPool&	_threadPool;
-					ThreadQueue*		_pThread;
+					const ThreadPool*	_pThreadPool;
 				};
 				_threadPool.queue<Decoding>(pFile->_decodingTrack, pFile, _threadPool, pBuffer, _size == available);
 			} else
@@ -171,63 +355,53 @@ void IOFile::read(const shared<File>& pFile, UInt32 size) {
 
 void IOFile::write(const shared<File>& pFile, const Packet& packet) {
 	struct WriteFile : Action { 
-		WriteFile(const Handler& handler, const shared<File>& pFile, const Packet& packet) : _packet(move(packet)), Action("WriteFile", handler, pFile) {
+		WriteFile(const Handler& handler, const shared<File>& pFile, const Packet& packet, Ring* pRing) : _packet(move(packet)), _pRing(pRing), Action("WriteFile", handler, pFile) {
 			pFile->_queueing += _packet.size();
 		}
 	private:
-		struct Handle : Action::Handle, virtual Object {
-			Handle(const char* name, shared<File>& pFile) : Action::Handle(name, pFile) {}
-		private:
-			void handle(File& file) {
-				if(!--file._flushing)
-					file._onFlush(!file.loaded());
-			}
-		};
 		bool process(Exception& ex, shared<File>& pFile) override {
 			// No check pFile.unique => File writing full asynchronous (without any other hand on the file)
+			if (_pRing && _pRing->write(pFile, _packet))
+				return true; // queueing decremented and flush signaled on completion
 			UInt64 queueing = (pFile->_queueing -= _packet.size());
 			if (!pFile->write(ex, _packet.data(), _packet.size()))
 				return false;
 			if (queueing)
 				return true;
 			if(!pFile->_flushing++) // To signal end of write!
-				handle<Handle>();
+				handle<FlushHandle>();
 			else
 				--pFile->_flushing;
 			return true;
 		}
 		Packet		 _packet;
+		Ring*		 _pRing;
 	};
 	// do the WriteFile even if packet is empty when not loaded to allow to open the file and clear its content or create the file
 	// or to allow to create the folder => if File is a Folder opened in WRITE/APPEND mode loaded is always false and write an empty packet create the folder => allow a folder creation asynchrone!
 	if(packet || !pFile->loaded())
-		_threadPool.queue<WriteFile>(pFile->_ioTrack, handler, pFile, packet);
+		_threadPool.queue<WriteFile>(pFile->_ioTrack, handler, pFile, packet, ring());
 }
 
 void IOFile::erase(const shared<File>& pFile) {
 	struct EraseFile : Action {
-		EraseFile(const Handler& handler, const shared<File>& pFile) : Action("EraseFile", handler, pFile) {}
+		EraseFile(const Handler& handler, const shared<File>& pFile, Ring* pRing) : Action("EraseFile", handler, pFile), _pRing(pRing) {}
 	private:
-		struct Handle : Action::Handle, virtual Object {
-			Handle(const char* name, shared<File>& pFile) : Action::Handle(name, pFile) {}
-		private:
-			void handle(File& file) {
-				if (!--file._flushing)
-					file._onFlush(!file.loaded());
-			}
-		};
 		bool process(Exception& ex, shared<File>& pFile) override {
 			// No check pFile.unique => File erasing full asynchronous (without any other hand on the file)
+			if (_pRing)
+				_pRing->join(*pFile); // erase after writings!
 			if (!pFile->erase(ex))
 				return false;
 			if (!pFile->_flushing++) // To signal end of write!
-				handle<Handle>();
+				handle<FlushHandle>();
 			else
 				--pFile->_flushing;
 			return true;
 		}
+		Ring*	_pRing;
 	};
-	_threadPool.queue<EraseFile>(pFile->_ioTrack, handler, pFile);
+	_threadPool.queue<EraseFile>(pFile->_ioTrack, handler, pFile, _pRing.get());
 }
 
 
@@ -15,6 +15,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 */
 
 #include "Mona/IOSocket.h"
+#include "Mona/Metrics.h"
 #if defined(_BSD)
     #include <sys/types.h>
     #include <sys/event.h>
@@ -24,6 +25,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #elif !defined(_WIN32)
     #include <unistd.h>
     #include "sys/epoll.h"
+	#include "Mona/IOUring.h"
     #include <vector>
 	#include <fcntl.h>
 #if !defined(EPOLLRDHUP)  // ANDROID
@@ -40,6 +42,9 @@ using namespace std;
 
 namespace Mona {
 
+static Metrics::Histogram Batches("mona_iosocket_batch_us", "Processing time of socket events returned by one system wait (microseconds)");
+static Metrics::Histogram Events("mona_iosocket_batch_events", "Count of socket events returned by one system wait");
+
 struct IOSocket::Action : Runner, virtual Object {
 	Action(const char* name, int error, const shared<Socket>& pSocket) : Runner(name), _weakSocket(pSocket) {
 		if (error)
@@ -92,9 +97,37 @@ private:
 	Exception		_ex;
 };
 
+#if !defined(_WIN32) && !defined(_BSD)
+#define RING_BUFFERS		256 // buffers provided to io_uring by reactor (memory got on first use)
+#define RING_BUFFER_SIZE	16384
+
+/*!
+weak<Socket> of a socket polled by io_uring, deleted by the reactor on the completion of its last operation */
+struct IOSocket::Polled : weak<Socket> {
+	Polled(const shared<Socket>& pSocket, bool buffers) : weak<Socket>(pSocket), ops(1), receiving(false),
+		receivable(buffers && pSocket->type == Socket::TYPE_STREAM && !pSocket->listening() && !pSocket->isSecure()) {}
+
+	void*	tag() { return (UInt8*)this + 1; } // user data of its receptions (the poll one is this)
+	void*	canceling() { return (UInt8*)this + 2; } // user data of its poll cancellation
+	UInt32	events() const { return (receivable ? 0 : EPOLLIN) | EPOLLRDHUP | EPOLLOUT; } // readable event useless when received by io_uring
 
-IOSocket::IOSocket(const Handler& handler, const ThreadPool& threadPool, const char* name) : _initSignal(false),
-   _system(0), Thread(name),_subscribers(0),handler(handler), threadPool(threadPool) {
+	UInt8		ops; // poll + reception in progress, protected by IOSocket::_mutex
+	bool		receiving; // reception armed on the first EPOLLOUT (connected), reactor side
+	const bool	receivable;
+};
+#endif
+
+
+IOSocket::IOSocket(const Handler& handler, const ThreadPool& threadPool, const char* name, UInt16 reactors) : _initSignal(false),
+   _system(0), Thread(name),_subscribers(0),handler(handler), threadPool(threadPool), _nextThread(0) {
+	// a reactor by receiving thread at the most, socket reactor is deduced of its receiving thread
+	if (!reactors || reactors > threadPool.threads())
+		reactors = threadPool.threads();
+	if (reactors < 2)
+		return;
+	_reactors.reserve(reactors);
+	for (UInt16 i = 0; i < reactors; ++i)
+		_reactors.emplace_back(new IOSocket(handler, threadPool, name));
 }
 
 IOSocket::~IOSocket() {
@@ -106,7 +139,7 @@ IOSocket::~IOSocket() {
 			PostMessage(_system, WM_QUIT, 0, 0);
 	#else
 		if (_system)
-			::close(_eventFD);
+			::close(_eventFD); // EPOLLHUP on the reader side, for epoll or io_uring loop
 	#endif
 	Thread::stop();
 }
@@ -155,7 +188,28 @@ bool IOSocket::subscribe(Exception& ex, const shared<Socket>& pSocket,
 	return false;
 }
 
+UInt32 IOSocket::subscribers() const {
+	if (_reactors.empty())
+		return _subscribers;
+	UInt32 subscribers(0);
+	for (const unique<IOSocket>& pReactor : _reactors)
+		subscribers += pReactor->subscribers();
+	return subscribers;
+}
+
+void IOSocket::setReactor(Socket& socket, UInt16 reactor) {
+	socket._threadReceive = (reactor % threadPool.strands()) + 1;
+}
+
+IOSocket& IOSocket::reactor(Socket& socket) {
+	if (!socket._threadReceive) // fix now the receiving thread to match the reactor
+		socket._threadReceive = (_nextThread++ % threadPool.strands()) + 1;
+	return *_reactors[(socket._threadReceive - 1) % _reactors.size()];
+}
+
 bool IOSocket::subscribe(Exception& ex, const shared<Socket>& pSocket) {
+	if (!_reactors.empty())
+		return reactor(*pSocket).subscribe(ex, pSocket);
 	lock_guard<mutex> lock(_mutex); // must protect "start" + _system (to avoid a write operation on restarting) + _subscribers increment
 	if (!running()) {
 		_initSignal.reset();
@@ -176,25 +230,39 @@ bool IOSocket::subscribe(Exception& ex, const shared<Socket>& pSocket) {
 	}
 	_sockets.emplace(*pSocket, pSocket);
 #else
-	pSocket->_pWeakThis = new weak<Socket>(pSocket);
 	int res;
 #if defined(_BSD)
+	pSocket->_pWeakThis = new weak<Socket>(pSocket);
 	struct kevent events[2];
 	// no need to look EV_EOF, set automatically!
 	EV_SET(&events[0], *pSocket, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, pSocket->_pWeakThis);
 	EV_SET(&events[1], *pSocket, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, pSocket->_pWeakThis);
 	res = kevent(_system, events, 2, NULL, 0, NULL);
 #else
-	epoll_event event;
-	memset(&event, 0, sizeof(event));
-	event.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT | EPOLLET;
-	event.data.fd = *pSocket;
-	event.data.ptr = pSocket->_pWeakThis;
-	res = epoll_ctl(_system, EPOLL_CTL_ADD, *pSocket, &event);
+	if (_pRing) {
+		Polled* pPolled = new Polled(pSocket, _pRing->buffers() ? true : false);
+		// submitted by the reactor thread to get completions processed on its side (and not on this thread)
+		if ((res = _pRing->poll(*pSocket, pPolled->events(), pPolled) ? 0 : -1) == 0) {
+			pSocket->_pWeakThis = pPolled;
+			++_polleds;
+			::write(_eventFD, "", 1); // ignore error, the next wake up will submit the poll
+		} else
+			delete pPolled;
+	} else {
+		pSocket->_pWeakThis = new weak<Socket>(pSocket);
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT | EPOLLET;
+		event.data.fd = *pSocket;
+		event.data.ptr = pSocket->_pWeakThis;
+		res = epoll_ctl(_system, EPOLL_CTL_ADD, *pSocket, &event);
+	}
 #endif
 	if (res<0) {
-		delete pSocket->_pWeakThis;
-		pSocket->_pWeakThis = NULL;
+		if (pSocket->_pWeakThis) {
+			delete pSocket->_pWeakThis;
+			pSocket->_pWeakThis = NULL;
+		}
 		ex.set<Ex::Net::System>(Net::LastErrorMessage(), ", ", name(), " can't manage sockets");
 		return false;
 	}
@@ -222,6 +290,8 @@ void IOSocket::unsubscribe(shared<Socket>& pSocket) {
 }
 
 void IOSocket::unsubscribe(Socket* pSocket) {
+	if (!_reactors.empty())
+		return reactor(*pSocket).unsubscribe(pSocket);
 #if defined(_WIN32)
 	{
 		// decrements _count before the PostMessage
@@ -252,11 +322,22 @@ void IOSocket::unsubscribe(Socket* pSocket) {
 		EV_SET(&events[1], *pSocket, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
 		kevent(_system, events, 2, NULL, 0, NULL);
 #else
-		epoll_event event;
-		memset(&event, 0, sizeof(event));
-		epoll_ctl(_system, EPOLL_CTL_DEL, *pSocket, &event);
+		if (_pRing) {
+			// the last operation completion will delete _pWeakThis on reactor side,
+			// if the cancellation fails _pWeakThis leaks rather to be deleted while polled
+			Polled* pPolled = (Polled*)pSocket->_pWeakThis;
+			_pRing->cancel(pPolled, pPolled->canceling());
+			if (pPolled->receivable)
+				_pRing->abort(pPolled->tag());
+			::write(_eventFD, "", 1);
+			pSocket->_pWeakThis = NULL;
+		} else {
+			epoll_event event;
+			memset(&event, 0, sizeof(event));
+			epoll_ctl(_system, EPOLL_CTL_DEL, *pSocket, &event);
+		}
 #endif
-		if (::write(_eventFD, &pSocket->_pWeakThis, sizeof(pSocket->_pWeakThis)) >= 0)
+		if (pSocket->_pWeakThis && ::write(_eventFD, &pSocket->_pWeakThis, sizeof(pSocket->_pWeakThis)) >= 0)
 			pSocket->_pWeakThis = NULL; // success!
 	}
 	if (pSocket->_pWeakThis) {
@@ -266,11 +347,13 @@ void IOSocket::unsubscribe(Socket* pSocket) {
 #endif
 }
 
-void IOSocket::read(const shared<Socket>& pSocket, int error) {
+void IOSocket::read(const shared<Socket>& pSocket, int error, shared<Buffer>* ppBuffer) {
 	//::printf("READ(%d) socket %d\n", error, pSocket->id());
-	if(pSocket->_reading && !error)
-		return; // useless!
-	++pSocket->_reading;
+	if (!ppBuffer) { // else io_uring reception, rearmed by the receiving thread
+		if(pSocket->_reading && !error)
+			return; // useless!
+		++pSocket->_reading;
+	}
 	//::printf("READING(%d) socket %d\n", error, pSocket->id());
 
 	if (pSocket->listening()) {
@@ -280,26 +363,26 @@ void IOSocket::read(const shared<Socket>& pSocket, int error) {
 		private:
 			struct Handle : Action::Handle {
 				Handle(const char* name, const shared<Socket>& pSocket, const Exception& ex, shared<Socket>& pConnection, bool& stop) :
-					Action::Handle(name, pSocket, ex), _pConnection(move(pConnection)), _pThread(NULL) {
+					Action::Handle(name, pSocket, ex), _pConnection(move(pConnection)), _pThreadPool(NULL) {
 					if (++pSocket->_receiving < Socket::BACKLOG_MAX)
 						return;
 					stop = true;
-					_pThread = ThreadQueue::Current();
+					_pThreadPool = ThreadPool::Current();
 					++pSocket->_reading;
 				}
 			private:
 				void handle(const shared<Socket>& pSocket) {
 					pSocket->_onAccept(_pConnection);
 					UInt32 receiving = --pSocket->_receiving;
-					if (!_pThread)
+					if (!_pThreadPool)
 						return;
 					if (receiving < Socket::BACKLOG_MAX)
-						_pThread->queue<Accept>(0, pSocket); // REARM
+						_pThreadPool->queue<Accept>(pSocket->_threadReceive, 0, pSocket); // REARM on the same strand
 					else
 						--pSocket->_reading;
 				}
 				shared<Socket>		_pConnection;
-				ThreadQueue*		_pThread;
+				const ThreadPool*	_pThreadPool;
 			};
 			bool process(Exception& ex, const shared<Socket>& pSocket) {
 				if (!pSocket->_reading--) // me and something else! useless!
@@ -324,15 +407,18 @@ void IOSocket::read(const shared<Socket>& pSocket, int error) {
 
 
 	struct Receive : Action {
-		Receive(int error, const shared<Socket>& pSocket) : Action("SocketReceive", error, pSocket) {}
+		Receive(int error, const shared<Socket>& pSocket, IOSocket* pRing = NULL, shared<Buffer>* ppBuffer = NULL) : Action("SocketReceive", error, pSocket), _pRing(pRing) {
+			if (ppBuffer)
+				_pBuffer = move(*ppBuffer);
+		}
 	private:
 		struct Handle : Action::Handle {
-			Handle(const char* name, const shared<Socket>& pSocket, const Exception& ex, shared<Buffer>& pBuffer, const SocketAddress& address, bool& stop) :
-				Action::Handle(name, pSocket, ex), _address(address), _pBuffer(move(pBuffer)), _pThread(NULL) {
+			Handle(const char* name, const shared<Socket>& pSocket, const Exception& ex, shared<Buffer>& pBuffer, const SocketAddress& address, bool& stop, IOSocket* pRing) :
+				Action::Handle(name, pSocket, ex), _address(address), _pBuffer(move(pBuffer)), _pThreadPool(NULL), _pRing(pRing) {
 				if ((pSocket->_receiving += _pBuffer->size()) < pSocket->recvBufferSize())
 					return;
 				stop = true;
-				_pThread = ThreadQueue::Current();
+				_pThreadPool = ThreadPool::Current();
 				++pSocket->_reading;
 			}
 		private:
@@ -340,21 +426,28 @@ void IOSocket::read(const shared<Socket>& pSocket, int error) {
 				UInt32 receiving = _pBuffer->size();
 				pSocket->_onReceived(_pBuffer, _address);
 				receiving = pSocket->_receiving -= receiving;
-				if (!_pThread)
+				if (!_pThreadPool)
 					return;
 				if(receiving < pSocket->recvBufferSize())
-					_pThread->queue<Receive>(0, pSocket); // REARM
+					_pThreadPool->queue<Receive>(pSocket->_threadReceive, 0, pSocket, _pRing); // REARM on the same strand
 				else
 					--pSocket->_reading;
 			}
 			shared<Buffer>		_pBuffer;
 			SocketAddress		_address;
-			ThreadQueue*		_pThread;
+			const ThreadPool*	_pThreadPool;
+			IOSocket*			_pRing;
 		};
 
 		bool process(Exception& ex, const shared<Socket>& pSocket) {
+#if !defined(_WIN32) && !defined(_BSD)
+			if (_pRing)
+				return processRing(ex, pSocket);
+#endif
 			if (!pSocket->_reading--) // me and something else! useless!
 				return true;
+			if (pSocket->type == Socket::TYPE_DATAGRAM)
+				return processDatagrams(ex, pSocket);
 			bool stop(false);
 			while (!stop) {
 				UInt32 available = pSocket->available();
@@ -363,18 +456,8 @@ void IOSocket::read(const shared<Socket>& pSocket, int error) {
 				shared<Buffer>	pBuffer(SET, available);
 				SocketAddress	address;
 				int received = pSocket->receive(ex, pBuffer->data(), available, 0, &address);
-				if (received < 0) {
-					if (ex.cast<Ex::Net::Socket>().code != NET_ESHUTDOWN) {
-						// if NET_EMSGSIZE => UDP packet lost! (can happen on windows! error displaid!)
-						// error, but not necessary a disconnection
-						if (ex.cast<Ex::Net::Socket>().code != NET_EWOULDBLOCK)
-							return false; 
-						// ::printf("NET_EWOULDBLOCK %d\n", pSocket->id());
-					} else // If "shutdown" error on receive it means that that the user has called a shutdown BOTH because waits nothing else however IOSocket has receveid the "recv=0", so it's not an error!
-						pSocket->_reading = 0xFF; // block reception!
-					ex = nullptr;
-					return true;
-				}
+				if (received < 0)
+					return failed(ex, *pSocket);
 
 				// a recv returns 0 without any error can happen on TCP socket one time disconnected!
 				if (!received && pSocket->type == Socket::TYPE_STREAM) {
@@ -388,13 +471,94 @@ void IOSocket::read(const shared<Socket>& pSocket, int error) {
 				if (pSocket->_pDecoder)
 					pSocket->_pDecoder->decode(pBuffer, address, pSocket);
 				if(pBuffer)
-					handle<Handle>(pSocket, pBuffer, address, stop);
+					handle<Handle>(pSocket, pBuffer, address, stop, _pRing);
 			};
 			return true;
 		}
+
+#if !defined(_WIN32) && !defined(_BSD)
+		bool processRing(Exception& ex, const shared<Socket>& pSocket) {
+			// data received by io_uring, or rearm after a stop on recvBufferSize
+			if (pSocket->_reading == 0xFF)
+				return true; // reception blocked (disconnection)
+			if (_pBuffer) {
+				if (pSocket->_ex) {
+					ex = pSocket->_ex;
+					return failed(ex, *pSocket);
+				}
+				pSocket->receive(_pBuffer->size());
+				if (!pSocket->_address)
+					pSocket->_address.set(IPAddress::Loopback(), 0); // to advise that address is computable
+				SocketAddress address(pSocket->peerAddress());
+				if (pSocket->_pDecoder)
+					pSocket->_pDecoder->decode(_pBuffer, address, pSocket);
+				bool stop(false);
+				if (_pBuffer)
+					handle<Handle>(pSocket, _pBuffer, address, stop, _pRing);
+				if (stop)
+					return true; // Handle will rearm on the same strand
+			} else
+				--pSocket->_reading; // incremented by Handle on stop
+			if (_pRing->receive(pSocket))
+				return true;
+			Socket::SetException(Net::LastError(), ex);
+			return false;
+		}
+#endif
+
+		bool processDatagrams(Exception& ex, const shared<Socket>& pSocket) {
+			// several datagrams by system call, buffers not delivered are reused on next call
+			enum { BATCH = 16 };
+			shared<Buffer>	pBuffers[BATCH];
+			SocketAddress	addresses[BATCH];
+			bool stop(false);
+			while (!stop) {
+				UInt32 available = pSocket->available();
+				UInt32 count = BATCH;
+				if (available > 2048) // 2048 to be greater than max possible MTU (~1500 bytes)
+					count = 1; // big datagram, receive it alone with its size
+				else
+					available = 2048;
+				for (UInt32 i = 0; i < count; ++i) {
+					if (pBuffers[i])
+						pBuffers[i]->resize(available);
+					else
+						pBuffers[i].set(available);
+				}
+				int received = pSocket->receiveFrom(ex, pBuffers, addresses, count);
+				if (received < 0)
+					return failed(ex, *pSocket);
+				if (ex) // datagram truncated and lost
+					handle<Action::Handle>(pSocket);
+				for (int i = 0; i < received; ++i) {
+					shared<Buffer>& pBuffer(pBuffers[i]);
+					if (pSocket->_pDecoder)
+						pSocket->_pDecoder->decode(pBuffer, addresses[i], pSocket);
+					if (pBuffer)
+						handle<Handle>(pSocket, pBuffer, addresses[i], stop, _pRing);
+				}
+			}
+			return true;
+		}
+
+		bool failed(Exception& ex, Socket& socket) {
+			if (ex.cast<Ex::Net::Socket>().code != NET_ESHUTDOWN) {
+				// if NET_EMSGSIZE => UDP packet lost! (can happen on windows! error displaid!)
+				// error, but not necessary a disconnection
+				if (ex.cast<Ex::Net::Socket>().code != NET_EWOULDBLOCK)
+					return false; 
+				// ::printf("NET_EWOULDBLOCK %d\n", pSocket->id());
+			} else // If "shutdown" error on receive it means that that the user has called a shutdown BOTH because waits nothing else however IOSocket has receveid the "recv=0", so it's not an error!
+				socket._reading = 0xFF; // block reception!
+			ex = nullptr;
+			return true;
+		}
+
+		shared<Buffer>	_pBuffer;
+		IOSocket*		_pRing;
 	};
 
-	threadPool.queue<Receive>(pSocket->_threadReceive, error, pSocket);
+	threadPool.queue<Receive>(pSocket->_threadReceive, error, pSocket, ppBuffer ? this : NULL, ppBuffer);
 }
 
 void IOSocket::write(const shared<Socket>& pSocket, int error) {
@@ -472,6 +636,10 @@ bool IOSocket::run(Exception& ex, const volatile bool& requestStop) {
 	_system = CreateWindow(name(), name(), WS_EX_LEFT, 0, 0, 0, 0, HWND_MESSAGE, NULL, NULL, NULL);
 
 #else
+#if !defined(_BSD)
+	if (IOUring::Enabled())
+		return runRing(ex);
+#endif
 	int pipefds[2] = {};
 	int readFD(0);
 	_system=_eventFD=0;
@@ -598,6 +766,7 @@ bool IOSocket::run(Exception& ex, const volatile bool& requestStop) {
 				continue;
 			break;
 		}
+		Int64 time = Metrics::Enabled() ? Metrics::Clock() : 0;
 
 		// for each ready socket
 		for(i=0;i<result;++i) {
@@ -656,34 +825,8 @@ bool IOSocket::run(Exception& ex, const volatile bool& requestStop) {
 			}
 
 			shared<Socket> pSocket(reinterpret_cast<weak<Socket>*>(event.data.ptr)->lock());
-			if(!pSocket)
-				continue; // socket error
-			// EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLRDHUP
-			//printf("%d => 0x%08x\n", pSocket->id(), event.events);
-			int error = 0;
-			if(event.events&EPOLLERR) {
-				socklen_t len(sizeof(error));
-				if(getsockopt(pSocket->id(), SOL_SOCKET, SO_ERROR, (void *)&error, &len)==-1)
-					error = Net::LastError();
-			}
-			if (event.events&EPOLLRDHUP) {
-				// disconnection
-				close(pSocket, error);
-				continue;
-			}
-			if (!(event.events&EPOLLHUP)) { // if socket unexpected close no more read or write!
-				// EPOLLOUT in first to get the onFlush (onConnection for TCP) in first (before any reception)
-				if (event.events&EPOLLOUT) {
-					write(pSocket, error);
-					error = 0;
-				}
-				if (event.events&EPOLLIN) {
-					read(pSocket, error);
-					error = 0;
-				}
-			}
-			if (error) // on few unix system we can get an error without anything else
-				threadPool.queue<Action>(pSocket->_threadReceive, "SocketError", error, pSocket);
+			if(pSocket) // else socket error
+				process(pSocket, event.events);
 #endif
 		}
 
@@ -692,6 +835,11 @@ bool IOSocket::run(Exception& ex, const volatile bool& requestStop) {
 			delete pWeakSocket;
 		removedSockets.clear();
 
+		if (time) {
+			Batches.add(Metrics::Clock() - time);
+			Events.add(result);
+		}
+
 		if(i==-1)
 			break; // termination signal on IOSocket deletion
 
@@ -723,7 +871,227 @@ bool IOSocket::run(Exception& ex, const volatile bool& requestStop) {
 	return false;
 }
 	
+#if !defined(_WIN32) && !defined(_BSD)
+
+void IOSocket::process(const shared<Socket>& pSocket, UInt32 events) {
+	// EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLRDHUP
+	//printf("%d => 0x%08x\n", pSocket->id(), events);
+	int error = 0;
+	if(events&EPOLLERR) {
+		socklen_t len(sizeof(error));
+		if(getsockopt(pSocket->id(), SOL_SOCKET, SO_ERROR, (void *)&error, &len)==-1)
+			error = Net::LastError();
+	}
+	if (events&EPOLLRDHUP) {
+		// disconnection
+		close(pSocket, error);
+		return;
+	}
+	if (!(events&EPOLLHUP)) { // if socket unexpected close no more read or write!
+		// EPOLLOUT in first to get the onFlush (onConnection for TCP) in first (before any reception)
+		if (events&EPOLLOUT) {
+			write(pSocket, error);
+			error = 0;
+		}
+		if (events&EPOLLIN) {
+			read(pSocket, error);
+			error = 0;
+		}
+	}
+	if (error) // on few unix system we can get an error without anything else
+		threadPool.queue<Action>(pSocket->_threadReceive, "SocketError", error, pSocket);
+}
+
+bool IOSocket::receive(const shared<Socket>& pSocket, bool submit) {
+	lock_guard<mutex> lock(_mutex);
+	Polled* pPolled = (Polled*)pSocket->_pWeakThis;
+	if (!pPolled)
+		return true; // unsubscribed
+	if (!_pRing->receive(*pSocket, pPolled->tag()))
+		return false;
+	++pPolled->ops;
+	return !submit || _pRing->flush();
+}
+
+bool IOSocket::runRing(Exception& ex) {
+	// Same loop than epoll but with io_uring multishot polls:
+	// - subscribe/unsubscribe prepare poll/cancel requests and write on _eventFD to wake up this thread which submits them
+	// (submitter thread is the one which processes readiness completions, not the caller thread)
+	// - a poll completion without "more" flag is the last one, it deletes the weak<Socket> or rearms the poll if always subscribed
+	// - TCP sockets without TLS are received in buffers provided to io_uring, each reception is decoded on the receiving thread
+	// which rearms the next one (to keep the recvBufferSize limit), readable events are not polled for them
+	int pipefds[2] = {};
+	_system = _eventFD = 0;
+	if (pipe(pipefds) == 0) {
+		if (fcntl(pipefds[0], F_SETFL, fcntl(pipefds[0], F_GETFL, 0) | O_NONBLOCK) != -1 && _pRing.set(MAXEVENTS) && _pRing->poll(pipefds[0], EPOLLIN, this)) {
+			_system = _pRing->id();
+			_eventFD = pipefds[1];
+			if (!_pRing->provide(RING_BUFFERS, RING_BUFFER_SIZE))
+				DEBUG(name(), " io_uring without provided buffers (kernel 5.19 required), sockets received by recv calls");
+		} else {
+			::close(pipefds[0]);
+			::close(pipefds[1]);
+			_pRing.reset();
+		}
+	}
+	int readFD = pipefds[0];
+	_polleds = 0;
+
+	_initSignal.set();
+
+	if (!_system) {
+		ex.set<Ex::Net::System>("impossible to start IOSocket with io_uring");
+		return false;
+	}
+	
+	IOUring::Completion completions[MAXEVENTS];
+	int result;
+	bool terminate = false;
+	while (!terminate && (result = _pRing->wait(completions, MAXEVENTS)) >= 0) {
+		Int64 time = Metrics::Enabled() ? Metrics::Clock() : 0;
+
+		for (int i = 0; i < result; ++i) {
+			const IOUring::Completion& completion(completions[i]);
+			if (!completion.pData)
+				continue; // cancellation result
+
+			if (completion.pData == this) {
+				if (completion.result < 0 || (completion.result&EPOLLHUP)) {
+					terminate = true; // termination signal on IOSocket deletion
+					continue;
+				}
+				char buffer[64];
+				while (::read(readFD, buffer, sizeof(buffer)) > 0); // wake up signal, pending requests will be submitted on next wait
+				if (!completion.more && !_pRing->poll(readFD, EPOLLIN, this))
+					terminate = true;
+				continue;
+			}
+
+			if (UInt64(completion.pData) & 2) {
+				// poll cancellation result, -EALREADY if submitted with the poll still arming => retry
+				if (completion.result == -EALREADY)
+					_pRing->cancel((UInt8*)completion.pData - 2, completion.pData);
+				continue;
+			}
+
+			if (UInt64(completion.pData) & 1) {
+				// reception in a provided buffer, copied to release the buffer immediatly
+				Polled* pPolled = (Polled*)((UInt8*)completion.pData - 1);
+				shared<Buffer> pBuffer;
+				if (completion.buffer >= 0) {
+					if (completion.result > 0)
+						pBuffer.set(_pRing->buffer(UInt16(completion.buffer)), UInt32(completion.result));
+					_pRing->release(UInt16(completion.buffer));
+				}
+				shared<Socket> pSocket(pPolled->lock());
+				{
+					lock_guard<mutex> lock(_mutex);
+					--pPolled->ops;
+					if (!pSocket || pSocket->_pWeakThis != pPolled) {
+						if (!pPolled->ops) {
+							delete pPolled;
+							--_polleds;
+						}
+						continue;
+					}
+				}
+				if (pBuffer)
+					read(pSocket, 0, &pBuffer);
+				else if (completion.result == -ENOBUFS) { // all the buffers in use, retry (buffers of this batch are released)
+					if (!receive(pSocket, false))
+						threadPool.queue<Action>(pSocket->_threadReceive, "SocketError", Net::LastError(), pSocket);
+				} else if (completion.result < 0 && completion.result != -ECANCELED)
+					threadPool.queue<Action>(pSocket->_threadReceive, "SocketError", -completion.result, pSocket);
+				// else 0 => disconnection, signaled by EPOLLRDHUP
+				continue;
+			}
+
+			Polled* pPolled = (Polled*)completion.pData;
+			shared<Socket> pSocket(pPolled->lock());
+			if (!completion.more) {
+				// poll canceled on unsubscription, or ended by the system => rearm it if socket always subscribed
+				lock_guard<mutex> lock(_mutex);
+				if (!pSocket || pSocket->_pWeakThis != pPolled) {
+					if (!--pPolled->ops) {
+						delete pPolled;
+						--_polleds;
+					}
+					continue;
+				}
+				if (!_pRing->poll(*pSocket, pPolled->events(), pPolled)) {
+					threadPool.queue<Action>(pSocket->_threadReceive, "SocketError", Net::LastError(), pSocket);
+					continue;
+				}
+			}
+			if (!pSocket || completion.result <= 0)
+				continue; // socket error
+			process(pSocket, completion.result);
+			if (pPolled->receivable && !pPolled->receiving && (completion.result&EPOLLOUT) && !(completion.result&(EPOLLERR | EPOLLHUP))) {
+				// connected, start to receive
+				pPolled->receiving = true;
+				if (!receive(pSocket, false))
+					threadPool.queue<Action>(pSocket->_threadReceive, "SocketError", Net::LastError(), pSocket);
+			}
+		}
+		if (time) {
+			Batches.add(Metrics::Clock() - time);
+			Events.add(result);
+		}
+
+		if (!_subscribers) {
+			lock_guard<mutex> lock(_mutex);
+			// no more socket to manage?
+			if (!_subscribers) {
+				// release weak<Socket> of last operations canceled, waiting their completions (bounded if one never comes)
+				Time stopping;
+				while (_polleds && !stopping.isElapsed(1000) && (result = _pRing->wait(completions, MAXEVENTS, 100)) >= 0) {
+					for (int i = 0; i < result; ++i) {
+						const IOUring::Completion& completion(completions[i]);
+						if (!completion.pData || completion.pData == this || completion.more)
+							continue;
+						if (UInt64(completion.pData) & 2) {
+							if (completion.result == -EALREADY)
+								_pRing->cancel((UInt8*)completion.pData - 2, completion.pData);
+							continue;
+						}
+						Polled* pPolled = (Polled*)completion.pData;
+						if (UInt64(completion.pData) & 1) {
+							pPolled = (Polled*)((UInt8*)completion.pData - 1);
+							if (completion.buffer >= 0)
+								_pRing->release(UInt16(completion.buffer));
+						}
+						if (!--pPolled->ops) {
+							delete pPolled;
+							--_polleds;
+						}
+					}
+				}
+				if (_polleds)
+					WARN(name(), " stops with ", _polleds, " io_uring operations not completed");
+				::close(readFD);  // close reader pipe side
+				::close(_eventFD);  // close writer pipe side
+				_pRing.reset(); // close io_uring
+				stop(); // to set running=false!
+				return true;
+			}
+		}
+	}
+	::close(readFD);  // close reader pipe side
+	if (!terminate) { // error
+		ex.set<Ex::Net::System>("impossible to manage sockets (error ", errno, ")");
+		return false;
+	}
+	if (!_subscribers)
+		return true; // IOSocket deletion
+	ex.set<Ex::Net::System>("dies with remaining sockets managed");
+	return false;
+}
+
+#endif
+
 void IOSocket::stop() {
+	for (unique<IOSocket>& pReactor : _reactors)
+		pReactor->stop();
 #if defined(SRT_API)
 	if (_pIOSRTSocket)
 		_pIOSRTSocket->stop();
@@ -0,0 +1,346 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/IOUring.h"
+#if defined(__linux__) && !defined(__ANDROID__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+	#include <linux/io_uring.h>
+	#include <sys/syscall.h>
+	#include <sys/mman.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+	#include <errno.h>
+#if defined(IORING_FEAT_RSRC_TAGS) && defined(IORING_POLL_ADD_MULTI) && defined(__NR_io_uring_setup) // kernel 5.13 (multishot poll)
+	#define IO_URING 1
+#endif
+#if defined(IORING_RECVSEND_POLL_FIRST) // kernel 5.19 (provided buffer rings, IORING_REGISTER_PBUF_RING is an enum value)
+	#define IO_URING_PBUF 1
+#endif
+#endif
+#endif
+
+
+using namespace std;
+
+namespace Mona {
+
+bool IOUring::_Enabled(false);
+
+bool IOUring::Available() {
+	static const bool Available(IOUring(2) ? true : false);
+	return Available;
+}
+
+bool IOUring::Enable(bool enable) {
+	if (enable && !Available())
+		return false;
+	_Enabled = enable;
+	return true;
+}
+
+#if defined(IO_URING)
+
+IOUring::IOUring(UInt32 entries) : _fd(-1), _toSubmit(0), _sqTail(0),
+	_pSQ(NULL), _sqSize(0), _pCQ(NULL), _cqSize(0), _pSQEs(NULL), _sqesSize(0), _pBufRing(NULL), _pBuffers(NULL), _bufCount(0), _bufSize(0), _bufTail(0) {
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if (_fd < 0)
+		return;
+	// RSRC_TAGS is the 5.13 feature flag, first kernel with multishot poll
+	if (!(params.features & IORING_FEAT_RSRC_TAGS) || !(params.features & IORING_FEAT_NODROP)) {
+		::close(_fd);
+		_fd = -1;
+		return;
+	}
+	_sqSize = params.sq_off.array + params.sq_entries * sizeof(UInt32);
+	_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		_sqSize = _cqSize = max(_sqSize, _cqSize);
+	_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+	void* pSQ = mmap(NULL, _sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+	void* pCQ = pSQ;
+	if (pSQ != MAP_FAILED && !(params.features & IORING_FEAT_SINGLE_MMAP))
+		pCQ = mmap(NULL, _cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+	_pSQEs = mmap(NULL, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+	_pSQ = pSQ == MAP_FAILED ? NULL : (UInt8*)pSQ;
+	_pCQ = pCQ == MAP_FAILED ? NULL : (UInt8*)pCQ;
+	if (_pSQEs == MAP_FAILED)
+		_pSQEs = NULL;
+	if (!_pSQ || !_pCQ || !_pSQEs) {
+		if (_pSQEs)
+			munmap(_pSQEs, _sqesSize);
+		if (_pCQ && _pCQ != _pSQ)
+			munmap(_pCQ, _cqSize);
+		if (_pSQ)
+			munmap(_pSQ, _sqSize);
+		_pSQ = _pCQ = NULL;
+		_pSQEs = NULL;
+		::close(_fd);
+		_fd = -1;
+		return;
+	}
+
+	_sqEntries = params.sq_entries;
+	_pSQHead = (UInt32*)(_pSQ + params.sq_off.head);
+	_pSQTail = (UInt32*)(_pSQ + params.sq_off.tail);
+	_sqMask = *(UInt32*)(_pSQ + params.sq_off.ring_mask);
+	_pSQArray = (UInt32*)(_pSQ + params.sq_off.array);
+	_sqTail = *_pSQTail;
+
+	_pCQHead = (UInt32*)(_pCQ + params.cq_off.head);
+	_pCQTail = (UInt32*)(_pCQ + params.cq_off.tail);
+	_cqMask = *(UInt32*)(_pCQ + params.cq_off.ring_mask);
+	_pCQEs = _pCQ + params.cq_off.cqes;
+}
+
+IOUring::~IOUring() {
+	if (_pSQEs)
+		munmap(_pSQEs, _sqesSize);
+	if (_pCQ && _pCQ != _pSQ)
+		munmap(_pCQ, _cqSize);
+	if (_pSQ)
+		munmap(_pSQ, _sqSize);
+	if (_fd >= 0)
+		::close(_fd);
+	if (_pBufRing)
+		munmap(_pBufRing, _bufCount * sizeof(io_uring_buf));
+	if (_pBuffers)
+		munmap(_pBuffers, _bufCount * _bufSize);
+}
+
+bool IOUring::provide(UInt16 count, UInt32 size) {
+	// to call once before any receive
+	if (_fd < 0 || _bufCount || !count || (count & (count - 1)))
+		return false;
+#if defined(IO_URING_PBUF)
+	_pBufRing = mmap(NULL, count * sizeof(io_uring_buf), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	void* pBuffers = mmap(NULL, count * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); // not populated, pages are got on first receptions
+	if (_pBufRing != MAP_FAILED && pBuffers != MAP_FAILED) {
+		io_uring_buf_reg reg;
+		memset(&reg, 0, sizeof(reg));
+		reg.ring_addr = (UInt64)_pBufRing;
+		reg.ring_entries = count;
+		reg.bgid = 0;
+		if (syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0) {
+			_pBuffers = (UInt8*)pBuffers;
+			_bufCount = count;
+			_bufSize = size;
+			for (UInt16 id = 0; id < count; ++id)
+				release(id);
+			return true;
+		}
+	}
+	if (pBuffers != MAP_FAILED)
+		munmap(pBuffers, count * size);
+	if (_pBufRing != MAP_FAILED)
+		munmap(_pBufRing, count * sizeof(io_uring_buf));
+	_pBufRing = NULL;
+#endif
+	return false;
+}
+
+void IOUring::release(UInt16 id) {
+#if defined(IO_URING_PBUF)
+	// io_uring_buf entries used directly because io_uring_buf_ring::bufs is shifted in C++ (empty struct of __DECLARE_FLEX_ARRAY)
+	io_uring_buf* pBufs = (io_uring_buf*)_pBufRing;
+	io_uring_buf& buf = pBufs[_bufTail & (_bufCount - 1)];
+	// set just these fields, resv of the first entry is the ring tail
+	buf.addr = (UInt64)buffer(id);
+	buf.len = _bufSize;
+	buf.bid = id;
+	__atomic_store_n(&pBufs->resv, ++_bufTail, __ATOMIC_RELEASE);
+#endif
+}
+
+void* IOUring::prepare(UInt8 opcode, int fd, void* pData) {
+	// _mutex locked by caller
+	if (_fd < 0) {
+		errno = ENOSYS;
+		return NULL;
+	}
+	if ((_sqTail - __atomic_load_n(_pSQHead, __ATOMIC_ACQUIRE)) >= _sqEntries) {
+		// submission queue full, submit to release entries
+		if (!submit() || (_sqTail - __atomic_load_n(_pSQHead, __ATOMIC_ACQUIRE)) >= _sqEntries) {
+			errno = EBUSY;
+			return NULL;
+		}
+	}
+	UInt32 index = _sqTail & _sqMask;
+	io_uring_sqe* pSQE = (io_uring_sqe*)_pSQEs + index;
+	memset(pSQE, 0, sizeof(io_uring_sqe));
+	pSQE->opcode = opcode;
+	pSQE->fd = fd;
+	pSQE->user_data = (UInt64)pData;
+	_pSQArray[index] = index;
+	return pSQE;
+}
+
+bool IOUring::submit() {
+	// _mutex locked by caller
+	if (!_toSubmit)
+		return true;
+	int result = (int)syscall(__NR_io_uring_enter, _fd, _toSubmit, 0, 0, NULL, 0);
+	if (result < 0)
+		return errno == EINTR || errno == EAGAIN || errno == EBUSY; // retry on next submission
+	_toSubmit -= result;
+	return true;
+}
+
+bool IOUring::commit() {
+	// _mutex locked by caller
+	__atomic_store_n(_pSQTail, ++_sqTail, __ATOMIC_RELEASE);
+	++_toSubmit;
+	return true;
+}
+
+bool IOUring::poll(int fd, UInt32 events, void* pData) {
+	lock_guard<mutex> lock(_mutex);
+	io_uring_sqe* pSQE = (io_uring_sqe*)prepare(IORING_OP_POLL_ADD, fd, pData);
+	if (!pSQE)
+		return false;
+	pSQE->len = IORING_POLL_ADD_MULTI; // edge-triggered by default (IORING_POLL_ADD_LEVEL is not set)
+#if __BYTE_ORDER == __BIG_ENDIAN
+	events = (events << 16) | (events >> 16);
+#endif
+	pSQE->poll32_events = events;
+	return commit();
+}
+
+bool IOUring::cancel(void* pData, void* pResult) {
+	lock_guard<mutex> lock(_mutex);
+	io_uring_sqe* pSQE = (io_uring_sqe*)prepare(IORING_OP_POLL_REMOVE, -1, pResult);
+	if (!pSQE)
+		return false;
+	pSQE->addr = (UInt64)pData;
+	return commit();
+}
+
+bool IOUring::write(int fd, const iovec* iovecs, UInt32 count, void* pData) {
+	lock_guard<mutex> lock(_mutex);
+	io_uring_sqe* pSQE = (io_uring_sqe*)prepare(IORING_OP_WRITEV, fd, pData);
+	if (!pSQE)
+		return false;
+	pSQE->addr = (UInt64)iovecs;
+	pSQE->len = count;
+	pSQE->off = UInt64(-1); // current file position (IORING_FEAT_RW_CUR_POS)
+	return commit();
+}
+
+bool IOUring::receive(int fd, void* pData) {
+	lock_guard<mutex> lock(_mutex);
+	io_uring_sqe* pSQE = (io_uring_sqe*)prepare(IORING_OP_RECV, fd, pData);
+	if (!pSQE)
+		return false;
+	pSQE->flags = IOSQE_BUFFER_SELECT;
+	pSQE->buf_group = 0;
+	pSQE->len = 0; // size of the provided buffer
+	return commit();
+}
+
+bool IOUring::abort(void* pData) {
+	lock_guard<mutex> lock(_mutex);
+	io_uring_sqe* pSQE = (io_uring_sqe*)prepare(IORING_OP_ASYNC_CANCEL, -1, NULL);
+	if (!pSQE)
+		return false;
+	pSQE->addr = (UInt64)pData;
+	return commit();
+}
+
+bool IOUring::wakeUp(void* pData) {
+	lock_guard<mutex> lock(_mutex);
+	if (!prepare(IORING_OP_NOP, -1, pData))
+		return false;
+	return commit();
+}
+
+bool IOUring::flush() {
+	lock_guard<mutex> lock(_mutex);
+	return submit();
+}
+
+int IOUring::wait(Completion* completions, UInt32 size, Int32 timeout) {
+	if (_fd < 0) {
+		errno = ENOSYS;
+		return -1;
+	}
+	{
+		lock_guard<mutex> lock(_mutex);
+		if (!submit())
+			return -1;
+	}
+	for (;;) {
+		UInt32 head = *_pCQHead; // just this thread writes it
+		UInt32 tail = __atomic_load_n(_pCQTail, __ATOMIC_ACQUIRE);
+		UInt32 count = 0;
+		while (head != tail && count < size) {
+			const io_uring_cqe& cqe = ((const io_uring_cqe*)_pCQEs)[head++ & _cqMask];
+			Completion& completion = completions[count++];
+			completion.pData = (void*)cqe.user_data;
+			completion.result = cqe.res;
+			completion.more = (cqe.flags & IORING_CQE_F_MORE) ? true : false;
+			completion.buffer = (cqe.flags & IORING_CQE_F_BUFFER) ? Int32(cqe.flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+		}
+		if (count) {
+			__atomic_store_n(_pCQHead, head, __ATOMIC_RELEASE);
+			return int(count);
+		}
+		if (!timeout)
+			return 0;
+		if (timeout < 0) {
+			if (syscall(__NR_io_uring_enter, _fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+				return -1;
+			continue;
+		}
+		// timeout with the extended argument (kernel 5.11)
+		__kernel_timespec ts;
+		ts.tv_sec = timeout / 1000;
+		ts.tv_nsec = (timeout % 1000) * 1000000;
+		io_uring_getevents_arg arg;
+		memset(&arg, 0, sizeof(arg));
+		arg.ts = (UInt64)&ts;
+		if (syscall(__NR_io_uring_enter, _fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) < 0) {
+			if (errno == ETIME)
+				return 0;
+			if (errno != EINTR)
+				return -1;
+		}
+	}
+}
+
+#else
+
+IOUring::IOUring(UInt32 entries) : _fd(-1), _toSubmit(0), _sqTail(0),
+	_pSQ(NULL), _sqSize(0), _pCQ(NULL), _cqSize(0), _pSQEs(NULL), _sqesSize(0), _pBufRing(NULL), _pBuffers(NULL), _bufCount(0), _bufSize(0), _bufTail(0) {}
+IOUring::~IOUring() {}
+bool IOUring::provide(UInt16 count, UInt32 size) { return false; }
+void IOUring::release(UInt16 id) {}
+void* IOUring::prepare(UInt8 opcode, int fd, void* pData) { return NULL; }
+bool IOUring::commit() { return false; }
+bool IOUring::submit() { return false; }
+bool IOUring::poll(int fd, UInt32 events, void* pData) { return false; }
+bool IOUring::cancel(void* pData, void* pResult) { return false; }
+bool IOUring::write(int fd, const iovec* iovecs, UInt32 count, void* pData) { return false; }
+bool IOUring::receive(int fd, void* pData) { return false; }
+bool IOUring::abort(void* pData) { return false; }
+bool IOUring::wakeUp(void* pData) { return false; }
+bool IOUring::flush() { return false; }
+int  IOUring::wait(Completion* completions, UInt32 size, Int32 timeout) { return -1; }
+
+#endif
+
+} // namespace Mona
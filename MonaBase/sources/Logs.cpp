@@ -16,16 +16,130 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 #include "Mona/Logs.h"
 #include "Mona/Util.h"
+#include "Mona/Metrics.h"
+#include <vector>
 
 using namespace std;
 
 namespace Mona {
 
+// always counted (without Metrics::Enabled check), Logs::Dropped() and the drop report rely on it
+static Metrics::Counter	LogsDropped("mona_logs_dropped", "Logs dropped on asynchronous buffer overflow");
+static thread_local bool IsWriterThread(false);
+
+/*!
+Single producer (the logging thread) single consumer (the thread draining with Logs::_Mutex locked) lock-free ring,
+records are 8 bytes aligned and never split: if a record doesn't fit before the end a padding marker fills the rest */
+struct Logs::Ring : virtual Object {
+	struct Record {
+		UInt32		size; // record size with data, 0 = padding until the end of the ring
+		UInt32		line;
+		UInt32		threadId;
+		UInt32		headerSize; // file for a log, header for a dump
+		UInt32		dataSize; // message for a log, data for a dump
+		LOG_LEVEL	level; // 0 for a dump
+		Int64		time;
+	};
+
+	Ring(UInt32 capacity) : capacity(capacity), _data(new UInt8[capacity]), _head(0), _tail(0) {}
+	~Ring() { delete[] _data; }
+
+	const UInt32 capacity;
+
+	/*!
+	Returns false if there is not enough room, tooBig is set if the record can't fit even in an empty ring */
+	bool push(LOG_LEVEL level, const char* header, UInt32 headerSize, long line, const UInt8* data, UInt32 size, bool& wasEmpty, bool& tooBig) {
+		UInt32 need = (sizeof(Record) + headerSize + size + 7) & ~7;
+		if ((tooBig = need > capacity / 2))
+			return false;
+		UInt32 head = _head.load(memory_order_relaxed);
+		UInt32 tail = _tail.load(memory_order_acquire);
+		UInt32 offset = head & (capacity - 1);
+		UInt32 rest = capacity - offset;
+		if ((capacity - (head - tail)) < (rest < need ? rest + need : need))
+			return false;
+		wasEmpty = head == tail;
+		if (rest < need) {
+			((Record*)(_data + offset))->size = 0;
+			head += rest;
+			offset = 0;
+		}
+		Record& record = *(Record*)(_data + offset);
+		record.size = need;
+		record.line = UInt32(line);
+		record.threadId = Thread::CurrentId();
+		record.headerSize = headerSize;
+		record.dataSize = size;
+		record.level = level;
+		record.time = Time::Now();
+		memcpy(_data + offset + sizeof(Record), header, headerSize);
+		memcpy(_data + offset + sizeof(Record) + headerSize, data, size);
+		_head.store(head + need, memory_order_release);
+		return true;
+	}
+
+	template<typename OnRecord>
+	void pop(const OnRecord& onRecord) {
+		UInt32 tail = _tail.load(memory_order_relaxed);
+		UInt32 head = _head.load(memory_order_acquire);
+		while (tail != head) {
+			UInt32 offset = tail & (capacity - 1);
+			const Record& record = *(Record*)(_data + offset);
+			if (!record.size) {
+				tail += capacity - offset;
+				continue;
+			}
+			const char* header = STR(_data + offset + sizeof(Record));
+			onRecord(record, header, BIN(header + record.headerSize));
+			_tail.store(tail += record.size, memory_order_release);
+		}
+	}
+
+private:
+	UInt8*			_data;
+	atomic<UInt32>	_head; // written by producer
+	char			_padding[60]; // _head and _tail on different cache lines
+	atomic<UInt32>	_tail; // written by consumer
+};
+
+struct Logs::Writer : Thread {
+	Writer() : Thread("Logs"), ringSize(0x10000), overflow(OVERFLOW_DROP), reported(0) {}
+	~Writer() {
+		_Async = false;
+		stop();
+		Flush();
+	}
+
+	vector<shared<Ring>>	rings; // protected by _Mutex
+	UInt32					ringSize;
+	Overflow				overflow;
+	UInt64					reported; // dropped count already reported
+
+	void signal() { wakeUp.set(); }
+
+private:
+	bool run(Exception& ex, const volatile bool& requestStop) {
+		IsWriterThread = true;
+		while (!requestStop) {
+			wakeUp.wait(100); // batch, and wake up on first log after an empty ring
+			Flush();
+		}
+		Flush();
+		return true;
+	}
+};
+
 
 mutex					Logs::_Mutex;
 
 thread_local bool		Logs::_Dumping(false);
 thread_local bool		Logs::_Logging(false);
+thread_local String		Logs::_Message;
+
+atomic<bool>			Logs::_Async(false);
+atomic<UInt16>			Logs::_RateLimit(0);
+UInt32					Logs::_ThreadId(0);
+Int64					Logs::_Time(0);
 
 volatile bool			Logs::_Dump;
 std::string				Logs::_DumpFilter;
@@ -35,6 +149,7 @@ volatile bool			Logs::_DumpResponse(true);
 
 atomic<LOG_LEVEL>		Logs::_Level(LOG_DEFAULT); // default log level
 Logs::Loggers			Logs::_Loggers;
+Logs::Writer			Logs::_Writer; // after _Loggers to be stopped and flushed before loggers deletion
 
 std::string				Logs::_Critic;
 
@@ -90,11 +205,178 @@ void Logs::SetDump(const char* name) {
 	}
 }
 
+void Logs::SetAsync(bool async, UInt32 bufferSize, Overflow overflow) {
+	_Async = false;
+	_Writer.stop();
+	Flush();
+	if (!async)
+		return;
+	UInt32 capacity(0x1000);
+	while (capacity < bufferSize && capacity < 0x10000000)
+		capacity <<= 1;
+	_Writer.ringSize = capacity;
+	_Writer.overflow = overflow;
+	_Writer.start();
+	_Async = true;
+}
+
+UInt64 Logs::Dropped() {
+	return LogsDropped.value();
+}
+
+void Logs::Flush() {
+	Disable disable; // a logger logging itself must not reenter
+	lock_guard<mutex> lock(_Mutex);
+	Drain();
+}
+
+bool Logs::Dumpable(const char* name) {
+	lock_guard<mutex> lock(_Mutex);
+	return _DumpFilter.empty() || String::ICompare(_DumpFilter, name) == 0;
+}
+
+bool Logs::RateLimit(const char* file, long line, UInt32& suppressed) {
+	struct Rate {
+		const char* file;
+		long		line;
+		Int64		second;
+		UInt32		count;
+		UInt32		suppressed;
+	};
+	thread_local Rate Rates[16]; // by thread, no lock, a collision just resets the counter
+	Rate& rate(Rates[((size_t(file) >> 3) ^ line) & 15]);
+	Int64 second = Time::Now() / 1000;
+	if (rate.file != file || rate.line != line) {
+		rate.file = file;
+		rate.line = line;
+		rate.second = second;
+		rate.count = 1;
+		rate.suppressed = 0;
+		return true;
+	}
+	if (rate.second != second) {
+		rate.second = second;
+		rate.count = 0;
+	}
+	if (++rate.count > _RateLimit) {
+		++rate.suppressed;
+		return false;
+	}
+	suppressed = rate.suppressed;
+	rate.suppressed = 0;
+	return true;
+}
+
+Logs::Ring* Logs::ThreadRing() {
+	thread_local shared<Ring> PRing;
+	if (!PRing || PRing->capacity != _Writer.ringSize) {
+		PRing.set(_Writer.ringSize);
+		lock_guard<mutex> lock(_Mutex);
+		_Writer.rings.emplace_back(PRing);
+	}
+	return PRing.get();
+}
+
+bool Logs::Push(LOG_LEVEL level, const char* header, UInt32 headerSize, long line, const UInt8* data, UInt32 size) {
+	if (!_Async || IsWriterThread || (level && level <= LOG_CRITIC))
+		return false;
+	Ring& ring(*ThreadRing());
+	bool wasEmpty, tooBig;
+	while (!ring.push(level, header, headerSize, line, data, size, wasEmpty, tooBig)) {
+		if (tooBig)
+			return false; // synchronous to keep it entire
+		if (_Writer.overflow == OVERFLOW_DROP) {
+			LogsDropped.add();
+			return true;
+		}
+		_Writer.signal();
+		this_thread::yield();
+		if (!_Async)
+			return false;
+	}
+	if (wasEmpty)
+		_Writer.signal();
+	return true;
+}
+
+void Logs::Write(LOG_LEVEL level, const char* file, long line, const string& message) {
+	if (Push(level, file, UInt32(strlen(file)), line, BIN message.data(), UInt32(message.size())))
+		return;
+	lock_guard<mutex> lock(_Mutex);
+	Drain(); // pending logs before, to keep order
+	_ThreadId = Thread::CurrentId();
+	_Time = Time::Now();
+	Dispatch(level, file, line, message);
+}
+
 void Logs::Dump(const string& header, const UInt8* data, UInt32 size) {
-	Buffer out;
-	Util::Dump(data, (_DumpLimit<0 || size<UInt32(_DumpLimit)) ? size : _DumpLimit, out);
+	Int32 limit = _DumpLimit;
+	if (limit >= 0 && size > UInt32(limit))
+		size = limit;
+	// hexadecimal formatting is done by Dispatch, on the "Logs" thread in asynchronous mode
+	if (Push(0, header.data(), UInt32(header.size()), 0, data, size))
+		return;
+	lock_guard<mutex> lock(_Mutex);
+	Drain();
+	_ThreadId = Thread::CurrentId();
+	_Time = Time::Now();
+	Dispatch(header, data, size);
+}
+
+void Logs::Drain() {
+	if (_Writer.rings.empty())
+		return;
+	static String Header;
+	static String Message;
+	for (auto it = _Writer.rings.begin(); it != _Writer.rings.end();) {
+		bool orphan = it->unique(); // its thread is dead, no more push possible
+		(*it)->pop([](const Ring::Record& record, const char* header, const UInt8* data) {
+			_ThreadId = record.threadId;
+			_Time = record.time;
+			Header.assign(header, record.headerSize);
+			if (!record.level)
+				return Dispatch(Header, data, record.dataSize);
+			Message.assign(STR data, record.dataSize);
+			Dispatch(record.level, Header.c_str(), record.line, Message);
+		});
+		if (orphan)
+			it = _Writer.rings.erase(it);
+		else
+			++it;
+	}
+	if (Header.size() > 0xFF || Message.size() > 0xFF) {
+		Header.resize(0);
+		Header.shrink_to_fit();
+		Message.resize(0);
+		Message.shrink_to_fit();
+	}
+	UInt64 dropped = LogsDropped.value();
+	if (dropped <= _Writer.reported)
+		return;
+	_ThreadId = Thread::CurrentId();
+	_Time = Time::Now();
+	Dispatch(LOG_WARN, __FILE__, __LINE__, String(dropped - _Writer.reported, " logs dropped on asynchronous buffer overflow"));
+	_Writer.reported = dropped;
+}
+
+void Logs::Dispatch(LOG_LEVEL level, const char* file, long line, const string& message) {
+	static Path File;
+	File.set(file);
+	if (level <= LOG_CRITIC)
+		_Critic.assign(message.empty() ? "unknown" : message.c_str());
+	for (auto& it : _Loggers) {
+		if (*it.second && !it.second->log(level, File, line, message))
+			_Loggers.fail(*it.second);
+	}
+	_Loggers.flush();
+}
+
+void Logs::Dispatch(const string& header, const UInt8* data, UInt32 size) {
+	static Buffer Out;
+	Out.clear();
+	Util::Dump(data, size, Out);
 	for (auto& it : _Loggers) {
-		if (*it.second && !it.second->dump(header, out.data(), out.size()))
+		if (*it.second && !it.second->dump(header, Out.data(), Out.size()))
 			_Loggers.fail(*it.second);
 	}
 	_Loggers.flush();
@@ -0,0 +1,234 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/Metrics.h"
+#include "Mona/String.h"
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace Mona {
+
+bool Metrics::_Enabled(false);
+
+static mutex& Mutex() {
+	static mutex Mutex;
+	return Mutex;
+}
+static vector<Metrics::Metric*>& Registry() {
+	// function static to be built before the first static metric registration, and destroyed after its unregistration
+	static vector<Metrics::Metric*> Registry;
+	return Registry;
+}
+
+static UInt8 Log2(UInt64 value) {
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return UInt8(index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, UInt32(value >> 32)))
+		return UInt8(index + 32);
+	_BitScanReverse(&index, UInt32(value));
+	return UInt8(index);
+#else
+	return UInt8(63 - __builtin_clzll(value));
+#endif
+}
+
+Int64 Metrics::Clock() {
+	return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+UInt8 Metrics::Slot() {
+	static atomic<UInt8> Slots(0);
+	static thread_local UInt8 Slot(Slots++ % SLOTS);
+	return Slot;
+}
+
+Buffer& Metrics::Write(Buffer& buffer, Format format) {
+	lock_guard<mutex> lock(Mutex());
+	if (format == FORMAT_JSON)
+		buffer.append(EXPAND("{"));
+	bool first = true;
+	for (const Metric* pMetric : Registry()) {
+		if (format == FORMAT_JSON) {
+			if (!first)
+				buffer.append(EXPAND(","));
+			String::Append(buffer, '"', pMetric->name, "\":");
+		} else if (pMetric->help)
+			String::Append(buffer, "# HELP ", pMetric->name, ' ', pMetric->help, '\n');
+		pMetric->write(buffer, format);
+		first = false;
+	}
+	if (format == FORMAT_JSON)
+		buffer.append(EXPAND("}"));
+	return buffer;
+}
+
+
+Metrics::Metric::Metric(const char* name, const char* help) : name(name), help(help) {
+	if (!name)
+		return; // local
+	lock_guard<mutex> lock(Mutex());
+	Registry().emplace_back(this);
+}
+
+Metrics::Metric::~Metric() {
+	if (!name)
+		return;
+	lock_guard<mutex> lock(Mutex());
+	vector<Metric*>& registry(Registry());
+	registry.erase(remove(registry.begin(), registry.end(), this), registry.end());
+}
+
+
+Metrics::Histogram::Histogram(const char* name, const char* help) : Metric(name, help) {
+	for (Slot& slot : _slots) {
+		for (atomic<UInt64>& count : slot.counts)
+			count.store(0, memory_order_relaxed);
+		slot.sum.store(0, memory_order_relaxed);
+		slot.max.store(0, memory_order_relaxed);
+	}
+}
+
+UInt16 Metrics::Histogram::Bucket(UInt64 value) {
+	if (value < 16)
+		return UInt16(value);
+	UInt8 exponent = Log2(value);
+	if (exponent > 35)
+		return BUCKETS - 1;
+	return 16 + (exponent - 4) * 8 + ((value >> (exponent - 3)) & 7);
+}
+
+UInt64 Metrics::Histogram::BucketMax(UInt16 bucket) {
+	if (bucket < 16)
+		return bucket;
+	bucket -= 16;
+	UInt8 shift = bucket / 8 + 1; // exponent - 3
+	return ((UInt64(8 + (bucket & 7)) + 1) << shift) - 1;
+}
+
+void Metrics::Histogram::add(UInt64 value) {
+	Slot& slot(_slots[Metrics::Slot()]);
+	slot.counts[Bucket(value)].fetch_add(1, memory_order_relaxed);
+	slot.sum.fetch_add(value, memory_order_relaxed);
+	UInt64 max = slot.max.load(memory_order_relaxed);
+	while (value > max && !slot.max.compare_exchange_weak(max, value, memory_order_relaxed));
+}
+
+Metrics::Histogram::Snapshot& Metrics::Histogram::snapshot(Snapshot& snapshot) const {
+	for (const Slot& slot : _slots) {
+		for (UInt16 i = 0; i < BUCKETS; ++i) {
+			UInt64 count = slot.counts[i].load(memory_order_relaxed);
+			snapshot.counts[i] += count;
+			snapshot.count += count;
+		}
+		snapshot.sum += slot.sum.load(memory_order_relaxed);
+		snapshot.max = max(snapshot.max, slot.max.load(memory_order_relaxed));
+	}
+	return snapshot;
+}
+
+UInt64 Metrics::Histogram::Snapshot::percentile(double rate) const {
+	if (!count)
+		return 0;
+	UInt64 rank = UInt64(rate * count + 0.5);
+	if (!rank)
+		rank = 1;
+	UInt64 total = 0;
+	for (UInt16 i = 0; i < BUCKETS; ++i) {
+		if ((total += counts[i]) >= rank)
+			return min(BucketMax(i), max);
+	}
+	return max;
+}
+
+void Metrics::Histogram::write(Buffer& buffer, Format format) const {
+	static const struct Quantile {
+		double		rate;
+		const char* name;
+		const char* key;
+	} Quantiles[] = { { 0.5, "0.5", "p50" }, { 0.9, "0.9", "p90" }, { 0.99, "0.99", "p99" }, { 0.999, "0.999", "p999" } };
+
+	Snapshot snapshot;
+	this->snapshot(snapshot);
+	if (format == FORMAT_JSON) {
+		String::Append(buffer, "{\"count\":", snapshot.count, ",\"sum\":", snapshot.sum, ",\"max\":", snapshot.max);
+		for (const Quantile& quantile : Quantiles)
+			String::Append(buffer, ",\"", quantile.key, "\":", snapshot.percentile(quantile.rate));
+		buffer.append(EXPAND("}"));
+		return;
+	}
+	String::Append(buffer, "# TYPE ", name, " summary\n");
+	for (const Quantile& quantile : Quantiles)
+		String::Append(buffer, name, "{quantile=\"", quantile.name, "\"} ", snapshot.percentile(quantile.rate), '\n');
+	String::Append(buffer, name, "_sum ", snapshot.sum, '\n', name, "_count ", snapshot.count, '\n');
+}
+
+
+Metrics::Counter::Counter(const char* name, const char* help) : Metric(name, help) {
+	for (Slot& slot : _slots)
+		slot.value.store(0, memory_order_relaxed);
+}
+
+UInt64 Metrics::Counter::value() const {
+	UInt64 value = 0;
+	for (const Slot& slot : _slots)
+		value += slot.value.load(memory_order_relaxed);
+	return value;
+}
+
+void Metrics::Counter::write(Buffer& buffer, Format format) const {
+	if (format == FORMAT_JSON)
+		String::Append(buffer, value());
+	else
+		String::Append(buffer, "# TYPE ", name, " counter\n", name, ' ', value(), '\n');
+}
+
+void Metrics::Gauge::write(Buffer& buffer, Format format) const {
+	if (format == FORMAT_JSON)
+		String::Append(buffer, value());
+	else
+		String::Append(buffer, "# TYPE ", name, " gauge\n", name, ' ', value(), '\n');
+}
+
+void Metrics::Series::write(Buffer& buffer, Format format) const {
+	if (format == FORMAT_JSON) {
+		buffer.append(EXPAND("{"));
+		bool first = true;
+		_probe([&](const string& value, Int64 metric) {
+			String::Append(buffer, first ? "\"" : ",\"", value, "\":", metric);
+			first = false;
+		});
+		buffer.append(EXPAND("}"));
+		return;
+	}
+	String::Append(buffer, "# TYPE ", name, _counter ? " counter\n" : " gauge\n");
+	_probe([&](const string& value, Int64 metric) {
+		String::Append(buffer, name, '{', label, "=\"", value, "\"} ", metric, '\n');
+	});
+}
+
+
+} // namespace Mona
@@ -0,0 +1,67 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/RunnerQueue.h"
+#include "Mona/Slab.h"
+
+using namespace std;
+
+namespace Mona {
+
+RunnerQueue::RunnerQueue() : _pHead(&_stub), _pTail(&_stub), _size(0) {
+}
+
+void RunnerQueue::push(shared<Runner>&& pRunner) {
+	++_size; // before to be never less than the runners reachable by pop
+	push(new (Slab::Allocate(sizeof(Node))) Node(move(pRunner)));
+}
+
+void RunnerQueue::push(Node* pNode) {
+	pNode->pNext.store(NULL, memory_order_relaxed);
+	Node* pPrev = _pHead.exchange(pNode, memory_order_acq_rel);
+	// here the list is cut until the next assignment (a pop returns null)
+	pPrev->pNext.store(pNode, memory_order_release);
+}
+
+shared<Runner> RunnerQueue::pop(Int64& queued) {
+	Node* pTail = _pTail;
+	Node* pNext = pTail->pNext.load(memory_order_acquire);
+	if (pTail == &_stub) {
+		if (!pNext)
+			return nullptr; // empty
+		_pTail = pTail = pNext;
+		pNext = pNext->pNext.load(memory_order_acquire);
+	}
+	if (!pNext) {
+		if (pTail != _pHead.load(memory_order_acquire))
+			return nullptr; // a producer is pushing
+		// last node, push the stub to be able to release it
+		push(&_stub);
+		pNext = pTail->pNext.load(memory_order_acquire);
+		if (!pNext)
+			return nullptr; // a producer is pushing
+	}
+	_pTail = pNext;
+	--_size;
+	shared<Runner> pRunner(move(pTail->pRunner));
+	queued = pTail->queued;
+	pTail->~Node();
+	Slab::Deallocate(pTail);
+	return pRunner;
+}
+
+
+} // namespace Mona
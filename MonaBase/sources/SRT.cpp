@@ -180,6 +180,8 @@ bool SRT::Socket::processParams(Exception& ex, const Parameters& parameters, con
 		result = setOverheadBW(ex, value) && result;
 	if (processParam(parameters, "maxbw", i64Value, prefix))
 		result = setMaxBW(ex, i64Value) && result;
+	if (processParam(parameters, "streamid", stValue, prefix))
+		result = setStreamId(ex, stValue.data(), stValue.size()) && result;
 	return result;
 }
 
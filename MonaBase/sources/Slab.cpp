@@ -0,0 +1,140 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/Slab.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace Mona {
+
+#define SLAB_CLASSES	5		// 64, 128, 256, 512 and 1024 bytes
+#define SLAB_LIMIT		1024	// blocks kept by class and by thread
+
+struct alignas(16) Slab::Block {
+	Cache*	pCache; // NULL if allocated with malloc (big size or thread exiting)
+	UInt8	index;
+};
+
+struct Slab::Cache {
+	struct Free { Free* pNext; };
+
+	Cache() : frees(), counts() {
+		for (std::atomic<Free*>& remote : remotes)
+			remote = NULL;
+	}
+
+	Free*				frees[SLAB_CLASSES];
+	UInt32				counts[SLAB_CLASSES];
+	std::atomic<Free*>	remotes[SLAB_CLASSES]; // released by other threads
+};
+
+// Caches are never deleted: a block can be released after the end of its allocator thread,
+// so on thread exit the cache is orphaned and a next thread adopts it
+static mutex&			Mutex() { static mutex& Mutex(*new mutex()); return Mutex; }
+static vector<void*>&	Orphans() { static vector<void*>& Orphans(*new vector<void*>()); return Orphans; }
+// trivial thread_local variables to stay valid during thread_local destructions
+static thread_local void* _PCache(NULL);
+static thread_local bool  _Exited(false);
+
+static thread_local struct CacheHolder {
+	~CacheHolder() {
+		_Exited = true;
+		if (!_PCache)
+			return;
+		lock_guard<mutex> lock(Mutex());
+		Orphans().emplace_back(_PCache);
+		_PCache = NULL;
+	}
+} _Holder;
+
+Slab::Cache* Slab::CurrentCache() {
+	if (_PCache || _Exited)
+		return (Cache*)_PCache;
+	(void)&_Holder; // build the holder to orphan the cache on thread exit
+	lock_guard<mutex> lock(Mutex());
+	vector<void*>& orphans(Orphans());
+	if (orphans.empty())
+		_PCache = new Cache();
+	else {
+		_PCache = orphans.back();
+		orphans.pop_back();
+	}
+	return (Cache*)_PCache;
+}
+
+void* Slab::Allocate(size_t size) {
+	size += sizeof(Block);
+	UInt8 index(0);
+	size_t capacity(64);
+	while (capacity < size) {
+		if (++index == SLAB_CLASSES) {
+			// big size
+			Block* pBlock = (Block*)malloc(size);
+			if (!pBlock)
+				throw bad_alloc();
+			pBlock->pCache = NULL;
+			return pBlock + 1;
+		}
+		capacity <<= 1;
+	}
+	Cache* pCache = CurrentCache();
+	Cache::Free* pFree = pCache ? pCache->frees[index] : NULL;
+	if (!pFree && pCache && (pFree = pCache->remotes[index].exchange(NULL, memory_order_acquire))) {
+		// adopt blocks released by other threads
+		pCache->frees[index] = pFree;
+		for (Cache::Free* pNext = pFree; pNext; pNext = pNext->pNext)
+			++pCache->counts[index];
+	}
+	if (!pFree) {
+		Block* pBlock = (Block*)malloc(capacity);
+		if (!pBlock)
+			throw bad_alloc();
+		pBlock->pCache = pCache;
+		pBlock->index = index;
+		return pBlock + 1;
+	}
+	pCache->frees[index] = pFree->pNext;
+	--pCache->counts[index];
+	return pFree;
+}
+
+void Slab::Deallocate(void* pData) {
+	if (!pData)
+		return;
+	Block* pBlock = (Block*)pData - 1;
+	Cache* pOwner = pBlock->pCache;
+	if (!pOwner)
+		return free(pBlock);
+	UInt8 index = pBlock->index;
+	Cache::Free* pFree = (Cache::Free*)pData;
+	if (pOwner == _PCache) {
+		if (pOwner->counts[index] >= SLAB_LIMIT)
+			return free(pBlock);
+		pFree->pNext = pOwner->frees[index];
+		pOwner->frees[index] = pFree;
+		++pOwner->counts[index];
+		return;
+	}
+	// release to the allocator thread (lock-free push, pop is an exchange of the whole list => no ABA problem)
+	pFree->pNext = pOwner->remotes[index].load(memory_order_relaxed);
+	while (!pOwner->remotes[index].compare_exchange_weak(pFree->pNext, pFree, memory_order_release, memory_order_relaxed));
+}
+
+
+} // namespace Mona
@@ -16,9 +16,21 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 
 #include "Mona/Socket.h"
+#include "Mona/Metrics.h"
 #if !defined(_WIN32)
 #include <net/if.h>
 #include <fcntl.h>
+#include <limits.h> // IOV_MAX
+#endif
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+#if defined(_WIN32)
+#define IOV_MAX 1024 // WSASend has no limit, just to bound the stack
+#endif
+#if defined(MSG_WAITFORONE) // recvmmsg and sendmmsg available
+// maximum datagrams by system call
+#define MMSG_MAX 64
 #endif
 
 
@@ -26,6 +38,8 @@ using namespace std;
 
 namespace Mona {
 
+static Metrics::Histogram Queueings("mona_socket_queueing_bytes", "Bytes queued on socket when a sending has to wait (Socket::queueing)");
+
 Socket::Socket(Type type) :
 #if !defined(_WIN32)
 	_pWeakThis(NULL), 
@@ -442,6 +456,70 @@ int Socket::receive(Exception& ex, void* buffer, UInt32 size, int flags, SocketA
 	return rc;
 }
 
+int Socket::receiveFrom(Exception& ex, shared<Buffer>* pBuffers, SocketAddress* pAddresses, UInt32 count, int flags) {
+#if defined(MSG_WAITFORONE)
+	if (_ex) {
+		ex = _ex;
+		return -1;
+	}
+	if (count > MMSG_MAX)
+		count = MMSG_MAX;
+	mmsghdr msgs[MMSG_MAX];
+	iovec	iovs[MMSG_MAX];
+	union {
+		struct sockaddr_in  sa_in;
+		struct sockaddr_in6 sa_in6;
+	} addrs[MMSG_MAX];
+	memset(msgs, 0, count * sizeof(mmsghdr));
+	for (UInt32 i = 0; i < count; ++i) {
+		iovs[i].iov_base = pBuffers[i]->data();
+		iovs[i].iov_len = pBuffers[i]->size();
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &addrs[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+	}
+
+	int rc;
+	int error;
+	do {
+		rc = ::recvmmsg(_id, msgs, count, flags | MSG_WAITFORONE, NULL); // MSG_WAITFORONE => never wait more than the first datagram
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+	if (rc < 0) {
+		SetException(error, ex, " (count=", count, ", flags=", flags, ")");
+		return -1;
+	}
+
+	UInt32 size(0);
+	int received(0);
+	for (int i = 0; i < rc; ++i) {
+		size += msgs[i].msg_len;
+		if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+			// datagram bigger than its buffer => lost, like NET_EMSGSIZE on windows
+			SetException(NET_EMSGSIZE, ex, " (size=", iovs[i].iov_len, ", flags=", flags, ")");
+			continue;
+		}
+		if (received != i)
+			swap(pBuffers[received], pBuffers[i]);
+		pBuffers[received]->resize(msgs[i].msg_len);
+		pAddresses[received++].set(type == TYPE_STREAM ? peerAddress() : reinterpret_cast<const sockaddr&>(addrs[i]));
+	}
+	if (!_address)
+		_address.set(IPAddress::Loopback(), 0); // to advise that address is computable
+
+	receive(size);
+	return received;
+#else
+	if (!count)
+		return 0;
+	int received = receive(ex, pBuffers[0]->data(), pBuffers[0]->size(), flags, pAddresses);
+	if (received < 0)
+		return -1;
+	pBuffers[0]->resize(received);
+	return 1;
+#endif
+}
+
 int Socket::sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags) {
 	if (_ex) {
 		ex = _ex;
@@ -483,6 +561,8 @@ int Socket::write(Exception& ex, const Packet& packet, const SocketAddress& addr
 	if(!_sendings.empty()) {
 		_sendings.emplace_back(packet, address ? address : _peerAddress, flags);
 		_queueing += packet.size();
+		if (Metrics::Enabled())
+			Queueings.add(_queueing);
 		return 0;
 	}
 	_sending = true;
@@ -507,45 +587,310 @@ int Socket::write(Exception& ex, const Packet& packet, const SocketAddress& addr
 
 	_sendings.emplace_back(packet+sent, address ? address : _peerAddress, flags);
 	_queueing += _sendings.back().size();
+	if (Metrics::Enabled())
+		Queueings.add(_queueing);
 	return sent;
 }
 
-bool Socket::flush(Exception& ex, bool deleting) {
-	UInt32 written(0);
+int Socket::gather(Exception& ex, const Packet* const* packets, UInt32 count, const SocketAddress& address, int flags) {
+	if (_ex) {
+		ex = _ex;
+		return -1;
+	}
+	if (count > IOV_MAX)
+		count = IOV_MAX;
+
+#if defined(MSG_NOSIGNAL)
+	flags |= MSG_NOSIGNAL;
+#endif
+
+	UInt32 size(0);
+	int rc;
+	int error;
+#if defined(_WIN32)
+	WSABUF buffers[IOV_MAX];
+	for (UInt32 i = 0; i < count; ++i) {
+		buffers[i].buf = STR packets[i]->data();
+		size += (buffers[i].len = packets[i]->size());
+	}
+	DWORD sent;
+	DWORD wsaFlags(flags);
+	do {
+		if (type == TYPE_DATAGRAM && address) // for TCP socket, address must be null!
+			rc = WSASendTo(_id, buffers, count, &sent, wsaFlags, address.data(), address.size(), NULL, NULL);
+		else
+			rc = WSASend(_id, buffers, count, &sent, wsaFlags, NULL, NULL);
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+	if (!rc)
+		rc = sent;
+#else
+	iovec iovs[IOV_MAX];
+	for (UInt32 i = 0; i < count; ++i) {
+		iovs[i].iov_base = (void*)packets[i]->data();
+		size += (iovs[i].iov_len = packets[i]->size());
+	}
+	msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iovs;
+	msg.msg_iovlen = count;
+	if (type == TYPE_DATAGRAM && address) { // for TCP socket, address must be null!
+		msg.msg_name = (void*)address.data();
+		msg.msg_namelen = address.size();
+	}
+	do {
+		rc = ::sendmsg(_id, &msg, flags);
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+#endif
+	if (rc < 0) {
+		SetException(error, ex, " (address=", address ? address : _peerAddress, ", count=", count, ", size=", size, ", flags=", flags, ")");
+		return -1;
+	}
+
+	if (!_address)
+		_address.set(IPAddress::Loopback(), 0); // to advise that address is computable
+
+	send(rc);
+
+	if (UInt32(rc) < size && type == TYPE_DATAGRAM) {
+		SetException(NET_EMSGSIZE, ex, " (address=", address ? address : _peerAddress, ", count=", count, ", size=", size, ", flags=", flags, ")");
+		return -1;
+	}
+
+	return rc;
+}
+
+int Socket::write(Exception& ex, const Packet* const* packets, UInt32 count, const SocketAddress& address, int flags) {
+	lock_guard<mutex> lock(_mutexSending);
+	bool queueing(!_sendings.empty());
+	for (UInt32 i = 0; i < count; ++i) {
+		_sendings.emplace_back(*packets[i], address ? address : _peerAddress, flags);
+		_queueing += packets[i]->size();
+	}
+	if (queueing || !count) {
+		if (queueing && Metrics::Enabled())
+			Queueings.add(_queueing);
+		return count; // wait next call to flush()
+	}
+	_sending = true;
+	if (flushSendings(ex, false) >= 0 && !ex)
+		return count; // sent or queued (can't send now, no error)
+	if (type == TYPE_STREAM)
+		return -1; // closed
+	// a datagram has failed (removed), the following ones are not queued to let the caller repeats them
+	count -= _sendings.size() + 1;
+	_sendings.clear();
+	_queueing = 0;
+	_sending = false;
+	return count ? int(count) : -1;
+}
+
+bool Socket::zeroCopy() const {
+#if defined(__linux__)
+	return type == TYPE_STREAM;
+#else
+	return false;
+#endif
+}
+
+int Socket::sendFile(Exception& ex, File& file, UInt32 size) {
+	lock_guard<mutex> lock(_mutexSending);
+	if (!_sendings.empty())
+		return 0; // wait next call to flush()
+	_sending = true;
+	int sent = transferFile(ex, file, size);
+	if (sent < 0) {
+		int code = ex.cast<Ex::Net::Socket>().code;
+		if ((code == NET_ENOTCONN && _peerAddress) || code == NET_EWOULDBLOCK) {
+			// wait next call to flush(), no error!
+			ex = nullptr;
+			return 0;
+		}
+		if (type == TYPE_STREAM)
+			close(); // shutdown system to avoid to try to send before shutdown!
+		_sending = false;
+		return -1;
+	}
+	if (UInt32(sent) >= size)
+		_sending = false;
+	return sent;
+}
+
+int Socket::transferFile(Exception& ex, File& file, UInt32 size) {
+	if (_ex) {
+		ex = _ex;
+		return -1;
+	}
+	if (!file.load(ex))
+		return -1;
+#if defined(__linux__)
+	ssize_t rc;
+	int error;
+	do {
+		rc = ::sendfile(_id, FileDescriptor(file), NULL, size); // NULL => move the file reading position
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+	if (rc < 0) {
+		SetException(error, ex, " (file=", file.path(), ", size=", size, ")");
+		return -1;
+	}
+	file._readen += rc;
+	if (!_address)
+		_address.set(IPAddress::Loopback(), 0); // to advise that address is computable
+	send(UInt32(rc));
+	return int(rc);
+#else
+	return copyFile(ex, file, size);
+#endif
+}
 
+int Socket::copyFile(Exception& ex, File& file, UInt32 size) {
+	Buffer buffer(size);
+	int readen = file.read(ex, buffer.data(), size);
+	if (readen <= 0)
+		return readen;
+	int sent = sendTo(ex, buffer.data(), readen, SocketAddress::Wildcard());
+	if (sent < readen) // replace the file reading position on the first byte not sent
+		file.reset(file.readen() - readen + max(sent, 0));
+	return sent;
+}
+
+bool Socket::flush(Exception& ex, bool deleting) {
 	unique_lock<mutex> lock(_mutexSending, defer_lock);
 	if (!deleting)
 		lock.lock();
-	int sent(0);
-	while(sent>=0 && !_sendings.empty()) {
-		Sending& sending(_sendings.front());
-		sent = sendTo(ex, sending.data(), sending.size(), sending.address, sending.flags);
-		if (sent >= 0) {
-			written += sent;
-			if (UInt32(sent) < sending.size()) {
-				// can't send more!
-				sending += sent;
+	return flushSendings(ex, deleting) >= 0;
+}
+
+int Socket::sendSendings(Exception& ex, UInt32& written) {
+	// first packets with the same flags
+	int flags = _sendings.front().flags;
+	if (type == TYPE_STREAM) {
+		// gather in one write (writev), the first packet not completly sent stays in the queue
+		const Packet* packets[IOV_MAX];
+		UInt32 count(0);
+		for (const Sending& sending : _sendings) {
+			if (count == IOV_MAX || sending.flags != flags)
 				break;
+			packets[count++] = &sending;
+		}
+		int rc = gather(ex, packets, count, SocketAddress::Wildcard(), flags);
+		if (rc < 0)
+			return -1;
+		written += rc;
+		UInt32 sent(0);
+		while (count--) {
+			Sending& sending(_sendings.front());
+			if (UInt32(rc) < sending.size()) {
+				if (!rc)
+					break; // gather can send less packets (TLS record)
+				sending += rc; // can't send more!
+				return 0;
 			}
+			rc -= sending.size();
+			_sendings.pop_front();
+			++sent;
+		}
+		return sent;
+	}
+#if defined(MSG_WAITFORONE)
+	mmsghdr msgs[MMSG_MAX];
+	iovec	iovs[MMSG_MAX];
+	UInt32 count(0);
+	for (const Sending& sending : _sendings) {
+		if (count == MMSG_MAX || sending.flags != flags)
+			break;
+		iovs[count].iov_base = (void*)sending.data();
+		iovs[count].iov_len = sending.size();
+		memset(&msgs[count], 0, sizeof(mmsghdr));
+		msgs[count].msg_hdr.msg_iov = &iovs[count];
+		msgs[count].msg_hdr.msg_iovlen = 1;
+		if (sending.address) {
+			msgs[count].msg_hdr.msg_name = (void*)sending.address.data();
+			msgs[count].msg_hdr.msg_namelen = sending.address.size();
+		}
+		++count;
+	}
+#if defined(MSG_NOSIGNAL)
+	flags |= MSG_NOSIGNAL;
+#endif
+	int rc;
+	int error;
+	do {
+		rc = ::sendmmsg(_id, msgs, count, flags);
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+	if (rc < 0) {
+		const SocketAddress& address = _sendings.front().address;
+		SetException(error, ex, " (address=", address ? address : _peerAddress, ", count=", count, ", flags=", flags, ")");
+		return -1;
+	}
+	if (!_address)
+		_address.set(IPAddress::Loopback(), 0); // to advise that address is computable
+	UInt32 size(0);
+	for (int i = 0; i < rc; ++i) {
+		size += msgs[i].msg_len;
+		_sendings.pop_front();
+	}
+	send(size);
+	written += size;
+	return rc;
+#else
+	// one datagram by system call
+	const Sending& sending(_sendings.front());
+	int rc = sendTo(ex, sending.data(), sending.size(), sending.address, flags);
+	if (rc < 0)
+		return -1;
+	written += rc;
+	_sendings.pop_front();
+	return 1;
+#endif
+}
+
+int Socket::flushSendings(Exception& ex, bool deleting) {
+	UInt32 written(0);
+	int sent(0);
+	while(sent>=0 && !_sendings.empty()) {
+		if (_sendings.size() > 1) {
+			// several packets => one system call
+			if ((sent = sendSendings(ex, written)) > 0)
+				continue;
+			if (!sent)
+				break; // can't send more!
 		} else {
-			int code = ex.cast<Ex::Net::Socket>().code;
-			if ((code == NET_ENOTCONN && _peerAddress) || code == NET_EWOULDBLOCK) {
-				// is connecting, can't send more now (wait onFlush)
-				ex = nullptr;
-				break;
-			}
-			if (type == TYPE_STREAM) {
-				// fail to send few reliable data, shutdown send!
-				if(!deleting)
-					close(); // shutdown system to avoid to try to send before shutdown!
-				return false;
+			Sending& sending(_sendings.front());
+			sent = sendTo(ex, sending.data(), sending.size(), sending.address, sending.flags);
+			if (sent >= 0) {
+				written += sent;
+				if (UInt32(sent) < sending.size()) {
+					// can't send more!
+					sending += sent;
+					break;
+				}
+				_sendings.pop_front();
+				continue;
 			}
 		}
+		int code = ex.cast<Ex::Net::Socket>().code;
+		if ((code == NET_ENOTCONN && _peerAddress) || code == NET_EWOULDBLOCK) {
+			// is connecting, can't send more now (wait onFlush)
+			ex = nullptr;
+			break;
+		}
+		if (type == TYPE_STREAM) {
+			// fail to send few reliable data, shutdown send!
+			if(!deleting)
+				close(); // shutdown system to avoid to try to send before shutdown!
+			return -1;
+		}
 		_sendings.pop_front();
 	}
-	if (!deleting && written && !(_queueing -= written))
+	if (deleting)
+		return written;
+	if (_sendings.empty()) {
+		// datagrams in error are removed too
+		_queueing = 0;
 		_sending = false;
-	return true;
+	} else
+		_queueing -= written;
+	return written;
 }
 
 
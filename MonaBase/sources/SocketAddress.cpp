@@ -84,6 +84,18 @@ bool SocketAddress::setIntern(Exception& ex, const char* hostAndPort, std::size_
 	return false;
 }
 
+UInt64 SocketAddress::hash() const {
+	const UInt8* data = (const UInt8*)host().data();
+	UInt64 hash = (UInt64(port()) << 32) | host().scope();
+	for (UInt8 i = 0; i < host().size(); i += 4) {
+		UInt32 word;
+		memcpy(&word, data + i, 4);
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+		hash ^= hash >> 29;
+	}
+	return hash;
+}
+
 bool SocketAddress::operator < (const SocketAddress& address) const {
 	if (family() != address.family())
 		return family() < address.family();
@@ -34,14 +34,33 @@ const shared<Socket>& TCPServer::socket() {
 }
 
 bool TCPServer::start(Exception& ex,const SocketAddress& address) {
+	if (io.reactors() > 1 && !_subscribed) {
+		socket()->setReusePort(true);
+		io.setReactor(*_pSocket, 0);
+	}
 	// listen has to be called BEFORE io.sibscribe (can subscribe after bind + listen for server, no risk to miss an event)
-	if (socket()->bind(ex, address) && _pSocket->listen(ex) && (_subscribed=io.subscribe(ex, _pSocket, onConnection, onError)))
-		return true;
-	stop();
-	return false;
+	if (!socket()->bind(ex, address) || !_pSocket->listen(ex) || !(_subscribed=io.subscribe(ex, _pSocket, onConnection, onError))) {
+		stop();
+		return false;
+	}
+	for (UInt16 reactor = 1; reactor < io.reactors(); ++reactor) {
+		shared<Socket> pSocket = newSocket();
+		pSocket->setReusePort(true);
+		io.setReactor(*pSocket, reactor);
+		Exception ignore; // SO_REUSEPORT unsupported, just one listener
+		if (!pSocket->bind(ignore, _pSocket->address()) || !pSocket->listen(ignore) || !io.subscribe(ignore, pSocket, onConnection, onError)) {
+			DEBUG(_pSocket->address(), " listened by ", _sockets.size() + 1, " sockets, ", ignore);
+			break;
+		}
+		_sockets.emplace_back(move(pSocket));
+	}
+	return true;
 }
 
 void TCPServer::stop() {
+	for (shared<Socket>& pSocket : _sockets)
+		io.unsubscribe(pSocket);
+	_sockets.clear();
 	if (_subscribed) {
 		_subscribed = false;
 		io.unsubscribe(_pSocket);
@@ -29,7 +29,10 @@ bool TLS::Create(Exception& ex, shared<TLS>& pTLS, const SSL_METHOD* method) {
 		/* If the underlying BIO is blocking, SSL_read()/SSL_write() will only return, once the read operation has been finished or an error occurred,
 		except when a renegotiation take place, in which case a SSL_ERROR_WANT_READ may occur.
 		This behaviour can be controlled with the SSL_MODE_AUTO_RETRY flag of the SSL_CTX_set_mode call. */
-		SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY);
+		SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER); // moving buffer => a write retry can coalesce the same packets in a new buffer
+#if defined(SSL_OP_ENABLE_KTLS)
+		SSL_CTX_set_options(pCTX, SSL_OP_ENABLE_KTLS); // kernel TLS if available, allows SSL_sendfile
+#endif
 		pTLS = new TLS(pCTX);
 		return true;
 	}
@@ -46,7 +49,10 @@ bool TLS::Create(Exception& ex, const char* cert, const char* key, shared<TLS>&
 			/* If the underlying BIO is blocking, SSL_read()/SSL_write() will only return, once the read operation has been finished or an error occurred,
 			except when a renegotiation take place, in which case a SSL_ERROR_WANT_READ may occur.
 			This behaviour can be controlled with the SSL_MODE_AUTO_RETRY flag of the SSL_CTX_set_mode call. */
-			SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY);
+			SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER); // moving buffer => a write retry can coalesce the same packets in a new buffer
+#if defined(SSL_OP_ENABLE_KTLS)
+		SSL_CTX_set_options(pCTX, SSL_OP_ENABLE_KTLS); // kernel TLS if available, allows SSL_sendfile
+#endif
 			pTLS = new TLS(pCTX);
 			return true;
 		}
@@ -166,6 +172,58 @@ int TLS::Socket::sendTo(Exception& ex, const void* data, UInt32 size, const Sock
 	return result;
 }
 
+int TLS::Socket::gather(Exception& ex, const Packet* const* packets, UInt32 count, const SocketAddress& address, int flags) {
+	if (!pTLS)
+		return Mona::Socket::gather(ex, packets, count, address, flags); // normal socket
+	// Coalesce packets while the TLS record is not full (a retry after WANT_WRITE gets at least the same data, queue is unchanged)
+	UInt32 size(0);
+	UInt32 i;
+	for (i = 0; i < count; ++i) {
+		if ((size + packets[i]->size()) > SSL3_RT_MAX_PLAIN_LENGTH)
+			break;
+		size += packets[i]->size();
+	}
+	if (i < 2) // nothing to coalesce
+		return count ? sendTo(ex, packets[0]->data(), packets[0]->size(), address, flags) : 0;
+	Buffer buffer(size);
+	size = 0;
+	while (i--) {
+		memcpy(buffer.data() + size, (*packets)->data(), (*packets)->size());
+		size += (*packets++)->size();
+	}
+	return sendTo(ex, buffer.data(), buffer.size(), address, flags);
+}
+
+bool TLS::Socket::zeroCopy() const {
+	if (!pTLS)
+		return Mona::Socket::zeroCopy(); // normal socket
+#if defined(SSL_OP_ENABLE_KTLS)
+	lock_guard<mutex> lock(_mutex);
+	return _ssl && BIO_get_ktls_send(SSL_get_wbio(_ssl));
+#else
+	return false;
+#endif
+}
+
+int TLS::Socket::transferFile(Exception& ex, File& file, UInt32 size) {
+	if (!pTLS)
+		return Mona::Socket::transferFile(ex, file, size); // normal socket
+#if defined(SSL_OP_ENABLE_KTLS)
+	if (zeroCopy()) {
+		if (!file.load(ex))
+			return -1;
+		lock_guard<mutex> lock(_mutex);
+		int result = catchResult(ex, int(SSL_sendfile(_ssl, FileDescriptor(file), file.readen(), size, 0)), " (file=", file.path(), ", size=", size, ")");
+		if (result <= 0)
+			return result;
+		file.reset(file.readen() + result); // SSL_sendfile doesn't move the file reading position
+		Mona::Socket::send(result);
+		return result;
+	}
+#endif
+	return copyFile(ex, file, size); // SSL_write
+}
+
 bool TLS::Socket::flush(Exception& ex, bool deleting) {
 	// Call when Writable!
 	if (!pTLS || queueing() || deleting) // if queueing a SLL_Write will do the handshake!
@@ -21,21 +21,146 @@ using namespace std;
 
 namespace Mona {
 
+thread_local const ThreadPool* ThreadPool::_PCurrent(NULL);
+
+static Metrics::Histogram Waits("mona_threadpool_wait_us", "Waiting time of runners in ThreadPool strands before run (microseconds)");
+
 void ThreadPool::init(UInt16 threads, Thread::Priority priority) {
-	_threads.resize(_size = threads ? threads : Thread::ProcessorCount());
+	_workers.resize(_size = threads ? threads : Thread::ProcessorCount());
 	for (UInt16 i = 0; i < _size; ++i)
-		_threads[i].set(priority);
+		_workers[i].set(self, i, priority);
+	// more strands than threads to balance finely the load
+	_strands.resize(min(UInt32(_size)*STRANDS_PER_THREAD, 0xFFFFu));
+	for (UInt32 i = 0; i < _strands.size(); ++i)
+		_strands[i].set(i % _size);
 }
 
 UInt16 ThreadPool::join() {
 	UInt16 count(0);
-	for (unique<ThreadQueue>& pThread : _threads) {
-		if (!pThread->running())
+	for (unique<Worker>& pWorker : _workers) {
+		if (!pWorker->running())
 			continue;
 		++count;
-		pThread->stop();
+		pWorker->stop();
 	}
 	return count;
 }
 
+ThreadPool::Stats ThreadPool::stats(UInt16 thread) const {
+	Stats stats;
+	if (thread >= _size)
+		return stats;
+	const Worker& worker = *_workers[thread];
+	stats.queueing = worker.queueing;
+	stats.runs = worker.runs;
+	stats.steals = worker.steals;
+	return stats;
+}
+
+void ThreadPool::schedule(Strand& strand) const {
+	Worker& worker = *_workers[strand.worker];
+	worker.push(strand);
+	if (worker.idle)
+		return;
+	// worker busy, wake an other worker to steal the strand
+	for (const unique<Worker>& pWorker : _workers) {
+		if (pWorker.get() != &worker && (pWorker->idle || !pWorker->running()))
+			return pWorker->wake();
+	}
+}
+
+ThreadPool::Strand* ThreadPool::steal(Worker& thief) const {
+	// steal the more loaded busy worker
+	Worker* pVictim(NULL);
+	UInt32 queueing(0);
+	for (const unique<Worker>& pWorker : _workers) {
+		if (pWorker.get() == &thief || pWorker->idle || pWorker->queueing <= queueing)
+			continue; // an idle worker is going to run its strands
+		queueing = pWorker->queueing;
+		pVictim = pWorker.get();
+	}
+	Strand* pStrand = pVictim ? pVictim->steal() : NULL;
+	if (pStrand)
+		++thief.steals;
+	return pStrand;
+}
+
+void ThreadPool::Worker::wake() {
+	if (!running()) {
+		lock_guard<mutex> lock(_mutexStart);
+		start(_priority);
+	}
+	wakeUp.set();
+}
+
+void ThreadPool::Worker::push(Strand& strand) {
+	{
+		lock_guard<mutex> lock(_mutex);
+		_strands.emplace_back(&strand);
+		++queueing;
+	}
+	// after push, see run which checks _strands before to stop
+	wake();
+}
+
+ThreadPool::Strand* ThreadPool::Worker::pop() {
+	lock_guard<mutex> lock(_mutex);
+	if (_strands.empty())
+		return NULL;
+	Strand* pStrand = _strands.front();
+	_strands.pop_front();
+	--queueing;
+	return pStrand;
+}
+
+ThreadPool::Strand* ThreadPool::Worker::steal() {
+	lock_guard<mutex> lock(_mutex);
+	if (_strands.empty())
+		return NULL;
+	Strand* pStrand = _strands.back(); // the last one, the more far to be run by its worker
+	_strands.pop_back();
+	--queueing;
+	return pStrand;
+}
+
+bool ThreadPool::Worker::run(Exception&, const volatile bool& requestStop) {
+	_PCurrent = &_pool;
+
+	for (;;) {
+		Strand* pStrand = pop();
+		if (!pStrand && !(pStrand = _pool.steal(self))) {
+			bool timeout(false);
+			if (!requestStop) {
+				idle = true;
+				timeout = !wakeUp.wait(120000); // 2 mn of timeout
+				idle = false;
+			}
+			if (!timeout && !requestStop)
+				continue;
+			lock_guard<mutex> lock(_mutex);
+			if (!_strands.empty())
+				continue; // a strand has been pushed before to stop
+			stop(); // to set _stop immediatly!
+			return true;
+		}
+		pStrand->worker = index; // affinity, next scheduling on this worker
+		// Run just what is queued now to let other strands run between two batchs
+		UInt32 count(pStrand->runners.size());
+		Int64 queued;
+		while (count--) {
+			shared<Runner> pRunner(pStrand->runners.pop(queued));
+			if (!pRunner)
+				break; // a producer is pushing, see below
+			if (queued)
+				Waits.add(Metrics::Clock() - queued);
+			pRunner->run(pRunner->name);
+			++runs;
+		}
+		pStrand->scheduled = false;
+		// scheduled=false before to check runners, a producer which has pushed before has seen scheduled=true
+		if (!pStrand->runners.empty() && !pStrand->scheduled.exchange(true))
+			push(*pStrand);
+	}
+}
+
 } // namespace Mona
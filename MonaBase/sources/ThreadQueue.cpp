@@ -24,28 +24,25 @@ namespace Mona {
 
 thread_local ThreadQueue* ThreadQueue::_PCurrent(NULL);
 
+static Metrics::Histogram Depths("mona_threadqueue_depth", "Runners found queued on ThreadQueue wake up");
+
 bool ThreadQueue::run(Exception&, const volatile bool& requestStop) {
 	_PCurrent = this;
 	
 	for (;;) {
 		bool timeout = !wakeUp.wait(120000); // 2 mn of timeout
-		for(;;) {
-			deque<shared<Runner>> runners;
-			{
-				lock_guard<mutex> lock(_mutex);
-				if (_runners.empty()) {
-					if (!timeout && !requestStop)
-						break; // wait more
-					stop(); // to set _stop immediatly!
-					return true;
-				}
-				runners = move(_runners);
-			}
-			for (shared<Runner>& pRunner : runners) {
-				pRunner->run(pRunner->name);
-				pRunner.reset(); // release resources
-			}
-		}
+		if (Metrics::Enabled())
+			Depths.add(_runners.size());
+		while (shared<Runner> pRunner = _runners.pop())
+			pRunner->run(pRunner->name);
+		if (!_runners.empty() || (!timeout && !requestStop))
+			continue; // wait more (if a producer is pushing it will signal it)
+		stop(); // to set _stop immediatly!
+		// stop before to check _runners, a producer which has seen the thread running has pushed before (see queue)
+		atomic_thread_fence(memory_order_seq_cst);
+		while (shared<Runner> pRunner = _runners.pop())
+			pRunner->run(pRunner->name);
+		return true;
 	}
 }
 
@@ -22,78 +22,140 @@ using namespace std;
 
 namespace Mona {
 
+Timer::Timer() : _count(0), _current(Time::Now()), _raising(false), _bits() {
+	for (UInt16 i = 0; i < FIRST_SLOTS; ++i) {
+		_slots[i].pBits = &_bits[i >> 6];
+		_slots[i].mask = 1ull << (i & 63);
+	}
+}
+
 Timer::~Timer() {
-	for(const auto& it : _timers) {
-		for (const OnTimer* pTimer : *it.second)
+	for (Slot& slot : _slots) {
+		for (const OnTimer* pTimer = slot.pFirst; pTimer; pTimer = pTimer->_pNext) {
 			pTimer->_nextRaising = 0;
+			pTimer->_pSlot = NULL;
+		}
 	}
 }
 
 const Timer::OnTimer& Timer::set(const OnTimer& onTimer,  UInt32 timeout) const {
-	shared<std::set<const OnTimer*>> pMove;
-	if (!remove(onTimer, pMove)) {
-		add(onTimer, timeout);
+	if (onTimer._nextRaising)
+		remove(onTimer);
+	if (!timeout)
 		return onTimer;
-	}
-	if (timeout) {
-		// MOVE (more efficient!)
-		++_count;
-		const auto& it = _timers.emplace(onTimer._nextRaising = Time::Now() + timeout, move(pMove));
-		if (!it.second)
-			it.first->second->emplace(&onTimer);
-		 else if (!it.first->second)
-			 it.first->second.set().emplace(&onTimer);
-	}
+	// re-arm without allocation, just a relinking
+	// (a raising can't be before the current tick on time change, and while raising the current tick slot is in progress)
+	Int64 time = Time::Now() + timeout;
+	add(onTimer, max(time, _current + (_raising ? 1 : 0)));
 	return onTimer;
 }
 
-void Timer::add(const OnTimer& onTimer,  UInt32 timeout) const {
-	if (!timeout)
-		return;
+void Timer::add(const OnTimer& onTimer, Int64 time) const {
 	++_count;
-	auto& it(_timers[(onTimer._nextRaising=Time::Now() + timeout)]);
-	if (!it)
-		it.set();
-	it->emplace(&onTimer);
+	onTimer._nextRaising = time;
+	UInt64 delta = time - _current;
+	Slot* pSlot;
+	if (delta < FIRST_SLOTS)
+		pSlot = &_slots[time & (FIRST_SLOTS - 1)];
+	else {
+		UInt8 level = 0;
+		UInt8 shift = FIRST_BITS + LEVEL_BITS;
+		while (++level < LEVELS && delta >= (1ull << shift))
+			shift += LEVEL_BITS;
+		shift -= LEVEL_BITS;
+		if (delta >= (1ull << (shift + LEVEL_BITS))) // beyond the wheel (> 49 days), stays on the last slot turn
+			time = _current + (1ull << (shift + LEVEL_BITS)) - 1;
+		pSlot = &_slots[FIRST_SLOTS + (level - 1)*LEVEL_SLOTS + ((time >> shift) & (LEVEL_SLOTS - 1))];
+	}
+	onTimer._pSlot = pSlot;
+	onTimer._pNext = NULL;
+	if ((onTimer._pPrev = pSlot->pLast))
+		pSlot->pLast->_pNext = &onTimer;
+	else
+		pSlot->pFirst = &onTimer;
+	pSlot->pLast = &onTimer;
+	if (pSlot->pBits)
+		*pSlot->pBits |= pSlot->mask;
+}
+
+void Timer::remove(const OnTimer& onTimer) const {
+	Slot* pSlot = onTimer._pSlot;
+	if (pSlot < _slots || pSlot >= (_slots + SLOTS))
+		FATAL_ERROR("Timer already used on an other Timer machine, create both individual Timer::Type rather");
+	if (onTimer._pPrev)
+		onTimer._pPrev->_pNext = onTimer._pNext;
+	else
+		pSlot->pFirst = onTimer._pNext;
+	if (onTimer._pNext)
+		onTimer._pNext->_pPrev = onTimer._pPrev;
+	else
+		pSlot->pLast = onTimer._pPrev;
+	if (!pSlot->pFirst && pSlot->pBits)
+		*pSlot->pBits &= ~pSlot->mask;
+	onTimer._pSlot = NULL;
+	onTimer._nextRaising = 0;
+	--_count;
+}
+
+void Timer::cascade(UInt8 level) const {
+	// redistribute the slot reached on lower levels
+	UInt8 shift = FIRST_BITS + level * LEVEL_BITS;
+	Slot& slot = _slots[FIRST_SLOTS + level*LEVEL_SLOTS + ((_current >> shift) & (LEVEL_SLOTS - 1))];
+	if (!((_current >> shift) & (LEVEL_SLOTS - 1)) && (level + 1) < LEVELS)
+		cascade(level + 1); // upper level in first to keep the order
+	while (slot.pFirst) {
+		const OnTimer& onTimer = *slot.pFirst;
+		Int64 time = onTimer._nextRaising;
+		remove(onTimer);
+		add(onTimer, time);
+	}
 }
 
-bool Timer::remove(const OnTimer& onTimer, shared<std::set<const OnTimer*>>& pMove) const {
-	if (!onTimer._nextRaising)
-		return false;
-	const auto& it(_timers.find(onTimer._nextRaising));
-	if (it != _timers.end()) {
-		onTimer._nextRaising = 0;
-		--_count;
-		if (it->second->size() == 1) {
-			if(*it->second->begin() == &onTimer) {
-				pMove = move(it->second);
-				_timers.erase(it);
-				return true;
+UInt16 Timer::next(UInt16 index) const {
+	for (UInt8 word = index >> 6; word < (FIRST_SLOTS / 64); ++word) {
+		UInt64 bits = _bits[word];
+		if (word == (index >> 6))
+			bits &= ~0ull << (index & 63);
+		if (bits) {
+			UInt16 bit = word << 6;
+			while (!(bits & 1)) {
+				bits >>= 1;
+				++bit;
 			}
-		} else if(it->second->erase(&onTimer))
-			return true;
+			return bit;
+		}
 	}
-	FATAL_ERROR("Timer already used on an other Timer machine, create both individual Timer::Type rather");
-	return false;
+	return FIRST_SLOTS;
 }
 
 UInt32 Timer::raise() {
-	while (!_timers.empty()) {
-		const auto& it(_timers.begin());
-		Int64 waiting(it->first-Time::Now());
-		if (waiting>0)
-			return UInt32(waiting); // > 0!
-		auto itTimers(move(it->second));
-		_timers.erase(it);
-		for (const OnTimer* pTimer : *itTimers) {
-			pTimer->_nextRaising = 0;
-			UInt32 timeout = (*pTimer)(UInt32(-waiting));
-			--_count;
-			if(timeout)
-				add(*pTimer, timeout);
+	Int64 now = Time::Now();
+	_raising = true;
+	while (_current <= now) {
+		UInt16 index = _current & (FIRST_SLOTS - 1);
+		Slot& slot = _slots[index];
+		while (slot.pFirst) {
+			const OnTimer& onTimer = *slot.pFirst;
+			remove(onTimer);
+			UInt32 timeout = onTimer(UInt32(now - _current));
+			if (!timeout)
+				continue;
+			if (onTimer._nextRaising)
+				remove(onTimer); // set again inside the raising, returned timeout prevails
+			add(onTimer, max(Time::Now() + timeout, _current + 1));
 		}
+		// jump to the next slot used or to the next cascade
+		index = next(index + 1);
+		Int64 current = (_current & ~Int64(FIRST_SLOTS - 1)) + index;
+		_current = current > now ? (now + 1) : current;
+		if (!(_current & (FIRST_SLOTS - 1)))
+			cascade(0); // new turn of the first level
 	}
-	return 0; //empty!
+	_raising = false;
+	if (!_count)
+		return 0; // empty!
+	// exact raising on the first level, else the next cascade
+	return UInt32((_current & ~Int64(FIRST_SLOTS - 1)) + next(_current & (FIRST_SLOTS - 1)) - now); // > 0!
 }
 
 
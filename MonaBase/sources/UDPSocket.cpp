@@ -23,10 +23,14 @@ using namespace std;
 
 namespace Mona {
 
-const shared<Socket>& UDPSocket::socket() {
+const shared<Socket>& UDPSocket::socket(bool reusePort) {
 	if (!_pSocket) {
 		_sendingTrack = 0;
 		_pSocket.set(Socket::TYPE_DATAGRAM);
+		if (reusePort) {
+			_pSocket->setReusePort(true);
+			io.setReactor(*_pSocket, 0); // next sockets bound on the same port go to the others reactors
+		}
 		Exception ex;
 		_subscribed = io.subscribe(ex, _pSocket, newDecoder(), onPacket, onFlush, onError);
 		if(!_subscribed || ex)
@@ -52,13 +56,34 @@ void UDPSocket::disconnect() {
 }
 
 bool UDPSocket::bind(Exception& ex, const SocketAddress& address) {
-	if (socket()->bind(ex, address))
+	bool reusePort = address.port() && io.reactors() > 1 && !_pSocket;
+	if (!socket(reusePort)->bind(ex, address)) {
+		close(); // release resources
+		return false;
+	}
+	if (!reusePort)
 		return true;
-	close(); // release resources
-	return false;
+	for (UInt16 reactor = 1; reactor < io.reactors(); ++reactor) {
+		Socket::Decoder* pDecoder = newDecoder();
+		if (pDecoder) {
+			delete pDecoder;
+			break;
+		}
+		shared<Socket> pSocket(SET, Socket::TYPE_DATAGRAM);
+		pSocket->setReusePort(true);
+		io.setReactor(*pSocket, reactor);
+		Exception ignore; // SO_REUSEPORT unsupported, just one socket
+		if (!pSocket->bind(ignore, address) || !io.subscribe(ignore, pSocket, onPacket, onFlush, onError))
+			break;
+		_sockets.emplace_back(move(pSocket));
+	}
+	return true;
 }
 
 void UDPSocket::close() {
+	for (shared<Socket>& pSocket : _sockets)
+		io.unsubscribe(pSocket);
+	_sockets.clear();
 	if (_subscribed) {
 		_subscribed = false;
 		io.unsubscribe(_pSocket);
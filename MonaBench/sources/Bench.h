@@ -0,0 +1,98 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Media.h"
+#include "Mona/Metrics.h"
+#include "Synthetic.h"
+
+namespace Mona {
+
+struct Bench : virtual Static {
+	/*!
+	Measures by protocol, everything runs on the bench thread so counters are not atomic */
+	struct Stats : virtual Object {
+		Stats(const std::string& protocol) : protocol(protocol), publishers(0), subscribers(0), joined(0), failures(0),
+			framesSent(0), bytesSent(0), framesReceived(0), bytesReceived(0), lost(0),
+			join(NULL, NULL), latency(NULL, NULL) {} // local histograms, one by protocol
+
+		const std::string	protocol;
+		UInt32				publishers;
+		UInt32				subscribers;
+		UInt32				joined; // subscribers which have received a first video frame
+		UInt32				failures; // connections rejected or lost
+		UInt64				framesSent;
+		UInt64				bytesSent;
+		UInt64				framesReceived;
+		UInt64				bytesReceived;
+		UInt64				lost;
+		Metrics::Histogram	join; // from subscription to first video frame, in us
+		Metrics::Histogram	latency; // from generation to reception of video frames, in us
+	};
+
+	/*!
+	Media reception of a subscriber */
+	struct Receiver : Media::Source, virtual Object {
+		Receiver(Stats& stats) : _stats(stats), _start(Metrics::Clock()), _joined(false) {}
+
+		void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) { _stats.bytesReceived += packet.size(); }
+		void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) {
+			Int64 now = Metrics::Clock();
+			_stats.bytesReceived += packet.size();
+			if (tag.frame == Media::Video::FRAME_CONFIG)
+				return;
+			++_stats.framesReceived;
+			if (!_joined) {
+				_joined = true;
+				++_stats.joined;
+				_stats.join.add(now - _start);
+			}
+			Int64 clock = Synthetic::ReadClock(packet);
+			if (clock >= 0 && now >= clock)
+				_stats.latency.add(now - clock);
+		}
+		void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) { _stats.bytesReceived += packet.size(); }
+		void addProperties(UInt8 track, Media::Data::Type type, const Packet& packet) {}
+		void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0) { _stats.lost += lost; }
+		void flush() {}
+		void reset() {}
+
+	private:
+		Stats&	_stats;
+		Int64	_start;
+		bool	_joined;
+	};
+
+	/*!
+	Simulated client, publisher or subscriber */
+	struct Client : virtual Object {
+		Client(Stats& stats) : stats(stats) {}
+
+		Stats& stats;
+		/*!
+		Called periodically to connect or reconnect */
+		virtual void			pulse() = 0;
+		/*!
+		Target to write the synthetic medias for a publisher, Null for a subscriber */
+		virtual Media::Target&	target() { return Media::Target::Null(); }
+	};
+};
+
+} // namespace Mona
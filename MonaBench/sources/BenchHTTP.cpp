@@ -0,0 +1,85 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "BenchHTTP.h"
+#include "Mona/HTTP/HTTPDecoder.h"
+#include "Mona/Metrics.h"
+#include <iostream>
+
+using namespace std;
+
+namespace Mona {
+
+static const char Request[] = "GET /live/stream.m3u8?token=6f1c2a HTTP/1.1\r\n"
+	"Host: 192.168.1.10:8080\r\n"
+	"Connection: keep-alive\r\n"
+	"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+	"Accept: */*\r\n"
+	"Origin: http://192.168.1.10:8080\r\n"
+	"Referer: http://192.168.1.10:8080/player.html\r\n"
+	"Accept-Encoding: gzip, deflate\r\n"
+	"Accept-Language: en-US,en;q=0.9,fr;q=0.8\r\n"
+	"Cache-Control: no-cache\r\n"
+	"Cookie: session=8a7f6e5d4c3b2a19; theme=dark; lang=en\r\n"
+	"\r\n";
+
+struct BenchDecoder : HTTPDecoder {
+	BenchDecoder(const Handler& handler) : HTTPDecoder(handler, "") {}
+	using HTTPDecoder::decode;
+};
+
+static void Bench(const char* name, UInt32 count, bool materialize) {
+	Signal signal;
+	Handler handler(signal);
+	shared<Socket> pSocket(SET, Socket::TYPE_STREAM);
+	SocketAddress address;
+	UInt32 requests(0), errors(0);
+	BenchDecoder::OnRequest onRequest([&](HTTP::Request& request) {
+		if (!request || request.ex)
+			++errors;
+		else if (materialize && !request.count())
+			++errors;
+		++requests;
+	});
+	BenchDecoder decoder(handler);
+	decoder.onRequest = onRequest;
+
+	Int64 start = Metrics::Clock();
+	for (UInt32 i = 0; i < count; ++i) {
+		shared<Buffer> pBuffer(SET, Request, UInt32(sizeof(Request) - 1));
+		decoder.decode(pBuffer, address, pSocket);
+		if (!(i & 0xFF))
+			handler.flush();
+	}
+	handler.flush();
+	Int64 elapsed = max<Int64>(Metrics::Clock() - start, 1);
+
+	cout << "  " << name << string(14 - strlen(name), ' ') << String(String::Format<double>("%.0f", requests * 1000000.0 / elapsed)) << " requests/s ("
+		<< String(String::Format<double>("%.0f", elapsed * 1000.0 / count)) << "ns by request)";
+	if (errors || requests != count)
+		cout << ", " << (count - requests + errors) << " ERRORS";
+	cout << endl;
+}
+
+void BenchHTTP::Run(UInt32 count) {
+	cout << "HTTP requests parsing on one core, " << count << " requests of " << (sizeof(Request) - 1) << " bytes:" << endl;
+	Bench("views", count, false);
+	Bench("+ Parameters", count, true);
+}
+
+} // namespace Mona
@@ -0,0 +1,32 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+
+namespace Mona {
+
+/*!
+Offline bench of the HTTP request parsing on one core: header fields kept as views into the received buffer,
+and the same with the Parameters materialization (what cost each request before, and what costs now a script reading its properties) */
+struct BenchHTTP : virtual Static {
+	static void Run(UInt32 count);
+};
+
+} // namespace Mona
@@ -0,0 +1,104 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "BenchJSON.h"
+#include "Mona/JSONReader.h"
+#include "Mona/Bytes.h"
+#include "Mona/Metrics.h"
+#include <iostream>
+
+using namespace std;
+
+namespace Mona {
+
+// messages received by WebSocket and HTTP clients (handler name then arguments)
+static const char* Messages[] = {
+	"[\"play\",1,null,\"live/stream\"]",
+	"[\"publish\",0,null,\"live/stream?token=6f1c2a7b\",\"live\",{\"videocodecid\":7,\"audiocodecid\":10}]",
+	"[\"setDataFrame\",\"onMetaData\",{\"width\":1280,\"height\":720,\"framerate\":30,\"videodatarate\":2500,\"audiodatarate\":128,\"encoder\":\"obs-output module (libobs version 29.1.3)\"}]",
+	"[\"onStatus\",0,null,{\"level\":\"status\",\"code\":\"NetStream.Play.Start\",\"description\":\"Started playing live/stream\",\"clientid\":\"6f1c2a\"}]",
+	"{\"event\":\"chat\",\"room\":\"lobby\",\"user\":{\"id\":1234,\"name\":\"alice\",\"roles\":[\"admin\",\"moderator\"]},\"message\":\"hello everybody, the stream starts in five minutes\",\"sent\":1697000000000}",
+	"[\"onCuePoint\",{\"name\":\"ad\",\"time\":12.5,\"type\":\"event\",\"parameters\":{\"id\":\"spot-42\",\"duration\":30,\"skippable\":false,\"urls\":[\"https://cdn.example.com/ad/42/720.mp4\",\"https://cdn.example.com/ad/42/480.mp4\"]}}]"
+};
+
+struct CountWriter : DataWriter {
+	CountWriter() : count(0) {}
+	UInt64 count;
+	void   writePropertyName(const char* value) { ++count; }
+	void   writeNumber(double value) { ++count; }
+	void   writeString(const char* value, UInt32 size) { ++count; }
+	void   writeBoolean(bool value) { ++count; }
+	void   writeNull() { ++count; }
+	UInt64 writeDate(const Date& date) { ++count; return 0; }
+	UInt64 writeByte(const Packet& bytes) { ++count; return 0; }
+};
+
+static void Bench(const char* name, const vector<Packet>& payloads, UInt32 count, UInt32 tapeMinSize, bool skip) {
+	CountWriter writer;
+	UInt64 bytes(0);
+	Int64 start = Metrics::Clock();
+	for (UInt32 i = 0; i < count; ++i) {
+		for (const Packet& payload : payloads) {
+			JSONReader reader(payload, tapeMinSize);
+			if (skip) {
+				// handler name, and skip arguments
+				reader.read(writer, 1);
+				reader.next(DataReader::END);
+			} else
+				reader.read(writer);
+			bytes += payload.size();
+		}
+	}
+	Int64 elapsed = max<Int64>(Metrics::Clock() - start, 1);
+	cout << "  " << name << string(22 - strlen(name), ' ') << String(String::Format<double>("%.1f", bytes / double(elapsed))) << " MB/s" << endl;
+}
+
+static void Bench(const vector<Packet>& payloads, UInt32 count) {
+	// tape from its default size as in production
+	Bench("char by char", payloads, count, 0xFFFFFFFF, false);
+	Bench("tape", payloads, count, JSONReader::TAPE_MIN_SIZE, false);
+	Bench("skip, char by char", payloads, count, 0xFFFFFFFF, true);
+	Bench("skip, tape", payloads, count, JSONReader::TAPE_MIN_SIZE, true);
+}
+
+void BenchJSON::Run(UInt32 count) {
+	// JSONReader can write a null char temporarily in its packet, so buffers rather than static strings
+	vector<Packet> payloads;
+	UInt32 size(0);
+	for (const char* message : Messages) {
+		shared<Buffer> pBuffer(SET, message, UInt32(strlen(message)));
+		payloads.emplace_back(pBuffer);
+		size += payloads.back().size();
+	}
+	cout << "JSON reading of RPC payloads on one core (" << Bytes::KernelToString(Bytes::Current()) << "), " << count << " times " << payloads.size() << " messages of " << size << " bytes:" << endl;
+	Bench(payloads, count);
+
+	// large payload, metadata of a media server application
+	String metadata("[\"onMetaData\",{");
+	for (UInt32 i = 0; i < 60; ++i)
+		String::Append(metadata, i ? "," : "", "\"property", i, "\":{\"value\":", i * 1.5, ",\"name\":\"some text value with spaces\",\"flags\":[true,false,null,1,2,3]}");
+	metadata += "}]";
+	shared<Buffer> pBuffer(SET, metadata.data(), UInt32(metadata.size()));
+	payloads.clear();
+	payloads.emplace_back(pBuffer);
+	count = max<UInt32>(count * size / UInt32(metadata.size()), 1u);
+	cout << "JSON reading of a " << metadata.size() << " bytes payload, " << count << " times:" << endl;
+	Bench(payloads, count);
+}
+
+} // namespace Mona
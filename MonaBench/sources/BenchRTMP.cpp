@@ -0,0 +1,295 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "BenchRTMP.h"
+#include "Mona/RTMP/RTMP.h"
+#include "Mona/AMFWriter.h"
+#include "Mona/AMFReader.h"
+#include "Mona/MapWriter.h"
+#include "Mona/FLVWriter.h"
+#include "Mona/FLVReader.h"
+#include "Mona/AVC.h"
+
+using namespace std;
+
+namespace Mona {
+
+BenchRTMP::BenchRTMP(IOSocket& io, const SocketAddress& address, const string& name, Bench::Stats& stats, bool publisher) : TCPClient(io), Bench::Client(stats),
+	_address(address), _name(name), _state(STATE_CLOSED), _streamId(0), _chunkSize(RTMP::DEFAULT_CHUNKSIZE), _winAckSize(0), _unackBytes(0), _receivedBytes(0) {
+	if (!publisher)
+		_pReceiver.set(stats);
+	onData = [this](Packet& buffer) { return onChunks(buffer); };
+	onError = [this](const Exception& ex) { DEBUG("RTMP ", _name, ", ", ex); };
+	onDisconnection = [this](const SocketAddress& address) {
+		if (!_state)
+			return;
+		++this->stats.failures;
+		_state = STATE_CLOSED;
+	};
+}
+
+BenchRTMP::~BenchRTMP() {
+	_state = STATE_CLOSED;
+	onDisconnection = nullptr;
+	disconnect();
+}
+
+void BenchRTMP::pulse() {
+	if (_state)
+		return; // connecting or connected
+	_channels.clear();
+	_chunkSize = RTMP::DEFAULT_CHUNKSIZE;
+	_winAckSize = _unackBytes = _receivedBytes = _streamId = 0;
+	Exception ex;
+	if (!connect(ex, _address))
+		return fail(ex);
+	_state = STATE_HANDSHAKE;
+	// C0 + C1 without digest => simple handshake
+	shared<Buffer> pBuffer(SET);
+	BinaryWriter(*pBuffer).write8(3).write32(0).write32(0).writeRandom(1528);
+	if (!TCPClient::send(ex, Packet(pBuffer)))
+		fail(ex);
+}
+
+UInt32 BenchRTMP::onChunks(Packet& buffer) {
+	if (_state == STATE_HANDSHAKE) {
+		// S0 + S1 + S2
+		if (buffer.size() < 3073)
+			return buffer.size();
+		// C2 = S1 echo
+		Exception ex;
+		shared<Buffer> pC2(SET, buffer.data() + 1, 1536);
+		if (!TCPClient::send(ex, Packet(pC2))) {
+			fail(ex);
+			return 0;
+		}
+		buffer += 3073;
+		_state = STATE_CONNECTING;
+
+		shared<Buffer> pBuffer(SET);
+		BinaryWriter(*pBuffer).write32(0x7FFFFFFF); // no chunking
+		send(2, AMF::TYPE_CHUNKSIZE, 0, pBuffer);
+
+		pBuffer.set();
+		AMFWriter writer(*pBuffer, true);
+		writer.writeString(EXPAND("connect"));
+		writer.writeNumber(1);
+		writer.beginObject();
+		writer.writeStringProperty("app", String::Empty());
+		writer.writeStringProperty("tcUrl", String("rtmp://", _address, '/'));
+		writer.endObject();
+		if (!send(3, AMF::TYPE_INVOCATION, 0, pBuffer))
+			return 0;
+	}
+
+	while (buffer) {
+		BinaryReader reader(buffer.data(), buffer.size());
+
+		UInt8 headerSize = reader.read8();
+		UInt32 id = headerSize & 0x3F;
+		headerSize = 12 - (headerSize >> 6) * 4;
+		if (!headerSize)
+			headerSize = 1;
+		if (id < 2)
+			headerSize += id + 1;
+		if (reader.size() < headerSize)
+			return buffer.size();
+		if (id < 2)
+			id = (id ? reader.read16() : reader.read8()) + 64;
+
+		Channel& channel(_channels[id]);
+		bool isRelative(true);
+		if (headerSize >= 4) {
+			channel.time = reader.read24();
+			if (headerSize >= 8) {
+				channel.size = reader.read24();
+				channel.type = AMF::Type(reader.read8());
+				if (headerSize >= 12) {
+					isRelative = false;
+					reader.next(4); // stream id
+				}
+			}
+		}
+		if (channel.time >= 0xFFFFFF) {
+			if (reader.available() < 4)
+				return buffer.size();
+			channel.time = reader.read32();
+		}
+
+		UInt32 size(channel.size);
+		if (!channel.pBuffer) {
+			// new message
+			channel.absoluteTime = isRelative ? (channel.absoluteTime + channel.time) : channel.time;
+			channel.pBuffer.set();
+		} else if (channel.pBuffer->size() > size) {
+			fail("chunked message doesn't match its size");
+			return 0;
+		} else
+			size -= channel.pBuffer->size();
+		if (size > _chunkSize)
+			size = _chunkSize;
+		if (reader.available() < size)
+			return buffer.size();
+
+		channel.pBuffer->append(reader.current(), size);
+		size += reader.position();
+		buffer += size;
+		_unackBytes += size;
+		if (channel.pBuffer->size() < channel.size)
+			continue; // wait next chunk
+
+		process(channel.type, channel.absoluteTime, Packet(channel.pBuffer));
+		if (!_state)
+			return 0; // closed
+	}
+	return 0;
+}
+
+void BenchRTMP::process(AMF::Type type, UInt32 time, const Packet& packet) {
+	switch (type) {
+		case AMF::TYPE_CHUNKSIZE:
+			_chunkSize = BinaryReader(packet.data(), packet.size()).read32();
+			break;
+		case AMF::TYPE_WIN_ACKSIZE:
+			_winAckSize = BinaryReader(packet.data(), packet.size()).read32();
+			break;
+		case AMF::TYPE_RAW: {
+			// user control message, answer to ping request
+			BinaryReader reader(packet.data(), packet.size());
+			if (reader.read16() != 6)
+				break;
+			shared<Buffer> pBuffer(SET);
+			BinaryWriter(*pBuffer).write16(7).write32(reader.read32());
+			send(2, AMF::TYPE_RAW, 0, pBuffer);
+			break;
+		}
+		case AMF::TYPE_AUDIO: {
+			if (!_pReceiver || !packet)
+				break;
+			Media::Audio::Tag tag;
+			Media::Audio::Config config;
+			UInt8 size = FLVReader::ReadMediaHeader(packet.data(), packet.size(), tag, config);
+			tag.time = time;
+			_pReceiver->writeAudio(tag, Packet(packet, packet.data() + size, packet.size() - size));
+			break;
+		}
+		case AMF::TYPE_VIDEO: {
+			if (!_pReceiver || !packet)
+				break;
+			Media::Video::Tag tag;
+			UInt8 size = FLVReader::ReadMediaHeader(packet.data(), packet.size(), tag);
+			tag.time = time;
+			_pReceiver->writeVideo(tag, Packet(packet, packet.data() + size, packet.size() - size));
+			break;
+		}
+		case AMF::TYPE_INVOCATION: {
+			AMFReader reader(packet);
+			string name;
+			double transaction(0);
+			reader.readString(name);
+			reader.readNumber(transaction);
+			reader.readNull();
+			if (name == "_result") {
+				shared<Buffer> pBuffer(SET);
+				AMFWriter writer(*pBuffer, true);
+				if (transaction == 1) {
+					// connected => createStream
+					writer.writeString(EXPAND("createStream"));
+					writer.writeNumber(2);
+					writer.writeNull();
+					send(3, AMF::TYPE_INVOCATION, 0, pBuffer);
+				} else if (transaction == 2 && reader.readNumber(_streamId)) {
+					// stream created => publish or play
+					if (_pReceiver)
+						writer.writeString(EXPAND("play"));
+					else
+						writer.writeString(EXPAND("publish"));
+					writer.writeNumber(0);
+					writer.writeNull();
+					writer.writeString(_name.data(), _name.size());
+					if (!_pReceiver)
+						writer.writeString(EXPAND("live"));
+					send(8, AMF::TYPE_INVOCATION, _streamId, pBuffer);
+				}
+			} else if (name == "onStatus") {
+				Parameters status;
+				MapWriter<Parameters> writer(status);
+				reader.read(writer, 1);
+				const char* code = status.getString("code", "");
+				if (String::ICompare(status.getString("level", ""), "error") == 0)
+					return fail(code);
+				if (String::ICompare(code, "NetStream.Publish.Start") == 0 || String::ICompare(code, "NetStream.Play.Start") == 0)
+					_state = STATE_STREAMING;
+			} else if (name == "_error")
+				return fail(name);
+			break;
+		}
+		default:;
+	}
+	if (!_winAckSize || _unackBytes < (_winAckSize >> 1))
+		return;
+	_receivedBytes += _unackBytes;
+	_unackBytes = 0;
+	shared<Buffer> pBuffer(SET);
+	BinaryWriter(*pBuffer).write32(_receivedBytes);
+	send(2, AMF::TYPE_ACK, 0, pBuffer);
+}
+
+bool BenchRTMP::send(UInt8 channel, AMF::Type type, UInt32 time, UInt32 streamId, const Packet& header, const Packet& content) {
+	shared<Buffer> pBuffer(SET);
+	BinaryWriter writer(*pBuffer);
+	writer.write8(channel); // chunk type 0, full header
+	writer.write24(min(time, 0xFFFFFFu));
+	writer.write24(header.size() + content.size());
+	writer.write8(type);
+	writer.write8(streamId).write8(streamId >> 8).write8(streamId >> 16).write8(streamId >> 24); // little endian!
+	if (time >= 0xFFFFFF)
+		writer.write32(time);
+	writer.write(header.data(), header.size());
+	Exception ex;
+	if (TCPClient::send(ex, Packet(pBuffer)) && (!content || TCPClient::send(ex, content)))
+		return true;
+	fail(ex);
+	return false;
+}
+
+bool BenchRTMP::writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) {
+	if (_state != STATE_STREAMING)
+		return false;
+	UInt8 header[] = { FLVWriter::ToCodecs(tag), UInt8(tag.isConfig ? 0 : 1) }; // AAC packet type
+	return send(4, AMF::TYPE_AUDIO, tag.time, _streamId, Packet(header, sizeof(header)), packet);
+}
+
+bool BenchRTMP::writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable) {
+	if (_state != STATE_STREAMING)
+		return false;
+	UInt8 header[5];
+	BinaryWriter writer(header, sizeof(header));
+	writer.write8(FLVWriter::ToCodecs(tag)).write8(tag.frame == Media::Video::FRAME_CONFIG ? 0 : 1).write24(tag.compositionOffset); // AVC packet type + composition offset
+	if (tag.frame != Media::Video::FRAME_CONFIG)
+		return send(6, AMF::TYPE_VIDEO, tag.time, _streamId, Packet(header, sizeof(header)), packet);
+	// config => AVCDecoderConfigurationRecord
+	Packet sps, pps;
+	if (!AVC::ParseVideoConfig(packet, sps, pps))
+		return false;
+	shared<Buffer> pBuffer(SET);
+	AVC::WriteVideoConfig(BinaryWriter(*pBuffer).write(header, sizeof(header)), sps, pps);
+	return send(6, AMF::TYPE_VIDEO, tag.time, _streamId, Packet(pBuffer));
+}
+
+} // namespace Mona
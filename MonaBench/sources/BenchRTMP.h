@@ -0,0 +1,81 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/TCPClient.h"
+#include "Mona/AMF.h"
+#include "Bench.h"
+
+namespace Mona {
+
+/*!
+Minimal RTMP client: simple handshake, connect, createStream, then publish or play (no chunking on sending, chunk size is set to maximum) */
+struct BenchRTMP : TCPClient, Bench::Client, Media::Target, virtual Object {
+	BenchRTMP(IOSocket& io, const SocketAddress& address, const std::string& name, Bench::Stats& stats, bool publisher);
+	~BenchRTMP();
+
+	void			pulse();
+	Media::Target&	target() { return _pReceiver ? Media::Target::Null() : self; }
+
+	bool beginMedia(const std::string& name) { return true; }
+	bool writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable);
+	bool writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable);
+
+private:
+	enum State {
+		STATE_CLOSED = 0,
+		STATE_HANDSHAKE,
+		STATE_CONNECTING,
+		STATE_STREAMING
+	};
+	struct Channel {
+		Channel() : time(0), absoluteTime(0), size(0), type(AMF::TYPE_EMPTY) {}
+		UInt32			time;
+		UInt32			absoluteTime;
+		UInt32			size;
+		AMF::Type		type;
+		shared<Buffer>	pBuffer;
+	};
+
+	UInt32	onChunks(Packet& buffer);
+	void	process(AMF::Type type, UInt32 time, const Packet& packet);
+	bool	send(UInt8 channel, AMF::Type type, UInt32 time, UInt32 streamId, const Packet& header, const Packet& content = Packet::Null());
+	bool	send(UInt8 channel, AMF::Type type, UInt32 streamId, shared<Buffer>& pBuffer) { return send(channel, type, 0, streamId, Packet(pBuffer)); }
+	template<typename ...Args>
+	void	fail(Args&&... args) {
+		DEBUG("RTMP ", _name, ", ", std::forward<Args>(args)...);
+		++stats.failures;
+		_state = STATE_CLOSED; // before disconnect to not count twice the failure
+		disconnect();
+	}
+
+	const SocketAddress			_address;
+	const std::string			_name;
+	unique<Bench::Receiver>		_pReceiver;
+	State						_state;
+	UInt32						_streamId;
+	std::map<UInt32, Channel>	_channels;
+	UInt32						_chunkSize;
+	UInt32						_winAckSize;
+	UInt32						_unackBytes;
+	UInt32						_receivedBytes;
+};
+
+} // namespace Mona
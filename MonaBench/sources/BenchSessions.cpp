@@ -0,0 +1,170 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "BenchSessions.h"
+#include "Mona/Entity.h"
+#include "Mona/SocketAddress.h"
+#include "Mona/HashMap.h"
+#include "Mona/SlotMap.h"
+#include "Mona/Metrics.h"
+#include <iostream>
+#include <deque>
+
+using namespace std;
+
+namespace Mona {
+
+struct FakeSession {
+	FakeSession(UInt32 index) : id(0), peerId() {
+		in_addr host;
+		host.s_addr = index;
+		address.set(IPAddress(host), UInt16(Util::Random<UInt16>() | 1024));
+		Util::Random(peerId, Entity::SIZE);
+	}
+	UInt32			id;
+	SocketAddress	address;
+	UInt8			peerId[Entity::SIZE];
+};
+
+struct MapIndexes {
+	static const char* Name() { return "std::map"; }
+
+	void create(FakeSession& session) {
+		// id computation of the previous Sessions implementation
+		if (!_freeIds.empty()) {
+			session.id = _freeIds.front() - 1;
+			_freeIds.pop_front();
+		} else if (!_sessions.empty())
+			session.id = _sessions.rbegin()->first;
+		while (!_sessions.emplace(++session.id, &session).second);
+		_sessionsByPeerId.emplace(session.peerId, &session);
+		_byProtocol[SocketAddress::Wildcard()].emplace(session.address, &session);
+	}
+	FakeSession* find(UInt32 id) { const auto& it = _sessions.find(id); return it == _sessions.end() ? NULL : it->second; }
+	FakeSession* findByAddress(const SocketAddress& address) {
+		map<SocketAddress, FakeSession*>& sessionsByAddress = _byProtocol[SocketAddress::Wildcard()];
+		const auto& it = sessionsByAddress.find(address);
+		return it == sessionsByAddress.end() ? NULL : it->second;
+	}
+	FakeSession* findByPeer(const UInt8* peerId) { const auto& it = _sessionsByPeerId.find(peerId); return it == _sessionsByPeerId.end() ? NULL : it->second; }
+	void remove(FakeSession& session) {
+		_sessionsByPeerId.erase(session.peerId);
+		_byProtocol[SocketAddress::Wildcard()].erase(session.address);
+		_freeIds.emplace_back(session.id);
+		_sessions.erase(session.id);
+	}
+private:
+	map<UInt32, FakeSession*>										_sessions;
+	deque<UInt32>													_freeIds;
+	map<const UInt8*, FakeSession*, Entity::Comparator>				_sessionsByPeerId;
+	map<SocketAddress, map<SocketAddress, FakeSession*>>			_byProtocol;
+};
+
+struct HashIndexes {
+	static const char* Name() { return "hash"; }
+
+	void create(FakeSession& session) {
+		session.id = _sessions.add(&session);
+		_sessionsByPeerId.emplace(session.peerId, &session);
+		_byProtocol[SocketAddress::Wildcard()].emplace(session.address, &session);
+	}
+	FakeSession* find(UInt32 id) { FakeSession** ppSession = _sessions.find(id); return ppSession ? *ppSession : NULL; }
+	FakeSession* findByAddress(const SocketAddress& address) { FakeSession** ppSession = _byProtocol[SocketAddress::Wildcard()].find(address); return ppSession ? *ppSession : NULL; }
+	FakeSession* findByPeer(const UInt8* peerId) { FakeSession** ppSession = _sessionsByPeerId.find(peerId); return ppSession ? *ppSession : NULL; }
+	void remove(FakeSession& session) {
+		_sessionsByPeerId.erase(session.peerId);
+		_byProtocol[SocketAddress::Wildcard()].erase(session.address);
+		_sessions.remove(session.id);
+	}
+private:
+	SlotMap<FakeSession*>													_sessions;
+	HashMap<const UInt8*, FakeSession*, Entity::Hasher, Entity::Equal>		_sessionsByPeerId;
+	map<SocketAddress, HashMap<SocketAddress, FakeSession*, SocketAddress::Hasher>> _byProtocol;
+};
+
+static string Ns(Int64 us, UInt32 count) { return String(String::Format<double>("%.0f", us * 1000.0 / count)); }
+
+template<typename IndexesType>
+static void Bench(vector<unique<FakeSession>>& sessions, vector<UInt32>& order) {
+	IndexesType indexes;
+	UInt32 count = UInt32(sessions.size());
+	Int64 start = Metrics::Clock();
+	for (unique<FakeSession>& pSession : sessions)
+		indexes.create(*pSession);
+	Int64 create = Metrics::Clock() - start;
+
+	UInt32 errors(0);
+	start = Metrics::Clock();
+	for (UInt32 i : order) {
+		if (indexes.find(sessions[i]->id) != sessions[i].get())
+			++errors;
+	}
+	Int64 byId = Metrics::Clock() - start;
+	start = Metrics::Clock();
+	for (UInt32 i : order) {
+		if (indexes.findByAddress(sessions[i]->address) != sessions[i].get())
+			++errors;
+	}
+	Int64 byAddress = Metrics::Clock() - start;
+	start = Metrics::Clock();
+	for (UInt32 i : order) {
+		if (indexes.findByPeer(sessions[i]->peerId) != sessions[i].get())
+			++errors;
+	}
+	Int64 byPeer = Metrics::Clock() - start;
+
+	// churn: remove and create again a half, in random order
+	start = Metrics::Clock();
+	for (UInt32 i = 0; i < count / 2; ++i)
+		indexes.remove(*sessions[order[i]]);
+	for (UInt32 i = 0; i < count / 2; ++i)
+		indexes.create(*sessions[order[i]]);
+	Int64 churn = Metrics::Clock() - start;
+
+	start = Metrics::Clock();
+	for (UInt32 i : order)
+		indexes.remove(*sessions[i]);
+	Int64 remove = Metrics::Clock() - start;
+
+	cout << "  " << IndexesType::Name() << string(10 - strlen(IndexesType::Name()), ' ')
+		<< "create " << Ns(create, count) << "ns, find by id " << Ns(byId, count) << "ns, by address " << Ns(byAddress, count) << "ns, by peer " << Ns(byPeer, count)
+		<< "ns, churn " << Ns(churn, count) << "ns, remove " << Ns(remove, count) << "ns";
+	if (errors)
+		cout << ", " << errors << " ERRORS";
+	cout << endl;
+}
+
+void BenchSessions::Run(const vector<UInt32>& counts) {
+	cout << "Sessions indexes, time by operation:" << endl;
+	for (UInt32 count : counts) {
+		vector<unique<FakeSession>> sessions;
+		sessions.reserve(count);
+		vector<UInt32> order(count);
+		for (UInt32 i = 0; i < count; ++i) {
+			sessions.emplace_back(SET, Util::Random<UInt32>());
+			order[i] = i;
+		}
+		for (UInt32 i = count; i > 1; --i)
+			swap(order[i - 1], order[Util::Random<UInt32>() % i]);
+		cout << count << " sessions" << endl;
+		Bench<MapIndexes>(sessions, order);
+		Bench<HashIndexes>(sessions, order);
+	}
+}
+
+} // namespace Mona
@@ -0,0 +1,59 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "BenchStream.h"
+
+using namespace std;
+
+namespace Mona {
+
+BenchStream::BenchStream(Exception& ex, const string& name, const string& description, Bench::Stats& stats, const Timer& timer, IOFile& ioFile, IOSocket& ioSocket, bool publisher) :
+	Bench::Client(stats), _name(name), _pTarget(NULL) {
+	if (!publisher)
+		_pReceiver.set(stats);
+	_pStream = MediaStream::New(ex, _pReceiver ? *_pReceiver : Media::Source::Null(), description, timer, ioFile, ioSocket);
+	if (!_pStream)
+		return;
+	if (publisher && !(_pTarget = dynamic_cast<Media::Target*>(_pStream.get()))) {
+		ex.set<Ex::Unsupported>(description, " is not a stream target");
+		_pStream.reset();
+		return;
+	}
+	_pStream->onStop = [this]() {
+		if (_pStream->ex)
+			++this->stats.failures;
+	};
+}
+
+BenchStream::~BenchStream() {
+	if (!_pStream)
+		return;
+	_pStream->onStop = nullptr;
+	_pStream->stop();
+}
+
+void BenchStream::pulse() {
+	if (!_pStream)
+		return;
+	if (!_pTarget)
+		_pStream->start();
+	else if (!_pStream->state())
+		_pTarget->beginMedia(_name); // start or restart the publication
+}
+
+} // namespace Mona
@@ -0,0 +1,45 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/MediaStream.h"
+#include "Bench.h"
+
+namespace Mona {
+
+/*!
+Client built on a MediaStream description (HTTP, SRT or UDP), publisher if no receiver is given */
+struct BenchStream : Bench::Client, virtual Object {
+	NULLABLE(!_pStream)
+
+	BenchStream(Exception& ex, const std::string& name, const std::string& description, Bench::Stats& stats, const Timer& timer, IOFile& ioFile, IOSocket& ioSocket, bool publisher);
+	~BenchStream();
+
+	void			pulse();
+	Media::Target&	target() { return _pTarget ? *_pTarget : Media::Target::Null(); }
+
+private:
+	const std::string		_name;
+	unique<Bench::Receiver>	_pReceiver;
+	unique<MediaStream>		_pStream;
+	Media::Target*			_pTarget;
+};
+
+} // namespace Mona
@@ -0,0 +1,87 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "BenchWS.h"
+
+using namespace std;
+
+namespace Mona {
+
+BenchWS::BenchWS(IOSocket& io, const SocketAddress& address, const string& name, Bench::Stats& stats, bool publisher) : Bench::Client(stats),
+	_io(io), _address(address), _name(name), _closed(false), _opened(false) {
+	if (!publisher)
+		_pReceiver.set(stats);
+}
+
+void BenchWS::pulse() {
+	if (_pClient && !_closed)
+		return; // connecting or connected
+	// WSClient disconnected can't be reused, create a new one
+	_pClient.set(_io);
+	_closed = false;
+	_pClient->onError = [this](const Exception& ex) { DEBUG("WS ", _name, ", ", ex); };
+	_pClient->onDisconnection = [this](const SocketAddress& address) {
+		if (_closed)
+			return;
+		_closed = true;
+		++stats.failures;
+	};
+	_pClient->onMessage = [this](DataReader& message) {
+		if (!_pReceiver || !_pClient->binaryData)
+			return; // JSON command
+		UInt8 track;
+		Media::Data::Type type;
+		BinaryReader reader(message.data(), message.size());
+		switch (Media::Unpack(reader, _audio, _video, type, track)) {
+			case Media::TYPE_AUDIO:
+				return _pReceiver->writeAudio(_audio, Packet(message, reader.current(), reader.available()), track);
+			case Media::TYPE_VIDEO:
+				return _pReceiver->writeVideo(_video, Packet(message, reader.current(), reader.available()), track);
+			case Media::TYPE_DATA:
+				return _pReceiver->writeData(type, Packet(message, reader.current(), reader.available()), track);
+			default:;
+		}
+	};
+
+	_pClient->onOpen = [this]() {
+		_opened = true;
+		shared<Buffer> pCommand(SET);
+		String::Append(*pCommand, _pReceiver ? "[\"@subscribe\",\"" : "[\"@publish\",\"", _name, "\"]");
+		Exception ex;
+		if (!_pClient->send(ex, Packet(pCommand), WS::TYPE_TEXT))
+			DEBUG("WS ", _name, ", ", ex);
+	};
+
+	_opened = false;
+	Exception ex;
+	if (_pClient->connect(ex, _address, "/"))
+		return;
+	DEBUG("WS ", _name, ", ", ex);
+	_closed = true;
+	++stats.failures;
+}
+
+bool BenchWS::writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) {
+	return write(tag, packet);
+}
+
+bool BenchWS::writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable) {
+	return write(tag, packet);
+}
+
+} // namespace Mona
@@ -0,0 +1,66 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/WS/WSClient.h"
+#include "Bench.h"
+
+namespace Mona {
+
+/*!
+WebSocket client publishing or subscribing with Mona commands (@publish, @subscribe) and binary media packing,
+a new WSClient is created on every reconnection */
+struct BenchWS : Bench::Client, Media::Target, virtual Object {
+	BenchWS(IOSocket& io, const SocketAddress& address, const std::string& name, Bench::Stats& stats, bool publisher);
+
+	void			pulse();
+	Media::Target&	target() { return _pReceiver ? Media::Target::Null() : self; }
+
+	bool beginMedia(const std::string& name) { return true; }
+	bool writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable);
+	bool writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable);
+
+private:
+	template<typename TagType>
+	bool write(const TagType& tag, const Packet& packet) {
+		if (!_opened || _closed)
+			return false;
+		shared<Buffer> pBuffer(SET);
+		BinaryWriter writer(*pBuffer);
+		Media::Pack(writer, tag);
+		Exception ex;
+		if (_pClient->send(ex, Packet(pBuffer), WS::TYPE_BINARY) && _pClient->send(ex, packet, WS::TYPE_BINARY))
+			return true;
+		DEBUG("WS ", _name, ", ", ex);
+		return false;
+	}
+
+	IOSocket&				_io;
+	const SocketAddress		_address;
+	const std::string		_name;
+	unique<Bench::Receiver>	_pReceiver;
+	unique<WSClient>		_pClient;
+	bool					_closed;
+	bool					_opened; // handshake done
+	Media::Audio::Tag		_audio;
+	Media::Video::Tag		_video;
+};
+
+} // namespace Mona
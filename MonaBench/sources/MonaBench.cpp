@@ -0,0 +1,284 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "MonaBench.h"
+#include "Mona/File.h"
+#include "Mona/FileSystem.h"
+#include "BenchRTMP.h"
+#include "BenchWS.h"
+#include "BenchStream.h"
+#include <iostream>
+#if !defined(_WIN32)
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace Mona {
+
+MonaBench::MonaBench(const Parameters& arguments, TerminateSignal& terminateSignal) : Thread("MonaBench"), _arguments(arguments), _terminateSignal(terminateSignal),
+	_host(arguments.getString("arguments.host", "127.0.0.1")), _edge(arguments.getString("arguments.edge", _host.c_str())), _stream(arguments.getString("arguments.stream", "bench")),
+	_publishers(arguments.getNumber<UInt32, 1>("arguments.publishers")), _subscribers(arguments.getNumber<UInt32, 10>("arguments.subscribers")),
+	_duration(arguments.getNumber<UInt32, 30>("arguments.duration")), _ramp(arguments.getNumber<UInt32, 0>("arguments.ramp")), _pid(arguments.getNumber<UInt32, 0>("arguments.pid")),
+	_handler(wakeUp), _ioSocket(_handler, _threadPool), _ioFile(_handler, _threadPool), _publishing(0) {
+	String::Split(arguments.getString("arguments.publish", "rtmp"), ",", _publish, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+	String::Split(arguments.getString("arguments.subscribe", "rtmp"), ",", _subscribe, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+	if (!_duration)
+		_duration = 1;
+}
+
+MonaBench::~MonaBench() {
+	stop();
+}
+
+Bench::Stats& MonaBench::stats(const string& protocol) {
+	unique<Bench::Stats>& pStats = _stats[protocol];
+	if (!pStats)
+		pStats.set(protocol);
+	return *pStats;
+}
+
+unique<Bench::Client> MonaBench::newClient(Exception& ex, const string& protocol, const string& name, Bench::Stats& stats, bool publisher, UInt32 index) {
+	unique<Bench::Client> pClient;
+	SocketAddress address;
+	const string& host(publisher ? _host : _edge);
+	if (String::ICompare(protocol, "rtmp") == 0) {
+		if (address.set(ex, host, _arguments.getNumber<UInt16, 1935>("arguments.rtmpPort")))
+			pClient.set<BenchRTMP>(_ioSocket, address, name, stats, publisher);
+		return pClient;
+	}
+	if (String::ICompare(protocol, "ws") == 0) {
+		if (address.set(ex, host, _arguments.getNumber<UInt16, 80>("arguments.httpPort")))
+			pClient.set<BenchWS>(_ioSocket, address, name, stats, publisher);
+		return pClient;
+	}
+	string description;
+	if (String::ICompare(protocol, "flv") == 0 || String::ICompare(protocol, "mp4") == 0 || String::ICompare(protocol, "ts") == 0)
+		String::Assign(description, "http://", host, ':', _arguments.getNumber<UInt16, 80>("arguments.httpPort"), '/', name, '.', String::Lower(string(protocol)));
+	else if (String::ICompare(protocol, "srt") == 0)
+		String::Assign(description, "srt://", host, ':', _arguments.getNumber<UInt16, 9710>("arguments.srtPort"), " ts?streamid=%23!::r=", name, ",m=", publisher ? "publish" : "request");
+	else if (String::ICompare(protocol, "udp") == 0) {
+		// UDP is ingest only, server has to declare its UDP streams in its configuration (one port by publisher)
+		if (!publisher) {
+			ex.set<Ex::Unsupported>("UDP subscription");
+			return pClient;
+		}
+		String::Assign(description, "udp://", host, ':', _arguments.getNumber<UInt16, 1234>("arguments.udpPort") + index, " ts");
+	} else {
+		ex.set<Ex::Unsupported>("Protocol ", protocol);
+		return pClient;
+	}
+	unique<BenchStream> pStream(SET, ex, name, description, stats, _timer, _ioFile, _ioSocket, publisher);
+	if (*pStream)
+		pClient = move(pStream);
+	return pClient;
+}
+
+bool MonaBench::run(Exception&, const volatile bool& requestStop) {
+	Synthetic synthetic(_arguments.getNumber<UInt16, 25>("arguments.fps"), _arguments.getNumber<UInt32, 1000>("arguments.bitrate") * 1000);
+	deque<unique<Media::Base>> medias;
+	Int64 start = Time::Now();
+	double cpu = serverCPU();
+
+	for (const string& protocol : _publish) {
+		Bench::Stats& stats = this->stats(protocol);
+		for (UInt32 i = 0; i < _publishers; ++i) {
+			Exception ex;
+			unique<Bench::Client> pClient = newClient(ex, protocol, String(_stream, i), stats, true, i);
+			if (!pClient) {
+				ERROR("Publisher ", protocol, ", ", ex);
+				break;
+			}
+			++stats.publishers;
+			pClient->pulse();
+			_clients.emplace_back(move(pClient));
+		}
+	}
+	_publishing = _clients.size();
+	NOTE(_publishing, " publishers, ", _subscribers, " subscribers by protocol during ", _duration, " seconds");
+
+	Timer::OnTimer onMedia([&](UInt32) {
+		UInt32 timeout = synthetic.generate(medias);
+		for (const unique<Media::Base>& pMedia : medias) {
+			for (UInt32 i = 0; i < _publishing; ++i) {
+				Bench::Client& client = *_clients[i];
+				bool written;
+				if (pMedia->type == Media::TYPE_AUDIO)
+					written = client.target().writeAudio(pMedia->track, ((const Media::Audio&)*pMedia).tag, *pMedia, true);
+				else
+					written = client.target().writeVideo(pMedia->track, ((const Media::Video&)*pMedia).tag, *pMedia, true);
+				if (!written)
+					continue;
+				client.target().flush();
+				if (pMedia->type == Media::TYPE_VIDEO && !pMedia->isConfig())
+					++client.stats.framesSent;
+				client.stats.bytesSent += pMedia->size();
+			}
+		}
+		medias.clear();
+		return timeout;
+	});
+	_timer.set(onMedia, 1);
+
+	// subscribers starts after one second to get a publication already alive, ramp-up then on _ramp seconds
+	UInt32 subscribing(0);
+	UInt32 subscribers(_subscribers * _subscribe.size());
+	Timer::OnTimer onSubscribe([&](UInt32) {
+		UInt32 target = subscribers;
+		Int64 elapsed = Time::Now() - start - 1000;
+		if (_ramp && elapsed < Int64(_ramp) * 1000)
+			target = UInt32(UInt64(subscribers) * elapsed / (_ramp * 1000));
+		while (subscribing < target) {
+			const string& protocol(_subscribe[subscribing / _subscribers]);
+			UInt32 index = subscribing++ % _subscribers;
+			Exception ex;
+			Bench::Stats& stats = this->stats(protocol);
+			unique<Bench::Client> pClient = newClient(ex, protocol, _publishers ? String(_stream, index % _publishers) : _stream, stats, false, index);
+			if (!pClient) {
+				ERROR("Subscriber ", protocol, ", ", ex);
+				subscribing += _subscribers - index - 1; // skip this protocol
+				continue;
+			}
+			++stats.subscribers;
+			pClient->pulse();
+			_clients.emplace_back(move(pClient));
+		}
+		return subscribing < subscribers ? 100 : 0;
+	});
+	_timer.set(onSubscribe, 1000);
+
+	// reconnect every second and log progress every 5 seconds
+	Timer::OnTimer onPulse([&](UInt32 count) {
+		for (const unique<Bench::Client>& pClient : _clients)
+			pClient->pulse();
+		if (!(count % 5)) {
+			for (auto& it : _stats)
+				INFO(it.first, ", ", it.second->joined, "/", it.second->subscribers, " subscribers joined, ", it.second->framesReceived, " frames received, ", it.second->failures, " failures");
+		}
+		if ((Time::Now() - start) < Int64(_duration) * 1000)
+			return 1000;
+		_terminateSignal.set(); // end of the bench!
+		return 0;
+	});
+	_timer.set(onPulse, 1000);
+
+	while (!requestStop) {
+		if (wakeUp.wait(_timer.raise()))
+			_handler.flush();
+	}
+	_timer.set(onMedia, 0);
+	_timer.set(onSubscribe, 0);
+	_timer.set(onPulse, 0);
+
+	double duration = (Time::Now() - start) / 1000.0;
+	if (cpu >= 0)
+		cpu = (serverCPU() - cpu) * 100 / duration;
+	report(duration, cpu);
+
+	// release clients before sockets and threads
+	_clients.clear();
+	_threadPool.join();
+	_ioFile.join();
+	_handler.flush(true);
+	return true;
+}
+
+static string Ms(UInt64 us) {
+	return String(String::Format<double>("%.1f", us / 1000.0));
+}
+
+void MonaBench::report(double duration, double cpu) {
+	shared<Buffer> pJSON(SET);
+	String::Append(*pJSON, "{\"duration\":", String::Format<double>("%.1f", duration), ",\"cpu\":", String::Format<double>("%.1f", cpu), ",\"protocols\":{");
+	string report;
+	String::Append(report, "\n", String::Format<double>("%.1f", duration), " seconds");
+	if (cpu >= 0)
+		String::Append(report, ", server CPU ", String::Format<double>("%.1f", cpu), '%');
+	for (auto& it : _stats) {
+		const Bench::Stats& stats = *it.second;
+		Metrics::Histogram::Snapshot join, latency;
+		stats.join.snapshot(join);
+		stats.latency.snapshot(latency);
+		String::Append(report, "\n", stats.protocol, ": ", stats.publishers, " publishers, ", stats.subscribers, " subscribers (", stats.joined, " joined, ", stats.failures, " failures)\n",
+			"  sent ", String::Format<double>("%.1f", stats.framesSent / duration), " fps ", String::Format<double>("%.2f", stats.bytesSent * 8 / duration / 1000000), " Mbps",
+			", received ", String::Format<double>("%.1f", stats.framesReceived / duration), " fps ", String::Format<double>("%.2f", stats.bytesReceived * 8 / duration / 1000000), " Mbps, ", stats.lost, " lost\n",
+			"  join p50=", Ms(join.percentile(0.5)), "ms p99=", Ms(join.percentile(0.99)), "ms",
+			", latency p50=", Ms(latency.percentile(0.5)), "ms p90=", Ms(latency.percentile(0.9)), "ms p99=", Ms(latency.percentile(0.99)), "ms max=", Ms(latency.max), "ms");
+		if (pJSON->data()[pJSON->size() - 1] != '{')
+			String::Append(*pJSON, ',');
+		String::Append(*pJSON, '"', stats.protocol, "\":{\"publishers\":", stats.publishers, ",\"subscribers\":", stats.subscribers, ",\"joined\":", stats.joined, ",\"failures\":", stats.failures,
+			",\"framesSent\":", stats.framesSent, ",\"bytesSent\":", stats.bytesSent, ",\"framesReceived\":", stats.framesReceived, ",\"bytesReceived\":", stats.bytesReceived, ",\"lost\":", stats.lost,
+			",\"join\":{\"p50\":", join.percentile(0.5), ",\"p99\":", join.percentile(0.99), "},\"latency\":{\"p50\":", latency.percentile(0.5), ",\"p90\":", latency.percentile(0.9),
+			",\"p99\":", latency.percentile(0.99), ",\"max\":", latency.max, "}}");
+	}
+	String::Append(*pJSON, "}}");
+	cout << report << endl;
+
+	const char* json = _arguments.getString("arguments.json");
+	if (!json)
+		return;
+	Exception ex;
+	File file(json, File::MODE_WRITE);
+	if (!file.write(ex, pJSON->data(), pJSON->size()))
+		ERROR("Report ", json, ", ", ex);
+}
+
+double MonaBench::serverCPU() {
+#if defined(_WIN32)
+	return -1;
+#else
+	UInt32 pid = _pid;
+	if (!pid) {
+		// search a MonaServer or MonaTiny process
+		Exception ex;
+		FileSystem::ListFiles(ex, "/proc/", [&pid](const string& path, UInt16 level) {
+			string name;
+			if (!String::ToNumber(FileSystem::GetName(path, name), pid))
+				return true;
+			char comm[16];
+			FILE* pFile = fopen(String(path, "/comm").c_str(), "r");
+			if (pFile) {
+				if (fgets(comm, sizeof(comm), pFile) && (strncmp(comm, "MonaServer", 10) == 0 || strncmp(comm, "MonaTiny", 8) == 0)) {
+					fclose(pFile);
+					return false; // found!
+				}
+				fclose(pFile);
+			}
+			pid = 0;
+			return true;
+		});
+		if (!(_pid = pid))
+			return -1;
+	}
+	char stat[512];
+	FILE* pFile = fopen(String("/proc/", pid, "/stat").c_str(), "r");
+	if (!pFile)
+		return -1;
+	size_t size = fread(stat, 1, sizeof(stat) - 1, pFile);
+	fclose(pFile);
+	stat[size] = 0;
+	// fields after the process name (which can contain spaces), utime and stime are the 14th and 15th
+	const char* cur = strrchr(stat, ')');
+	unsigned long utime, stime;
+	if (!cur || sscanf(cur + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2)
+		return -1;
+	return double(utime + stime) / sysconf(_SC_CLK_TCK);
+#endif
+}
+
+} // namespace Mona
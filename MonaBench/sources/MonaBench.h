@@ -0,0 +1,83 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Thread.h"
+#include "Mona/ThreadPool.h"
+#include "Mona/Handler.h"
+#include "Mona/IOSocket.h"
+#include "Mona/IOFile.h"
+#include "Mona/Timer.h"
+#include "Mona/TerminateSignal.h"
+#include "Mona/Parameters.h"
+#include "Bench.h"
+
+namespace Mona {
+
+/*!
+Load generator: simulated publishers and subscribers on a running server, one thread with its own sockets and files runtime.
+Publishers send a synthetic H264/AAC stream, subscribers measure join time and end-to-end latency,
+a report by protocol is printed at the end of the run (then terminateSignal is set) */
+struct MonaBench : private Thread, virtual Object {
+	MonaBench(const Parameters& arguments, TerminateSignal& terminateSignal);
+	~MonaBench();
+
+	void start() { Thread::start(); }
+	void stop() { Thread::stop(); }
+
+private:
+	bool run(Exception& ex, const volatile bool& requestStop);
+
+	/*!
+	Create a client of protocol (rtmp, ws, flv, mp4, ts, srt, udp) on the stream name */
+	unique<Bench::Client> newClient(Exception& ex, const std::string& protocol, const std::string& name, Bench::Stats& stats, bool publisher, UInt32 index);
+	Bench::Stats& stats(const std::string& protocol);
+
+	void report(double duration, double cpu);
+	/*!
+	Server CPU time consumed in seconds, or -1 if unavailable */
+	double serverCPU();
+
+	const Parameters&		_arguments;
+	TerminateSignal&		_terminateSignal;
+
+	std::string				_host;
+	std::string				_edge; // host of subscribers
+	std::string				_stream;
+	std::vector<std::string> _publish;
+	std::vector<std::string> _subscribe;
+	UInt32					_publishers;
+	UInt32					_subscribers;
+	UInt32					_duration; // in seconds
+	UInt32					_ramp; // in seconds
+	UInt32					_pid;
+
+	ThreadPool				_threadPool; // keep in first (must be build before ioSocket and ioFile)
+	Handler					_handler;
+	IOSocket				_ioSocket;
+	IOFile					_ioFile;
+	Timer					_timer;
+
+	std::map<std::string, unique<Bench::Stats>>	_stats;
+	std::vector<unique<Bench::Client>>			_clients;
+	UInt32										_publishing; // publishers count in _clients (in first)
+};
+
+} // namespace Mona
@@ -0,0 +1,122 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Synthetic.h"
+#include "Mona/Metrics.h"
+#include "Mona/BinaryWriter.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace Mona {
+
+// H264 baseline 640x480 and AAC-LC 44100Hz stereo
+static const UInt8 SPS[] = { 0x67, 0x42, 0xC0, 0x1E, 0xDA, 0x02, 0x80, 0xF6, 0x40 };
+static const UInt8 PPS[] = { 0x68, 0xCE, 0x3C, 0x80 };
+static const UInt8 AAC_CONFIG[] = { 0x12, 0x10 };
+static const char  MARKER[] = { 'M', 'B', 'C', 'H' };
+static const char  HEXA[] = "0123456789ABCDEF";
+
+enum {
+	AAC_RATE = 44100,
+	AAC_SAMPLES = 1024, // by frame
+	CLOCK_SIZE = sizeof(MARKER) + 16 // marker + 64 bits in hexadecimal
+};
+
+Synthetic::Synthetic(UInt16 fps, UInt32 videoBitrate, UInt32 audioBitrate, UInt16 keyInterval) :
+	fps(fps ? fps : 25), keyInterval(keyInterval ? keyInterval : (fps ? fps : 25)), _video(Media::Video::CODEC_H264), _audio(Media::Audio::CODEC_AAC),
+	_start(0), _videoFrames(0), _audioFrames(0) {
+
+	_videoSize = max(videoBitrate / 8 / this->fps, UInt32(1 + CLOCK_SIZE)); // NAL header + clock at less
+
+	shared<Buffer> pBuffer(SET);
+	BinaryWriter(*pBuffer).write32(sizeof(SPS)).write(SPS, sizeof(SPS)).write32(sizeof(PPS)).write(PPS, sizeof(PPS));
+	_videoConfig.set(pBuffer);
+
+	_audio.rate = AAC_RATE;
+	_audio.channels = 2;
+	if (!audioBitrate)
+		return;
+	_audioConfig.set(AAC_CONFIG, sizeof(AAC_CONFIG));
+	// Frame content is useless (no decoding), just the size matters, and avoid zero bytes
+	pBuffer.set(max(UInt32(UInt64(audioBitrate) * AAC_SAMPLES / AAC_RATE / 8), 1u));
+	memset(pBuffer->data(), 0x5A, pBuffer->size());
+	_audioFrame.set(pBuffer);
+}
+
+UInt32 Synthetic::generate(deque<unique<Media::Base>>& medias) {
+	Int64 now = Metrics::Clock();
+	if (!_start)
+		_start = now;
+	UInt64 time = UInt64(now - _start) / 1000;
+
+	// AUDIO, every due frames to keep the sample rate
+	if (_audioFrame) {
+		UInt64 frames = time * AAC_RATE / AAC_SAMPLES / 1000 + 1;
+		while (_audioFrames < frames) {
+			_audio.time = UInt32(_audioFrames * AAC_SAMPLES * 1000 / AAC_RATE);
+			if (!(_audioFrames++ % (AAC_RATE / AAC_SAMPLES))) { // config every second
+				_audio.isConfig = true;
+				medias.emplace_back(Media::New(_audio, _audioConfig));
+				_audio.isConfig = false;
+			}
+			medias.emplace_back(Media::New(_audio, _audioFrame));
+		}
+	}
+
+	// VIDEO, just the last due frame (a late encoder drops frames)
+	UInt64 frames = time * fps / 1000 + 1;
+	if (_videoFrames < frames) {
+		_video.time = UInt32((frames - 1) * 1000 / fps);
+		bool isKey = !_videoFrames || ((frames - 1) / keyInterval) != ((_videoFrames - 1) / keyInterval);
+		_videoFrames = frames;
+		if (isKey) {
+			_video.frame = Media::Video::FRAME_CONFIG;
+			medias.emplace_back(Media::New(_video, _videoConfig));
+		}
+		_video.frame = isKey ? Media::Video::FRAME_KEY : Media::Video::FRAME_INTER;
+
+		shared<Buffer> pBuffer(SET, 4 + _videoSize);
+		BinaryWriter writer(pBuffer->data(), pBuffer->size());
+		writer.write32(_videoSize).write8(isKey ? 0x65 : 0x41).write(MARKER, sizeof(MARKER));
+		for (Int8 shift = 60; shift >= 0; shift -= 4)
+			writer.write8(HEXA[(now >> shift) & 0x0F]);
+		memset(pBuffer->data() + writer.size(), 0x5A, pBuffer->size() - writer.size());
+		medias.emplace_back(Media::New(_video, Packet(pBuffer)));
+	}
+	return UInt32((frames * 1000 + fps - 1) / fps - time);
+}
+
+Int64 Synthetic::ReadClock(const Packet& packet) {
+	// marker is just after the NAL header, search it in the first bytes (an AUD NAL can be added before by few formats)
+	const UInt8* end = packet.data() + min(packet.size(), 128u);
+	const UInt8* cur = search(packet.data(), end, MARKER, MARKER + sizeof(MARKER));
+	if ((end - cur) < CLOCK_SIZE)
+		return -1;
+	cur += sizeof(MARKER);
+	Int64 clock = 0;
+	for (UInt8 i = 0; i < 16; ++i) {
+		const char* hexa = strchr(HEXA, *cur++);
+		if (!hexa || !*hexa)
+			return -1;
+		clock = (clock << 4) | (hexa - HEXA);
+	}
+	return clock;
+}
+
+} // namespace Mona
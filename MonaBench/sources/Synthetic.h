@@ -0,0 +1,60 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Media.h"
+#include <deque>
+
+namespace Mona {
+
+/*!
+Synthetic H264/AAC source to feed simulated publishers.
+Every video NAL carries the monotonic clock of its generation (Metrics::Clock in hexadecimal, without zero byte to survive to any Annex B conversion)
+to measure end-to-end latency on reception. Medias are built one time and shared by all the publishers */
+struct Synthetic : virtual Object {
+	/*!
+	keyInterval is the GOP size in frames, fps by default (1 second) */
+	Synthetic(UInt16 fps = 25, UInt32 videoBitrate = 1000000, UInt32 audioBitrate = 128000, UInt16 keyInterval = 0);
+
+	const UInt16 fps;
+	const UInt16 keyInterval;
+
+	/*!
+	Add the medias expected at this time (configs before every key frame), returns the timeout in ms before the next video frame */
+	UInt32 generate(std::deque<unique<Media::Base>>& medias);
+
+	/*!
+	Read the clock carried by a synthetic video frame, searched in its first bytes to tolerate any container header,
+	returns -1 if the packet has not been generated by Synthetic */
+	static Int64 ReadClock(const Packet& packet);
+
+private:
+	Media::Video::Tag	_video;
+	Media::Audio::Tag	_audio;
+	Packet				_videoConfig;
+	Packet				_audioConfig;
+	Packet				_audioFrame;
+	UInt32				_videoSize;
+	Int64				_start;
+	UInt64				_videoFrames;
+	UInt64				_audioFrames;
+};
+
+} // namespace Mona
@@ -0,0 +1,122 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/ServerApplication.h"
+#include "MonaBench.h"
+#include "BenchSessions.h"
+#include "BenchHTTP.h"
+#include "BenchJSON.h"
+#include "Version.h"
+
+#define VERSION		"1." STRINGIFY(MONA_VERSION)
+
+using namespace std;
+using namespace Mona;
+
+struct BenchApp : ServerApplication  {
+
+	BenchApp() { setString("description", "MonaBench load generator"); }
+
+	const char* defineVersion() { return VERSION; }
+
+	void defineOptions(Exception& ex, Options& options) {
+		options.add(ex, "host", "ip", "Server host to bench, 127.0.0.1 by default.")
+			.argument("host");
+		options.add(ex, "edge", "ed", "Edge server host where subscribers connect (same ports), publishers stay on host which is its origin: subscribers join only if the edge pulls the streams from host.")
+			.argument("host");
+		options.add(ex, "publish", "pub", "Protocols of publishers separated by a comma: rtmp, ws, flv, mp4, ts, srt or udp. rtmp by default.")
+			.argument("protocols");
+		options.add(ex, "subscribe", "sub", "Protocols of subscribers separated by a comma: rtmp, ws, flv, mp4, ts or srt. rtmp by default.")
+			.argument("protocols");
+		options.add(ex, "publishers", "np", "Number of publishers by protocol, 1 by default. Publisher i publishes the stream <stream><i>.")
+			.argument("number");
+		options.add(ex, "subscribers", "ns", "Number of subscribers by protocol, 10 by default. Subscriber j subscribes to <stream><j%publishers>, or <stream> without publisher.")
+			.argument("number");
+		options.add(ex, "duration", "du", "Duration of the bench in seconds, 30 by default.")
+			.argument("seconds");
+		options.add(ex, "ramp", "ra", "Ramp-up duration of subscribers in seconds, 0 by default (all in one time).")
+			.argument("seconds");
+		options.add(ex, "fps", "fps", "Video frame rate of publishers, 25 by default.")
+			.argument("number");
+		options.add(ex, "bitrate", "br", "Video bitrate of publishers in kbps, 1000 by default.")
+			.argument("kbps");
+		options.add(ex, "stream", "st", "Stream name prefix, bench by default.")
+			.argument("name");
+		options.add(ex, "rtmpPort", "rp", "RTMP port of the server, 1935 by default.")
+			.argument("port");
+		options.add(ex, "httpPort", "hp", "HTTP and WebSocket port of the server, 80 by default.")
+			.argument("port");
+		options.add(ex, "srtPort", "sp", "SRT port of the server, 9710 by default.")
+			.argument("port");
+		options.add(ex, "udpPort", "up", "First UDP port of the server, publisher i sends to udpPort+i which has to be configured as a TS stream source on server side, 1234 by default.")
+			.argument("port");
+		options.add(ex, "pid", "pid", "Server process id to measure its CPU usage, by default a MonaServer or MonaTiny process is searched.")
+			.argument("pid");
+		options.add(ex, "json", "js", "File to write the report in JSON.")
+			.argument("file");
+		options.add(ex, "sessions", "se", "Bench offline the server sessions indexes (creation, lookups, removal) rather than a running server, for each count of sessions separated by a comma, ex: 100000,1000000.")
+			.argument("counts");
+		options.add(ex, "http", "ht", "Bench offline the HTTP requests parsing on one core rather than a running server, with the count of requests to parse, ex: 1000000.")
+			.argument("count");
+		options.add(ex, "rpc", "rpc", "Bench offline the JSON reading of RPC payloads on one core rather than a running server (char by char against the tape), with the count of readings of the payloads, ex: 100000.")
+			.argument("count");
+
+		ServerApplication::defineOptions(ex, options);
+	}
+
+///// MAIN
+	int main(TerminateSignal& terminateSignal) {
+		const char* sessions = getString("arguments.sessions");
+		if (sessions) {
+			vector<UInt32> counts;
+			String::ForEach forEach([&counts](UInt32 index, const char* value) {
+				UInt32 count;
+				if (String::ToNumber(value, count) && count)
+					counts.emplace_back(count);
+				return true;
+			});
+			String::Split(sessions, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+			BenchSessions::Run(counts);
+			return Application::EXIT_OK;
+		}
+		UInt32 requests;
+		if (getNumber("arguments.http", requests) && requests) {
+			BenchHTTP::Run(requests);
+			return Application::EXIT_OK;
+		}
+		if (getNumber("arguments.rpc", requests) && requests) {
+			BenchJSON::Run(requests);
+			return Application::EXIT_OK;
+		}
+
+
+		MonaBench bench(self, terminateSignal);
+		bench.start();
+
+		terminateSignal.wait();
+		// Stop the bench (prints the report)
+		bench.stop();
+
+		return Application::EXIT_OK;
+	}
+
+};
+
+int main(int argc, const char* argv[]) {
+	return BenchApp().run(argc, argv);
+}
@@ -32,6 +32,20 @@ struct Client : Entity, virtual Object, Net::Stats {
 	typedef Event<bool(const std::string& key, DataReader* pReader)>	ON(SetProperty);
 	NULLABLE(!connection || !_pWriter->operator bool())
 
+	/*!
+	Properties which can be materialized just on first access (see HTTPSession) */
+	struct Properties : Parameters, virtual Object {
+		typedef std::function<void(Parameters& properties)> Filler;
+		Properties& setParams(Parameters&& other) { _filler = nullptr; Parameters::setParams(std::move(other)); return self; }
+		/*!
+		Replace properties by the ones which will be written by filler on first access */
+		Properties& setParams(Filler&& filler);
+	private:
+		void onParamInit();
+
+		Filler _filler;
+	};
+
 	Client(const char* protocol, const SocketAddress& address);
 
 	const SocketAddress			address;
@@ -97,7 +111,7 @@ private:
 	mutable void*				_pData;
 	Net::Stats*					_pNetStats;
 	Writer*						_pWriter;
-	Parameters					_properties;
+	Properties					_properties;
 	UInt16						_ping;
 	UInt32						_rto;
 	double						_rttvar;	
@@ -76,6 +76,12 @@ protected:
 	BinaryReader	reader;
 
 	bool			readNext(DataWriter& writer);
+
+////  OPTIONAL DEFINE ////
+	// skip the following value (type is END if not already computed by nextType), must return false if nothing to skip.
+	// Reads it on DataWriter::Null by default, can be override to jump over a value without parsing it
+	virtual bool	skipOne(UInt8 type);
+////////////////////
 	
 private:
 	
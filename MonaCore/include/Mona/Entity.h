@@ -25,6 +25,10 @@ namespace Mona {
 
 struct Entity : virtual Object {
 	struct Comparator { bool operator()(const UInt8* a, const UInt8* b) const { return memcmp(a, b, SIZE)<0; } };
+	/*!
+	To index ids in a HashMap, ids are random or SHA256 so first bytes are enough */
+	struct Hasher { UInt64 operator()(const UInt8* id) const { UInt64 hash; memcpy(&hash, id, sizeof(hash)); return hash; } };
+	struct Equal { bool operator()(const UInt8* a, const UInt8* b) const { return memcmp(a, b, SIZE) == 0; } };
 	template<typename EntityType>
 	struct Map : std::map<const UInt8*, EntityType*, Comparator> {
 		using std::map<const UInt8*, EntityType*, Comparator>::map;
@@ -50,7 +50,9 @@ struct FlashWriter : Writer, Media::TrackTarget, virtual Object {
 	virtual bool			beginMedia(const std::string& name);
 	virtual bool			writeAudio(const Media::Audio::Tag& tag, const Packet& packet, bool reliable);
 	virtual bool			writeVideo(const Media::Video::Tag& tag, const Packet& packet, bool reliable);
-	virtual bool			writeData(Media::Data::Type type, const Packet& packet, bool reliable);
+	virtual bool			writeData(Media::Data::Type type, const Packet& packet, bool reliable) { return writeData(type, packet, Packet::Null(), reliable); }
+	virtual bool			writeData(Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable);
+	Media::Data::Type		dataType() const override { return amf0 ? Media::Data::TYPE_AMF0 : Media::Data::TYPE_AMF; }
 	virtual bool			writeProperties(const Media::Properties& properties);
 	virtual bool			endMedia();
 
@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Mona.h"
 #include "Mona/WS/WSDecoder.h"
+#include <vector>
 
 namespace Mona {
 
@@ -163,7 +164,51 @@ struct HTTP : virtual Static {
 
 	static bool			 WriteDirectoryEntries(Exception& ex, BinaryWriter& writer, const std::string& fullPath, const std::string& path, SortBy sortBy = SORTBY_NAME, Sort sort = SORT_ASC);
 
+	struct Message;
+	/*!
+	Header received, fields are parsed without allocation in views of the message received (null terminated),
+	well-known names are interned to get their value in O(1) with get(Name).
+	Parameters (scripts and client properties) are materialized just on first access */
 	struct Header : Parameters, virtual Object {
+		enum Name : UInt8 {
+			NAME_UNKNOWN = 0,
+			NAME_HOST,
+			NAME_CONNECTION,
+			NAME_CONTENT_TYPE,
+			NAME_CONTENT_LENGTH,
+			NAME_TRANSFER_ENCODING,
+			NAME_RANGE,
+			NAME_ORIGIN,
+			NAME_UPGRADE,
+			NAME_COOKIE,
+			NAME_ACCEPT_ENCODING,
+			NAME_IF_MODIFIED_SINCE,
+			NAME_IF_NONE_MATCH,
+			NAME_SEC_WEBSOCKET_KEY,
+			NAME_SEC_WEBSOCKET_ACCEPT,
+			NAME_SEC_WEBSOCKET_PROTOCOL,
+			NAME_ACCESS_CONTROL_REQUEST_HEADERS,
+			NAME_ACCESS_CONTROL_REQUEST_METHOD,
+			NAMES
+		};
+		enum {
+			FIELDS = 64 // max header lines
+		};
+		struct Field {
+			Name		id;
+			const char* name;
+			const char* value;
+		};
+		struct Fields {
+			Fields(const Field* begin, const Field* end) : _begin(begin), _end(end) {}
+			const Field*	begin() const { return _begin; }
+			const Field*	end() const { return _end; }
+			UInt8			size() const { return UInt8(_end - _begin); }
+		private:
+			const Field*	_begin;
+			const Field*	_end;
+		};
+
 		Header(const Socket& socket, bool rendezVous=false);
 
 		MIME::Type		mime;
@@ -195,7 +240,34 @@ struct HTTP : virtual Static {
 
 		bool			rendezVous;
 
-		void			set(const char* key, const char* value);
+		/*!
+		Value of a well-known header field, NULL if missing */
+		const char*		get(Name name) const { return _names[name] ? _fields[_names[name] - 1].value : NULL; }
+		/*!
+		Value of a header field, NULL if missing */
+		const char*		get(const char* name) const;
+		Fields			fields() const { return Fields(_fields, _fields + _size); }
+
+		/*!
+		Hold the buffer received which contains code and fields views */
+		void			hold(const Packet& buffer);
+		/*!
+		Add a header field, name and value are null terminated views in a buffer held,
+		returns false if header has already FIELDS lines */
+		bool			add(const char* name, const char* value);
+
+		static Name		ParseName(const char* name, std::size_t size);
+		/*!
+		Materialize type, version or code, fields and cookies */
+		void			fill(Parameters& parameters) const;
+	private:
+		void			onParamInit() { fill(self); }
+
+		Field					_fields[FIELDS];
+		UInt8					_names[NAMES]; // index+1 of the well-known fields
+		UInt8					_size;
+		Packet					_buffer;
+		std::vector<Packet>		_buffers; // previous buffers when header is received in several parts
 	};
 
 	
@@ -213,23 +285,25 @@ struct HTTP : virtual Static {
 		operator const shared<const Header>&() const { return _pHeader; }
 		bool unique() const { return _pHeader.unique(); }
 	protected:
-		Message(shared<Header>& pHeader, const Packet& packet, bool flush) : lost(0), pMedia(NULL), flush(flush), Packet(std::move(packet)), _pHeader(std::move(pHeader)) { if (_pHeader) setParams(*_pHeader); }
-		Message(shared<Header>& pHeader, const shared<WSDecoder>& pDecoder) : lost(0), pMedia(NULL), flush(true), Packet(Packet::Null()), pWSDecoder(pDecoder), _pHeader(std::move(pHeader)) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, const Packet& packet, bool flush) : lost(0), pMedia(NULL), flush(flush), Packet(std::move(packet)), _pHeader(std::move(pHeader)) {}
+		Message(shared<Header>& pHeader, const shared<WSDecoder>& pDecoder) : lost(0), pMedia(NULL), flush(true), Packet(Packet::Null()), pWSDecoder(pDecoder), _pHeader(std::move(pHeader)) {}
 		/*!
 		exception */
-		Message(shared<Header>& pHeader, const Exception& ex) : lost(0), pMedia(NULL), ex(ex), flush(true), _pHeader(std::move(pHeader)) {} // Exception => no need to parse params!
+		Message(shared<Header>& pHeader, const Exception& ex) : lost(0), pMedia(NULL), ex(ex), flush(true), _pHeader(std::move(pHeader)) {} // Exception => no params!
 		/*!
 		media packet */
-		Message(shared<Header>& pHeader, Media::Base* pMedia) : lost(0), pMedia(pMedia), _pHeader(std::move(pHeader)), flush(false) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, Media::Base* pMedia) : lost(0), pMedia(pMedia), _pHeader(std::move(pHeader)), flush(false) {}
 		/*!
 		media lost infos */
-		Message(shared<Header>& pHeader, Media::Type type, UInt32 lost, UInt8 track = 0) : lost(lost), pMedia(new Media::Base(type, Packet::Null(), track)), _pHeader(std::move(pHeader)), flush(false) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, Media::Type type, UInt32 lost, UInt8 track = 0) : lost(lost), pMedia(new Media::Base(type, Packet::Null(), track)), _pHeader(std::move(pHeader)), flush(false) {}
 		/*!
 		media reset, flush or publish end */
-		Message(shared<Header>& pHeader, bool endMedia, bool flush) : lost(0), pMedia(endMedia ? NULL : new Media::Base()), _pHeader(std::move(pHeader)), flush(flush) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, bool endMedia, bool flush) : lost(0), pMedia(endMedia ? NULL : new Media::Base()), _pHeader(std::move(pHeader)), flush(flush) {}
 
 		~Message() { if (pMedia) delete pMedia; }
 	private:
+		void onParamInit() { if (_pHeader && !ex) _pHeader->fill(self); } // header params materialized on first access
+
 		shared<const Header> _pHeader;
 	};
 
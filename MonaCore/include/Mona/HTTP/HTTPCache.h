@@ -0,0 +1,102 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/IOFile.h"
+#include "Mona/MIME.h"
+#include "Mona/HashMap.h"
+#include <list>
+
+
+namespace Mona {
+
+/*!
+In-memory LRU cache of the small static files of www, up to maxSize bytes.
+An entry holds the file content and its header lines already built (Content-Type, Content-Length, Last-Modified, ETag),
+with the pre-compressed variants found beside the file (file.br and file.gz) to answer to Accept-Encoding.
+Filled by HTTPFileSender on first reading, entries are watched with IOFile::watch to be released on file change or deletion.
+Thread-safe (filled in IOFile decoding threads, requested by sessions), must be created in a shared (file updates hold just a weak<HTTPCache>) */
+struct HTTPCache : std::enable_shared_from_this<HTTPCache>, virtual Object {
+	enum {
+		MAX_FILE_SIZE = 0x100000 // 1MB, bigger files are not cached (sent without copy)
+	};
+	enum Encoding : UInt8 {
+		ENCODING_IDENTITY = 0,
+		ENCODING_GZIP, // file.gz
+		ENCODING_BROTLI, // file.br
+		ENCODINGS
+	};
+
+	struct Entry : virtual Object {
+		struct Variant : virtual Object {
+			NULLABLE(!header)
+			Int64		lastChange;
+			std::string	eTag; // with quotes
+			Packet		header; // header lines, "\r\nName: value" format
+			Packet		content;
+		};
+		Entry(const Path& path) : path(path), lastChange(path.lastChange()), size(path.size()) {}
+
+		const Path		path;
+		const Int64		lastChange;
+		const UInt64	size;
+		/*!
+		Variant to send according the Accept-Encoding value (can be null), identity if no variant is acceptable */
+		const Variant&	variant(const char* acceptEncoding) const;
+	private:
+		Variant							_variants[ENCODINGS];
+		UInt32							_memory;
+		std::list<shared<Entry>>::iterator _it;
+		shared<const FileWatcher>		_pWatchers[ENCODINGS];
+		friend struct HTTPCache;
+	};
+
+	HTTPCache(IOFile& ioFile, UInt64 maxSize);
+
+	const UInt64 maxSize;
+
+	UInt64	size() const { std::lock_guard<std::mutex> lock(_mutex); return _size; }
+	UInt32	count() const { std::lock_guard<std::mutex> lock(_mutex); return _entries.size(); }
+
+	/*!
+	Get the entry of file if cached and up to date, file attributes have to be loaded (request file tested by HTTPDecoder),
+	no disk access here */
+	shared<const Entry> get(const Path& file);
+	/*!
+	Add the file content fully readen, size and last change of file are ones of its reading (File::load) */
+	void	add(const Path& file, const Packet& content, MIME::Type mime, const char* subMime);
+	void	remove(const Path& file);
+	void	clear();
+
+	static std::string& ETag(Int64 lastChange, UInt64 size, std::string& eTag);
+
+private:
+	void	erase(const shared<Entry>& pEntry);
+	void	update(const Path& file);
+
+	IOFile&										_ioFile;
+	mutable std::mutex							_mutex;
+	std::list<shared<Entry>>					_lru; // most recent in front
+	HashMap<std::string, shared<Entry>>			_entries;
+	UInt64										_size;
+};
+
+
+} // namespace Mona
@@ -0,0 +1,59 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/HTTP/HTTPSender.h"
+#include "Mona/HTTP/HTTPCache.h"
+
+namespace Mona {
+
+/*!
+Static file sent from HTTPCache, header lines and content are already built: one vectored write,
+answers 304 Not Modified to a If-None-Match or If-Modified-Since request */
+struct HTTPCacheSender : HTTPSender, virtual Object {
+	HTTPCacheSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
+		const shared<const HTTPCache::Entry>& pEntry) : _pEntry(pEntry), HTTPSender("HTTPCacheSender", pRequest, pSocket) {}
+
+	const Path& path() const override { return _pEntry->path; }
+
+private:
+	bool run() override {
+		const HTTPCache::Entry::Variant& variant = _pEntry->variant(pRequest->get(HTTP::Header::NAME_ACCEPT_ENCODING));
+		const char* eTags = pRequest->get(HTTP::Header::NAME_IF_NONE_MATCH);
+		// If-Modified-Since has a second precision
+		if (eTags ? (strstr(eTags, variant.eTag.c_str()) || strcmp(eTags, "*") == 0) : pRequest->ifModifiedSince >= (_pEntry->lastChange / 1000 * 1000)) {
+			// NOT MODIFIED
+			DEBUG(peerAddress(), " GET 304 ", pRequest->path, _pEntry->path.name(), " (cache)");
+			HTTP_BEGIN_HEADER(buffer())
+				HTTP_ADD_HEADER("ETag", variant.eTag)
+			HTTP_END_HEADER
+			send(HTTP_CODE_304);
+			return true;
+		}
+		DEBUG(peerAddress(), " GET 200 ", pRequest->path, _pEntry->path.name(), " (cache)");
+		send(HTTP_CODE_200, variant.header, variant.content);
+		return true;
+	}
+
+	shared<const HTTPCache::Entry> _pEntry;
+};
+
+
+} // namespace Mona
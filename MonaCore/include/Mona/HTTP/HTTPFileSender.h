@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Mona.h"
 #include "Mona/HTTP/HTTPSender.h"
+#include "Mona/HTTP/HTTPCache.h"
 
 
 namespace Mona {
@@ -28,13 +29,18 @@ namespace Mona {
 File send,
 - call io.subscribe(pFileSender, (File::Decoder*)pFileSender.get(), onFileReaden, onFileError)
 - call io.read(pFileSender) to start file sending
-- on pSocket.onFlush and if pFileSender.unique() && *pFileSender recall io.read(pFileSender)
-- on onEnd the file has been fully sent */
+- on pSocket.onFlush and if pFileSender.unique() && *pFileSender recall io.read(pFileSender, pFileSender->readSize())
+- on onEnd the file has been fully sent
+A file without properties to replace supports HTTP Range, and is sent without copy when the socket allows it (sendfile),
+with pCache a small file is added to the cache after its reading */
 struct HTTPFileSender : HTTPSender, File, File::Decoder, virtual Object {
 	HTTPFileSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		const Path& file, Parameters& properties);
+		const Path& file, Parameters& properties, const shared<HTTPCache>& pCache = nullptr);
 
 	const Path& path() const override { return self; }
+	/*!
+	Size to read with io.read, 0 when the rest of file is sent without copy (see decode) */
+	UInt32		readSize() const { return _zeroCopy ? 0 : 0xFFFF; }
 
 private:
 	bool				run() override { ERROR(HTTPSender::name, " not runnable, read me with ioFile.read(pFileSender)"); return true; }
@@ -47,6 +53,11 @@ private:
 	MIME::Type				_mime;
 	const char*				_subMime;
 	const char*				_protocol;
+	UInt64					_rest; // rest to send (for a file without properties)
+	bool					_range;
+	std::atomic<bool>		_zeroCopy;
+	shared<HTTPCache>		_pCache;
+	shared<Buffer>			_pCaching; // content of a file in several readings to cache
 
 	// For search!
 	Parameters::const_iterator	_result;
@@ -25,10 +25,17 @@ details (or else see http://www.gnu.org/licenses/).
 namespace Mona {
 
 struct HTTPMediaSender : HTTPSender, virtual Object {
+	/*!
+	Media muxed by pWriter (created by the first sender which sends HTTP header), begin=true to call pWriter->beginMedia before */
 	HTTPMediaSender(const shared<const HTTP::Header>& pRequest,
 		const shared<Socket>& pSocket,
 		shared<MediaWriter>& pWriter,
-		Media::Base* pMedia=NULL);
+		Media::Base* pMedia=NULL, bool begin=false);
+	/*!
+	Media already muxed (shared muxing, see Subscription::setFormat), a null packet ends the stream */
+	HTTPMediaSender(const shared<const HTTP::Header>& pRequest,
+		const shared<Socket>& pSocket,
+		const Packet& packet);
 
 	bool hasHeader() const override { return _first; }
 
@@ -36,8 +43,10 @@ private:
 	bool run() override;
 
 	bool _first;
+	bool _begin;
 	shared<MediaWriter> _pWriter;
 	unique<Media::Base>	_pMedia;
+	Packet				_packet;
 };
 
 
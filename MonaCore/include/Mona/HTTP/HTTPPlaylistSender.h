@@ -33,6 +33,9 @@ struct HTTPPlaylistSender : HTTPSender, virtual Object {
 		_playlist(path), _format(std::move(format)), HTTPSender("HTTPPlaylistSender", pRequest, pSocket) {
 		segments.to(_playlist);
 	}
+	/*!
+	Refresh playlist before sending, allows to defer the sending until segments progress (LL-HLS blocking playlist reload) */
+	void update(const Segments& segments) { segments.to(_playlist); }
 
 private:
 	bool  run() override;
@@ -28,13 +28,18 @@ namespace Mona {
 /*!
 Media Segment send,
 send with TCPSender::send(pHTTPSender) but keep a reference on until get a onFlush,
-If after onFlush the pHTTPSender.unique() && !pHTTPSender->flushing() the media has been fully sent, otherwise recall TCPSender::send(pHTTPSender) */
+If after onFlush the pHTTPSender.unique() && !pHTTPSender->flushing() the media has been fully sent, otherwise recall TCPSender::send(pHTTPSender).
+If part>=0 sends just this part of segment (LL-HLS) prefixed with configs of the segment to stay decodable,
+without specific parameters the part is muxed one time by publication and format (see Segment::mux) */
 struct HTTPSegmentSender : HTTPSender, private Media::Target, virtual Object {
 	
 	HTTPSegmentSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		const Path& path, const Segment& segment, Parameters& params);
+		const Path& path, const Segment& segment, Parameters& params, Int32 part = -1);
 
 	const Path& path() const override { return _path; }
+	/*!
+	Refresh segment before sending, allows to defer a part request until the part is written (LL-HLS preload hint) */
+	void update(const Segment& segment);
 
 private:
 
@@ -49,8 +54,14 @@ private:
 
 	MediaWriter::OnWrite	_onWrite;
 	unique<MediaWriter>		_pWriter;
-	const Segment			_segment;
+	MIME::Type				_mime;
+	const char*				_subMime;
+	const bool				_shared; // part shared by every viewer
+	Packet					_muxed;
+	unique<const Segment>	_pSegment;
+	Int32					_part;
 	Segment::const_iterator _itMedia;
+	Segment::const_iterator _itEnd;
 	Subscription			_subscription; // use subscription to support properties subscription
 	Path					_path;
 	UInt32					_lastTime;
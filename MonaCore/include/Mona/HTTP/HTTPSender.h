@@ -70,9 +70,16 @@ struct HTTPSender : Runner, virtual Object {
 	If extraSize=UINT64_MAX + !path(): live streaming => no content-length, live attributes and close on end of response */
 	bool send(const char* code, MIME::Type mime = MIME::TYPE_UNKNOWN, const char* subMime = NULL, UInt64 extraSize = 0);
 	/*!
+	Send HTTP header and content in one vectored write, header contains the lines already built of this content (Content-Type, Content-Length...) */
+	bool send(const char* code, const Packet& header, const Packet& content);
+	/*!
 	Send HTTP body content */
 	bool send(const Packet& content);
 	/*!
+	Send HTTP body content from file reading position without copy when possible (see Socket::sendFile),
+	returns size sent, less than size means wait socket.onFlush (or -1 if error) */
+	int  send(File& file, UInt32 size);
+	/*!
 	Finalize send */
 	void end();
 
@@ -85,6 +92,7 @@ struct HTTPSender : Runner, virtual Object {
 protected:
 
 	const SocketAddress& peerAddress() { return _pSocket ? _pSocket->peerAddress() : SocketAddress::Wildcard(); }
+	bool				 zeroCopy() const { return !_chunked && _pSocket->zeroCopy(); }
 
 	const shared<const HTTP::Header> pRequest;
 	UInt8							 connection;
@@ -104,6 +112,9 @@ private:
 	virtual const Path& path() const { return Path::Null(); }
 
 	bool socketSend(const Packet& packet);
+	bool socketSend(const Packet* const* packets, UInt32 count);
+	Buffer& writeHeader(Buffer& buffer, const char* code);
+	bool sendHeader(shared<Buffer>& pBuffer, const UInt8* headerEnd, const Packet& content = Packet::Null());
 	virtual bool run(Exception&);
 	/*!
 	must return end if finished, otherwise false */
@@ -35,7 +35,7 @@ private:
 	HTTPDecoder::OnResponse	_onResponse;
 
 	void			onParameters(const Parameters& parameters);
-	bool			manage();
+	UInt32			manage();
 	void			flush();
 
 	void			disconnection(); // usefull for Protocol upgrade like WebSocket upgrade
@@ -64,6 +64,25 @@ private:
 	bool			writeFile(Exception& ex, HTTP::Request& request, QueryReader& parameters);
 	bool			invoke(Exception& ex, HTTP::Request& request, QueryReader& parameters, const char* name = NULL);
 
+	/*!
+	LL-HLS blocking request (playlist reload or part preload hint), the response sender is kept to defer its sending */
+	struct Blocking : virtual Object {
+		Blocking(const std::string& publication, UInt32 sequence, Int32 part, UInt32 timeout) :
+			publication(publication), sequence(sequence), part(part), timeout(timeout) {}
+		const std::string			publication;
+		const UInt32				sequence;
+		const Int32					part;
+		const UInt32				timeout;
+		const Time					time;
+		shared<HTTPPlaylistSender>	pPlaylist;
+		shared<HTTPSegmentSender>	pPart;
+	};
+	Blocking&		block(const std::string& publication, const Segments& segments, UInt32 sequence, Int32 part);
+	/*!
+	Release the blocking request if ready (or if force), returns false if always blocked */
+	bool			unblock(bool force = false);
+	const Segments*	segments(const std::string& publication);
+
 	unique<HTTPWriter>  _pWriter; // pointer to release source on session::kill
 	Subscription*		_pSubscription;
 	Publication*		_pPublication;
@@ -73,6 +92,9 @@ private:
 
 	unique<Session>		_pUpgradeSession;
 
+	unique<Blocking>	_pBlocking;
+	Segments::OnReady	_onSegmentsReady;
+
 	// options
 	std::string			_index;
 	bool				_indexDirectory;
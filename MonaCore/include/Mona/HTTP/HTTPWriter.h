@@ -25,6 +25,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/HTTP/HTTPDataSender.h"
 #include "Mona/HTTP/HTTPMediaSender.h"
 #include "Mona/HTTP/HTTPFileSender.h"
+#include "Mona/HTTP/HTTPCacheSender.h"
 #include "Mona/HTTP/HTTPFolderSender.h"
 #include "Mona/HTTP/HTTPPlaylistSender.h"
 #include "Mona/HTTP/HTTPSegmentSender.h"
@@ -36,6 +37,9 @@ struct HTTPWriter : Writer, Media::Target, virtual Object {
 	HTTPWriter(TCPSession& session);
 
 	bool			crossOriginIsolated;
+	/*!
+	Static files cache of the protocol, null if disabled */
+	shared<HTTPCache> pCache;
 
 	HTTPWriter&		beginRequest(const shared<const HTTP::Header>& pRequest);
 	void			endRequest();
@@ -54,18 +58,24 @@ struct HTTPWriter : Writer, Media::Target, virtual Object {
 	void			writeSetCookie(const std::string& key, DataReader& reader);
 
 	void			writeFile(const Path& file, Parameters& properties);
-	void			writeSegment(const Path& path, const Segment& segment, Parameters& params);
-	void			writePlaylist(const Path& path, const Segments& segments, std::string&& format = "ts") { newSender<HTTPPlaylistSender>(true, path, segments, std::move(format)); }
+	/*!
+	Write segment (or its part if part>=0) and playlist,
+	keeping the returned sender defers its sending (and the following responses) until release + flush() (LL-HLS blocking requests) */
+	shared<HTTPSegmentSender>	writeSegment(const Path& path, const Segment& segment, Parameters& params, Int32 part = -1);
+	shared<HTTPPlaylistSender>	writePlaylist(const Path& path, const Segments& segments, std::string&& format = "ts");
 	void			writeMasterPlaylist(Playlist::Master&& playlist) { newSender<HTTPMPlaylistSender>(true, std::move(playlist)); }
 
 	BinaryWriter&   writeRaw(const char* code);
 	DataWriter&     writeResponse(const char* subMime);
+	/*!
+	Write a response with a content already built, subMime has to be static */
+	void			writeResponse(MIME::Type mime, const char* subMime, const Packet& packet);
 
 
 	bool			beginMedia(const std::string& name);
-	bool			writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) { return newSender<HTTPMediaSender>(_pMediaWriter, new Media::Audio(tag, packet, track)) ? true : false; }
-	bool			writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable) { return newSender<HTTPMediaSender>(_pMediaWriter, new Media::Video(tag, packet, track)) ? true : false; }
-	bool			writeData(UInt8 track, Media::Data::Type type, const Packet& packet, bool reliable) { return newSender<HTTPMediaSender>(_pMediaWriter, new Media::Data(type, packet, track)) ? true : false; }
+	bool			writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) { return writeMedia(new Media::Audio(tag, packet, track)); }
+	bool			writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable) { return writeMedia(new Media::Video(tag, packet, track)); }
+	bool			writeData(UInt8 track, Media::Data::Type type, const Packet& packet, bool reliable);
 	// No writeProperties here because HTTP has no way to control a multiple channel global stream
 	bool			endMedia();
 
@@ -81,6 +91,7 @@ private:
 	void			closing(Int32 error=0, const char* reason = NULL) override;
 
 	DataWriter&		writeMessage(bool isResponse);
+	bool			writeMedia(Media::Base* pMedia);
 
 
 	template <typename SenderType, typename ...Args>
@@ -114,6 +125,7 @@ private:
 	File::OnError						_onFileError;
 	
 	shared<MediaWriter>					_pMediaWriter;
+	bool								_mediaBegun; // _pMediaWriter->beginMedia called (media not already muxed)
 	TCPSession&							_session;
 	shared<Buffer>						_pSetCookie;
 
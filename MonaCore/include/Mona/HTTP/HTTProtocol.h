@@ -21,6 +21,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Mona.h"
 #include "Mona/TCProtocol.h"
 #include "Mona/HTTP/HTTPSession.h"
+#include "Mona/HTTP/HTTPCache.h"
 
 namespace Mona {
 
@@ -32,6 +33,7 @@ struct HTTProtocol : TCProtocol, virtual Object {
 		setNumber("timeout", 11); // ideal value between 7 and 11, but take 11 to be superior to max keyframe interval configurable for a video (10sec), to allow a live streaming not interrupted by session timeout
 		setBoolean("index", true); // index directory, if false => forbid directory index, otherwise redirection to index
 		setBoolean("rendezVous", false);
+		setNumber("cache", 16); // static files cache size in MB, 0 to disable
 		setBoolean("crossOriginIsolated", false); // if true adds COOP & COEP headers, needed to access SharedArrayBuffer (https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/SharedArrayBuffer/Planned_changes)
 
 		onConnection = [this](const shared<Socket>& pSocket) {
@@ -42,12 +44,16 @@ struct HTTProtocol : TCProtocol, virtual Object {
 	~HTTProtocol() { onConnection = nullptr; }
 
 	shared<HTTP::RendezVous> pRendezVous;
+	shared<HTTPCache>		 pCache;
 
 	SocketAddress load(Exception& ex) {
 		if (getBoolean<false>("rendezVous")) {
 			INFO(name, " RendezVous service started");
 			pRendezVous.set(api.timer);
 		}
+		UInt32 cache = getNumber<UInt32>("cache");
+		if (cache)
+			pCache.set(api.ioFile, UInt64(cache) * 1024 * 1024);
 		return TCProtocol::load(ex);
 	}
 
@@ -24,11 +24,22 @@ details (or else see http://www.gnu.org/licenses/).
 namespace Mona {
 
 
+/*!
+JSON reader in two stages: a structural index of the JSON (see Bytes::IndexJSON) is validated on construction in a tape,
+where each { and [ knows the index following its } or ], then values are read from the tape without parsing char by char
+and can be skipped (next) without parsing their content.
+A JSON malformed is read char by char to report the error as before */
 struct JSONReader : DataReader, virtual Object {
-	JSONReader(const Packet& packet);
+	enum : UInt32 {
+		// size from which a JSON is read from a tape rather than char by char (smaller the tape costs more than it saves)
+		TAPE_MIN_SIZE = 64
+	};
+	/*!
+	tapeMinSize to 0xFFFFFFFF reads always char by char (bench) */
+	JSONReader(const Packet& packet, UInt32 tapeMinSize = TAPE_MIN_SIZE);
 
 	bool				isValid() const { return _isValid; }
-	void				reset() { reader.reset(_pos); }
+	void				reset();
 
 private:
 	enum {
@@ -38,8 +49,18 @@ private:
 
 	bool	readOne(UInt8 type, DataWriter& writer);
 	UInt8	followingType();
+	bool	skipOne(UInt8 type);
+
+	UInt8			valueType(const char* value);
 
+	// tape
+	void			index();
+	UInt32			jump(UInt32 index) const;
+	UInt8			followingTapeType();
+	bool			readTapeArray(DataWriter& writer);
+	bool			readTapeObject(DataWriter& writer);
 
+	// char by char
 	const char*		jumpToString(UInt32& size);
 	bool			jumpTo(char marker);
 	bool			countArrayElement(UInt32& count);
@@ -50,6 +71,12 @@ private:
 	double			_number;
 	bool			_isValid;
 	UInt32			_pos;
+
+	Buffer			_tape; // structural positions followed by jumps
+	const UInt32*	_positions; // NULL if read char by char
+	UInt32*			_jumps; // set just for { and [, index following the } or ] matching
+	UInt32			_cursor;
+	UInt32			_end;
 };
 
 
@@ -60,6 +60,9 @@ struct MP4Writer : MediaWriter, virtual Object {
 	void writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, const OnWrite& onWrite);
 	void writeData(UInt8 track, Media::Data::Type type, const Packet& packet, const OnWrite& onWrite);
 	void endMedia(const OnWrite& onWrite);
+	/*!
+	Write again the last ftyp+moov header, the following moof can be joined after it */
+	bool writeHeader(const OnWrite& onWrite);
 
 private:
 	void flush(const OnWrite& onWrite, Int8 reset=0);
@@ -130,6 +133,7 @@ private:
 	UInt16						_buffering;
 	UInt16						_bufferMinSize;
 	UInt8						_errors;
+	Packet						_header; // last ftyp+moov written
 };
 
 
@@ -29,6 +29,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/MIME.h"
 #include "Mona/Timer.h"
 #include "Mona/Logs.h"
+#include <mutex>
 
 
 namespace Mona {
@@ -343,6 +344,23 @@ struct Media : virtual Static {
 		UInt8						_track;
 	};
 
+	/*!
+	Serializations of one data packet, each type is converted on its first request and then shared,
+	allows to convert one time a data packet for all the targets which expect the same type (thread-safe) */
+	struct DataCache : virtual Object {
+		DataCache(Media::Data::Type type, const Packet& packet) : type(type), packet(packet), _requested(0) {}
+
+		const Media::Data::Type type;
+		const Packet&			packet;
+		/*!
+		Returns packet converted to type, or a null packet if type is the original one or if conversion is impossible */
+		const Packet& convert(Media::Data::Type type) const;
+	private:
+		mutable std::mutex	_mutex;
+		mutable Packet		_packets[Media::Data::TYPE_TEXT];
+		mutable UInt8		_requested; // bit flags of types already converted
+	};
+
 
 	/*!
 	To write a media part from source (just a part of one media, so no beginMedia/endMedia and writeProperties) */
@@ -385,6 +403,13 @@ struct Media : virtual Static {
 		virtual bool writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable);
 		virtual bool writeData(UInt8 track, Media::Data::Type type, const Packet& packet, bool reliable);
 		/*!
+		Serialization in which the target converts data packets, TYPE_UNKNOWN if it writes them unchanged */
+		virtual Media::Data::Type dataType() const { return Media::Data::TYPE_UNKNOWN; }
+		/*!
+		writeData with packet already converted to dataType() by the caller, type stays the original type of packet.
+		Allows to share one conversion between all the targets which expect the same serialization (see Media::DataCache) */
+		virtual bool writeData(UInt8 track, Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable) { return writeData(track, type, packet, reliable); }
+		/*!
 		endMedia, tolerates a this deletion (and subscription deletion), should returns flase in this case (else execute a target.flush) */
 		virtual bool endMedia() { return true; }
 	
@@ -402,10 +427,12 @@ struct Media : virtual Static {
 		virtual bool writeAudio(const Media::Audio::Tag& tag, const Packet& packet, bool reliable);
 		virtual bool writeVideo(const Media::Video::Tag& tag, const Packet& packet, bool reliable);
 		virtual bool writeData(Media::Data::Type type, const Packet& packet, bool reliable);
+		virtual bool writeData(Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable) { return writeData(type, packet, reliable); }
 	private:
 		bool writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) { return writeAudio(tag, packet, reliable); }
 		bool writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, bool reliable) { return writeVideo(tag, packet, reliable); }
 		bool writeData(UInt8 track, Media::Data::Type type, const Packet& packet, bool reliable) { return writeData(type, packet, reliable); }
+		bool writeData(UInt8 track, Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable) { return writeData(type, packet, converted, reliable); }
 	};
 
 };
@@ -0,0 +1,100 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/MediaWriter.h"
+#include <map>
+#include <mutex>
+
+namespace Mona {
+
+/*!
+Muxing shared by all the subscriptions of one publication which want the same format (see Publication::mux),
+every media is written one time whatever the number of readers and resulting packets, immutables, are distributed as such.
+A reader joins the muxing in progress with header() and then gets packets returned by each write call.
+Timestamps start on first media muxed, a reader which requires its own time (time, from, duration, track selection, MBR)
+has to use a private MediaWriter rather. The packets muxed since the last key frame can be kept to replay the GOP on join (see Publication::gop).
+Thread-safe when threadSafe is set, to allow readers written by different threads (see Publication::shards) */
+struct MediaMux : virtual Object {
+	NULLABLE(!_begun)
+
+	MediaMux(unique<MediaWriter>&& pWriter, bool threadSafe = false);
+	~MediaMux();
+
+	/*!
+	Lock every call, required just when readers are written by different threads */
+	bool		threadSafe;
+
+	const char*	format() const { return _pWriter->format(); }
+
+	/*!
+	Begin the muxing if not already begun, a reader has to join it with header() */
+	void beginMedia();
+	/*!
+	Packets required to join the muxing in progress, before to get the next write call results.
+	With gop set to the sequence number of the media in distribution, adds the GOP muxed before it,
+	returns false (and fills nothing) if the muxing has no GOP (started after the key frame) */
+	bool header(std::deque<Packet>& packets, UInt64 gop = 0) const;
+
+	/*!
+	Keep the packets muxed from the next write (a key frame) to replay them on join, until stopGOP */
+	void startGOP();
+	void stopGOP();
+
+	/*!
+	Write the media if it's not already done for this sequence number (call in a row by each subscription, see Publication::sequence),
+	and returns the packets resulting (can be empty if the container bufferizes), sequence 0 writes always.
+	Packets returned stay valid after a next write which can happen on an other thread */
+	shared<const std::deque<Packet>> writeProperties(UInt64 sequence, const Media::Properties& properties);
+	shared<const std::deque<Packet>> writeAudio(UInt64 sequence, UInt8 track, const Media::Audio::Tag& tag, const Packet& packet);
+	shared<const std::deque<Packet>> writeVideo(UInt64 sequence, UInt8 track, const Media::Video::Tag& tag, const Packet& packet);
+	shared<const std::deque<Packet>> writeData(UInt64 sequence, UInt8 track, Media::Data::Type type, const Packet& packet);
+	/*!
+	End the muxing, next write will begin implicitly a new media */
+	shared<const std::deque<Packet>> endMedia();
+
+private:
+	std::unique_lock<std::mutex> guard() const { return threadSafe ? std::unique_lock<std::mutex>(_mutex) : std::unique_lock<std::mutex>(); }
+	void	  begin();
+	void	  clear();
+	void	  gop();
+	bool	  write(UInt64 sequence);
+	UInt32	  scaleTime(UInt32 time, bool isConfig);
+	void	  hold(UInt16 key, UInt32 from);
+
+	unique<MediaWriter>						_pWriter;
+	MediaWriter::OnWrite					_onWrite;
+	shared<std::deque<Packet>>				_pPackets; // replaced rather cleared when still read by a subscription
+	bool									_begun;
+	// sequence number of the current media to write just one time the same media
+	UInt64									_sequence;
+	// timestamps
+	bool									_started;
+	UInt32									_startTime;
+	// beginMedia, properties and configs packets (ordered) to replay on join
+	std::map<UInt16, std::deque<Packet>>	_header;
+	// packets muxed since the key frame, to replay on join
+	std::deque<Packet>						_gop;
+	bool									_gopping;
+	UInt64									_gopSequence; // sequence of the last packets added to _gop
+	mutable std::mutex						_mutex;
+};
+
+
+} // namespace Mona
@@ -50,6 +50,11 @@ struct MediaWriter : virtual Object {
 	/*!
 	Release the media ressources */
 	virtual void endMedia(const OnWrite& onWrite) {}
+	/*!
+	Write what a reader joining the media in progress requires before to get the next packets (see MediaMux),
+	returns false to let the caller replays what has been written on beginMedia, writeProperties and last codec configurations,
+	overloads it when container writes lazily its header (MP4 for example) */
+	virtual bool writeHeader(const OnWrite& onWrite) { return false; }
 	
 	void writeMedia(const Media::Base& media, const OnWrite& onWrite);
 	void writeMedia(const Media::Properties& properties, const OnWrite& onWrite) { writeProperties(properties, onWrite); }
@@ -33,7 +33,7 @@ struct Peer : Client, virtual Object {
 	Peer(ServerAPI& api, const char* protocol, const SocketAddress& address);
 	~Peer();
 
-	Parameters&					properties() { return (Parameters&)Client::properties(); }
+	Properties&					properties() { return (Properties&)Client::properties(); }
 	const char*					authentification() const override;
 
 	void						setAddress(const SocketAddress& address);
@@ -59,7 +59,15 @@ struct Playlist : Path, virtual Object {
 	/*!
 	Represents a playlist, fix maxDuration on item addition and sequence on remove item
 	Path must informs on name and format playlist by its extension: ts/mp4 */
-	Playlist(const Path& path) : Path(path), sequence(0), maxDuration(0), _duration(0) {}
+	Playlist(const Path& path) : Path(path), sequence(0), maxDuration(0), partDuration(0), _duration(0) {}
+
+	/*!
+	Part of segment (LL-HLS), index is the part position in the segment 'sequence' */
+	struct Part : Segment::Part {
+		Part(UInt32 sequence, UInt16 index, const Segment::Part& part) : Segment::Part(part), sequence(sequence), index(index) {}
+		UInt32 sequence;
+		UInt16 index;
+	};
 
 
 	UInt32						sequence;
@@ -67,17 +75,23 @@ struct Playlist : Path, virtual Object {
 	UInt32						duration() const { return _duration; }
 	const std::deque<UInt16>	durations() const { return _durations; }
 	UInt32						count() const { return _durations.size(); }
+	/*!
+	LL-HLS, partDuration is the max part duration (0 if no parts) */
+	UInt16						partDuration;
+	const std::vector<Part>&	parts() const { return _parts; }
 
 	template <typename ...Args>
 	Playlist&					setPath(Args&&... args) { Path::set(std::forward<Args>(args)...); return self; }
 	Playlist&					addItem(UInt16 duration);
 	Playlist&					removeItem();
+	Playlist&					addParts(UInt32 sequence, const Segment& segment);
 	Playlist&					reset();
 private:
 	void set() {} // make private Path::set, use setPath rather
 
 	UInt32				_duration;
 	std::deque<UInt16>	_durations;
+	std::vector<Part>	_parts;
 };
 
 } // namespace Mona
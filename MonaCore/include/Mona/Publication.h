@@ -25,12 +25,19 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/MediaFile.h"
 #include "Mona/CCaption.h"
 #include "Mona/Segments.h"
+#include "Mona/MediaMux.h"
+#include "Mona/ThreadPool.h"
+#include "Mona/Signal.h"
 #include <set>
 
 namespace Mona {
 
 struct Publication : Media::Source, Media::Properties, virtual Object {
 	NULLABLE(!_publishing && subscriptions.empty())
+	enum {
+		GOP_DURATION = 10000, // ms
+		GOP_SIZE = 0x800000 // 8MB
+	};
 
 	template<typename TrackType>
 	struct Tracks : std::deque<TrackType>, virtual Object {
@@ -66,7 +73,7 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 	};
 
 
-	Publication(const std::string& name);
+	Publication(const std::string& name, const ThreadPool& threadPool);
 	virtual ~Publication();
 
 	const std::string&				name() const { return _name; }
@@ -82,7 +89,13 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 	/*!
 	Memory segmentation */
 	const Segments&					segments;
-							
+	/*!
+	GOP cache, medias since the last key frame of the first video track, empty if disabled or waiting a key frame.
+	Opt-in with "gop" property (gop=true or max duration in ms, and gopSize=max bytes), a new subscription
+	replays it to start immediately on this key frame rather than to wait the next one (see Subscription "gop" parameter),
+	the shared muxings keep the same GOP muxed to replay it on join (see MediaMux::header) */
+	const std::deque<unique<Media::Base>>&	gop() const { return _gop; }
+
 
 	UInt16							latency() const { return _latency; }
 	UInt64							byteRate() const { return _byteRate; }
@@ -92,6 +105,18 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 	UInt32							lastTime() const;
 
 	const std::set<Subscription*>	subscriptions;
+	/*!
+	Number of shards which write media to subscriptions in parallel on pool threads, 0 if the fan-out stays on the caller thread.
+	Opt-in with "shards" property, subscriptions of a same client are always written by the same shard,
+	by the caller thread after the other shards if one of them can end or switch (see Subscription::shardable) */
+	UInt8							shards() const { return UInt8(_shards.size()); }
+	/*!
+	Returns the muxing in format shared by subscriptions without specific parameters (see Subscription::setFormat),
+	returns null if format is unsupported */
+	shared<MediaMux>				mux(const char* format);
+	/*!
+	Sequence number of the media in distribution, identifies it for the shared muxings (see MediaMux) */
+	UInt64							sequence() const { return _sequence; }
 
 	void							start(unique<MediaFile::Writer>&& pRecorder = nullptr);
 	void							reset();
@@ -131,6 +156,22 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 private:
 	void flushProperties();
 	void stopRecording();
+	void cache(unique<Media::Base>&& pMedia);
+	void clearGOP();
+	/*!
+	Write media on every shard and wait the end of all, the caller thread writes the first shard,
+	or writes all itself if it's a worker thread of the pool (nested fan-out of a relay) */
+	void fanOut(const std::function<void(Subscription&)>& write);
+	void premux(const std::function<void(MediaMux&)>& write);
+	void partition();
+	struct Shard;
+	struct Sharding {
+		Sharding(Subscription* pSubscription, const void* pOwner, UInt8 state) : pSubscription(pSubscription), pOwner(pOwner), state(state) {}
+		bool operator==(const Sharding& other) const { return pSubscription == other.pSubscription && pOwner == other.pOwner && state == other.state; }
+		Subscription*	pSubscription;
+		const void*		pOwner;
+		UInt8			state; // 0 not yet subscribed, 1 shardable, 2 written by the caller thread (see Subscription::shardable)
+	};
 
 	// Media::Properties overrides
 	void onParamChange(const std::string& key, const std::string* pValue);
@@ -155,9 +196,31 @@ private:
 
 	unique<Subscription>			_pRecording;
 
+	std::map<std::string, weak<MediaMux>>	_muxes;
+	std::mutex								_mutexMuxes; // mux() can be called from shards, locked just if _shards
+	UInt64									_sequence;
+
+	// multi-threaded fan-out
+	const ThreadPool&						_threadPool;
+	std::vector<std::vector<Subscription*>>	_shards;
+	std::vector<UInt16>						_strands;
+	std::vector<Sharding>					_partition; // subscriptions state of the current partition, computed again on change
+	std::vector<Sharding>					_states; // subscriptions state of the current media, to compare with _partition
+	std::vector<Subscription*>				_unshardables; // written by the caller thread after the join
+	std::atomic<UInt8>						_pending;
+	Signal									_sharded;
+	UInt32									_shardsVersion;
+
 	// segmentation support (HLS/DASH)
 	Segments						_segments;
 	bool							_segmenting;
+
+	// GOP cache
+	std::deque<unique<Media::Base>>	_gop;
+	UInt32							_gopSize;
+	UInt32							_gopMaxDuration; // 0 if disabled
+	UInt32							_gopMaxSize;
+	UInt64							_gopKey; // sequence of the key frame starting the GOP
 };
 
 
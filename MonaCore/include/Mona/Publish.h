@@ -62,7 +62,7 @@ struct Publish : Media::Source, Server::Action, virtual Object {
 
 	struct Logger : virtual Object, Mona::Logger {
 		Logger(Publish& publish) : _publish(publish) {}
-		bool log(LOG_LEVEL level, const Path& file, long line, const std::string& message) { writeData(String::Log(Logs::LevelToString(level), file, line, message, Thread::CurrentId())); return true;	}
+		bool log(LOG_LEVEL level, const Path& file, long line, const std::string& message) { writeData(String::Log(Logs::LevelToString(level), file, line, message, Logs::CurrentThreadId(), Logs::CurrentTime())); return true;	}
 		bool dump(const  std::string& header, const UInt8* data, UInt32 size) { writeData(header, '\n', String::Data(data, size)); return true; }
 	private:
 		template<typename ...Args>
@@ -82,14 +82,19 @@ struct RTMFP : virtual Static {
 		Entity::Map<RTMFP::Group>& _groups;
 	};
 
+	/*!
+	RTMFP packet encryption, AES key schedules are expanded once by engine (see Crypto::AES).
+	/!\ Not thread-safe, copy it to use it in an other thread */
 	struct Engine : virtual Object {
-		Engine(const UInt8* key) : _context(EVP_CIPHER_CTX_new()) { memcpy(_key, key, KEY_SIZE); EVP_CIPHER_CTX_init(_context);	}
-		Engine(const Engine& engine) : _context(EVP_CIPHER_CTX_new()) { memcpy(_key, engine._key, KEY_SIZE); EVP_CIPHER_CTX_init(_context); }
-		virtual ~Engine() { EVP_CIPHER_CTX_cleanup(_context); EVP_CIPHER_CTX_free(_context); }
+		Engine(const UInt8* key) : _aes(key) {}
+		Engine(const Engine& engine) : _aes(engine._aes) {}
 
 		bool			decode(Exception& ex, Buffer& buffer, const SocketAddress& address);
 		shared<Buffer>&	encode(shared<Buffer>& pBuffer, UInt32 farId, const SocketAddress& address);
 		shared<Buffer>&	encode(shared<Buffer>& pBuffer, UInt32 farId, const std::set<SocketAddress>& addresses);
+		/*!
+		Encode a batch of packets in one multi-buffer AES pass */
+		void			encode(shared<Buffer>* pBuffers, UInt32 count, UInt32 farId, const SocketAddress& address);
 
 		static bool				Decode(Exception& ex, Buffer& buffer, const SocketAddress& address) { return Default().decode(ex, buffer, address); }
 		static shared<Buffer>&	Encode(shared<Buffer>& pBuffer, UInt32 farId, const SocketAddress& address) { return Default().encode(pBuffer, farId, address); }
@@ -97,12 +102,14 @@ struct RTMFP : virtual Static {
 
 	private:
 		void	encode(const shared<Buffer>& pBuffer, UInt32 farId);
+		/*!
+		Pad and write CRC, returns the size to encrypt after the 4 bytes of id */
+		static UInt32	Prepare(Buffer& buffer);
+		static void		Finalize(Buffer& buffer, UInt32 farId);
 
 		static Engine& Default() { thread_local Engine Engine(BIN "Adobe Systems 02"); return Engine; }
 
-		enum { KEY_SIZE = 0x10 };
-		UInt8							_key[KEY_SIZE];
-		EVP_CIPHER_CTX*					_context;
+		Crypto::AES		_aes;
 	};
 
 	struct Handshake : Packet, virtual Object {
@@ -166,6 +173,9 @@ struct RTMFP : virtual Static {
 	};
 
 	static bool				Send(Socket& socket, const Packet& packet, const SocketAddress& address);
+	/*!
+	Send count packets in one system call when possible, returns count of packets sent (or queued to be sent) */
+	static UInt32			Send(Socket& socket, const Packet* const* packets, UInt32 count, const SocketAddress& address);
 	static Buffer&			InitBuffer(shared<Buffer>& pBuffer, UInt8 marker = 0x4a);
 	static Buffer&			InitBuffer(shared<Buffer>& pBuffer, std::atomic<Int64>& initiatorTime, UInt8 marker = 0x4a);
 	static void				ComputeAsymetricKeys(const UInt8* secret, UInt16 secretSize, const UInt8* initiatorNonce, UInt16 initNonceSize, const UInt8* responderNonce, UInt16 respNonceSize, UInt8* requestKey, UInt8* responseKey);
@@ -139,6 +139,8 @@ private:
 	void	flush();
 
 	std::deque<Message>	_messages;
+	std::vector<shared<Buffer>>				_pBuffers; // packets to encode
+	std::vector<std::pair<UInt32, bool>>	_packets; // fragments and reliable of _pBuffers
 
 	// current buffer (similar to variable local, trick to avoid to pass it in flush method as params) =>
 	shared<Buffer>		_pBuffer;
@@ -62,7 +62,7 @@ private:
 
 	void				onParameters(const Parameters& parameters);
 	bool				keepalive();
-	bool				manage();
+	UInt32				manage();
 	void				flush();
 	
 
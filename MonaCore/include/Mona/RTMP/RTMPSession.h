@@ -30,7 +30,7 @@ struct RTMPSession : TCPSession, virtual Object {
 	RTMPSession(Protocol& protocol, const shared<Socket>& pSocket);
 
 private:
-	bool			manage();
+	UInt32			manage();
 	void			flush();
 	void			kill(Int32 error=0, const char* reason = NULL) override;
 	
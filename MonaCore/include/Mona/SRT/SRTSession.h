@@ -30,7 +30,7 @@ struct SRTSession : SocketSession, virtual Object {
 	void	init(SRTProtocol::Params& params);
 
 private:
-	bool	manage();
+	UInt32	manage();
 	void	kill(Int32 error = 0, const char* reason = NULL) override;
 
 	void	flush() { if (_pWriter) _pWriter->flush(); }
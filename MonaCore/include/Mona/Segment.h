@@ -51,16 +51,40 @@ struct Segment : virtual Object  {
 		std::string buffer;
 		return Path(path.parent(), path.baseName(), '.', sequence, WriteDuration(duration, buffer), '.', path.extension());
 	}
+	/*!
+	Format part name (LL-HLS) in the format NAME.S.pP with S the segment sequence and P the part index,
+	'p' makes it unreadable by ReadName to never confuse a part with a segment */
+	template<typename BufferType>
+	static BufferType& WritePartName(const std::string& name, UInt32 sequence, UInt16 part, BufferType& buffer) {
+		return String::Append(buffer, name, '.', sequence, ".p", part);
+	}
+	/*!
+	Read sequence and part index from name and returns size of basename, if file is not in a part format NAME.S.pP.EXT returns string::npos */
+	static std::size_t ReadPartName(const std::string& name, UInt32& sequence, UInt16& part);
+
+	/*!
+	Part of segment (LL-HLS), medias of the part finish at 'end' index (begins at the end of the previous part) */
+	struct Part {
+		Part(UInt32 end, UInt16 duration, bool independent) : end(end), duration(duration), independent(independent) {}
+		UInt32	end;
+		UInt16	duration;
+		bool	independent; // starts with a key frame
+	private:
+		friend struct Segment;
+		mutable std::map<std::string, Packet, String::IComparator> _muxings; // part muxed by format (see Segment::mux)
+	};
 	
-	Segment() : _lastTime(0), _discontinuous(false) {}
-	Segment(const Segment& segment) : _lastTime(segment._lastTime), 
-		_discontinuous(segment._discontinuous), _medias(segment._medias) {
+	Segment() : _lastTime(0), _discontinuous(false), _partTime(0), _partIndependent(true) {}
+	Segment(const Segment& segment) : _lastTime(segment._lastTime), _discontinuous(segment._discontinuous), _medias(segment._medias),
+		_parts(segment._parts), _partTime(segment._partTime), _partIndependent(segment._partIndependent) {
 		if (segment._pFirstTime)
 			_pFirstTime.set(*segment._pFirstTime);
 	}
-	Segment(Segment&& segment) : _lastTime(segment._lastTime), _pFirstTime(std::move(segment._pFirstTime)),
-		_discontinuous(segment._discontinuous), _medias(std::move(segment._medias)) {
+	Segment(Segment&& segment) : _lastTime(segment._lastTime), _pFirstTime(std::move(segment._pFirstTime)), _discontinuous(segment._discontinuous),
+		_medias(std::move(segment._medias)), _parts(std::move(segment._parts)), _partTime(segment._partTime), _partIndependent(segment._partIndependent) {
 		segment._discontinuous = false;
+		segment._parts.clear();
+		segment._partIndependent = true;
 	}
 
 	bool discontinuous() const { return _discontinuous; }
@@ -73,7 +97,22 @@ struct Segment : virtual Object  {
 	UInt32			time() const { return _pFirstTime ? *_pFirstTime : 0;  }
 	UInt16			duration() const { return _pFirstTime ? UInt16(Util::Distance(*_pFirstTime, _lastTime)) : 0; }
 
-	void			reset() { _discontinuous = true; _medias.clear(); _pFirstTime.reset(); }
+	void			reset() { _discontinuous = true; _medias.clear(); _pFirstTime.reset(); _parts.clear(); _partIndependent = true; }
+
+	/*!
+	Parts closed, empty if the segment is not cut in parts */
+	const std::vector<Part>& parts() const { return _parts; }
+	/*!
+	Start time of the part in progress */
+	UInt32			partTime() const { return _parts.empty() ? time() : _partTime; }
+	/*!
+	Close the part in progress at time, 'independent' qualifies the next part, returns false if nothing to close */
+	bool			addPart(UInt32 time, bool independent = false);
+	/*!
+	Part 'part' muxed in the 'subMime' container, muxed one time on first call and then shared by every viewer,
+	a part in the middle of segment is prefixed with configs and properties of the segment to stay decodable.
+	Returns a null packet if the part doesn't exist or the format is not supported */
+	const Packet&	mux(UInt16 part, const char* subMime) const;
 
 	template<typename MediaType, typename ...Args>
 	bool			add(Args&&... args) {
@@ -97,6 +136,9 @@ private:
 	unique<UInt32>						   _pFirstTime;
 	UInt32								   _lastTime;
 	bool								   _discontinuous;
+	std::vector<Part>					   _parts;
+	UInt32								   _partTime;
+	bool								   _partIndependent;
 };
 
 } // namespace Mona
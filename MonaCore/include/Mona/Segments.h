@@ -25,6 +25,7 @@ namespace Mona {
 
 struct Segments : virtual Object, Media::Target, private MediaWriter {
 	typedef Event<void(UInt16 duration)> ON(Segment);
+	typedef Event<void()>				 OnReady;
 	NULLABLE(!_maxSegments) // no real sense to use in writing/reading if _maxSegments==0
 
 	enum : UInt8 {
@@ -92,10 +93,27 @@ struct Segments : virtual Object, Media::Target, private MediaWriter {
 	UInt16		maxDuration() const { return _writer.duration(); }
 	UInt16		setMaxDuration(UInt16 value) { return _writer.setDuration(value); }
 
+	/*!
+	Part duration (LL-HLS), 0 to disable parts, otherwise the max part duration got (never less than value set) */
+	UInt16		partDuration() const { return _maxPartDuration; }
+	UInt16		setPartDuration(UInt16 value) { return _maxPartDuration = _partDuration = value; }
+
 	Segments&	operator=(std::nullptr_t) { setMaxSegments(0);  return self; }
 	/*!
 	Get segment by its sequence number, or by a relative end index if negative */
 	const Segment& operator()(Int32 sequence) const;
+	/*!
+	Get the segment owning the part 'part', can be the segment in progress (LL-HLS),
+	returns Segment::Null() if the part is not available (yet) */
+	const Segment& operator()(UInt32 sequence, UInt16 part) const;
+	/*!
+	Returns true if segment 'sequence' is written (or its part 'part' if the segment is in progress),
+	or if no more segment will come (LL-HLS blocking playlist reload) */
+	bool		   ready(UInt32 sequence, Int32 part = -1) const;
+	/*!
+	Register a one-shot event raised on next part, next segment or end of media (LL-HLS blocking requests),
+	onReady is copied so its subscriber can die without unregistering */
+	void		   wait(const OnReady& onReady) const { _readies.emplace_back(onReady); }
 	Playlist&	   to(Playlist& playlist) const;
 	
 	typedef std::deque<Segment>::const_iterator const_iterator;
@@ -134,8 +152,19 @@ private:
 		addSegment<Media::Data>(type, packet, 0, true);
 	}
 	void writeData(UInt8 track, Media::Data::Type type, const Packet& packet, const OnWrite& onWrite) override { addSegment<Media::Data>(type, packet, track); }
-	void writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, const OnWrite& onWrite) override { addSegment<Media::Audio>(tag, packet, track); }
-	void writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, const OnWrite& onWrite) override { addSegment<Media::Video>(tag, packet, track); }
+	void writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, const OnWrite& onWrite) override {
+		if (!tag.isConfig)
+			addPart(tag.time);
+		addSegment<Media::Audio>(tag, packet, track);
+	}
+	void writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, const OnWrite& onWrite) override {
+		if (tag.frame != Media::Video::FRAME_CONFIG)
+			addPart(tag.time, tag.frame == Media::Video::FRAME_KEY);
+		addSegment<Media::Video>(tag, packet, track);
+	}
+	// Cut a part if the current one reaches _partDuration
+	void addPart(UInt32 time, bool independent = false);
+	void ready();
 	template <typename MediaType, typename ...Args>
 	void addSegment(Args&&... args) {
 		bool added = _segment.add<MediaType>(std::forward<Args>(args) ...);
@@ -149,6 +178,9 @@ private:
 	Writer				_writer;
 	bool				_started;
 	UInt32				_duration;
+	UInt16				_partDuration;
+	UInt16				_maxPartDuration;
+	mutable std::vector<OnReady> _readies;
 };
 
 } // namespace Mona
@@ -25,7 +25,7 @@ details (or else see http://www.gnu.org/licenses/).
 namespace Mona {
 
 struct Server : protected ServerAPI, private Thread {
-	Server(UInt16 cores=0);
+	Server(UInt16 cores=0, UInt16 reactors=1);
 	virtual ~Server();
 
 	Parameters& start() { Parameters parameters;  return start(parameters); }// params by default
@@ -74,6 +74,9 @@ private:
 
 	void  loadIniStreams();
 
+	void  pull(Publication& publication);
+	bool  unpull(Publication& publication);
+
 	bool			run(Exception& ex, const volatile bool& requestStop);
 
 	Handler				_handler;
@@ -82,6 +85,7 @@ private:
 	std::string			_www;
 
 	std::map<shared<MediaStream>, unique<Subscription>>				_iniStreams;
+	std::map<std::string, shared<MediaStream>>						_pulls; // publications pulled from origin
 	std::multimap<const char*, Publication*, String::Comparator>	_streamPublications; // contains publications initiated by ::stream
 	std::map<shared<Media::Target>, unique<Subscription>>			_streamSubscriptions; // contains susbscriptions created by ::stream target
 	std::map<std::string, Publication>								_publications;
@@ -98,7 +98,16 @@ struct ServerAPI : virtual Object, Parameters {
 	virtual void			onUnsubscribe(Subscription& subscription, Publication& publication, Client* pClient){}
 
 protected:
-	ServerAPI(std::string& www, std::map<std::string, Publication>& publications, const Handler& handler, const Protocols& protocols, const Timer& timer, UInt16 cores=0);
+	/*!
+	Called when a first subscription arrives on a publication which is not publishing,
+	allows to pull the stream from an upstream server (origin/edge cascading) */
+	virtual void			pull(Publication& publication) {}
+	/*!
+	Called when the last subscription of a publication leaves, returns true if the publication was pulled
+	and is now released (publication can be erased, don't use it after a true return) */
+	virtual bool			unpull(Publication& publication) { return false; }
+
+	ServerAPI(std::string& www, std::map<std::string, Publication>& publications, const Handler& handler, const Protocols& protocols, const Timer& timer, UInt16 cores=0, UInt16 reactors=1);
 
 private:
 	bool					subscribe(Exception& ex, std::string& stream, Subscription& subscription, Client* pClient);
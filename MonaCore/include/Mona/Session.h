@@ -19,6 +19,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #include "Mona/Peer.h"
 #include "Mona/Protocol.h"
 #include "Mona/Logs.h"
+#include "Mona/Timer.h"
 
 namespace Mona {
 
@@ -72,9 +73,14 @@ public:
 	/*!
 	implement it to flush writers to avoid message queue exceed! */
 	virtual void flush() = 0;
+	enum {
+		MANAGE_PERIOD = 2000, // delay between two manage calls of a working session (sending queue, medias, keepalive...)
+		MANAGE_IDLE_PERIOD = Net::RTO_MAX // longest delay between two manage calls, to detect a sending congestion
+	};
 	/*!
-	Manage every 2 seconds */
-	virtual bool manage();
+	Called on its deadline, returns the delay in ms of the next one (nearest of timeout, ping, keepalive...), 0 if session dies.
+	Each session has its own deadline on the server timer, so an idle session is not touched before it is due */
+	virtual UInt32 manage();
 
 protected:
 	const bool			died; // keep it protected because just Sessions can check if session is died to delete it!
@@ -87,6 +93,14 @@ protected:
 	
 	// to fix morphing issue with kill intern call!
 	void close(Int32 error = 0, const char* reason = NULL) { peer.onClose(error, reason); } 
+	/*!
+	Advance the next manage call to delay ms at the latest, for a deadline set out of manage (blocking request...).
+	An upgraded session (WebSocket of a HTTP session) is not managed by Sessions but by the manage of its HTTP session,
+	its deadlines have to be returned by its manage (here delay is applied just if called during its manage) */
+	void manageIn(UInt32 delay);
+	/*!
+	Delay before duration is elapsed since time, 1 at least, to compute a manage deadline */
+	static UInt32 Remaining(const Time& time, UInt32 duration) { Int64 elapsed = time.elapsed(); return elapsed < duration ? UInt32(duration - elapsed) + 1 : 1; }
 private:
 	void init(Session& session);
 
@@ -96,6 +110,8 @@ private:
 	Protocol&					_protocol;
 	UInt32						_timeout;
 	Congestion					_congestion;
+	Timer::OnTimer				_onManage; // armed by Sessions
+	UInt32						_manageDelay;
 
 
 	friend struct Sessions;
@@ -22,6 +22,8 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Socket.h"
 #include "Mona/Logs.h"
 #include "Mona/Entity.h"
+#include "Mona/HashMap.h"
+#include "Mona/SlotMap.h"
 
 namespace Mona {
 
@@ -32,7 +34,10 @@ enum {
 };
 
 /*!
-Allow to manage sessions + override obsolete session on address duplication */
+Allow to manage sessions + override obsolete session on address duplication.
+Sessions are stored densely with generational ids (a stale id can't reach a new session),
+indexes by address and peer id are open addressing hash tables (consulted on every RTMFP packet).
+Each session is managed on the deadline returned by its previous manage (see Session::manage), a died session is deleted on its deadline */
 class Session;
 struct Protocol;
 struct Sessions : virtual Object {
@@ -42,57 +47,49 @@ struct Sessions : virtual Object {
 
 	template<typename SessionType = Session>
 	SessionType* findByAddress(Protocol& protocol, const SocketAddress& address) {
-		std::map<SocketAddress, Session*>& sessionsByAddress = this->sessionsByAddress(protocol);
-		const auto& it = sessionsByAddress.find(address);
-		if (it == sessionsByAddress.end())
-			return NULL;
-		return dynamic_cast<SessionType*>(it->second);
+		Session** ppSession = sessionsByAddress(protocol).find(address);
+		return ppSession ? dynamic_cast<SessionType*>(*ppSession) : NULL;
 	}
 
 
 	template<typename SessionType = Session>
 	SessionType* findByPeer(const UInt8* peerId) {
-		const auto& it = _sessionsByPeerId.find(peerId);
-		if (it == _sessionsByPeerId.end())
-			return NULL;
-		return dynamic_cast<SessionType*>(it->second);
+		Session** ppSession = _sessionsByPeerId.find(peerId);
+		return ppSession ? dynamic_cast<SessionType*>(*ppSession) : NULL;
 	}
 
 
 	template<typename SessionType = Session>
 	SessionType* find(UInt32 id) {
-		const auto& it = _sessions.find(id);
-		if (it == _sessions.end())
-			return NULL;
-		return dynamic_cast<SessionType*>(it->second);
+		Session** ppSession = _sessions.find(id);
+		return ppSession ? dynamic_cast<SessionType*>(*ppSession) : NULL;
 	}
 
 	template<typename SessionType, SESSION_OPTIONS options = SESSION_BYADDRESS, typename ...Args>
 	SessionType& create(Args&&... args) {
 		SessionType* pSession = new SessionType(std::forward<Args>(args)...);
-		if (!_freeIds.empty()) {
-			pSession->_id = _freeIds.front()-1;
-			_freeIds.pop_front();
-		} else if (!_sessions.empty())
-			pSession->_id = _sessions.rbegin()->first;
-		
-		while (!_sessions.emplace(++pSession->_id, pSession).second)
-			CRITIC("Bad computing session id, id ", pSession->_id, " already exists");
+		if (!(pSession->_id = _sessions.add(pSession)))
+			FATAL_ERROR("Sessions collection full, ", UInt32(SlotMap<Session*>::MAX_SIZE), " sessions");
 
 		pSession->_sessionsOptions = options;
 		addByPeer(*pSession);
 		addByAddress(*pSession);
+		pSession->_onManage = [this, pSession](UInt32 delay) { return manage(*pSession); };
+		pSession->api.timer.set(pSession->_onManage, SessionType::MANAGE_PERIOD);
 		DEBUG(pSession->name(), " created (client.id=", String::Hex(pSession->peer.id, Entity::SIZE),")");
 		return *pSession;
 	}
 
-	void	 manage();
-	
 private:
+	typedef HashMap<SocketAddress, Session*, SocketAddress::Hasher>			AddressIndex;
+	typedef HashMap<const UInt8*, Session*, Entity::Hasher, Entity::Equal>	PeerIndex;
 
-	std::map<SocketAddress, Session*>& sessionsByAddress(Protocol& protocol);
+	AddressIndex& sessionsByAddress(Protocol& protocol);
 
-	void    remove(const std::map<UInt32, Session*>::iterator& it, SESSION_OPTIONS options);
+	void    remove(Session& session, SESSION_OPTIONS options);
+	/*!
+	Returns the delay of the next manage, or 0 if session has been deleted */
+	UInt32	manage(Session& session);
 
 	void	addByPeer(Session& session);
 	void	removeByPeer(Session& session);
@@ -101,10 +98,9 @@ private:
 	void	removeByAddress(Session& session);
 	void	removeByAddress(const SocketAddress& address, Session& session);
 
-	std::map<UInt32, Session*>									_sessions;
-	std::deque<UInt32>											_freeIds;
-	Entity::Map<Session>										_sessionsByPeerId;
-	std::map<SocketAddress, std::map<SocketAddress, Session*>>	_sessionsByAddress[2]; // 0 - UDP, 1 - TCP
+	SlotMap<Session*>							_sessions;
+	PeerIndex									_sessionsByPeerId;
+	std::map<SocketAddress, AddressIndex>		_sessionsByAddress[2]; // 0 - UDP, 1 - TCP, by protocol address (few entries)
 };
 
 
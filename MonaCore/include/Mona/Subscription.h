@@ -20,7 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Mona.h"
 #include "Mona/Congestion.h"
-#include "Mona/MediaWriter.h"
+#include "Mona/MediaMux.h"
 
 namespace Mona {
 
@@ -32,6 +32,9 @@ Params:
 	timeout=UInt32 (0 = no timeout)
 	time=Int32 (set current time, if +Int32 or -Int32 it sets a time relative to source, and "time=source" let time of source unchanged)
 	audio|video|data=false|0|UInt8|all|true (disable|disable|track selected|all selected|allselected)
+	gop=true|false|live (with a publication GOP cache, starts on its key frame with a burst of the GOP (true by default),
+		or "live" to start on the live edge where the GOP video is just decoded, see Publication::gop),
+		a GOP replayed "live" requires a private muxing, a GOP burst is replayed by the muxing shared by the publication
 	*/
 struct Publication;
 struct Subscription : Media::Source, Media::Properties, virtual Object {
@@ -101,6 +104,13 @@ struct Subscription : Media::Source, Media::Properties, virtual Object {
 	const Tracks<Track>&			datas;
 
 	Publication*					pPublication;
+	/*!
+	Owner of the subscription (client), subscriptions of a same owner are written by the same thread (see Publication::shards) */
+	const void*						pOwner;
+	/*!
+	Returns false if a media written can end or switch the subscription (duration, from, MBR, next publication),
+	these steps change publications subscriptions and call scripting so have to stay on the publication thread (see Publication::shards) */
+	bool							shardable() const;
 	Publication*					setNext(Publication* publication);
 
 	bool							subscribed(const std::string& stream) const;
@@ -110,7 +120,11 @@ struct Subscription : Media::Source, Media::Properties, virtual Object {
 	UInt32							currentTime() const;
 	UInt32							lastTime() const;
 
-	void							setFormat(const char* format);
+	/*!
+	Set the format of the stream delivered to target as Media::Data::TYPE_MEDIA packets,
+	when subscription has no specific parameters it uses the muxing shared by the publication (see Publication::mux),
+	with sharedOnly=true target receives medias unchanged if the shared muxing can't be used (target muxes itself) */
+	void							setFormat(const char* format, bool sharedOnly = false);
 
 	const Time& streaming() const { return _streaming; }
 
@@ -123,7 +137,10 @@ struct Subscription : Media::Source, Media::Properties, virtual Object {
 	Push video packet, an empty video "config" packet can serve to keep alive a data stream (SRT/VTT subtitle stream for example)
 	Video timestamp should be monotonic (>=), but intern code should try to ignore it and let's pass packet such given */
 	void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1);
-	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0);
+	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) { writeData(type, packet, track, NULL); }
+	/*!
+	Push data packet with its serializations shared between the subscriptions (see Media::DataCache) */
+	void writeData(const Media::DataCache& data, UInt8 track = 0) { writeData(data.type, data.packet, track, &data); }
 	void writeProperties(const Media::Properties& properties);
 	void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0);
 	void flush();
@@ -138,6 +155,8 @@ private:
 	void parseFromTime(const char* time);
 	bool insideDuration(UInt32 time);
 
+	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track, const Media::DataCache* pData);
+
 	void clear(); // block father Parameters:clear call, and usefull in private!
 	void release(); // reset the full subscription as if was just created
 
@@ -153,6 +172,10 @@ private:
 	bool start(UInt8 track, const Media::Video::Tag& tag, const Packet& packet);
 
 	bool next();
+	void replay();
+
+	bool shareable() const;
+	void writeMux(const std::deque<Packet>& packets);
 
 	UInt32 scaleTime(UInt32 time, bool isConfig = true);
 
@@ -160,12 +183,20 @@ private:
 	bool writeToTarget(const TracksType& tracks, UInt8 track, const TagType& tag, const Packet& packet, bool isConfig = false) {
 		if (!_target.writeMedia(track, tag, packet, tracks.reliable || isConfig))
 			return false;
+		return flushable(packet.size());
+	}
+	bool writeToTarget(const Tracks<Track>& tracks, UInt8 track, Media::Data::Type type, const Packet& packet, const Packet& converted) {
+		if (!_target.writeData(track, type, packet, converted, tracks.reliable))
+			return false;
+		return flushable(converted.size());
+	}
+	bool flushable(UInt32 size) {
 		if (_flushable >= Net::MTU_RELIABLE_SIZE) {
 			// not call flush() for not update congestion now!
 			_flushable = 0;
 			_target.flush();
 		}
-		_flushable += packet.size();
+		_flushable += size;
 		return true;
 	}
 
@@ -252,6 +283,11 @@ private:
 		MBR_DOWN,
 		MBR_UP
 	}									_mbr;
+	enum {
+		GOP_NONE = 0,
+		GOP_BURST,
+		GOP_LIVE
+	}									_gop;
 	std::set<std::string>				_streams; // publication streams alternative = MBR!
 	Publication*						_pNextPublication;
 
@@ -269,6 +305,7 @@ private:
 	UInt32					_startTime;
 
 	unique<UInt32>			_pFromTime;
+	bool					_from; // "from" parameter set, _pFromTime is also used to start on first time
 	UInt32					_duration;
 
 	Time					_streaming;
@@ -288,6 +325,8 @@ private:
 	// For "format" parameter
 	MediaWriter::OnWrite	_onMediaWrite;
 	unique<MediaWriter>		_pMediaWriter;
+	bool					_sharedOnly;
+	shared<MediaMux>		_pMux;
 };
 
 
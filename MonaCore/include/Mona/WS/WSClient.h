@@ -11,6 +11,9 @@ namespace Mona {
 
 struct WSClient : TCPClient, Client, virtual Object {
 	typedef Event<void(DataReader& message)>	ON(Message);
+	/*!
+	WebSocket handshake done, messages sent before can be ignored by the server */
+	typedef Event<void()>						ON(Open);
 
 	WSClient(IOSocket& io, const char* name = NULL);
 	WSClient(IOSocket& io, const shared<TLS>& pTLS, const char* name = NULL);
@@ -36,6 +39,7 @@ private:
 	HTTPDecoder::OnResponse		_onResponse;
 	WSDecoder::OnMessage		_onMessage;
 	shared<const HTTP::Header>	_pHTTPHeader;
+	shared<WSDecoder>			_pWSDecoder; // keep it alive, else HTTPDecoder considers the upgrade rejected
 	std::string					_url;
 	WSWriter					_writer;
 };
@@ -31,7 +31,7 @@ struct WSSession : Session, virtual Object {
 
 	WSWriter	writer;
 
-	bool		manage();
+	UInt32		manage();
 	void		flush();
 
 private:
@@ -46,7 +46,9 @@ struct WSWriter : Writer, Media::TrackTarget, virtual Object {
 	bool			beginMedia(const std::string& name) override;
 	bool			writeAudio(const Media::Audio::Tag& tag, const Packet& packet, bool reliable) override;
 	bool			writeVideo(const Media::Video::Tag& tag, const Packet& packet, bool reliable) override;
-	bool			writeData(Media::Data::Type type, const Packet& packet, bool reliable) override;
+	bool			writeData(Media::Data::Type type, const Packet& packet, bool reliable) override { return writeData(type, packet, Packet::Null(), reliable); }
+	bool			writeData(Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable) override;
+	Media::Data::Type dataType() const override { return Media::Data::TYPE_JSON; }
 	bool			writeProperties(const Media::Properties& properties) override;
 	bool			endMedia() override;
 
@@ -30,6 +30,23 @@ Client::Client(const char* protocol, const SocketAddress& address) : // if broad
 	((IPAddress&)serverAddress.host()).set(address.host()); // Try to determine serverAddress.host with address
 }
 
+Client::Properties& Client::Properties::setParams(Filler&& filler) {
+	_filler = nullptr;
+	if (count())
+		clear();
+	else
+		onParamClear(); // change version anyway, properties are replaced
+	_filler = move(filler);
+	return self;
+}
+
+void Client::Properties::onParamInit() {
+	if (!_filler)
+		return;
+	Filler filler(move(_filler)); // before filling, setting a property calls again onParamInit
+	filler(self);
+}
+
 const string* Client::setProperty(const string& key, DataReader& reader) {
 	string value;
 	StringWriter<string> writer(value);
@@ -65,9 +65,26 @@ bool DataReader::readNext(DataWriter& writer) {
 }
 
 
+bool DataReader::skipOne(UInt8 type) {
+	if (!type)
+		type = followingType();
+	return type != END && readOne(type, DataWriter::Null());
+}
+
 UInt32 DataReader::read(DataWriter& writer, UInt32 count) {
 	bool all(count == END);
 	UInt32 results(0);
+	if (&writer == &DataWriter::Null()) {
+		// nothing to write, skip values (see skipOne)
+		while (all || count-- > 0) {
+			UInt8 type(_nextType);
+			_nextType = END;
+			if (!skipOne(type))
+				break;
+			++results;
+		}
+		return results;
+	}
 	while ((all || count-- > 0) && readNext(writer))
 		++results;
 	return results;
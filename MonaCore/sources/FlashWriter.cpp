@@ -169,9 +169,10 @@ bool FlashWriter::writeVideo(const Media::Video::Tag& tag, const Packet& packet,
 	return !closed();
 }
 
-bool FlashWriter::writeData(Media::Data::Type type, const Packet& packet, bool reliable) {
+bool FlashWriter::writeData(Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable) {
 	// Always give 0 here for time, otherwise RTMP or RTMFP can't receive the data (tested..)
-	AMFWriter& writer(write(AMF::TYPE_DATA, 0, type, packet, reliable));
+	// converted is already in dataType() serialization => no conversion by the sender, handler is still deduced from the original packet
+	AMFWriter& writer(converted ? write(AMF::TYPE_DATA, 0, dataType(), converted, reliable) : write(AMF::TYPE_DATA, 0, type, packet, reliable));
 	if (type == Media::Data::TYPE_AMF && packet && (*packet.data() == AMF::AMF0_STRING || *packet.data() == AMF::AMF0_LONG_STRING))
 		return true; // has already correct (AMF0) handler!
 	// Handler required (else can't be received in flash)
@@ -44,72 +44,214 @@ HTTP::Header::Header(const Socket& socket, bool rendezVous) : accessControlReque
 	chunked(false),
 	code(NULL),
 	forceText(false),
-	rendezVous(rendezVous) {
+	rendezVous(rendezVous),
+	_size(0) {
+	memset(_names, 0, sizeof(_names));
 }
 
-void HTTP::Header::set(const char* key, const char* value) {
-	value = setString(key, value).c_str();
-
-	if (String::ICompare(key, "content-type") == 0) {
-		mime = MIME::Read(value, subMime);
-		if (!mime)
-			WARN("Unknown Content-Type ", value);
-	} else if (String::ICompare(key, "connection") == 0) {
-		connection = ParseConnection(value);
-	} else if (String::ICompare(key, "range") == 0) {
-		range = strchr(value, '=');
-		if (range)
-			String::TrimLeft(++range);
-	} else if (String::ICompare(key, "host") == 0) {
-		host = value;
-	} else if (String::ICompare(key, "origin") == 0) {
-		origin = value;
-	} else if (String::ICompare(key, "upgrade") == 0) {
-		upgrade = value;
-	} else if (String::ICompare(key, "sec-websocket-key") == 0) {
-		secWebsocketKey = value;
-	} else if (String::ICompare(key, "sec-webSocket-accept") == 0) {
-		secWebsocketAccept = value;
-	} else if (String::ICompare(key, "transfer-encoding") == 0) {
-		String::ForEach forEach([this](UInt32 index, const char* value) {
-			if (String::ICompare(value, "chunked") == 0)
-				chunked = true;
-			return true;
-		});
-		String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
-	} else if (String::ICompare(key, "if-modified-since") == 0) {
-		Exception ex;
-		AUTO_ERROR(ifModifiedSince.update(ex, value, Date::FORMAT_HTTP), "HTTP header")
-	} else if (String::ICompare(key, "access-control-request-headers") == 0) {
+HTTP::Header::Name HTTP::Header::ParseName(const char* name, size_t size) {
+	switch (size) {
+		case 4:
+			if (String::ICompare(name, "host") == 0)
+				return NAME_HOST;
+			break;
+		case 5:
+			if (String::ICompare(name, "range") == 0)
+				return NAME_RANGE;
+			break;
+		case 6:
+			if (String::ICompare(name, "origin") == 0)
+				return NAME_ORIGIN;
+			if (String::ICompare(name, "cookie") == 0)
+				return NAME_COOKIE;
+			break;
+		case 7:
+			if (String::ICompare(name, "upgrade") == 0)
+				return NAME_UPGRADE;
+			break;
+		case 10:
+			if (String::ICompare(name, "connection") == 0)
+				return NAME_CONNECTION;
+			break;
+		case 12:
+			if (String::ICompare(name, "content-type") == 0)
+				return NAME_CONTENT_TYPE;
+			break;
+		case 13:
+			if (String::ICompare(name, "if-none-match") == 0)
+				return NAME_IF_NONE_MATCH;
+			break;
+		case 14:
+			if (String::ICompare(name, "content-length") == 0)
+				return NAME_CONTENT_LENGTH;
+			break;
+		case 15:
+			if (String::ICompare(name, "accept-encoding") == 0)
+				return NAME_ACCEPT_ENCODING;
+			break;
+		case 17:
+			if (String::ICompare(name, "transfer-encoding") == 0)
+				return NAME_TRANSFER_ENCODING;
+			if (String::ICompare(name, "if-modified-since") == 0)
+				return NAME_IF_MODIFIED_SINCE;
+			if (String::ICompare(name, "sec-websocket-key") == 0)
+				return NAME_SEC_WEBSOCKET_KEY;
+			break;
+		case 20:
+			if (String::ICompare(name, "sec-websocket-accept") == 0)
+				return NAME_SEC_WEBSOCKET_ACCEPT;
+			break;
+		case 22:
+			if (String::ICompare(name, "sec-websocket-protocol") == 0)
+				return NAME_SEC_WEBSOCKET_PROTOCOL;
+			break;
+		case 29:
+			if (String::ICompare(name, "access-control-request-method") == 0)
+				return NAME_ACCESS_CONTROL_REQUEST_METHOD;
+			break;
+		case 30:
+			if (String::ICompare(name, "access-control-request-headers") == 0)
+				return NAME_ACCESS_CONTROL_REQUEST_HEADERS;
+			break;
+		default:;
+	}
+	return NAME_UNKNOWN;
+}
+
+const char* HTTP::Header::get(const char* name) const {
+	Name id = ParseName(name, strlen(name));
+	if (id)
+		return get(id);
+	const char* value = NULL;
+	for (const Field& field : fields()) {
+		if (String::ICompare(field.name, name) == 0)
+			value = field.value; // the last one as Parameters
+	}
+	return value;
+}
+
+void HTTP::Header::hold(const Packet& buffer) {
+	if (_buffer.buffer() == buffer.buffer())
+		return;
+	if (_buffer)
+		_buffers.emplace_back(move(_buffer));
+	_buffer.set(buffer);
+}
+
+bool HTTP::Header::add(const char* key, const char* value) {
+	if (_size == FIELDS)
+		return false;
+	Name name = ParseName(key, strlen(key));
+	Field& field = _fields[_size++];
+	field.id = name;
+	field.name = key;
+	field.value = value;
+	if (name)
+		_names[name] = _size;
+
+	switch (name) {
+		case NAME_CONTENT_TYPE:
+			mime = MIME::Read(value, subMime);
+			if (!mime)
+				WARN("Unknown Content-Type ", value);
+			break;
+		case NAME_CONNECTION:
+			connection = ParseConnection(value);
+			break;
+		case NAME_RANGE:
+			range = strchr(value, '=');
+			if (range)
+				String::TrimLeft(++range);
+			break;
+		case NAME_HOST:
+			host = value;
+			break;
+		case NAME_ORIGIN:
+			origin = value;
+			break;
+		case NAME_UPGRADE:
+			upgrade = value;
+			break;
+		case NAME_SEC_WEBSOCKET_KEY:
+			secWebsocketKey = value;
+			break;
+		case NAME_SEC_WEBSOCKET_ACCEPT:
+			secWebsocketAccept = value;
+			break;
+		case NAME_TRANSFER_ENCODING: {
+			String::ForEach forEach([this](UInt32 index, const char* value) {
+				if (String::ICompare(value, "chunked") == 0)
+					chunked = true;
+				return true;
+			});
+			String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+			break;
+		}
+		case NAME_IF_MODIFIED_SINCE: {
+			Exception ex;
+			AUTO_ERROR(ifModifiedSince.update(ex, value, Date::FORMAT_HTTP), "HTTP header")
+			break;
+		}
+		case NAME_ACCESS_CONTROL_REQUEST_HEADERS:
 			accessControlRequestHeaders = value;
-	} else if (String::ICompare(key, "access-control-request-method") == 0) {
+			break;
+		case NAME_ACCESS_CONTROL_REQUEST_METHOD: {
+			String::ForEach forEach([this](UInt32 index, const char* value) {
+				Type type(ParseType(value));
+				if (!type)
+					WARN("Access-control-request-method, unknown ", value, " type")
+				else
+					accessControlRequestMethod |= type;
+				return true;
+			});
+			String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+			break;
+		}
+		default:;
+	}
+	return true;
+}
 
-		String::ForEach forEach([this](UInt32 index, const char* value) {
-			Type type(ParseType(value));
-			if (!type)
-				WARN("Access-control-request-method, unknown ", value, " type")
-			else
-				accessControlRequestMethod |= type;
-			return true;
-		});
-		String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
-
-	} else if (String::ICompare(key, "cookie") == 0) {
-		String::ForEach forEach([this](UInt32 index, const char* data) {
-			const char* value = data;
-			// trim key right
-			while (*value && *value != '=' && !isblank(*value))
+void HTTP::Header::fill(Parameters& parameters) const {
+	if (code)
+		parameters.setString("code", code);
+	else
+		parameters.setNumber("version", version);
+	if (type)
+		parameters.setString("type", TypeToString(type));
+	for (const Field& field : fields()) {
+		if (field.id == NAME_CONTENT_LENGTH && chunked)
+			continue; // no content-length with chunked transfer-encoding
+		parameters.setString(field.name, field.value);
+		if (field.id != NAME_COOKIE)
+			continue;
+		// cookies in Map!
+		const char* cookie = field.value;
+		while (*cookie) {
+			while (isblank(*cookie) || *cookie == ';')
+				++cookie;
+			const char* end = cookie;
+			while (*end && *end != ';')
+				++end;
+			const char* value = cookie;
+			while (value < end && *value != '=' && !isblank(*value))
 				++value;
-			const char *endKey = value;
-			// trim value left
-			while (*value && isblank(*++value));
-			String::Scoped scoped(endKey);
-			setString(data, value); // cookies in Map!
-			return true;
-		});
-		String::Split(value, ";", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+			string key(cookie, value - cookie);
+			// trim value
+			while (value < end && isblank(*value))
+				++value;
+			if (value < end && *value == '=')
+				++value;
+			while (value < end && isblank(*value))
+				++value;
+			const char* endValue = end;
+			while (endValue > value && isblank(*(endValue - 1)))
+				--endValue;
+			if (!key.empty())
+				parameters.setString(key, value, endValue - value);
+			cookie = end;
+		}
 	}
-	
 }
 
 const char* HTTP::ErrorToCode(Int32 error) {
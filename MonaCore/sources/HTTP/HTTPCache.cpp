@@ -0,0 +1,224 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/HTTP/HTTPCache.h"
+#include "Mona/Metrics.h"
+
+using namespace std;
+
+
+namespace Mona {
+
+static Metrics::Counter Hits("mona_http_cache_hits_total", "Static files served from the HTTP cache");
+static Metrics::Counter Misses("mona_http_cache_misses_total", "Static files cacheable requested but not in the HTTP cache (read from the disk)");
+static Metrics::Gauge	HitRate("mona_http_cache_hit_percent", "Static files served from the HTTP cache on all the cacheable ones requested (percent)", []() {
+	UInt64 hits = Hits.value();
+	UInt64 total = hits + Misses.value();
+	return total ? Int64(hits * 100 / total) : 0;
+});
+static Metrics::Gauge	Bytes("mona_http_cache_bytes", "Memory used by the HTTP cache (bytes)");
+static Metrics::Gauge	Entries("mona_http_cache_entries", "Files in the HTTP cache");
+
+static const struct {
+	const char* extension;
+	const char* name;
+} Encodings[] = { { NULL, NULL }, { "gz", "gzip" }, { "br", "br" } };
+
+
+const HTTPCache::Entry::Variant& HTTPCache::Entry::variant(const char* acceptEncoding) const {
+	if (!acceptEncoding || (!_variants[ENCODING_GZIP] && !_variants[ENCODING_BROTLI]))
+		return _variants[ENCODING_IDENTITY];
+	// Accept-Encoding: br;q=1.0, gzip;q=0.8, *;q=0.1 (just q=0 refuses an encoding)
+	bool accepted[ENCODINGS] = { true, false, false };
+	const char* cur = acceptEncoding;
+	while (*cur) {
+		while (*cur == ',' || isspace(*cur))
+			++cur;
+		const char* name = cur;
+		while (*cur && *cur != ',' && *cur != ';' && !isspace(*cur))
+			++cur;
+		size_t size = cur - name;
+		bool refused = false;
+		while (*cur && *cur != ',') {
+			if ((*cur == 'q' || *cur == 'Q') && cur[1] == '=')
+				refused = strtod(cur + 2, NULL) <= 0;
+			++cur;
+		}
+		if (refused)
+			continue;
+		for (UInt8 encoding = ENCODING_GZIP; encoding < ENCODINGS; ++encoding) {
+			if (size == strlen(Encodings[encoding].name) && String::ICompare(name, Encodings[encoding].name, size) == 0)
+				accepted[encoding] = true;
+		}
+	}
+	// prefer brotli, then gzip
+	for (UInt8 encoding = ENCODINGS - 1; encoding > ENCODING_IDENTITY; --encoding) {
+		if (accepted[encoding] && _variants[encoding])
+			return _variants[encoding];
+	}
+	return _variants[ENCODING_IDENTITY];
+}
+
+
+HTTPCache::HTTPCache(IOFile& ioFile, UInt64 maxSize) : maxSize(maxSize), _ioFile(ioFile), _size(0) {
+}
+
+string& HTTPCache::ETag(Int64 lastChange, UInt64 size, string& eTag) {
+	return String::Assign(eTag, '"', String::Format<UInt64>("%llx", UInt64(lastChange)), '-', String::Format<UInt64>("%llx", size), '"');
+}
+
+shared<const HTTPCache::Entry> HTTPCache::get(const Path& file) {
+	// out of the lock, can require a disk access if attributes are not loaded
+	Int64 lastChange = file.lastChange();
+	UInt64 size = file.size();
+	lock_guard<mutex> lock(_mutex);
+	shared<Entry>* ppEntry = _entries.find(file);
+	if (ppEntry) {
+		if ((*ppEntry)->lastChange == lastChange && (*ppEntry)->size == size) {
+			_lru.splice(_lru.begin(), _lru, (*ppEntry)->_it);
+			if (Metrics::Enabled())
+				Hits.add();
+			return *ppEntry;
+		}
+		// file changed, not again detected by the watcher
+		erase(*ppEntry);
+	}
+	if (Metrics::Enabled())
+		Misses.add();
+	return nullptr;
+}
+
+void HTTPCache::add(const Path& file, const Packet& content, MIME::Type mime, const char* subMime) {
+	if (!content || content.size() > MAX_FILE_SIZE || content.size() > maxSize)
+		return;
+	shared<Entry> pEntry(SET, file);
+	if (pEntry->size != content.size())
+		return; // file changed during reading
+	Path paths[ENCODINGS];
+	paths[ENCODING_IDENTITY] = file;
+	pEntry->_variants[ENCODING_IDENTITY].lastChange = pEntry->lastChange;
+	pEntry->_variants[ENCODING_IDENTITY].content.set(move(content)); // hold the buffer
+	// pre-compressed variants, just if smaller and more recent than the file
+	for (UInt8 encoding = ENCODING_GZIP; encoding < ENCODINGS; ++encoding) {
+		File variant(Path(file.c_str(), '.', Encodings[encoding].extension), File::MODE_READ);
+		Exception ex;
+		if (!variant.load(ex) || variant.size() >= content.size() || variant.lastChange() < pEntry->lastChange)
+			continue;
+		shared<Buffer> pBuffer(SET, UInt32(variant.size()));
+		if (variant.read(ex, pBuffer->data(), pBuffer->size()) != int(pBuffer->size()))
+			continue;
+		paths[encoding] = (const Path&)variant;
+		pEntry->_variants[encoding].lastChange = variant.lastChange();
+		pEntry->_variants[encoding].content.set(pBuffer);
+	}
+	// header lines
+	bool vary = pEntry->_variants[ENCODING_GZIP].content || pEntry->_variants[ENCODING_BROTLI].content;
+	String date(String::Date(pEntry->lastChange, Date::FORMAT_HTTP));
+	pEntry->_memory = 0;
+	for (UInt8 encoding = ENCODING_IDENTITY; encoding < ENCODINGS; ++encoding) {
+		Entry::Variant& variant = pEntry->_variants[encoding];
+		if (!variant.content)
+			continue;
+		ETag(variant.lastChange, variant.content.size(), variant.eTag);
+		shared<Buffer> pHeader(SET);
+		MIME::Write(String::Append(*pHeader, "\r\nContent-Type: "), mime, subMime);
+		String::Append(*pHeader, "\r\nContent-Length: ", variant.content.size(), "\r\nLast-Modified: ", date, "\r\nETag: ", variant.eTag);
+		if (encoding)
+			String::Append(*pHeader, "\r\nContent-Encoding: ", Encodings[encoding].name);
+		else
+			pHeader->append(EXPAND("\r\nAccept-Ranges: bytes"));
+		if (vary)
+			pHeader->append(EXPAND("\r\nVary: Accept-Encoding"));
+		variant.header.set(pHeader);
+		pEntry->_memory += variant.header.size() + variant.content.size();
+	}
+	// watch files to release entry on change, watching stops on entry release,
+	// updates are queued on the main handler so can come after the cache deletion => weak
+	weak<HTTPCache> weakThis(shared_from_this());
+	FileWatcher::OnUpdate onUpdate([weakThis](const Path& file, bool firstWatch) {
+		shared<HTTPCache> pThis(weakThis.lock());
+		if (pThis)
+			pThis->update(file);
+	});
+	for (UInt8 encoding = ENCODING_IDENTITY; encoding < ENCODINGS; ++encoding) {
+		if (!paths[encoding])
+			continue;
+		pEntry->_pWatchers[encoding].set(paths[encoding]);
+		_ioFile.watch(pEntry->_pWatchers[encoding], onUpdate);
+	}
+
+	lock_guard<mutex> lock(_mutex);
+	shared<Entry>* ppEntry = _entries.find(file);
+	if (ppEntry)
+		erase(*ppEntry); // concurrent reading or old version
+	pEntry->_it = _lru.emplace(_lru.begin(), pEntry);
+	_entries.emplace(file, pEntry);
+	_size += pEntry->_memory;
+	Bytes.add(pEntry->_memory);
+	Entries.add(1);
+	while (_size > maxSize)
+		erase(_lru.back());
+}
+
+void HTTPCache::update(const Path& file) {
+	// file or one of its variants (file.gz, file.br) has changed (or has been deleted)
+	lock_guard<mutex> lock(_mutex);
+	for (UInt8 encoding = ENCODING_IDENTITY; encoding < ENCODINGS; ++encoding) {
+		shared<Entry>* ppEntry;
+		if (encoding) {
+			if (String::ICompare(file.extension(), Encodings[encoding].extension) != 0)
+				continue;
+			ppEntry = _entries.find(string(file.c_str(), file.size() - file.extension().size() - 1));
+		} else
+			ppEntry = _entries.find(file);
+		if (!ppEntry)
+			continue;
+		const Entry::Variant& variant = (*ppEntry)->_variants[encoding];
+		// compare with the file readen, ignore the first watch of a file unchanged since its reading,
+		// or a late watch of a previous entry released
+		if (variant ? variant.lastChange == file.lastChange() : !file.exists())
+			continue;
+		DEBUG("HTTP cache, ", file, " update");
+		erase(*ppEntry);
+	}
+}
+
+void HTTPCache::remove(const Path& file) {
+	lock_guard<mutex> lock(_mutex);
+	shared<Entry>* ppEntry = _entries.find(file);
+	if (ppEntry)
+		erase(*ppEntry);
+}
+
+void HTTPCache::clear() {
+	lock_guard<mutex> lock(_mutex);
+	while (!_lru.empty())
+		erase(_lru.back());
+}
+
+void HTTPCache::erase(const shared<Entry>& pEntry) {
+	// _mutex locked by caller
+	shared<Entry> pErased(pEntry); // hold it, pEntry can be a reference to the erased element
+	_size -= pErased->_memory;
+	Bytes.add(-Int64(pErased->_memory));
+	Entries.add(-1);
+	_lru.erase(pErased->_it);
+	_entries.erase(pErased->path);
+}
+
+} // namespace Mona
@@ -129,12 +129,12 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 					if (_pHeader->chunked) {
 						_stage = CHUNKED;
 						_pHeader->progressive = true;
-						// force no content-length!
-						_pHeader->erase("content-length");
-						_length = 0;
+						_length = 0; // no content-length (see HTTP::Header::fill)
 					} else {
 						_stage = BODY;
-						_pHeader->progressive = !_pHeader->getNumber("content-length", _length = -1);
+						const char* length = _pHeader->get(HTTP::Header::NAME_CONTENT_LENGTH);
+						_length = -1;
+						_pHeader->progressive = !length || !String::ToNumber(length, _length);
 					}
 
 					bool invocation = false;
@@ -195,26 +195,27 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 				}
 
 				// KEY = VALUE
+				// null terminated in the buffer which stays hold by header (no copy, see HTTP::Header::Field)
 				char* endValue(STR buffer.data());
 				while (isblank(*--endValue));
-
-				String::Scoped scoped(++endValue);
+				*++endValue = 0;
+				_pHeader->hold(buffer);
 				if (_stage==VERSION) {
-					if (!_code) {
-						// Set request version!
+					if (!_code) // Set request version!
 						String::ToNumber(signifiant + 5, _pHeader->version);
-						_pHeader->setNumber("version", _pHeader->version);
-					} else // Set response code!
-						_pHeader->code = _pHeader->setString("code", signifiant).c_str();
+					else // Set response code!
+						_pHeader->code = signifiant;
 				} else {
-					const char* endValue(signifiant);
-					while (isblank(*--endValue)); // after the :
-					while (isblank(*--endValue)); // before the :
-					String::Scoped scoped(++endValue);
-					if(key)
-						_pHeader->set(key, signifiant);
-					else
-						_pHeader->set(signifiant, "");
+					if (key) {
+						char* endKey(STR signifiant);
+						while (isblank(*--endKey)); // after the :
+						while (isblank(*--endKey)); // before the :
+						*++endKey = 0;
+					}
+					if (!_pHeader->add(key ? key : signifiant, key ? signifiant : "")) {
+						_ex.set<Ex::Protocol>("HTTP header has too many fields (>", UInt32(HTTP::Header::FIELDS), ")");
+						break;
+					}
 					key = NULL;
 				}
 
@@ -246,7 +247,6 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 							_ex.set<Ex::Protocol>("Request disabled HTTP Rendezvous service (HTTP.RDV=false)");
 							break;
 						}
-						_pHeader->setString("type", HTTP::TypeToString(_pHeader->type));
 					}
 					signifiant = STR buffer.data() + 1;
 					_stage = PATH;
@@ -25,9 +25,9 @@ namespace Mona {
 
 
 HTTPFileSender::HTTPFileSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-	const Path& file, Parameters& properties) : HTTPSender("HTTPFileSender", pRequest, pSocket),
+	const Path& file, Parameters& properties, const shared<HTTPCache>& pCache) : HTTPSender("HTTPFileSender", pRequest, pSocket), _pCache(pCache),
 		File(file, File::MODE_READ), _properties(move(properties)), _mime(MIME::TYPE_UNKNOWN),
-		_pos(0), _step(properties.count()), _stage(0) {
+		_pos(0), _step(properties.count()), _stage(0), _rest(0), _range(false), _zeroCopy(false) {
 		_result = _properties.begin(); // do it here to get compatible _properties.begin() and not properties.begin()
 		_protocol = pSocket->isSecure() ? "https://" : "http://";
 }
@@ -39,13 +39,64 @@ bool HTTPFileSender::load(Exception& ex) {
 
 	DEBUG(peerAddress(), " GET 200 ", pRequest->path, File::name());
 	if (File::load(ex)) {
+		if (_properties.count())
+			return true;
 		/// not modified if there is no parameters file (impossible to determinate if the parameters have changed since the last request)
-		if (!_properties.count() && pRequest->ifModifiedSince >= lastChange()) {
+		string eTag;
+		HTTPCache::ETag(lastChange(), size(), eTag); // same as HTTPCache
+		const char* eTags = pRequest->get(HTTP::Header::NAME_IF_NONE_MATCH);
+		if (eTags ? (strstr(eTags, eTag.c_str()) || strcmp(eTags, "*") == 0) : pRequest->ifModifiedSince >= lastChange()) {
 			// NOT MODIFIED
 			DEBUG(peerAddress(), " GET 304 ", pRequest->path, File::name());
+			HTTP_BEGIN_HEADER(buffer())
+				HTTP_ADD_HEADER("ETag", eTag)
+			HTTP_END_HEADER
 			send(HTTP_CODE_304);
 			return false;
 		}
+		// No properties => content is the file, supports Range
+		_rest = size();
+		if (_pCache && _rest > HTTPCache::MAX_FILE_SIZE)
+			_pCache.reset(); // too big to be cached
+		HTTP_BEGIN_HEADER(buffer())
+			HTTP_ADD_HEADER("ETag", eTag)
+			HTTP_ADD_HEADER("Accept-Ranges", "bytes")
+		HTTP_END_HEADER
+		if (!pRequest->range)
+			return true;
+		// Range: bytes=first-last, bytes=first- or bytes=-suffix (just one range supported, else full content)
+		UInt64 first(0), last(_rest - 1);
+		const char* range(pRequest->range);
+		char* next;
+		if (*range == '-') {
+			UInt64 suffix = strtoull(++range, &next, 10);
+			if (suffix < _rest)
+				first = _rest - suffix;
+			else if (!suffix)
+				first = _rest; // unsatisfiable
+		} else {
+			first = strtoull(range, &next, 10);
+			if (*next != '-')
+				return true; // invalid range => ignore it
+			if (isdigit(*++next) && (last = strtoull(next, &next, 10)) >= _rest)
+				last = _rest - 1;
+		}
+		if (next == range || (*next && *next != ' ' && *next != '\r'))
+			return true; // invalid or multiple ranges => ignore it
+		if (first > last || first >= _rest) {
+			DEBUG(peerAddress(), " GET 416 ", pRequest->path, File::name(), " (bytes=", pRequest->range, ")");
+			HTTP_BEGIN_HEADER(buffer())
+				HTTP_ADD_HEADER("Content-Range", "bytes */", _rest)
+			HTTP_END_HEADER
+			send(HTTP_CODE_416);
+			return false;
+		}
+		DEBUG(peerAddress(), " GET 206 ", pRequest->path, File::name(), " (bytes=", first, '-', last, ")");
+		HTTP_BEGIN_HEADER(buffer())
+			HTTP_ADD_HEADER("Content-Range", "bytes ", first, '-', last, '/', _rest)
+		HTTP_END_HEADER
+		_rest = last - first + 1;
+		_range = reset(first);
 		return true;
 	}
 
@@ -80,8 +131,12 @@ UInt32 HTTPFileSender::decode(shared<Buffer>& pBuffer, bool end) {
 
 	UInt32 size;
 	if (!_properties.count()) {
-		size = packet.size();
-		packets.emplace_back(packet.buffer());
+		if (packet.size() >= _rest) {
+			packet.shrink(UInt32(_rest)); // range end
+			end = true;
+		}
+		_rest -= (size = packet.size());
+		packets.emplace_back(move(packet));
 	} else // properties => want parse files to replace properties!
 		size = generate(packet, packets);
 
@@ -92,10 +147,26 @@ UInt32 HTTPFileSender::decode(shared<Buffer>& pBuffer, bool end) {
 			_mime = MIME::TYPE_APPLICATION;
 			_subMime = "octet-stream";
 		}
-		if (!send(HTTP_CODE_200, _mime, _subMime, end ? size : UINT64_MAX)) {
+		if (!send(_range ? HTTP_CODE_206 : HTTP_CODE_200, _mime, _subMime, _properties.count() ? (end ? size : UINT64_MAX) : (size + _rest))) {
 			this->end(); // to avoid to read again
 			return 0;
 		}
+		// without properties the file rest can be sent without copy (sendfile), excepting if it has to be cached
+		_zeroCopy = !end && !_properties.count() && !_pCache && pRequest->type != HTTP::TYPE_HEAD && zeroCopy();
+	}
+	// CACHE
+	if (_pCache) {
+		if (!end || _pCaching) {
+			// content in several readings, copy it
+			if (!_pCaching)
+				_pCaching.set();
+			_pCaching->append(packets.front().data(), packets.front().size());
+		}
+		if (end) {
+			_pCache->add(path(), _pCaching ? Packet(_pCaching) : packets.front(), _mime, _subMime);
+			_pCaching.reset();
+			_pCache.reset();
+		}
 	}
 	// CONTENT
 	if (pRequest->type != HTTP::TYPE_HEAD) {
@@ -105,8 +176,21 @@ UInt32 HTTPFileSender::decode(shared<Buffer>& pBuffer, bool end) {
 				return 0;
 			}
 		}
-		if(!end)
-			return HTTPSender::flushing() ? 0 : 0xFFFF; // wait next!
+		if (!end) {
+			if (!_zeroCopy)
+				return HTTPSender::flushing() ? 0 : 0xFFFF; // wait next!
+			do {
+				UInt32 size = UInt32(min(_rest, UInt64(0x100000))); // 1MB by call
+				int sent = send((File&)self, size);
+				if (sent < 0) {
+					this->end(); // to avoid to read again
+					return 0;
+				}
+				_rest -= sent;
+				if (UInt32(sent) < size)
+					return 0; // wait next io.read(pFileSender, 0) on socket.onFlush
+			} while (_rest);
+		}
 	}
 	// END
 	this->end();
@@ -26,21 +26,34 @@ namespace Mona {
 HTTPMediaSender::HTTPMediaSender(const shared<const HTTP::Header>& pRequest,
 	const shared<Socket>& pSocket,
 	shared<MediaWriter>& pWriter,
-	Media::Base* pMedia) : HTTPSender("HTTPMediaSender", pRequest, pSocket), _pMedia(pMedia) {
+	Media::Base* pMedia, bool begin) : HTTPSender("HTTPMediaSender", pRequest, pSocket), _pMedia(pMedia), _begin(begin) {
 	if ((_first = (pWriter ? false : true)))
 		pWriter = MediaWriter::New(pRequest->subMime);
 	_pWriter = pWriter;
 }
 
+HTTPMediaSender::HTTPMediaSender(const shared<const HTTP::Header>& pRequest,
+	const shared<Socket>& pSocket,
+	const Packet& packet) : HTTPSender("HTTPMediaSender", pRequest, pSocket), _first(false), _begin(false), _packet(move(packet)) {
+}
+
 bool HTTPMediaSender::run() {
+	if (!_pWriter) {
+		// already muxed
+		if (_packet) {
+			send(_packet);
+			connection = HTTP::CONNECTION_KEEPALIVE;
+		}
+		return true;
+	}
 	MediaWriter::OnWrite onWrite([this](const Packet& packet) { send(packet); });
 	if (_first) {
-		// first packet streaming
-		if (send(HTTP_CODE_200, _pWriter->mime(), _pWriter->subMime(), UINT64_MAX))
-			_pWriter->beginMedia(onWrite);
+		// first packet streaming, media begins with the first packet muxed (can be already muxed)
+		send(HTTP_CODE_200, _pWriter->mime(), _pWriter->subMime(), UINT64_MAX);
 		connection = HTTP::CONNECTION_KEEPALIVE;
 	}
-	
+	if (_begin)
+		_pWriter->beginMedia(onWrite);
 	if (_pMedia) {
 		_pWriter->writeMedia(*_pMedia, onWrite);
 		connection = HTTP::CONNECTION_KEEPALIVE;
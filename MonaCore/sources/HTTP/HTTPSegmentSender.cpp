@@ -24,41 +24,78 @@ using namespace std;
 namespace Mona {
 
 HTTPSegmentSender::HTTPSegmentSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		const Path& path, const Segment& segment, Parameters& params) : _segment(segment), _path(path),
-		HTTPSender("HTTPSegmentSender", pRequest, pSocket), _subscription(self),
+		const Path& path, const Segment& segment, Parameters& params, Int32 part) : _part(part), _path(path),
+		HTTPSender("HTTPSegmentSender", pRequest, pSocket), _subscription(self), _subMime(pRequest->subMime), _mime(pRequest->mime),
+		_shared(part >= 0 && !params.count()),
 		_onWrite([this](const Packet& packet) {
 			if(!send(packet))
 				_pWriter.reset(); // connection death! Stop subscription!
 		}) {
+	if (!_mime)
+		_mime = MIME::Read(_path, _subMime);
 	_subscription.setParams(move(params));
-	_itMedia = _segment.begin();
+	update(segment);
+}
+
+void HTTPSegmentSender::update(const Segment& segment) {
+	if (!_shared)
+		_pSegment.set(segment);
+	else if (_mime) // mux the part here on the thread of segments, one time whatever the number of viewers
+		_muxed = segment.mux(UInt16(_part), _subMime);
 }
 
 
 bool HTTPSegmentSender::run() {
+	if (_shared) {
+		if (!_mime)
+			sendError(HTTP_CODE_406, "Segment part ", _path.name(), " with a non acceptable type ", _subMime);
+		else if (!_muxed)
+			sendError(HTTP_CODE_404, "Segment part ", _path.name(), " unavailable");
+		else if (send(HTTP_CODE_200, _mime, _subMime, _muxed.size()))
+			send(_muxed);
+		return true;
+	}
 	if (!_pWriter) {
-		if (_itMedia == _segment.end()) {
+		const Segment& segment = *_pSegment;
+		_itMedia = segment.begin();
+		_itEnd = segment.end();
+		if (_part >= 0) {
+			if (UInt32(_part) >= segment.parts().size()) {
+				sendError(HTTP_CODE_404, "Segment part ", _path.name(), " unavailable");
+				return true;
+			}
+			_itEnd = segment.begin() + segment.parts()[_part].end;
+			if (_part)
+				_itMedia += segment.parts()[_part - 1].end;
+		}
+		if (_itMedia == _itEnd) {
 			sendError(HTTP_CODE_404, "Segment ", _path.name(), " empty");
 			return true;
 		}
-		const char* subMime = pRequest->subMime;
-		MIME::Type mime = pRequest->mime;
-		if (!mime)
-			mime = MIME::Read(_path, subMime);
-		if (!mime) {
-			sendError(HTTP_CODE_406, "Segment ", _path.name(), " with a non acceptable type ", subMime);
+		if (!_mime) {
+			sendError(HTTP_CODE_406, "Segment ", _path.name(), " with a non acceptable type ", _subMime);
 			return true;
 		}
-		_pWriter = MediaWriter::New(subMime);
+		_pWriter = MediaWriter::New(_subMime);
 		if (!_pWriter) {
 			sendError(HTTP_CODE_501, "Segment ", _path.name(), " not supported");
 			return true;
 		}
-		send(HTTP_CODE_200, mime, subMime, UINT64_MAX);
+		send(HTTP_CODE_200, _mime, _subMime, UINT64_MAX);
+		// part in the middle of segment, write before configs and properties of the segment
+		for (auto it = segment.begin(); it != _itMedia; ++it) {
+			const Media::Base& media = **it;
+			if (!media.isConfig() && (media.type != Media::TYPE_DATA || !((const Media::Data&)media).isProperties))
+				continue;
+			_lastTime = media.time();
+			_subscription.writeMedia(media);
+			if (!_pWriter)
+				return true; // connection death!
+		}
 	}
 
 	// use subscription to support properties subscription
-	while(_itMedia != _segment.end()) {
+	while(_itMedia != _itEnd) {
 		if (HTTPSender::flushing())
 			return false;; // socket queueing, wait!
 		const Media::Base* pMedia = (_itMedia++)->get();
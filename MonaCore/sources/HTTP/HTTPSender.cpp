@@ -109,6 +109,52 @@ bool HTTPSender::send(const Packet& content) {
 	return content ? socketSend(content) : true;
 }
 
+int HTTPSender::send(File& file, UInt32 size) {
+	if (_end)
+		return -1;
+	if (pRequest->type == HTTP::TYPE_HEAD)
+		return size;
+	Exception ex;
+	int result = _pSocket->sendFile(ex, file, size);
+	if (ex || result < 0)
+		DEBUG(ex);
+	if (result >= 0)
+		return result;
+	// no shutdown required, already done by sendFile!
+	_end = true; //  end!
+	return -1;
+}
+
+bool HTTPSender::socketSend(const Packet* const* packets, UInt32 count) {
+	if (_end)
+		return false;
+	Exception ex;
+	for (UInt32 i = 0; i < count; ++i)
+		DUMP_RESPONSE(_pSocket->isSecure() ? "HTTPS" : "HTTP", packets[i]->data(), packets[i]->size(), _pSocket->peerAddress());
+	int result = _pSocket->write(ex, packets, count);
+	if (ex || result < 0)
+		DEBUG(ex);
+	if (result >= 0)
+		return true;
+	// no shutdown required, already done by write!
+	_end = true; //  end!
+	return false;
+}
+
+Buffer& HTTPSender::writeHeader(Buffer& buffer, const char* code) {
+	/// First line (HTTP/1.1 200 OK)
+	String::Append(buffer, "HTTP/1.1 ", code);
+
+	/// Date + Mona
+	String::Append(buffer, "\r\nDate: ", String::Date(Date::FORMAT_HTTP), "\r\nServer: Mona");
+
+	if (strcmp(code, HTTP_CODE_401)==0) {
+		// HTTP Auth Basic
+		String::Append(buffer, "\r\nWWW-Authenticate: Basic realm=\"", pRequest->host, '/', pRequest->path,'"');
+	}
+	return buffer;
+}
+
 bool HTTPSender::send(const char* code, MIME::Type mime, const char* subMime, UInt64 extraSize) {
 	if (_end)
 		return false;
@@ -122,16 +168,7 @@ bool HTTPSender::send(const char* code, MIME::Type mime, const char* subMime, UI
 	}
 
 	shared<Buffer> pBuffer(SET);
-	/// First line (HTTP/1.1 200 OK)
-	String::Append(*pBuffer, "HTTP/1.1 ", code);
-
-	/// Date + Mona
-	String::Append(*pBuffer, "\r\nDate: ", String::Date(Date::FORMAT_HTTP), "\r\nServer: Mona");
-
-	if (strcmp(code, HTTP_CODE_401)==0) {
-		// HTTP Auth Basic
-		String::Append(*pBuffer, "\r\nWWW-Authenticate: Basic realm=\"", pRequest->host, '/', pRequest->path,'"');
-	}
+	writeHeader(*pBuffer, code);
 
 	/// Last modified
 	const Path& path = this->path();
@@ -167,6 +204,21 @@ bool HTTPSender::send(const char* code, MIME::Type mime, const char* subMime, UI
 	} else if(code[0]>'3' || (code[0]>'1' && (code[1]!='0' || code[2] != '4')))
 		String::Append(*pBuffer, "\r\nContent-Length: ", extraSize);
 
+	return sendHeader(pBuffer, headerEnd);
+}
+
+bool HTTPSender::send(const char* code, const Packet& header, const Packet& content) {
+	if (_end)
+		return false;
+	// no extra content in _pBuffer here, just header lines (cookies)
+	const UInt8* headerEnd = _pBuffer ? (_pBuffer->data() + _pBuffer->size()) : NULL;
+	shared<Buffer> pBuffer(SET);
+	writeHeader(*pBuffer, code).append(header.data(), header.size());
+	_chunked = false;
+	return sendHeader(pBuffer, headerEnd, content);
+}
+
+bool HTTPSender::sendHeader(shared<Buffer>& pBuffer, const UInt8* headerEnd, const Packet& content) {
 	/// Connection type, same than request!
 	if (connection&HTTP::CONNECTION_KEEPALIVE) {
 		String::Append(*pBuffer, "\r\nConnection: keep-alive");
@@ -177,6 +229,7 @@ bool HTTPSender::send(const char* code, MIME::Type mime, const char* subMime, UI
 	else
 		String::Append(*pBuffer, "\r\nConnection: close");
 
+	const Path& path = this->path();
 	if (crossOriginIsolated) {
 		if (String::ICompare(path.extension(), "html") == 0)
 			String::Append(*pBuffer, "\r\nCross-Origin-Opener-Policy: same-origin");
@@ -188,11 +241,20 @@ bool HTTPSender::send(const char* code, MIME::Type mime, const char* subMime, UI
 	if (pRequest->origin && String::ICompare(pRequest->origin, pRequest->host) != 0)
 		String::Append(*pBuffer, "\r\nAccess-Control-Allow-Origin: ", pRequest->origin);
 
+	// gather header, extra header lines (with extra content) and content in one write
+	Packet packets[3];
+	const Packet* gathering[3];
+	UInt8 count(0);
+	if (!headerEnd)
+		String::Append(*pBuffer, "\r\n\r\n"); // no _pBuffer
+	packets[count++].set(pBuffer);
 	if (headerEnd)
-		return socketSend(Packet(pBuffer)) && socketSend(pRequest->type == HTTP::TYPE_HEAD ? Packet(_pBuffer, _pBuffer->data(), headerEnd - _pBuffer->data()) : Packet(_pBuffer));
-	// no _pBuffer
-	String::Append(*pBuffer, "\r\n\r\n");
-	return socketSend(Packet(pBuffer));
+		packets[count++].set(_pBuffer, _pBuffer->data(), UInt32((pRequest->type == HTTP::TYPE_HEAD ? headerEnd : _pBuffer->data() + _pBuffer->size()) - _pBuffer->data()));
+	if (content && pRequest->type != HTTP::TYPE_HEAD)
+		packets[count++].set(content);
+	for (UInt8 i = 0; i < count; ++i)
+		gathering[i] = &packets[i];
+	return socketSend(gathering, count);
 }
 
 
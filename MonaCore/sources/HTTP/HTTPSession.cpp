@@ -23,6 +23,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/ByteReader.h"
 #include "Mona/SplitReader.h"
 #include "Mona/WS/WSSession.h"
+#include "Mona/Metrics.h"
 
 
 using namespace std;
@@ -56,8 +57,9 @@ HTTPSession::HTTPSession(Protocol& protocol, const shared<Socket>& pSocket) : TC
 				peer.setQuery(request->query.c_str());
 			}
 			peer.setServerAddress(request->host);
-			// properties = version + headers + cookies
-			peer.properties().setParams(move(request));
+			// properties = version + headers + cookies, materialized just on first access
+			shared<const HTTP::Header> pHeader(request);
+			peer.properties().setParams([pHeader](Parameters& properties) { pHeader->fill(properties); });
 
 			Exception ex;
 			bool exToLog = false;
@@ -79,10 +81,9 @@ HTTPSession::HTTPSession(Protocol& protocol, const shared<Socket>& pSocket) : TC
 							// Create WSSession
 							HTTP_BEGIN_HEADER(_pWriter->writeRaw(HTTP_CODE_101)) // "101 Switching Protocols"
 								HTTP_ADD_HEADER("Upgrade", "WebSocket")
-								string protocols;
-								if (peer.properties().getString("sec-websocket-protocol", protocols)) {
-									String::Append(__writer, "Sec-WebSocket-Protocol: ", protocols, "\r\n");
-								}
+								const char* protocols = request->get(HTTP::Header::NAME_SEC_WEBSOCKET_PROTOCOL);
+								if (protocols)
+									HTTP_ADD_HEADER("Sec-WebSocket-Protocol", protocols)
 							WS::WriteKey(__writer.write(EXPAND("Sec-WebSocket-Accept: ")), request->secWebsocketKey).write("\r\n");
 							HTTP_END_HEADER
 						} else {
@@ -180,6 +181,7 @@ HTTPSession::HTTPSession(Protocol& protocol, const shared<Socket>& pSocket) : TC
 			flush();
 	}) {
 
+	_onSegmentsReady = [this]() { unblock(); };
 
 	_fileWriter.onError = [this](const Exception& ex) {
 		DEBUG(name(), ' ', ex);
@@ -222,6 +224,7 @@ void HTTPSession::onParameters(const Parameters& parameters) {
 	if (_pUpgradeSession)
 		return _pUpgradeSession->onParameters(parameters);
 	parameters.getBoolean("crossOriginIsolated", _pWriter->crossOriginIsolated = false);
+	_pWriter->pCache = protocol<HTTProtocol>().pCache;
 	_index.clear(); // default value
 	_indexDirectory = true; // default value
 	if (parameters.getString("index", _index)) {
@@ -235,9 +238,9 @@ void HTTPSession::onParameters(const Parameters& parameters) {
 	}
 }
 
-bool HTTPSession::manage() {
+UInt32 HTTPSession::manage() {
 	if (_pUpgradeSession)
-		return _pUpgradeSession->manage();
+		return _pUpgradeSession->manage(); // deadlines of the WebSocket session are the ones of this session
 
 	UInt32 timeout = this->timeout;
 	// if publication set timeoutPublication!
@@ -250,15 +253,24 @@ bool HTTPSession::manage() {
 	else if ((_pSubscription && _pSubscription->streaming()) || _pWriter->answering() || !self->sendTime().isElapsed(timeout))
 		(UInt32&)this->timeout = 0;
 		
-	if (!TCPSession::manage())
-		return false;
+	UInt32 delay = TCPSession::manage();
+	if (!delay)
+		return 0;
+
+	// LL-HLS blocking request, release it after 3 target durations
+	if (_pBlocking) {
+		if (_pBlocking->time.isElapsed(_pBlocking->timeout))
+			unblock(true);
+		else
+			delay = min(delay, Remaining(_pBlocking->time, _pBlocking->timeout));
+	}
 	
 	// check subscription
 	if (_pSubscription) {
 		if (!this->timeout && _pSubscription->streaming().isElapsed(timeout)) { // do just if timeout has been cancelled! (otherwise timeout is managed by session class)
 			INFO(name(), ' ', "Timeout connection");
 			kill(ERROR_IDLE);
-			return false;
+			return 0;
 		}
 		switch (_pSubscription->ejected()) {
 			case Subscription::EJECTED_NONE:
@@ -268,10 +280,14 @@ bool HTTPSession::manage() {
 			case Subscription::EJECTED_ERROR: //  HTTPWriter error, error already written!
 				unsubscribe();
 		}
-	}
+		delay = min(delay, UInt32(MANAGE_PERIOD));
+	} else if (_pPublication || _pWriter->answering())
+		delay = min(delay, UInt32(MANAGE_PERIOD)); // flush
+	else if (!this->timeout && timeout)
+		delay = min(delay, Remaining(self->sendTime(), timeout)); // timeout cancelled by a recent response
 
 	(UInt32&)this->timeout = timeout;
-	return true;
+	return delay;
 }
 
 void HTTPSession::flush() {
@@ -307,6 +323,8 @@ void HTTPSession::kill(Int32 error, const char* reason){
 	// release events before _pWriter close to avoid a crash on _pWriter access
 	_fileWriter.onFlush = nullptr;
 	_fileWriter.onError = nullptr;
+	_onSegmentsReady = nullptr;
+	_pBlocking.reset(); // no more deferred response
 
 	// close writer (flush)
 	_pWriter->close(error, reason);
@@ -318,6 +336,45 @@ void HTTPSession::kill(Int32 error, const char* reason){
 	_pWriter.reset();
 }
 
+const Segments* HTTPSession::segments(const string& publication) {
+	const auto& it = api.publications().find(publication);
+	if (it != api.publications().end())
+		return &it->second.segments;
+	// search in resources, maybe segments of one old publication
+	return api.resources.use<Segments>(publication);
+}
+
+HTTPSession::Blocking& HTTPSession::block(const string& publication, const Segments& segments, UInt32 sequence, Int32 part) {
+	unblock(true); // one blocking request at a time
+	// timeout of 3 target durations
+	_pBlocking.set(publication, sequence, part, 3 * ((segments.maxDuration() + 500) / 1000) * 1000);
+	manageIn(_pBlocking->timeout + 1); // release it on time (see manage)
+	segments.wait(_onSegmentsReady);
+	return *_pBlocking;
+}
+
+bool HTTPSession::unblock(bool force) {
+	if (!_pBlocking)
+		return true;
+	const Segments* pSegments = segments(_pBlocking->publication);
+	if (pSegments) {
+		if (!force && *pSegments) {
+			if (_pBlocking->pPlaylist ? !pSegments->ready(_pBlocking->sequence, _pBlocking->part) :
+				(!(*pSegments)(_pBlocking->sequence, UInt16(_pBlocking->part)) && !pSegments->ready(_pBlocking->sequence))) {
+				pSegments->wait(_onSegmentsReady);
+				return false;
+			}
+		}
+		if (_pBlocking->pPlaylist)
+			_pBlocking->pPlaylist->update(*pSegments);
+		else if (_pBlocking->pPart)
+			_pBlocking->pPart->update((*pSegments)(_pBlocking->sequence, UInt16(_pBlocking->part))); // if always unavailable => 404
+	}
+	_pBlocking.reset();
+	_pWriter->flush();
+	return true;
+}
+
 void HTTPSession::subscribe(Exception& ex, const string& stream) {
 	if(!_pSubscription)
 		_pSubscription = new Subscription(*_pWriter);
@@ -363,6 +420,15 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 	
 	Path& file(request.file);
 
+	// Metrics of the server, /metrics in Prometheus format and /metrics.json
+	if (Metrics::Enabled() && !peer.path.length() && String::ICompare(file.baseName(), "metrics") == 0 && (file.extension().empty() || String::ICompare(file.extension(), "json") == 0)) {
+		bool json = !file.extension().empty();
+		shared<Buffer> pBuffer(SET);
+		Metrics::Write(*pBuffer, json ? Metrics::FORMAT_JSON : Metrics::FORMAT_PROMETHEUS);
+		_pWriter->writeResponse(json ? MIME::TYPE_APPLICATION : MIME::TYPE_TEXT, json ? "json" : "plain; version=0.0.4", Packet(pBuffer));
+		return true;
+	}
+
 	// Priority on client method
 	if (file.extension().empty() && invoke(ex, request, parameters)) // can be method if not a file (can be a folder)
 		return true;
@@ -411,6 +477,8 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 			}
 			// LIVE SUBSCRIPTION?
 			if (file.exists()) {
+				if (!isPlaylist)
+					fileProperties.clear(); // media file, no properties to replace => Range and zero-copy sending
 				_pWriter->writeFile(file, fileProperties); // VOD
 				return true;
 			}
@@ -441,8 +509,12 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 			// - media => search if it's a segment, otherwise attempt a subscription (wait publication)
 			Int32 sequence;
 			UInt16 duration = 0;
+			Int32 part = -1;
+			UInt16 index;
 			size_t size;
-			if (isPlaylist || (size = Segment::ReadName(file.baseName(), (UInt32&)sequence, duration)) != string::npos) {
+			if (!isPlaylist && (size = Segment::ReadPartName(file.baseName(), (UInt32&)sequence, index)) != string::npos)
+				part = index; // LL-HLS part NAME.S.pP
+			if (isPlaylist || part >= 0 || (size = Segment::ReadName(file.baseName(), (UInt32&)sequence, duration)) != string::npos) {
 
 				string publication = file.baseName();
 				if (!isPlaylist)
@@ -467,7 +539,36 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 							Parameters params;
 							MapWriter<Parameters> writeParams(params);
 							parameters.read(writeParams);
-							_pWriter->writePlaylist(file, *pSegments, params.getString("format", "ts"));
+							// LL-HLS blocking playlist reload
+							UInt32 msn;
+							bool blocking = params.getNumber("_HLS_msn", msn);
+							if (params.getNumber("_HLS_part", part) && !blocking) {
+								ex.set<Ex::Protocol>("_HLS_part parameter without _HLS_msn");
+								return false;
+							}
+							if (blocking && msn > (pSegments->sequence() + pSegments->count() + 1)) {
+								ex.set<Ex::Protocol>("_HLS_msn ", msn, " too far of the last segment of publication ", publication);
+								return false;
+							}
+							shared<HTTPPlaylistSender> pSender = _pWriter->writePlaylist(file, *pSegments, params.getString("format", "ts"));
+							if (blocking && pSender && !pSegments->ready(msn, part))
+								block(publication, *pSegments, msn, part).pPlaylist = move(pSender);
+							return true;
+						}
+
+						if (part >= 0) {
+							// LL-HLS part, wait it if in progress (preload hint)
+							const Segment& segment = (*pSegments)(sequence, UInt16(part));
+							if (!segment && (pSegments->ready(sequence) || UInt32(sequence) > (pSegments->sequence() + pSegments->count() + 1))) {
+								ex.set<Ex::Unfound>("Part ", part, " of segment ", sequence, " of publication ", publication, " unavailable");
+								return false;
+							}
+							Parameters params;
+							MapWriter<Parameters> writeParams(params);
+							parameters.read(writeParams);
+							shared<HTTPSegmentSender> pSender = _pWriter->writeSegment(file, segment, params, part);
+							if (!segment && pSender)
+								block(publication, *pSegments, sequence, part).pPart = move(pSender);
 							return true;
 						}
 
@@ -519,6 +620,8 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 	
 			}
 			subscribe(ex, file.baseName());
+			if (_pSubscription) // use if possible the muxing shared by the publication
+				_pSubscription->setFormat(request->subMime, true);
 			return true;
 		}
 	}
@@ -600,7 +703,7 @@ bool HTTPSession::invoke(Exception& ex, HTTP::Request& request, QueryReader& par
 	if (!name && !request.file.isFolder())
 		name = request.file.name().c_str();
 
-	bool hasContent = request->hasKey("content-length");
+	bool hasContent = request->get(HTTP::Header::NAME_CONTENT_LENGTH) ? true : false;
 	string method;
 	Media::Data::Type type = Media::Data::ToType(request->subMime);
 	DataReader* pReader = hasContent ? Media::Data::NewReader<ByteReader>(type, request).release() : &parameters;
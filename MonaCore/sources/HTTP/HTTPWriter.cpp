@@ -78,7 +78,7 @@ private:
 };
 
 
-HTTPWriter::HTTPWriter(TCPSession& session) : _requestCount(0), _requesting(false), _session(session), crossOriginIsolated(false),
+HTTPWriter::HTTPWriter(TCPSession& session) : _requestCount(0), _requesting(false), _mediaBegun(false), _session(session), crossOriginIsolated(false),
 	_onSenderEnd([&]() {
 #if !defined(_DEBUG)
 		if (_flushings.empty()) {
@@ -148,7 +148,7 @@ void HTTPWriter::flush() {
 		// send or resend
 		if (pSender.unique() && *pSender) {
 			if (pSender->isFile())
-				_session.api.ioFile.read(static_pointer_cast<HTTPFileSender>(pSender));
+				_session.api.ioFile.read(static_pointer_cast<HTTPFileSender>(pSender), static_pointer_cast<HTTPFileSender>(pSender)->readSize());
 			else
 				_session.send(pSender);
 		}
@@ -202,7 +202,16 @@ void HTTPWriter::writeSetCookie(const string& key, DataReader& reader) {
 
 void HTTPWriter::writeFile(const Path& file, Parameters& properties) {
 	if (!file.isFolder()) {
-		shared<HTTPFileSender> pFileSender = newSender<HTTPFileSender>(true, file, properties);
+		// file without properties to replace and without Range request => cacheable
+		bool cacheable = pCache && _pRequest && !properties.count() && !_pRequest->range && !_pRequest->forceText;
+		if (cacheable) {
+			shared<const HTTPCache::Entry> pEntry = pCache->get(file);
+			if (pEntry) {
+				newSender<HTTPCacheSender>(true, pEntry);
+				return;
+			}
+		}
+		shared<HTTPFileSender> pFileSender = newSender<HTTPFileSender>(true, file, properties, cacheable ? pCache : nullptr);
 		if (!pFileSender)
 			return;
 		pFileSender->onEnd = _onSenderEnd;
@@ -211,10 +220,18 @@ void HTTPWriter::writeFile(const Path& file, Parameters& properties) {
 		newSender<HTTPFolderSender>(true, file, properties);
 }
 
-void HTTPWriter::writeSegment(const Path& path, const Segment& segment, Parameters& params) {
-	shared<HTTPSegmentSender> pSender = newSender<HTTPSegmentSender>(true, path, segment, params);
+shared<HTTPSegmentSender> HTTPWriter::writeSegment(const Path& path, const Segment& segment, Parameters& params, Int32 part) {
+	shared<HTTPSegmentSender> pSender = newSender<HTTPSegmentSender>(true, path, segment, params, part);
 	if (pSender)
 		pSender->onEnd = _onSenderEnd;
+	return pSender;
+}
+
+shared<HTTPPlaylistSender> HTTPWriter::writePlaylist(const Path& path, const Segments& segments, string&& format) {
+	shared<HTTPPlaylistSender> pSender = newSender<HTTPPlaylistSender>(true, path, segments, move(format));
+	if (pSender)
+		pSender->onEnd = _onSenderEnd; // wait its end to allow a deferred sending
+	return pSender;
 }
 
 DataWriter& HTTPWriter::writeMessage(bool isResponse) {
@@ -231,6 +248,10 @@ DataWriter& HTTPWriter::writeResponse(const char* subMime) {
 	return pSender ? pSender->writer() : DataWriter::Null();
 }
 
+void HTTPWriter::writeResponse(MIME::Type mime, const char* subMime, const Packet& packet) {
+	newSender<HTTPDataSender>(true, HTTP_CODE_200, mime, subMime, packet);
+}
+
 void HTTPWriter::writeRaw(DataReader& arguments, const Packet& packet) {
 	// Take the entiere control
 	// first parameter is HTTP headers in a object view
@@ -262,10 +283,26 @@ bool HTTPWriter::beginMedia(const string& name) {
 	return false;
 }
 
+bool HTTPWriter::writeMedia(Media::Base* pMedia) {
+	bool begin = !_mediaBegun;
+	_mediaBegun = true;
+	return newSender<HTTPMediaSender>(_pMediaWriter, pMedia, begin) ? true : false;
+}
+
+bool HTTPWriter::writeData(UInt8 track, Media::Data::Type type, const Packet& packet, bool reliable) {
+	if (type == Media::Data::TYPE_MEDIA && !_mediaBegun)
+		return newSender<HTTPMediaSender>(packet) ? true : false; // already muxed (shared muxing)
+	return writeMedia(new Media::Data(type, packet, track));
+}
+
 bool HTTPWriter::endMedia() {
 	if (!_pMediaWriter)
 		return true;
-	newSender<HTTPMediaSender>(_pMediaWriter); // End media => Close socket
+	if (_mediaBegun)
+		newSender<HTTPMediaSender>(_pMediaWriter); // End media => Close socket
+	else
+		newSender<HTTPMediaSender>(Packet::Null()); // Close socket
+	_mediaBegun = false;
 	return false;
 }
 
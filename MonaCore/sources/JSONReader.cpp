@@ -19,14 +19,14 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/JSONReader.h"
 #include "Mona/Logs.h"
 #include "Mona/Util.h"
+#include "Mona/Bytes.h"
 #include <sstream>
 
 using namespace std;
 
 namespace Mona {
 
-
-JSONReader::JSONReader(const Packet& packet) : _pos(reader.position()), DataReader(packet), _isValid(false) {
+JSONReader::JSONReader(const Packet& packet, UInt32 tapeMinSize) : _pos(reader.position()), DataReader(packet), _isValid(false), _positions(NULL), _jumps(NULL), _cursor(0), _end(0) {
 
 	// check first '[' and last ']' or '{ and '}'
 
@@ -56,8 +56,113 @@ JSONReader::JSONReader(const Packet& packet) : _pos(reader.position()), DataRead
 				}
 			} else if (*end == '}')
 				_isValid = true;
-			return;
+			break;
+		}
+	}
+	if (_isValid && size() >= tapeMinSize)
+		index();
+}
+
+void JSONReader::reset() {
+	DataReader::reset();
+	reader.reset(_pos);
+	if (_positions)
+		_cursor = data()[_positions[0]] == '[' ? 1 : 0;
+}
+
+void JSONReader::index() {
+	UInt32 count;
+	_tape.resize(size() * sizeof(UInt32), false);
+	if (!Bytes::IndexJSON(data(), size(), (UInt32*)_tape.data(), count))
+		return; // string not terminated
+	_tape.resize(2 * count * sizeof(UInt32));
+	UInt32* positions((UInt32*)_tape.data());
+	UInt32* jumps(positions + count);
+
+	// validate the grammar, jumps of opened containers link to their parent container until to be closed
+	const char* json(STR data());
+	enum {
+		VALUE,
+		FIRST_VALUE,
+		KEY,
+		FIRST_KEY,
+		COLON,
+		SEPARATOR
+	} expected(VALUE);
+	UInt32 parent(0xFFFFFFFF);
+	UInt32 i;
+	for (i = 0; i < count; ++i) {
+		char c(json[positions[i]]);
+		switch (expected) {
+			case FIRST_VALUE:
+				if (c == ']')
+					break; // empty array
+			case VALUE:
+				if (c == '{' || c == '[') {
+					jumps[i] = parent;
+					parent = i;
+					expected = c == '{' ? FIRST_KEY : FIRST_VALUE;
+					continue;
+				}
+				if (c == ']' || c == '}' || c == ':' || c == ',')
+					return;
+				if (c == '"')
+					++i; // the following structural is the closing quote
+				expected = SEPARATOR;
+				continue;
+			case FIRST_KEY:
+				if (c == '}')
+					break; // empty object
+			case KEY:
+				if (c != '"')
+					return;
+				++i;
+				expected = COLON;
+				continue;
+			case COLON:
+				if (c != ':')
+					return;
+				expected = VALUE;
+				continue;
+			default: // SEPARATOR
+				if (c == ',') {
+					expected = json[positions[parent]] == '{' ? KEY : VALUE;
+					continue;
+				}
+				if (c != ']' && c != '}')
+					return;
 		}
+		// close the parent container
+		if ((c == '}') != (json[positions[parent]] == '{'))
+			return;
+		UInt32 container(parent);
+		parent = jumps[container];
+		jumps[container] = i + 1;
+		if (parent == 0xFFFFFFFF)
+			break; // root closed
+		expected = SEPARATOR;
+	}
+	if ((i + 1) != count)
+		return; // root not closed or values after
+
+	_positions = positions;
+	_jumps = jumps;
+	if (json[positions[0]] == '[') {
+		_cursor = 1;
+		_end = count - 1;
+	} else
+		_end = count;
+}
+
+UInt32 JSONReader::jump(UInt32 index) const {
+	switch (data()[_positions[index]]) {
+		case '{':
+		case '[':
+			return _jumps[index];
+		case '"':
+			return index + 2;
+		default:
+			return index + 1;
 	}
 }
 
@@ -65,6 +170,8 @@ JSONReader::JSONReader(const Packet& packet) : _pos(reader.position()), DataRead
 UInt8 JSONReader::followingType() {
 	if (!_isValid)
 		return END;
+	if (_positions)
+		return followingTapeType();
 
 	const UInt8* cur = current();
 	if(!cur)
@@ -120,7 +227,10 @@ UInt8 JSONReader::followingType() {
 	} while (available && *cur != ',' && *cur != '}' && *cur != ']');
 
 	_size = String::TrimRight(value, _size);
+	return valueType(value);
+}
 
+UInt8 JSONReader::valueType(const char* value) {
 	if (_size == 4) {
 		if (String::ICompare(value, _size, "true") == 0) {
 			_number = 1;
@@ -137,12 +247,73 @@ UInt8 JSONReader::followingType() {
 
 	ERROR("JSON malformed, unknown ",String::Data(value,_size)," value");
 	reader.next(reader.available());
+	_cursor = _end;
 	return END;
 }
 
+UInt8 JSONReader::followingTapeType() {
+	if (_cursor >= _end) {
+		reader.next(reader.available());
+		return END;
+	}
+	const char* json(STR data());
+	if (json[_positions[_cursor]] == ',')
+		++_cursor;
+	UInt32 position(_positions[_cursor]);
+	reader.reset(position);
+
+	switch (json[position]) {
+		case '{':
+			return OBJECT;
+		case '[':
+			return ARRAY;
+		case '"': {
+			_size = _positions[_cursor + 1] - position - 1;
+			_cursor += 2;
+			Exception ex;
+			if (_date.update(ex, json + position + 1, _size))
+				return DATE;
+			return STRING;
+		}
+	}
+	// a value is always followed by a separator or a closing marker
+	_size = String::TrimRight(json + position, _positions[++_cursor] - position);
+	return valueType(json + position);
+}
+
+bool JSONReader::skipOne(UInt8 type) {
+	if (!_positions)
+		return DataReader::skipOne(type);
+	if (!type) {
+		// jump without computing the type
+		if (_cursor >= _end) {
+			reader.next(reader.available());
+			return false;
+		}
+		if (data()[_positions[_cursor]] == ',')
+			++_cursor;
+	} else if (type != OBJECT && type != ARRAY)
+		return readOne(type, DataWriter::Null()); // already parsed by followingType
+	UInt32 position(_positions[_cursor]);
+	_cursor = jump(_cursor);
+	if (data()[position] == '{' || data()[position] == '[' || data()[position] == '"')
+		position = _positions[_cursor - 1] + 1;
+	else
+		position += String::TrimRight(STR data() + position, _positions[_cursor] - position);
+	reader.reset(position);
+	return true;
+}
+
 
 bool JSONReader::readOne(UInt8 type, DataWriter& writer) {
 
+	if (_positions) {
+		if (type == ARRAY)
+			return readTapeArray(writer);
+		if (type == OBJECT)
+			return readTapeObject(writer);
+	}
+
 	switch (type) {
 
 		case STRING:
@@ -299,6 +470,112 @@ bool JSONReader::readOne(UInt8 type, DataWriter& writer) {
 	return true;
 }
 
+bool JSONReader::readTapeArray(DataWriter& writer) {
+	const char* json(STR data());
+	UInt32 array(_cursor++); // skip [
+	// count number of elements with jumps
+	UInt32 count(0);
+	for (UInt32 i = _cursor; json[_positions[i]] != ']'; ++count) {
+		if (json[_positions[i = jump(i)]] == ',')
+			++i;
+	}
+	// write array
+	writer.beginArray(count);
+	while (count-- > 0) {
+		if (!readNext(writer))
+			writer.writeNull();
+	}
+	writer.endArray();
+	// skip ] (if not interrupted by a malformed value)
+	if (_cursor < _end) {
+		_cursor = _jumps[array];
+		reader.reset(_positions[_cursor - 1] + 1);
+	}
+	return true;
+}
+
+bool JSONReader::readTapeObject(DataWriter& writer) {
+	const char* json(STR data());
+	UInt32 object(_cursor++); // skip {
+
+	bool started(false);
+	DataWriter* pWriter = &writer;
+
+	while (_cursor < _end && json[_positions[_cursor]] != '}') {
+
+		if (started)
+			++_cursor; // skip comma ,
+		else if (json[_positions[_cursor]] != '"') {
+			// comma after a __bin property
+			ERROR("JSON malformed, marker \" unfound");
+			reader.next(reader.available());
+			_cursor = _end;
+			return false;
+		}
+
+		const char* name(json + _positions[_cursor] + 1);
+		_size = _positions[_cursor + 1] - _positions[_cursor] - 1;
+		_cursor += 3; // skip "string":
+
+		// write key
+		if (!started) {
+			UInt32 position(_positions[_cursor]);
+			if (json[position] == '"') {
+				const char* value(json + position + 1);
+				UInt32 size(_positions[_cursor + 1] - position - 1);
+
+				if (_size == 6 && String::ICompare(name, EXPAND("__type")) == 0) {
+					_cursor += 2; // skip "string"
+					String::Scoped scoped(value + size);
+					pWriter->beginObject(value);
+					started = true;
+					continue;
+				}
+
+				if (_size == 5 && String::ICompare(name, EXPAND("__bin")) == 0) {
+					_cursor += 2; // skip "data"
+					shared<Buffer> pBuffer(SET);
+					if (!Util::FromBase64(BIN value, size, *pBuffer)) {
+						WARN("JSON raw ", String::Data(name, _size), " data must be in a base64 encoding format to be acceptable");
+						pWriter->writeByte(Packet(self, BIN value, size));
+					} else
+						pWriter->writeByte(Packet(pBuffer));
+					pWriter = &DataWriter::Null();
+					continue;
+				}
+			}
+
+			pWriter->beginObject();
+			started = true;
+		}
+
+		{
+			String::Scoped scoped(name + _size);
+			pWriter->writePropertyName(name);
+		}
+
+		// write value
+		if (!readNext(*pWriter)) {
+			// here necessary position is at the end of the packet
+			pWriter->writeNull();
+			pWriter->endObject();
+			return true;
+		}
+	}
+
+	if (!started)
+		pWriter->beginObject();
+	pWriter->endObject();
+
+	if (_cursor < _end) {
+		_cursor = _jumps[object]; // skip }
+		reader.reset(_positions[_cursor - 1] + 1);
+	} else
+		ERROR("JSON malformed, no object } end marker");
+
+	return true;
+}
+
 const char* JSONReader::jumpToString(UInt32& size) {
 	if (!jumpTo('"'))
 		return NULL;
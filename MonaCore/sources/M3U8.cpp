@@ -27,6 +27,21 @@ namespace Mona {
 
 #define WRITE_EXTINF(BUFFER, DURATION) String::Append(BUFFER, "\n#EXTINF:", String::Format<double>("%.3f", DURATION / 1000.0), ",\n")
 
+typedef vector<Playlist::Part>::const_iterator PartIterator;
+
+static PartIterator WriteParts(const Playlist& playlist, UInt32 sequence, PartIterator itPart, Buffer& buffer) {
+	// LL-HLS, parts of segment 'sequence'
+	for (; itPart != playlist.parts().end() && itPart->sequence <= sequence; ++itPart) {
+		if (itPart->sequence < sequence)
+			continue;
+		String::Append(buffer, "\n#EXT-X-PART:DURATION=", String::Format<double>("%.3f", itPart->duration / 1000.0), ",URI=\"");
+		String::Append(Segment::WritePartName(playlist.baseName(), sequence, itPart->index, buffer), '.', playlist.extension(), '"');
+		if (itPart->independent)
+			String::Append(buffer, ",INDEPENDENT=YES");
+	}
+	return itPart;
+}
+
 Buffer& M3U8::Write(const Playlist::Master& playlist, Buffer& buffer) {
 	String::Append(buffer, HEADER);
 	for (const auto& it : playlist.items) {
@@ -40,22 +55,42 @@ Buffer& M3U8::Write(const Playlist& playlist, Buffer& buffer, const char* type)
 	UInt32 sequence = playlist.sequence;
 	//  Round maxDuration, HLS tolerate a segment duration superior of 0.5 to target-duration
 	// "Media Segments MUST NOT exceed the target duration by more than 0.5 seconds"
-	String::Append(buffer, HEADER, "\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:",
+	String::Append(buffer, HEADER, "\n#EXT-X-VERSION:", playlist.partDuration ? 6 : 3, "\n#EXT-X-TARGETDURATION:",
 		(playlist.maxDuration+500) / 1000, "\n#EXT-X-MEDIA-SEQUENCE:", sequence); 
+	if (playlist.partDuration) {
+		// LL-HLS, blocking reload and a hold back of 3 parts
+		String::Append(buffer, "\n#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=", String::Format<double>("%.3f", playlist.partDuration * 3 / 1000.0));
+		String::Append(buffer, "\n#EXT-X-PART-INF:PART-TARGET=", String::Format<double>("%.3f", playlist.partDuration / 1000.0));
+	}
 	if (type)
 		String::Append(buffer, "\n#EXT-X-PLAYLIST-TYPE:", type);
 	else // else is a live playlist (not VOD or EVENT)
 		String::Append(buffer, "\n#EXT-X-ALLOW-CACHE:NO");
+	PartIterator itPart = playlist.parts().begin();
 	UInt32 i = 0;
+	bool ended = false;
 	for (UInt32 duration : playlist.durations()) {
 		++i;
 		if (duration) {
+			itPart = WriteParts(playlist, sequence, itPart, buffer);
 			WRITE_EXTINF(buffer, duration);
 			String::Append(Segment::WriteName(playlist.baseName(), sequence++, duration, buffer), '.', playlist.extension());
-		} else if(i==playlist.count())
+		} else if (i == playlist.count()) {
 			String::Append(buffer, i < playlist.count() ? DISCONTINUITY : ENDLIST);
+			ended = true;
+		}
 	}
-	return buffer;
+	if (!playlist.partDuration || ended)
+		return buffer;
+	// LL-HLS, parts of the segment in progress + hint of the next part
+	UInt16 index = 0;
+	if (itPart != playlist.parts().end()) {
+		itPart = WriteParts(playlist, sequence, itPart, buffer);
+		if ((itPart - 1)->sequence == sequence)
+			index = (itPart - 1)->index + 1;
+	}
+	String::Append(buffer, "\n#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"");
+	return String::Append(Segment::WritePartName(playlist.baseName(), sequence, index, buffer), '.', playlist.extension(), '"');
 }
 
 
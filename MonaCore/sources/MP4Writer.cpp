@@ -56,6 +56,13 @@ void MP4Writer::endMedia(const OnWrite& onWrite) {
 	// release resources
 	_videos.clear();
 	_audios.clear();
+	_header = nullptr;
+}
+
+bool MP4Writer::writeHeader(const OnWrite& onWrite) {
+	if (_header)
+		onWrite(_header);
+	return true; // just ftyp+moov is required to join
 }
 
 void MP4Writer::writeProperties(const Media::Properties& properties, const OnWrite& onWrite) {
@@ -233,6 +240,7 @@ void MP4Writer::flush(const OnWrite& onWrite, Int8 reset) {
 
 	UInt16 track(0);
 
+	UInt32 headerSize(0);
 	if (_buffering) {
 		// fftyp box => iso5....iso6mp41
 		writer.write(EXPAND("\x00\x00\x00\x18""ftyp\x69\x73\x6F\x35\x00\x00\x02\x00""iso6mp41"));
@@ -553,6 +561,7 @@ void MP4Writer::flush(const OnWrite& onWrite, Int8 reset) {
 		} while (track);
 
 		BinaryWriter(pBuffer->data() + sizePos, 4).write32(writer.size() - sizePos);
+		headerSize = writer.size();
 	}
 	if (reset) {
 		if (reset < 0) { // end (flushing)
@@ -612,7 +621,10 @@ void MP4Writer::flush(const OnWrite& onWrite, Int8 reset) {
 	if (!onWrite)
 		return;
 	// header
-	onWrite(Packet(pBuffer)); 
+	Packet header(pBuffer);
+	if (headerSize) // hold ftyp+moov for a reader which would join this media later (see writeHeader)
+		_header.set(move(header), header.data(), headerSize);
+	onWrite(header);
 	// payload
 	for (const deque<Frame>& frames : mediaFrames) {
 		for (const Frame& frame : frames)
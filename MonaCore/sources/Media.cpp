@@ -392,6 +392,24 @@ unique<DataWriter> Media::Data::NewWriter(Type type, Buffer& buffer) {
 	return nullptr;
 }
 
+const Packet& Media::DataCache::convert(Media::Data::Type type) const {
+	if (type == this->type || !type || type > Media::Data::TYPE_TEXT || !packet)
+		return Packet::Null();
+	lock_guard<mutex> lock(_mutex);
+	Packet& converted = _packets[type - 1];
+	if (_requested & (1 << type))
+		return converted;
+	_requested |= 1 << type;
+	unique<DataReader> pReader(Media::Data::NewReader(this->type, packet));
+	if (!pReader)
+		return converted; // raw, let target write it such given
+	shared<Buffer> pBuffer(SET);
+	unique<DataWriter> pWriter(Media::Data::NewWriter(type, *pBuffer));
+	if (pWriter && pReader->read(*pWriter)) // no packet if empty, target has to write its own empty serialization
+		converted.set(pBuffer);
+	return converted;
+}
+
 void Media::Source::addProperties(const Media::Properties& properties) {
 	Media::Data::Type type(Media::Data::TYPE_UNKNOWN);
 	const Packet& packet = properties.data(type);
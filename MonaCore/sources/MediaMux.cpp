@@ -0,0 +1,192 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+#include "Mona/MediaMux.h"
+#include "Mona/Logs.h"
+
+using namespace std;
+
+
+namespace Mona {
+
+MediaMux::MediaMux(unique<MediaWriter>&& pWriter, bool threadSafe) : _pWriter(move(pWriter)), threadSafe(threadSafe),
+	_onWrite([this](const Packet& packet) { _pPackets->emplace_back(move(packet)); }), // Packet(const Packet&&) holds the buffer (bufferizes if need), a copy would reference the packet
+	_pPackets(SET), _begun(false), _sequence(0), _started(false), _startTime(0), _gopping(false), _gopSequence(0) {
+	DEBUG("New ", _pWriter->format(), " shared muxing");
+}
+
+MediaMux::~MediaMux() {
+	if (_begun) // no more reader, end silently
+		_pWriter->endMedia(nullptr);
+	DEBUG(_pWriter->format(), " shared muxing deleted");
+}
+
+void MediaMux::beginMedia() {
+	unique_lock<mutex> lock(guard());
+	begin();
+}
+
+void MediaMux::begin() {
+	if (_begun)
+		return;
+	_begun = true;
+	_started = false;
+	_header.clear();
+	_gop.clear();
+	_gopping = false;
+	clear();
+	_sequence = 0;
+	_pWriter->beginMedia(_onWrite);
+	hold(0, 0);
+}
+
+bool MediaMux::header(deque<Packet>& packets, UInt64 gop) const {
+	unique_lock<mutex> lock(guard());
+	if (gop && !_gopping)
+		return false;
+	if (!_pWriter->writeHeader([&packets](const Packet& packet) { packets.emplace_back(move(packet)); })) {
+		for (const auto& it : _header) {
+			for (const Packet& packet : it.second)
+				packets.emplace_back(move(packet)); // holds the buffer, see _onWrite
+		}
+	}
+	if (!gop)
+		return true;
+	// packets of the media in distribution are delivered by its next write call
+	size_t size = _gop.size();
+	if (gop == _gopSequence)
+		size -= _pPackets->size();
+	for (size_t i = 0; i < size; ++i)
+		packets.emplace_back(move(_gop[i]));
+	return true;
+}
+
+void MediaMux::startGOP() {
+	unique_lock<mutex> lock(guard());
+	_gop.clear();
+	_gopSequence = 0;
+	_gopping = _begun;
+}
+
+void MediaMux::stopGOP() {
+	unique_lock<mutex> lock(guard());
+	_gop.clear();
+	_gopSequence = 0;
+	_gopping = false;
+}
+
+void MediaMux::hold(UInt16 key, UInt32 from) {
+	deque<Packet>& packets = _header[key];
+	packets.clear();
+	for (auto it = _pPackets->begin() + from; it != _pPackets->end(); ++it)
+		packets.emplace_back(move(*it)); // holds the buffer, _pPackets is cleared on next write
+}
+
+bool MediaMux::write(UInt64 sequence) {
+	if (!_begun)
+		begin(); // implicit begin, beginMedia packets stay before media packets
+	else if (sequence && sequence == _sequence)
+		return false; // already written for a previous subscription
+	else
+		clear();
+	_sequence = sequence;
+	return true;
+}
+
+void MediaMux::gop() {
+	if (!_gopping)
+		return;
+	for (const Packet& packet : *_pPackets)
+		_gop.emplace_back(move(packet)); // holds the buffer, see _onWrite
+	_gopSequence = _sequence;
+}
+
+void MediaMux::clear() {
+	if (_pPackets.unique())
+		_pPackets->clear();
+	else
+		_pPackets.set();
+}
+
+UInt32 MediaMux::scaleTime(UInt32 time, bool isConfig) {
+	if (_started)
+		return time - _startTime;
+	if (isConfig)
+		return 0;
+	_started = true;
+	_startTime = time;
+	return 0;
+}
+
+shared<const deque<Packet>> MediaMux::writeProperties(UInt64 sequence, const Media::Properties& properties) {
+	unique_lock<mutex> lock(guard());
+	if (!write(sequence))
+		return _pPackets;
+	UInt32 from = _pPackets->size();
+	_pWriter->writeProperties(properties, _onWrite);
+	hold(1, from); // not in GOP, header replays already the last properties
+	return _pPackets;
+}
+
+shared<const deque<Packet>> MediaMux::writeAudio(UInt64 sequence, UInt8 track, const Media::Audio::Tag& tag, const Packet& packet) {
+	unique_lock<mutex> lock(guard());
+	if (!write(sequence))
+		return _pPackets;
+	UInt32 from = _pPackets->size();
+	_pWriter->writeAudio(track, Media::Audio::Tag(tag, scaleTime(tag.time, tag.isConfig)), packet, _onWrite);
+	if (tag.isConfig)
+		hold((Media::TYPE_AUDIO << 8) | track, from);
+	else
+		gop();
+	return _pPackets;
+}
+
+shared<const deque<Packet>> MediaMux::writeVideo(UInt64 sequence, UInt8 track, const Media::Video::Tag& tag, const Packet& packet) {
+	unique_lock<mutex> lock(guard());
+	if (!write(sequence))
+		return _pPackets;
+	UInt32 from = _pPackets->size();
+	_pWriter->writeVideo(track, Media::Video::Tag(tag, scaleTime(tag.time, tag.frame == Media::Video::FRAME_CONFIG)), packet, _onWrite);
+	if (tag.frame == Media::Video::FRAME_CONFIG)
+		hold((Media::TYPE_VIDEO << 8) | track, from);
+	else
+		gop();
+	return _pPackets;
+}
+
+shared<const deque<Packet>> MediaMux::writeData(UInt64 sequence, UInt8 track, Media::Data::Type type, const Packet& packet) {
+	unique_lock<mutex> lock(guard());
+	if (write(sequence)) {
+		_pWriter->writeData(track, type, packet, _onWrite);
+		gop();
+	}
+	return _pPackets;
+}
+
+shared<const deque<Packet>> MediaMux::endMedia() {
+	unique_lock<mutex> lock(guard());
+	if (!_begun)
+		return _pPackets; // already ended
+	_begun = false;
+	_gop.clear();
+	_gopping = false;
+	clear();
+	_pWriter->endMedia(_onWrite);
+	return _pPackets;
+}
+
+} // namespace Mona
@@ -19,6 +19,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/NALNetReader.h"
 #include "Mona/HEVC.h"
 #include "Mona/AVC.h"
+#include "Mona/Bytes.h"
 #include "Mona/Logs.h"
 
 using namespace std;
@@ -40,6 +41,15 @@ UInt32 NALNetReader<VideoType>::parse(Packet& buffer, Media::Source& source) {
 
 
 	while(cur<end) {
+
+		if (!_state) {
+			// jump to the next start code, or to the 2 last bytes to keep a possible start code split on the next packet
+			const UInt8* next = Bytes::FindStartCode(cur, UInt32(end - cur));
+			if (next)
+				cur = next;
+			else if ((end - cur) > 2)
+				cur = end - 2;
+		}
 		
 		UInt8 value(*cur++);
 
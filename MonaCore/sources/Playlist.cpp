@@ -68,11 +68,20 @@ Playlist& Playlist::removeItem() {
 	return self;
 }
 
+Playlist& Playlist::addParts(UInt32 sequence, const Segment& segment) {
+	UInt16 index = 0;
+	for (const Segment::Part& part : segment.parts())
+		_parts.emplace_back(sequence, index++, part);
+	return self;
+}
+
 Playlist& Playlist::reset() {
 	sequence = 0;
 	maxDuration = 0;
+	partDuration = 0;
 	_duration = 0;
 	_durations.clear();
+	_parts.clear();
 	return self;
 }
 
@@ -19,15 +19,33 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Publication.h"
 #include "Mona/Util.h"
 #include "Mona/Logs.h"
+#include "Mona/Metrics.h"
 
 using namespace std;
 
 
 namespace Mona {
 
-Publication::Publication(const string& name): _latency(0), segments(_segments), _segments(0), _segmenting(false),
-	audios(_audios), videos(_videos), datas(_datas), _lostRate(_byteRate), _maxByteRate(0), _propVersion(0),
-	_publishing(0),_new(false), _newLost(false), _name(name) {
+static Metrics::Histogram FanOuts("mona_publication_fanout_us", "Distribution time of one media packet to the subscriptions of a publication (microseconds)");
+
+struct Publication::Shard : Runner, virtual Object {
+	Shard(Publication& publication, UInt8 index, const function<void(Subscription&)>& write) : Runner("PublicationShard"), _publication(publication), _index(index), _write(write) {}
+private:
+	bool run(Exception& ex) {
+		for (Subscription* pSubscription : _publication._shards[_index])
+			_write(*pSubscription);
+		if (!--_publication._pending)
+			_publication._sharded.set();
+		return true;
+	}
+	Publication&							_publication;
+	UInt8									_index;
+	const function<void(Subscription&)>&	_write;
+};
+
+Publication::Publication(const string& name, const ThreadPool& threadPool): _latency(0), segments(_segments), _segments(0), _segmenting(false),
+	audios(_audios), videos(_videos), datas(_datas), _lostRate(_byteRate), _maxByteRate(0), _propVersion(0), _sequence(0),
+	_publishing(0),_new(false), _newLost(false), _name(name), _threadPool(threadPool), _pending(0), _shardsVersion(0), _gopSize(0), _gopMaxDuration(0), _gopMaxSize(0), _gopKey(0) {
 	DEBUG("New publication ",name);
 	_segments.onSegment = [this](UInt16 duration) {
 		DEBUG("New ", _name, " segment of ", duration, "ms (segments: ", _segments.sequence(), "-", _segments.sequence() + _segments.count() - 1, ", maxDuration: ", _segments.maxDuration(),")");
@@ -76,6 +94,8 @@ void Publication::reportLost(Media::Type type, UInt32 lost, UInt8 track) {
 				break;
 			if(track)
 				_videos[track].waitKeyFrame = true;
+			if (track <= 1)
+				clearGOP(); // GOP broken
 			_videos.lostRate += lost;
 			break;
 		}
@@ -144,12 +164,35 @@ void Publication::start(unique<MediaFile::Writer>&& pRecorder) {
 		_pRecording->pPublication = this;
 		((set<Subscription*>&)subscriptions).emplace(_pRecording.get());
 	}
+	// fan-out on pool threads (the caller thread writes one shard)
+	UInt16 shards = min<UInt16>(getNumber<UInt8>("shards"), _threadPool.threads() + 1);
+	_shards.assign(shards > 1 ? shards : 0, vector<Subscription*>());
+	_strands.assign(_shards.size(), 0);
+	_partition.clear();
+	_unshardables.clear();
+	_shardsVersion = version - 1; // serialize properties before the next fan-out
+	for (auto& it : _muxes) {
+		shared<MediaMux> pMux = it.second.lock();
+		if (pMux)
+			pMux->threadSafe = _shards.size() > 0;
+	}
+	if (_shards.size())
+		INFO("Publication ", _name, " fan-out on ", _shards.size(), " shards");
+	// GOP cache
+	const char* gop = getString("gop");
+	_gopMaxDuration = gop && !String::IsFalse(gop) ? String::ToNumber<UInt32, GOP_DURATION>(gop) : 0;
+	_gopMaxSize = getNumber<UInt32, GOP_SIZE>("gopSize");
+	clearGOP();
+	if (_gopMaxDuration)
+		INFO("Publication ", _name, " GOP cache of ", _gopMaxDuration, "ms max");
+
 	// start or stop live segmenting
 	const char* strSegments = _segmenting ? NULL : getString("segments");
 	if (_segments.setMaxSegments(strSegments ? String::ToNumber<UInt8, Segments::DEFAULT_SEGMENTS>(strSegments) : 0)) {
 		_segmenting = true;
 		segments = _segments.maxSegments();
 		_segments.setMaxDuration(getNumber<UInt16>("duration"));
+		_segments.setPartDuration(getNumber<UInt16>("partDuration")); // LL-HLS
 	}
 
 	// display segmenting log =>
@@ -173,10 +216,18 @@ void Publication::reset() {
 	_latency = 0;
 	_maxByteRate = 0;
 	_new = _newLost = false;
+	clearGOP();
 
 	// Erase track metadata just!
 	clearTracks();
 
+	// end shared muxings before subscriptions reset to deliver their last packets
+	for (auto& it : _muxes) {
+		shared<MediaMux> pMux = it.second.lock();
+		if (pMux)
+			pMux->endMedia();
+	}
+
 	auto it = subscriptions.begin();
 	while (it != subscriptions.end()) { // using "while" rather "for each" because "reset" can remove an element of "subscriptions"!
 		Subscription* pSubscription(*it++);
@@ -206,6 +257,55 @@ void Publication::stop(const OnStop& onStop) {
 }
 
 
+shared<MediaMux> Publication::mux(const char* format) {
+	unique<MediaWriter> pWriter = MediaWriter::New(format);
+	if (!pWriter)
+		return nullptr;
+	unique_lock<mutex> lock(_mutexMuxes, defer_lock);
+	if (_shards.size())
+		lock.lock(); // can be called from shards
+	weak<MediaMux>& weakMux = _muxes[pWriter->format()];
+	shared<MediaMux> pMux = weakMux.lock();
+	if (!pMux) {
+		pMux.set(move(pWriter), _shards.size() > 0);
+		weakMux = pMux;
+	} else if (*pMux)
+		return pMux; // muxing in progress
+	// begin the muxing with the current state of the publication
+	pMux->beginMedia();
+	if (count())
+		pMux->writeProperties(0, self);
+	UInt8 track(0);
+	for (const AudioTrack& audio : _audios) {
+		++track;
+		if (audio.config)
+			pMux->writeAudio(0, track, audio.config, audio.config);
+	}
+	track = 0;
+	for (const VideoTrack& video : _videos) {
+		++track;
+		if (video.config)
+			pMux->writeVideo(0, track, video.config, video.config);
+	}
+	// GOP muxed to replay it on join, from the key frame in distribution or from the GOP cached
+	if (!_gopMaxDuration || (_gop.empty() && (!_gopKey || _gopKey != _sequence)))
+		return pMux;
+	pMux->startGOP();
+	for (const unique<Media::Base>& pMedia : _gop) {
+		switch (pMedia->type) {
+			case Media::TYPE_AUDIO:
+				pMux->writeAudio(0, pMedia->track, ((const Media::Audio&)*pMedia).tag, *pMedia);
+				break;
+			case Media::TYPE_VIDEO:
+				pMux->writeVideo(0, pMedia->track, ((const Media::Video&)*pMedia).tag, *pMedia);
+				break;
+			default:
+				pMux->writeData(0, pMedia->track, ((const Media::Data&)*pMedia).tag, *pMedia);
+		}
+	}
+	return pMux;
+}
+
 void Publication::flush(UInt16 ping) {
 	if(_publishing && ping)
 		_latency = ping >> 1;
@@ -268,13 +368,25 @@ void Publication::writeAudio(const Media::Audio::Tag& tag, const Packet& packet,
 	_byteRate += packet.size() + sizeof(tag);
 	_audios.byteRate += packet.size() + sizeof(tag);
 	_new = true;
+	++_sequence;
 	//INFO(name()," audio ",tag.time);
-	for (Subscription* pSubscription : subscriptions) {
+	Int64 time = Metrics::Enabled() ? Metrics::Clock() : 0;
+	if (_shards.size()) {
+		premux([&](MediaMux& mux) { mux.writeAudio(_sequence, track, tag, packet); });
+		fanOut([&](Subscription& subscription) { subscription.writeAudio(tag, packet, track); });
+	} else for (Subscription* pSubscription : subscriptions) {
 		if (pSubscription->pPublication == this || !pSubscription->pPublication)
 			pSubscription->writeAudio(tag, packet, track);
 	}
+	if (time)
+		FanOuts.add(Metrics::Clock() - time);
 	if (_segments)
 		_segments.writeAudio(track, tag, packet);
+	if (!tag.isConfig) {
+		if (!_gop.empty())
+			cache(make_unique<Media::Audio>(tag, packet, track));
+	} else if (pAudio && (pAudio->config.size() != packet.size() || memcmp(pAudio->config.data(), packet.data(), packet.size())))
+		clearGOP(); // new codec settings, GOP cached is obsolete
 
 	// Hold config packet after video distribution to avoid to distribute two times config packet if subscription call beginMedia
 	if (pAudio && tag.isConfig)
@@ -330,19 +442,49 @@ void Publication::writeVideo(const Media::Video::Tag& tag, const Packet& packet,
 	_byteRate += packet.size() + sizeof(tag);
 	_videos.byteRate += packet.size() + sizeof(tag);
 	_new = true;
+	++_sequence;
 	//INFO(name(), " video ", tag.time, " (", tag.frame, ")");
 
-	for (Subscription* pSubscription : subscriptions) {
-		if (pSubscription->pPublication != this && pSubscription->pPublication)
-			continue; // subscriber not yet subscribed
-		if (offsetCC && (!pSubscription->datas.pSelection || *pSubscription->datas.pSelection)) { // if a data track is selected => send without CC!
+	// new GOP, clear the previous one before distribution to not replay it to a subscription starting on this key frame
+	bool newGOP = _gopMaxDuration && track <= 1 && tag.frame == Media::Video::FRAME_KEY;
+	if (newGOP) {
+		clearGOP();
+		_gopKey = _sequence;
+		for (auto& it : _muxes) {
+			shared<MediaMux> pMux = it.second.lock();
+			if (pMux)
+				pMux->startGOP();
+		}
+	}
+
+	auto writeVideo = [&](Subscription& subscription) {
+		if (offsetCC && (!subscription.datas.pSelection || *subscription.datas.pSelection)) { // if a data track is selected => send without CC!
 			if (packet.size() > offsetCC)
-				pSubscription->writeVideo(tag, packet + offsetCC, track); // without CC
+				subscription.writeVideo(tag, packet + offsetCC, track); // without CC
 		} else
-			pSubscription->writeVideo(tag, packet, track); // with CC
+			subscription.writeVideo(tag, packet, track); // with CC
+	};
+	Int64 time = Metrics::Enabled() ? Metrics::Clock() : 0;
+	if (_shards.size()) {
+		// shared muxing is for subscriptions without data track selection => without CC
+		if (!offsetCC)
+			premux([&](MediaMux& mux) { mux.writeVideo(_sequence, track, tag, packet); });
+		else if (packet.size() > offsetCC)
+			premux([&](MediaMux& mux) { mux.writeVideo(_sequence, track, tag, packet + offsetCC); });
+		fanOut(writeVideo);
+	} else for (Subscription* pSubscription : subscriptions) {
+		if (pSubscription->pPublication == this || !pSubscription->pPublication)
+			writeVideo(*pSubscription);
 	}
+	if (time)
+		FanOuts.add(Metrics::Clock() - time);
 	if (_segments)
 		_segments.writeVideo(track, tag, packet);
+	if (tag.frame != Media::Video::FRAME_CONFIG) {
+		if (newGOP || !_gop.empty())
+			cache(make_unique<Media::Video>(tag, packet, track));
+	} else if (pVideo && packet && (pVideo->config.size() != packet.size() || memcmp(pVideo->config.data(), packet.data(), packet.size())))
+		clearGOP(); // new codec settings, GOP cached is obsolete
 
 	// Hold config packet after video distribution to avoid to distribute two times config packet if subscription call beginMedia
 	if (pVideo && tag.frame == Media::Video::FRAME_CONFIG && packet) // don't save the config "empty" (keep alive data stream!)
@@ -384,12 +526,43 @@ void Publication::writeData(Media::Data::Type type, const Packet& packet, UInt8
 	_byteRate += packet.size();
 	_datas.byteRate += packet.size();
 	_new = true;
-	for (Subscription* pSubscription : subscriptions) {
+	++_sequence;
+	Int64 time = Metrics::Enabled() ? Metrics::Clock() : 0;
+	// each serialization required by subscribers is converted one time, then shared
+	Media::DataCache data(type, packet);
+	if (_shards.size()) {
+		premux([&](MediaMux& mux) { mux.writeData(_sequence, track, type, packet); });
+		fanOut([&](Subscription& subscription) { subscription.writeData(data, track); });
+	} else for (Subscription* pSubscription : subscriptions) {
 		if (pSubscription->pPublication == this || !pSubscription->pPublication)
-			pSubscription->writeData(type, packet, track);
+			pSubscription->writeData(data, track);
 	}
+	if (time)
+		FanOuts.add(Metrics::Clock() - time);
 	if (_segments)
 		_segments.writeData(track, type, packet);
+	if (!_gop.empty())
+		cache(make_unique<Media::Data>(type, packet, track));
+}
+
+void Publication::clearGOP() {
+	_gop.clear();
+	_gopSize = 0;
+	for (auto& it : _muxes) {
+		shared<MediaMux> pMux = it.second.lock();
+		if (pMux)
+			pMux->stopGOP();
+	}
+}
+
+void Publication::cache(unique<Media::Base>&& pMedia) {
+	_gopSize += pMedia->size();
+	_gop.emplace_back(move(pMedia));
+	if (_gopSize <= _gopMaxSize && (!_gop.back()->hasTime() || Util::Distance(_gop.front()->time(), _gop.back()->time()) <= Int32(_gopMaxDuration)))
+		return;
+	// a GOP is useless without its key frame, wait the next one
+	DEBUG("Publication ", _name, " GOP exceeds cache limits (", _gopSize, " bytes), waits next key frame");
+	clearGOP();
 }
 
 void Publication::onParamChange(const string& key, const string* pValue) {
@@ -419,12 +592,16 @@ void Publication::flushProperties() {
 	if (_propVersion == version)
 		return;
 	_propVersion = version;
+	++_sequence;
 	// Logs before subscription logs!
 	if (self)
 		INFO("Write ", _name, " publication properties ", self)
 	else
 		INFO("Clear ", _name, " publication properties");
-	for (Subscription* pSubscription : subscriptions) {
+	if (_shards.size()) {
+		premux([this](MediaMux& mux) { mux.writeProperties(_sequence, self); });
+		fanOut([this](Subscription& subscription) { subscription.writeProperties(self); });
+	} else for (Subscription* pSubscription : subscriptions) {
 		if (pSubscription->pPublication == this || !pSubscription->pPublication)
 			pSubscription->writeProperties(self);
 	}
@@ -432,4 +609,82 @@ void Publication::flushProperties() {
 		_segments.writeProperties(self);
 }
 
+void Publication::premux(const function<void(MediaMux&)>& write) {
+	// mux one time here, then shards just get the packets resulting without to modify the shared muxing
+	for (auto& it : _muxes) {
+		shared<MediaMux> pMux = it.second.lock();
+		if (pMux && *pMux)
+			write(*pMux);
+	}
+}
+
+void Publication::partition() {
+	// subscriptions of a same client share its session and writers => same shard,
+	// and a client with a subscription not shardable is written by the caller thread after the join
+	for (vector<Subscription*>& shard : _shards)
+		shard.clear();
+	_unshardables.clear();
+	set<const void*> pinned;
+	for (const Sharding& sharding : _partition) {
+		if (sharding.state == 2)
+			pinned.emplace(sharding.pOwner);
+	}
+	for (const Sharding& sharding : _partition) {
+		if (!sharding.state)
+			continue; // subscriber not yet subscribed
+		if (!pinned.empty() && pinned.count(sharding.pOwner))
+			_unshardables.emplace_back(sharding.pSubscription);
+		else
+			_shards[((size_t(sharding.pOwner) * 0x9E3779B97F4A7C15ull) >> 32) % _shards.size()].emplace_back(sharding.pSubscription);
+	}
+}
+
+void Publication::fanOut(const function<void(Subscription&)>& write) {
+	// Media::Properties serializations are lazy, do it before to share them as immutable
+	if (_shardsVersion != version) {
+		_shardsVersion = version;
+		for (UInt8 type = Media::Data::TYPE_AMF; type <= Media::Data::TYPE_QUERY; ++type) {
+			Media::Data::Type dataType = Media::Data::Type(type);
+			data(dataType);
+		}
+	}
+	if (ThreadPool::Current() == &_threadPool) {
+		// nested fan-out (publication relayed by a subscription written by a shard): to wait shards queued behind this worker thread could deadlock
+		for (Subscription* pSubscription : subscriptions) {
+			if (pSubscription->pPublication == this || !pSubscription->pPublication)
+				write(*pSubscription);
+		}
+		return;
+	}
+	// partition computed again just when subscriptions change (subscribed, owner or shardable)
+	_states.clear();
+	for (Subscription* pSubscription : subscriptions) {
+		UInt8 state = pSubscription->pPublication != this && pSubscription->pPublication ? 0 : (pSubscription->shardable() ? 1 : 2);
+		_states.emplace_back(pSubscription, pSubscription->pOwner ? pSubscription->pOwner : pSubscription, state);
+	}
+	if (_states != _partition) {
+		_partition.swap(_states);
+		partition();
+	}
+	// fork, each shard keeps its strand to stay on a same worker thread (cache locality)
+	UInt8 pending(0);
+	for (UInt8 i = 1; i < _shards.size(); ++i) {
+		if (!_shards[i].empty())
+			++pending;
+	}
+	_pending = pending;
+	for (UInt8 i = 1; i < _shards.size(); ++i) {
+		if (!_shards[i].empty())
+			_threadPool.queue<Shard>(_strands[i], self, i, write);
+	}
+	for (Subscription* pSubscription : _shards[0])
+		write(*pSubscription);
+	// join, the last shard sets the signal one time
+	if (pending)
+		_sharded.wait();
+	// can reset, switch or unsubscribe (scripting), so alone and in last (subscriptions can be erased while iterating)
+	for (Subscription* pSubscription : _unshardables)
+		write(*pSubscription);
+}
+
 } // namespace Mona
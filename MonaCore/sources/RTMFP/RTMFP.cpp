@@ -118,13 +118,16 @@ bool RTMFP::Send(Socket& socket, const Packet& packet, const SocketAddress& addr
 	return true;
 }
 
+UInt32 RTMFP::Send(Socket& socket, const Packet* const* packets, UInt32 count, const SocketAddress& address) {
+	Exception ex;
+	int sent = socket.write(ex, packets, count, address);
+	if (ex)
+		DEBUG(ex);
+	return sent < 0 ? 0 : sent;
+}
+
 bool RTMFP::Engine::decode(Exception& ex, Buffer& buffer, const SocketAddress& address) {
-	static UInt8 IV[KEY_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-	EVP_CIPHER_CTX_reset(_context);
-	EVP_CipherInit_ex(_context, EVP_aes_128_cbc(), NULL, _key, IV, 0);
-	EVP_CIPHER_CTX_set_padding(_context, 0);
-	int temp = buffer.size();
-	EVP_CipherUpdate(_context, buffer.data(), &temp, buffer.data(), buffer.size());
+	_aes.decrypt(buffer.data(), buffer.size());
 	// Check CRC
 	BinaryReader reader(buffer.data(), buffer.size());
 	UInt16 crc(reader.read16());
@@ -152,30 +155,52 @@ shared<Buffer>& RTMFP::Engine::encode(shared<Buffer>& pBuffer, UInt32 farId, con
 	return pBuffer;
 }
 
+void RTMFP::Engine::encode(shared<Buffer>* pBuffers, UInt32 count, UInt32 farId, const SocketAddress& address) {
+	Crypto::AES::Job jobs[16];
+	while (count) {
+		UInt8 size = 0;
+		for (; count && size < sizeof(jobs) / sizeof(jobs[0]); --count) {
+			Buffer& buffer(**pBuffers++);
+			if (address)
+				DUMP_RESPONSE("RTMFP", buffer.data() + 6, buffer.size() - 6, address);
+			Crypto::AES::Job& job = jobs[size++];
+			job.size = Prepare(buffer);
+			job.data = buffer.data() + 4;
+			job.pAES = &_aes;
+		}
+		Crypto::AES::Encrypt(jobs, size);
+		for (UInt8 i = 0; i < size; ++i)
+			Finalize(**(pBuffers - size + i), farId);
+	}
+}
+
 void RTMFP::Engine::encode(const shared<Buffer>& pBuffer, UInt32 farId) {
-	int size = pBuffer->size();
+	_aes.encrypt(pBuffer->data() + 4, Prepare(*pBuffer));
+	Finalize(*pBuffer, farId);
+}
+
+UInt32 RTMFP::Engine::Prepare(Buffer& buffer) {
+	int size = buffer.size();
 	if (size > RTMFP::SIZE_PACKET)
 		CRITIC("Packet exceeds 1192 RTMFP maximum size, risks to be ignored by client");
 	// paddingBytesLength=(0xffffffff-plainRequestLength+5)&0x0F
 	int temp = (0xFFFFFFFF - size + 5) & 0x0F;
 	// Padd the plain request with paddingBytesLength of value 0xff at the end
-	pBuffer->resize(size + temp);
-	memset(pBuffer->data() + size, 0xFF, temp);
+	buffer.resize(size + temp);
+	memset(buffer.data() + size, 0xFF, temp);
 	size += temp;
 
-	UInt8* data = pBuffer->data();
-
 	// Write CRC (at the beginning of the request)
-	BinaryReader reader(data, size);
+	BinaryReader reader(buffer.data(), size);
 	reader.next(6);
-	BinaryWriter(data + 4, 2).write16(Crypto::ComputeChecksum(reader));
-	// Encrypt the resulted request
-	static UInt8 IV[KEY_SIZE];
-	EVP_CipherInit_ex(_context, EVP_aes_128_cbc(), NULL, _key, IV, 1);
-	EVP_CipherUpdate(_context, data+4, &temp, data + 4, size-4);
-
-	reader.reset(4);
-	BinaryWriter(data, 4).write32(reader.read32() ^ reader.read32() ^ farId);
+	BinaryWriter(buffer.data() + 4, 2).write16(Crypto::ComputeChecksum(reader));
+	return size - 4;
+}
+
+void RTMFP::Engine::Finalize(Buffer& buffer, UInt32 farId) {
+	// scramble far id with the first encrypted bytes
+	BinaryReader reader(buffer.data() + 4, 8);
+	BinaryWriter(buffer.data(), 4).write32(reader.read32() ^ reader.read32() ^ farId);
 }
 
 void RTMFP::ComputeAsymetricKeys(const UInt8* secret, UInt16 secretSize, const UInt8* initiatorNonce, UInt16 initNonceSize, const UInt8* responderNonce, UInt16 respNonceSize, UInt8* requestKey, UInt8* responseKey) {
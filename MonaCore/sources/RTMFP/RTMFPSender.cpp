@@ -29,16 +29,23 @@ bool RTMFPSender::run(Exception&) {
 	if (!pQueue)
 		return true;
 
-	// Flush Queue!
-	while (pSession->sendable && !pQueue->empty()) {
+	// Flush Queue! In one system call (packets not sent stay in queue)
+	const Mona::Packet* packets[RTMFP::SENDABLE_MAX];
+	UInt8 count(0);
+	for (auto it = pQueue->begin(); count < pSession->sendable && it != pQueue->end(); ++it)
+		packets[count++] = it->get();
+	if (!count)
+		return true;
+	UInt32 sent = RTMFP::Send(pSession->socket, packets, count, address);
+	if (sent < count)
+		pSession->sendable = 0;
+	else
+		pSession->sendable -= count;
+	count = UInt8(sent);
+	pSession->sendTime = Time::Now();
+	while (count--) {
 		TRACE("Stage ", pQueue->stageSending+1, " sent");
 		shared<Packet>& pPacket(pQueue->front());
-		if (!RTMFP::Send(pSession->socket, *pPacket, address)) {
-			pSession->sendable = 0;
-			break;
-		}
-		--pSession->sendable;
-		pSession->sendTime = Time::Now();
 		pSession->sendByteRate += pPacket->size();
 		pSession->queueing -= pPacket->size();
 		pPacket->setSent();
@@ -222,14 +229,21 @@ void RTMFPMessenger::run() {
 		} while (size);
 	}
 	flush();
+	if (_pBuffers.empty())
+		return;
+	// encode packets of this run in one multi-buffer AES pass and add them to pQueue
+	pSession->pEncoder->encode(_pBuffers.data(), _pBuffers.size(), pSession->farId(), address);
+	for (UInt32 i = 0; i < _pBuffers.size(); ++i) {
+		pQueue->emplace_back(SET, _pBuffers[i], _packets[i].first, _packets[i].second);
+		pSession->queueing += pQueue->back()->size();
+	}
 }
 
 void RTMFPMessenger::flush() {
 	if (!_pBuffer)
 		return;
-	// encode and add to pQueue
-	pQueue->emplace_back(SET, pSession->pEncoder->encode(_pBuffer, pSession->farId(), address), _fragments, _flags&RTMFP::MESSAGE_RELIABLE ? true : false);
-	pSession->queueing += pQueue->back()->size();
+	_pBuffers.emplace_back(move(_pBuffer));
+	_packets.emplace_back(_fragments, _flags&RTMFP::MESSAGE_RELIABLE ? true : false);
 }
 
 
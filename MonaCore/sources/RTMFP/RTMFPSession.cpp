@@ -299,45 +299,50 @@ bool RTMFPSession::keepalive() {
 	return true;
 }
 
-bool RTMFPSession::manage() {
+UInt32 RTMFPSession::manage() {
 
-	if (!Session::manage())
-		return false;
+	UInt32 delay = Session::manage();
+	if (!delay)
+		return 0;
 
 	if (_killing) {
 		// killing signal!
 		// no other message, just fail message, so I erase all data in first
 		send(shared<RTMFPCmdSender>(SET, 0x0C));
 		if (--_killing)
-			return true;
+			return MANAGE_PERIOD;
 		kill();
-		return false;
+		return 0;
 	}
 
 	// After 6 mn without any message we can considerate than the session has failed
 	if(_recvTime.isElapsed(360000)) {
 		WARN(name()," failed, reception timeout");
 		kill(ERROR_IDLE);
-		return false;
+		return 0;
 	}
 	
 	// To accelerate the deletion of peer ghost (mainly for netgroup efficient), starts a keepalive server after 2 mn
 	if (_recvTime.isElapsed(120000)) {
 		if (!_pSenderSession) {
 			kill(ERROR_CONGESTED); // timeout connection without response possible, client congested? client canceled?
-			return false;
+			return 0;
 		}
 		if (!peer) {
 			WARN(name(), " failed, connection client timeout");
 			kill(ERROR_IDLE);
-			return false;
+			return 0;
 		}
 		if (!keepalive())
-			return false;
+			return 0;
+		return min(delay, UInt32(MANAGE_PERIOD)); // next keepalive attempt
 	}
 
 	// After Session::manage, Session ::flush is called!
-	return true;
+	// Writers repeat their messages on flush until acknowledgment
+	if (_pSenderSession && _pSenderSession->queueing)
+		return min(delay, UInt32(MANAGE_PERIOD));
+	return min(delay, Remaining(_recvTime, 120000));
 }
 
 void RTMFPSession::flush() {
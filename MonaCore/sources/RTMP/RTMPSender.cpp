@@ -108,13 +108,7 @@ bool RTMPSender::run(Exception&) {
 	} else
 		DUMP_RESPONSE(_pSocket->isSecure() ? "RTMPS" : "RTMP", _pBuffer->data(), _pBuffer->size(), _pSocket->peerAddress());
 
-	Exception ex;
-	int result = _pSocket->write(ex, Packet(_pBuffer));
-	if (ex || result<0)
-		DEBUG(ex);
-	if (result < 0)
-		return true;
-
+	Packet header(_pBuffer);
 	if (_packet.size()) {
 		if (_pEncryptKey) {
 			DUMP_RESPONSE("RTMPE", _packet.data(), _packet.size(), _pSocket->peerAddress());
@@ -123,10 +117,12 @@ bool RTMPSender::run(Exception&) {
 			_packet.set(_pBuffer);
 		} else
 			DUMP_RESPONSE(_pSocket->isSecure() ? "RTMPS" : "RTMP", _packet.data(), _packet.size(), _pSocket->peerAddress());
-		if(_pSocket->write(ex, _packet)<0 && !ex)
-			DEBUG(ex);
 	}
-	
+
+	// header and payload in one system call
+	const Packet* packets[] = { &header, &_packet };
+	Exception ex;
+	_pSocket->write(ex, packets, _packet.size() ? 2 : 1);
 	if (ex)
 		DEBUG(ex);
 
@@ -127,14 +127,19 @@ void RTMPSession::kill(Int32 error, const char* reason) {
 	_controller.clear();
 }
 
-bool RTMPSession::manage() {
-	if (!TCPSession::manage())
-		return false;
-	if (peer && peer.pingTime.isElapsed(timeout/2)) {
-		_controller.writePing(peer.connection);
-		peer.pingTime.update();
+UInt32 RTMPSession::manage() {
+	UInt32 delay = TCPSession::manage();
+	if (!delay)
+		return 0;
+	if (peer) {
+		if (peer.pingTime.isElapsed(timeout/2)) {
+			_controller.writePing(peer.connection);
+			peer.pingTime.update();
+		}
+		delay = min(delay, Remaining(peer.pingTime, max(timeout / 2, UInt32(MANAGE_PERIOD))));
 	}
-	return true;
+	// streams to flush
+	return _writers.empty() ? delay : min(delay, UInt32(MANAGE_PERIOD));
 }
 
 void RTMPSession::flush() {
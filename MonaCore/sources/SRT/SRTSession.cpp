@@ -50,8 +50,16 @@ void SRTSession::init(SRTProtocol::Params& params) {
 		_pReader->onStop = [this]() { kill(TO_ERROR(_pReader->ex)); };
 		_pReader->start(); // no pulse required, socket already ready
 	} else { // by default "subscribe"!
-		_pWriter.set(MediaStream::TYPE_SRT, params.stream.c_str(), new TSWriter(), socket(), api.ioSocket);
-		if (!api.subscribe(ex, peer, params.stream, *(_pSubscription = new Subscription(*_pWriter)), peer.query.c_str()))
+		// TS, or MonaWriter framing with a .mona extension (cascading of an edge, see origin in configuration),
+		// other extensions are a part of the stream name as ever (live.ts subscribes to "live.ts")
+		string stream(params.stream.c_str());
+		unique<MediaWriter> pWriter;
+		if (String::ICompare(params.stream.extension(), "mona") == 0 && (pWriter = MediaWriter::New(params.stream.extension())))
+			stream.resize(stream.size() - params.stream.extension().size() - 1);
+		else
+			pWriter.set<TSWriter>();
+		_pWriter.set(MediaStream::TYPE_SRT, params.stream.c_str(), move(pWriter), socket(), api.ioSocket);
+		if (!api.subscribe(ex, peer, stream, *(_pSubscription = new Subscription(*_pWriter)), peer.query.c_str()))
 			return kill(TO_ERROR(ex));
 		_pWriter->onStop = [this]() { kill(TO_ERROR(_pWriter->ex)); };
 		_pWriter->start(); // no pulse required, socket already ready
@@ -77,9 +85,10 @@ void SRTSession::kill(Int32 error, const char* reason) {
 	Session::kill(error, reason);
 }
 
-bool SRTSession::manage() {
-	if (!Session::manage())
-		return false;
+UInt32 SRTSession::manage() {
+	UInt32 delay = Session::manage();
+	if (!delay)
+		return 0;
 	// check subscription
 	if (_pSubscription) {
 		switch (_pSubscription->ejected()) {
@@ -87,13 +96,14 @@ bool SRTSession::manage() {
 				break;
 			case Subscription::EJECTED_BANDWITDH:
 				kill(ERROR_CONGESTED, String("Insufficient bandwidth to play ", _pSubscription->name()).c_str());
-				return false;
+				return 0;
 			case Subscription::EJECTED_ERROR: //  HTTPWriter error, error already written!
 				kill(ERROR_SOCKET);
-				return false;
+				return 0;
 		}
+		return min(delay, UInt32(MANAGE_PERIOD));
 	}
-	return true;
+	return delay;
 }
 
 
@@ -15,6 +15,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 */
 
 #include "Mona/Segment.h"
+#include "Mona/MediaWriter.h"
 
 using namespace std;
 
@@ -41,6 +42,20 @@ size_t Segment::ReadName(const string& name, UInt32& sequence, UInt16& duration)
 	return size;
 }
 
+size_t Segment::ReadPartName(const string& name, UInt32& sequence, UInt16& part) {
+	// check format NAME.S.pP
+	size_t size = name.rfind(".p");
+	if (size == string::npos || !size || !String::ToNumber(name.c_str() + size + 2, name.size() - size - 2, part))
+		return string::npos;
+	const char* end = name.c_str() + size;
+	size = name.rfind('.', size - 1);
+	if (size == string::npos)
+		return string::npos;
+	const char* seq = name.c_str() + size + 1;
+	if (!String::ToNumber(seq, end - seq, sequence))
+		return string::npos; // no valid number S sequence
+	return size;
+}
 
 
 bool Segment::add(UInt32 time) {
@@ -56,5 +71,44 @@ bool Segment::add(UInt32 time) {
 	return true;
 }
 
+bool Segment::addPart(UInt32 time, bool independent) {
+	UInt32 begin = _parts.empty() ? 0 : _parts.back().end;
+	if (!_pFirstTime || _medias.size() <= begin)
+		return false; // empty part (or just configs without time)
+	Int32 duration = Util::Distance(partTime(), time);
+	_parts.emplace_back(_medias.size(), UInt16(max(duration, 0)), _partIndependent);
+	_partTime = time;
+	_partIndependent = independent;
+	return true;
+}
+
+const Packet& Segment::mux(UInt16 part, const char* subMime) const {
+	if (part >= _parts.size())
+		return Packet::Null();
+	const Part& item = _parts[part];
+	auto it = item._muxings.lower_bound(subMime);
+	if (it != item._muxings.end() && String::ICompare(it->first, subMime) == 0)
+		return it->second;
+	unique<MediaWriter> pWriter = MediaWriter::New(subMime);
+	if (!pWriter)
+		return Packet::Null();
+	shared<Buffer> pBuffer(SET);
+	MediaWriter::OnWrite onWrite([&pBuffer](const Packet& packet) { pBuffer->append(packet.data(), packet.size()); });
+	pWriter->beginMedia(onWrite);
+	auto itMedia = begin();
+	if (part) {
+		// part in the middle of segment, write before configs and properties of the segment
+		for (auto itEnd = begin() + _parts[part - 1].end; itMedia != itEnd; ++itMedia) {
+			const Media::Base& media = **itMedia;
+			if (media.isConfig() || (media.type == Media::TYPE_DATA && ((const Media::Data&)media).isProperties))
+				pWriter->writeMedia(media, onWrite);
+		}
+	}
+	for (auto itEnd = begin() + item.end; itMedia != itEnd; ++itMedia)
+		pWriter->writeMedia(**itMedia, onWrite);
+	pWriter->endMedia(onWrite);
+	return item._muxings.emplace_hint(it, subMime, Packet(pBuffer))->second;
+}
+
 
 } // namespace Mona
@@ -207,27 +207,57 @@ void Segments::Writer::writeVideo(UInt8 track, const Media::Video::Tag& tag, con
 
 /// SEGMENTS //////
 
-Segments::Segments(UInt8 maxSegments) : _started(false), _duration(0), _maxSegments(maxSegments), _sequence(0), _writer(self) {
+Segments::Segments(UInt8 maxSegments) : _started(false), _duration(0), _maxSegments(maxSegments), _sequence(0), _writer(self), _partDuration(0), _maxPartDuration(0) {
 	init();
 }
-Segments::Segments(Segments&& segments) : _started(false), _duration(segments._duration), _maxSegments(segments._maxSegments), _sequence(segments._sequence), _writer(self) {
+Segments::Segments(Segments&& segments) : _started(false), _duration(segments._duration), _maxSegments(segments._maxSegments), _sequence(segments._sequence), _writer(self),
+	_partDuration(segments._partDuration), _maxPartDuration(segments._maxPartDuration), _readies(std::move(segments._readies)) {
 	init();
 	segments._sequence += segments.count();
 	segments._duration = 0;
+	segments._readies.clear();
 	_segments = std::move(segments._segments);
 }
 
 void Segments::init() {
 	_writer.onSegment = [this](UInt16 duration) {
 		// add the valid segment to _segments
-		_segment.add(_segment.time() + duration);
+		UInt32 time = _segment.time() + duration;
+		_segment.add(time);
+		if (_partDuration && _segment.addPart(time)) {
+			// last part
+			if (_segment.parts().back().duration > _maxPartDuration)
+				_maxPartDuration = _segment.parts().back().duration;
+		}
 		_duration += duration;
 		_segments.emplace_back(move(_segment));
 		setMaxSegments(_maxSegments); // clean segments
 		onSegment(duration);
+		ready();
 	};
 }
 
+void Segments::addPart(UInt32 time, bool independent) {
+	if (!_partDuration || !_segment)
+		return;
+	Int32 duration = Util::Distance(_segment.partTime(), time);
+	if (duration < _partDuration || !_segment.addPart(time, independent))
+		return;
+	if (duration > _maxPartDuration)
+		_maxPartDuration = UInt16(min(duration, 0xFFFF));
+	ready();
+}
+
+void Segments::ready() {
+	if (_readies.empty())
+		return;
+	// one-shot, an onReady can register again
+	vector<OnReady> readies(move(_readies));
+	_readies.clear();
+	for (const OnReady& onReady : readies)
+		onReady();
+}
+
 UInt8 Segments::setMaxSegments(UInt8 maxSegments) {
 	// erase obsolete segments (keep one more if maxDuration not reached)
 	UInt32 maxDuration = maxSegments * this->maxDuration();
@@ -254,6 +284,7 @@ bool Segments::endMedia() {
 	_writer.endMedia(nullptr);
 	// reset segment after endMedia because onSegment will emplace_back this last segment
 	_segment.reset();
+	ready(); // no more segment, release blocking requests
 	// Don't reset _maxDuration and segments, must stays alive for playlist usage (delete the Segments object to reset all)
 	return true;
 }
@@ -272,9 +303,23 @@ const Segment& Segments::operator()(Int32 sequence) const {
 	return _segments[(UInt32)sequence];
 }
 
+const Segment& Segments::operator()(UInt32 sequence, UInt16 part) const {
+	const Segment& segment = sequence == (_sequence + _segments.size()) ? _segment : operator()(Int32(sequence));
+	return part < segment.parts().size() ? segment : Segment::Null();
+}
+
+bool Segments::ready(UInt32 sequence, Int32 part) const {
+	if (!_started)
+		return true;
+	UInt32 next = _sequence + _segments.size();
+	if (sequence < next)
+		return true;
+	return sequence == next && part >= 0 && UInt32(part) < _segment.parts().size();
+}
+
 Playlist& Segments::to(Playlist& playlist) const {
 	playlist.reset().sequence = _sequence;
-	(UInt64&)playlist.maxDuration = maxDuration();
+	playlist.maxDuration = maxDuration();
 	// Skip the first segment in playlist, because can be deleted by segments before request
 	bool first = _segments.size() >= _maxSegments;
 	for (const Segment& segment : _segments) {
@@ -290,6 +335,24 @@ Playlist& Segments::to(Playlist& playlist) const {
 	}
 	if (!_started)
 		playlist.addItem(0); // end
+	if (!_partDuration)
+		return playlist;
+	// LL-HLS, parts of segments in the last 3 target durations + parts of the segment in progress
+	playlist.partDuration = _maxPartDuration;
+	UInt32 sequence = _sequence + _segments.size();
+	UInt32 duration = 0;
+	auto it = _segments.end();
+	while (it != _segments.begin() && duration < 3u * maxDuration()) {
+		duration += (--it)->duration();
+		--sequence;
+	}
+	for (; it != _segments.end(); ++it) {
+		if (sequence >= playlist.sequence) // else segment skipped (see above)
+			playlist.addParts(sequence, *it);
+		++sequence;
+	}
+	if (_started)
+		playlist.addParts(sequence, _segment);
 	return playlist;
 }
 
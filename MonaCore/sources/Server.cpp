@@ -18,6 +18,8 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Server.h"
 #include "Mona/BufferPool.h"
+#include "Mona/IOUring.h"
+#include "Mona/Metrics.h"
 #include "Mona/MediaLogs.h"
 
 using namespace std;
@@ -25,9 +27,37 @@ using namespace std;
 
 namespace Mona {
 
+static Metrics::Histogram	Stalls("mona_main_stall_us", "Processing slices of the main loop, timers raising or handler flushing without going back to wait (microseconds)");
+static Metrics::Gauge		MaxStall("mona_main_stall_max_us", "Worst processing slice of the main loop on the last 10 to 20 seconds (microseconds)");
+
+/*!
+Measure a processing slice of the main loop */
+struct Stall : virtual Object {
+	Stall() : _start(Metrics::Enabled() ? Metrics::Clock() : 0) {}
+	~Stall() {
+		if (!_start)
+			return;
+		static Int64 Window(0), Current(0), Previous(0); // just main thread
+		Int64 now = Metrics::Clock();
+		Int64 duration = now - _start;
+		Stalls.add(duration);
+		if ((now - Window) > 10000000) {
+			Previous = (now - Window) > 20000000 ? 0 : Current;
+			Current = 0;
+			Window = now;
+		}
+		if (duration > Current)
+			Current = duration;
+		MaxStall.set(max(Current, Previous));
+	}
+private:
+	Int64 _start;
+};
 
-Server::Server(UInt16 cores) : Thread("Server"), ServerAPI(_www, _publications, _handler, _protocols, _timer, cores), _protocols(*this) {
+
+Server::Server(UInt16 cores, UInt16 reactors) : Thread("Server"), ServerAPI(_www, _publications, _handler, _protocols, _timer, cores, reactors), _protocols(*this) {
 	DEBUG(threadPool.threads(), " threads in server threadPool");
+	DEBUG(ioSocket.reactors(), " sockets reactors");
 }
  
 Server::~Server() {
@@ -60,10 +90,14 @@ Parameters& Server::start(const Parameters& parameters) {
 bool Server::run(Exception&, const volatile bool& requestStop) {
 	if (getBoolean<true>("poolBuffers"))
 		Buffer::Allocator::Set<BufferPool>();
+	if (!IOUring::Enable(getBoolean<false>("ioUring")))
+		WARN("io_uring unavailable, sockets and files keep epoll and blocking calls");
+	Metrics::Enable(getBoolean<false>("metrics"));
 
 	{ // encapsulate Sessions
 		Sessions sessions;
 		Timer::OnTimer onManage;
+		Timer::OnTimer onPulse;
 #if !defined(_DEBUG)
 		try
 #endif
@@ -90,10 +124,16 @@ bool Server::run(Exception&, const volatile bool& requestStop) {
 			// Start streams after onStart to get onPublish/onSubscribe permissions!
 			loadIniStreams();
 
+			// Sessions are managed on their own deadlines (see Sessions), here the remaining periodic works
 			onManage = ([&](UInt32) {
-				sessions.manage(); // in first to detect session useless died
 				_protocols.manage(); // manage custom protocol manage (resource protocols)
-
+				this->onManage(); // client manage (script, etc..)
+				if (clients.size() != countClient)
+					INFO((countClient = clients.size()), " clients");
+				// TODO? relayer.manage();
+				return 2000;
+			}); // manage every 2 seconds!
+			onPulse = ([&](UInt32) {
 				// Reset subscriptions of streams target
 				auto it = _streamSubscriptions.begin();
 				while (it != _streamSubscriptions.end()) {
@@ -113,18 +153,23 @@ bool Server::run(Exception&, const volatile bool& requestStop) {
 					else
 						it.first->start(self);
 				}
-
-				this->onManage(); // client manage (script, etc..)
-				if (clients.size() != countClient)
-					INFO((countClient = clients.size()), " clients");
-				// TODO? relayer.manage();
+				for (const auto& it : _pulls)
+					it.second->start(self); // reconnect to origin if lost
 				return 2000;
-			}); // manage every 2 seconds!
+			});
 			_timer.set(onManage, 2000);
+			_timer.set(onPulse, 1000); // shifted of one second from onManage to not stall main thread with both
 
 			while (!requestStop) {
-				if (wakeUp.wait(_timer.raise()))
+				UInt32 timeout;
+				{
+					Stall stall;
+					timeout = _timer.raise();
+				}
+				if (wakeUp.wait(timeout)) {
+					Stall stall;
 					_handler.flush();
+				}
 			}
 
 		}
@@ -135,8 +180,9 @@ bool Server::run(Exception&, const volatile bool& requestStop) {
 			FATAL("Server, unknown error");
 		}
 	#endif
-		// Stop onManage (useless now)
+		// Stop onManage and onPulse (useless now)
 		_timer.set(onManage, 0);
+		_timer.set(onPulse, 0);
 
 		// do a handler flush here too because few MediaStream like MediaLogger can have tasks to do after 
 		_handler.flush();
@@ -148,6 +194,7 @@ bool Server::run(Exception&, const volatile bool& requestStop) {
 				unsubscribe(*it.second);
 		}
 		_iniStreams.clear(); // before onStop because MediaStream::onDelete can call unpublish!
+		_pulls.clear(); // idem
 		// unsubscribe streamSubscriptions  => before onStop to get onUnsubscribe event before onStop!
 		for (const auto& it : _streamSubscriptions)
 			unsubscribe(*it.second);
@@ -162,6 +209,10 @@ bool Server::run(Exception&, const volatile bool& requestStop) {
 
 	// stop socket sending (it waits the end of sending last session messages)
 	threadPool.join();
+	for (UInt16 i = 0; i < threadPool.threads(); ++i) {
+		ThreadPool::Stats stats = threadPool.stats(i);
+		DEBUG("Thread ", i, " of server threadPool, ", stats.runs, " runs, ", stats.steals, " steals");
+	}
 
 	// finish writing file before to detach buffer allocator
 	ioFile.join();
@@ -189,6 +240,11 @@ bool Server::run(Exception&, const volatile bool& requestStop) {
 	// release memory
 	INFO("Server memory release...");
 	resources.clear();
+	for (UInt8 i = 0; i < Buffer::Allocator::CLASSES; ++i) {
+		Buffer::Allocator::Stats stats = Buffer::Allocator::ClassStats(i);
+		if (stats.hits || stats.misses)
+			DEBUG("Buffers of ", 16u << i, " bytes, ", stats.hits, " hits, ", stats.misses, " misses, ", stats.held, " bytes held");
+	}
 	Buffer::Allocator::Set();
 
 	_www.clear();
@@ -249,6 +305,35 @@ void Server::loadIniStreams() {
 	}
 }
 
+void Server::pull(Publication& publication) {
+	const char* origin = getString("origin");
+	if (!origin || !*origin || _pulls.count(publication.name()))
+		return;
+	// Pull the stream one time from origin in MonaWriter framing, local publication fans out to all the local subscribers
+	String description(origin);
+	if (String::ICompare(origin, EXPAND("srt:")) == 0)
+		String::Append(description, " mona?streamid=%23!::r=", publication.name(), ".mona,m=request");
+	else {
+		if (description.back() != '/')
+			description += '/';
+		String::Append(description, publication.name(), ".mona");
+	}
+	shared<MediaStream> pStream = stream(publication.name(), description, true);
+	if (!pStream)
+		return; // logs already displaid by stream call
+	pStream->start(self);
+	_pulls.emplace(publication.name(), move(pStream));
+}
+
+bool Server::unpull(Publication& publication) {
+	const auto& it = _pulls.find(publication.name());
+	if (it == _pulls.end())
+		return false;
+	INFO(it->first, " released from origin, no more subscription");
+	_pulls.erase(it); // MediaStream::onDelete unpublishes and erases the publication
+	return true;
+}
+
 shared<MediaStream> Server::stream(const string& publication, const string& description, bool isSource) {
 	shared<MediaStream> pStream;
 	if(isSource) { // is source
@@ -27,9 +27,9 @@ using namespace std;
 
 namespace Mona {
 
-ServerAPI::ServerAPI(std::string& www, map<string, Publication>& publications, const Handler& handler, const Protocols& protocols, const Timer& timer, UInt16 cores) :
+ServerAPI::ServerAPI(std::string& www, map<string, Publication>& publications, const Handler& handler, const Protocols& protocols, const Timer& timer, UInt16 cores, UInt16 reactors) :
 	www(www), _publications(publications), threadPool(cores), protocols(protocols), timer(timer), handler(handler),
-	ioSocket(handler, threadPool), ioFile(handler, threadPool, cores), clients(), resources(timer) {
+	ioSocket(handler, threadPool, "IOSocket", reactors), ioFile(handler, threadPool, cores), clients(), resources(timer) {
 	resources.onCreate = [](const string& name, const string& type, UInt32 lifeTime) {
 		INFO("New ", name , ' ', type, " resource alive during ", lifeTime, "ms");
 	};
@@ -48,7 +48,7 @@ Publication* ServerAPI::publish(Exception& ex, Path& stream, Client* pClient) {
 		return NULL;
 	}
 	
-	const auto& it = _publications.emplace(SET, forward_as_tuple(name), forward_as_tuple(name)).first;
+	const auto& it = _publications.emplace(SET, forward_as_tuple(name), forward_as_tuple(name, threadPool)).first;
 	Publication& publication(it->second);
 
 	if (publication.publishing()) {
@@ -173,7 +173,7 @@ bool ServerAPI::subscribe(Exception& ex, const string& stream, Subscription& sub
 			WARN(ex.set<Ex::Unfound>("Publication ", stream, " unfound"));
 			return false;
 		}
-		it = _publications.emplace_hint(it, SET, forward_as_tuple(stream), forward_as_tuple(stream));
+		it = _publications.emplace_hint(it, SET, forward_as_tuple(stream), forward_as_tuple(stream, threadPool));
 
 		// Write static metadata configured
 		if (String::ICompare(getString(stream), "publication") == 0) {
@@ -188,6 +188,8 @@ bool ServerAPI::subscribe(Exception& ex, const string& stream, Subscription& sub
 			erasePublication(it);
 		return false;
 	}
+	if (!it->second.publishing())
+		pull(it->second);
 
 	// update onMBR and onNext with new pClient value!
 	subscription.onMBR = nullptr;
@@ -237,6 +239,7 @@ bool ServerAPI::subscribe(Exception& ex, Publication& publication, Subscription&
 			WARN(ex.set<Ex::Permission>("Not authorized to play ", publication.name()));
 		return false;
 	}
+	subscription.pOwner = pClient;
 	((set<Subscription*>&)publication.subscriptions).emplace(&subscription);
 
 	if (subscription.pPublication)
@@ -265,6 +268,8 @@ void ServerAPI::unsubscribe(Subscription& subscription, Publication* pPublicatio
 		ERROR(pPublication->name()," unsubscription before client connection")
 	else
 		onUnsubscribe(subscription, *pPublication, pClient);
+	if (pPublication->subscriptions.empty() && unpull(*pPublication))
+		return; // publication pulled released (can be erased)
 	if (*pPublication)
 		return;
 	// remve empty publication
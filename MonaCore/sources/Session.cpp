@@ -45,17 +45,17 @@ Int32 Session::ToError(const Exception& ex) {
 }
 
 Session::Session(Protocol& protocol, shared<Peer>& pPeer, const char* name) : _pPeer(move(pPeer)), peer(*_pPeer),
-	_protocol(protocol), _name(name ? name : ""), api(protocol.api), died(false), _id(0), timeout(protocol.getNumber<UInt32>("timeout") * 1000) {
+	_protocol(protocol), _name(name ? name : ""), api(protocol.api), died(false), _id(0), _manageDelay(MANAGE_PERIOD), timeout(protocol.getNumber<UInt32>("timeout") * 1000) {
 	init(self);
 }
 	
 Session::Session(Protocol& protocol, const SocketAddress& address, const char* name) : peer(_pPeer.set(protocol.api, protocol.name, address)),
-	_protocol(protocol),_name(name ? name : ""), api(protocol.api), died(false), _id(0), timeout(protocol.getNumber<UInt32>("timeout") * 1000) {
+	_protocol(protocol),_name(name ? name : ""), api(protocol.api), died(false), _id(0), _manageDelay(MANAGE_PERIOD), timeout(protocol.getNumber<UInt32>("timeout") * 1000) {
 	init(self);
 }
 
 Session::Session(Protocol& protocol, Session& session) : _pPeer(session._pPeer), peer(*session._pPeer),
-	_sessionsOptions(session._sessionsOptions), _protocol(protocol), api(protocol.api), died(false), _id(session._id), timeout(protocol.getNumber<UInt32>("timeout") * 1000) {
+	_sessionsOptions(session._sessionsOptions), _protocol(protocol), api(protocol.api), died(false), _id(session._id), _manageDelay(MANAGE_PERIOD), timeout(protocol.getNumber<UInt32>("timeout") * 1000) {
 	// Morphing
 	session._name.clear(); // to fix name!
 	peer.protocol = protocol.name;
@@ -96,6 +96,17 @@ void Session::onParameters(const Parameters& parameters) {
 		_timeout *= 1000;
 }
 
+void Session::manageIn(UInt32 delay) {
+	if (!_onManage) {
+		// manage running (or session not managed by Sessions), applied on return
+		if (delay < _manageDelay)
+			_manageDelay = delay ? delay : 1;
+		return;
+	}
+	if (_onManage.nextRaising() > (Time::Now() + delay))
+		api.timer.set(_onManage, delay ? delay : 1);
+}
+
 void Session::kill(Int32 error, const char* reason) {
 	if (died)
 		return;
@@ -108,27 +119,30 @@ void Session::kill(Int32 error, const char* reason) {
 	(bool&)died = true; // keep in last to allow TCPSession::send in peer.onDisconnection!
 }
 
-bool Session::manage() {
+UInt32 Session::manage() {
 	if (died)
-		return false;
+		return 0;
 	// Congestion timeout to avoid to saturate a client saturating ressource + PULSE congestion variable of peer!
 	_congestion = peer.queueing();
 	if (_congestion(Net::RTO_MAX + Net::RTO_INIT)) {
 		// Control sending and receiving for protocol like HTTP which can streaming always in the same way (sending), without never more request (receiving)
 		WARN(name(), " congested");
 		close(ERROR_CONGESTED);
-		return false;
+		return 0;
 	}
+	// congestion is pulsed frequently while something is queueing
+	UInt32 delay = peer.queueing() ? MANAGE_PERIOD : MANAGE_IDLE_PERIOD;
 	// Connection timeout to liberate useless socket ressource (usually used just for TCP session)
 	if (!timeout)
-		return true;
+		return delay;
 	// If peer connected => control sending and receiving activity
 	// If peer not connected => control time taking to (re)call onConnection
-	if (peer ? (!peer.recvTime().isElapsed(timeout) || !peer.sendTime().isElapsed(timeout)) : !peer.disconnection.isElapsed(timeout))
-		return true;
+	Int64 elapsed = peer ? min(peer.recvTime().elapsed(), peer.sendTime().elapsed()) : peer.disconnection.elapsed();
+	if (elapsed <= timeout)
+		return min(delay, UInt32(timeout - elapsed) + 1);
 	LOG(String::ICompare(_protocol.name, EXPAND("HTTP"))==0 ? LOG_DEBUG : LOG_INFO, name(), " timeout connection");
 	close(ERROR_IDLE);
-	return false;
+	return 0;
 }
 
 
@@ -28,13 +28,14 @@ Sessions::~Sessions() {
 	// delete sessions
 	if (!_sessions.empty())
 		WARN("sessions are deleting");
-	for (auto& it : _sessions) {
-		it.second->kill(Session::ERROR_SERVER);
-		delete it.second;
+	for (Session* pSession : _sessions) {
+		pSession->api.timer.set(pSession->_onManage, 0);
+		pSession->kill(Session::ERROR_SERVER);
+		delete pSession;
 	}
 }
 
-std::map<SocketAddress, Session*>& Sessions::sessionsByAddress(Protocol& protocol) {
+Sessions::AddressIndex& Sessions::sessionsByAddress(Protocol& protocol) {
 	return _sessionsByAddress[dynamic_cast<TCProtocol*>(&protocol) ? 1 : 0][protocol.address];
 }
 
@@ -50,17 +51,17 @@ void Sessions::addByAddress(Session& session) {
 		if (!session.peer.address) // no address yet, wait next onAddressChanged event (usefull for TCPSession)
 			return;
 
-		map<SocketAddress, Session*>& sessionsByAddress = this->sessionsByAddress(session.protocol());
+		AddressIndex& sessionsByAddress = this->sessionsByAddress(session.protocol());
 		const auto& it = sessionsByAddress.emplace(session.peer.address, &session);
 		if (it.second)
 			return;
-		INFO(it.first->second->name(), " overloaded by ", session.name(), " (by ", session.peer.address, ")");
-		const auto& itSession = _sessions.find(it.first->second->_id);
-		if (itSession == _sessions.end())
-			CRITIC("Overloaded ", it.first->second->name(), " impossible to find in sessions collection")
+		Session& overloaded(**it.first);
+		INFO(overloaded.name(), " overloaded by ", session.name(), " (by ", session.peer.address, ")");
+		if (!_sessions.find(overloaded._id))
+			CRITIC("Overloaded ", overloaded.name(), " impossible to find in sessions collection")
 		else
-			remove(itSession, SESSION_BYPEER);
-		it.first->second = &session;
+			remove(overloaded, SESSION_BYPEER);
+		*sessionsByAddress.emplace(session.peer.address, &session).first = &session; // emplace again, remove can have changed the index
 	}
 }
 
@@ -75,15 +76,19 @@ void Sessions::removeByAddress(const SocketAddress& address, Session& session) {
 		if (!address)
 			return; // if no address, was not registered!
 
-		map<SocketAddress, Session*>& sessionsByAddress = this->sessionsByAddress(session.protocol());
+		AddressIndex& sessionsByAddress = this->sessionsByAddress(session.protocol());
 		if (!sessionsByAddress.erase(address)) {
 			ERROR(session.name(), ' ', address, " unfound in address sessions collection");
-			for (auto it = sessionsByAddress.begin(); it != sessionsByAddress.end(); ++it) {
-				if (it->second == &session) {
-					ERROR(session.name(), ' ', address, " found in address sessions collection with address ", it->first);
-					sessionsByAddress.erase(it);
-					break;
-				}
+			SocketAddress found;
+			sessionsByAddress.forEach([&session, &found](const SocketAddress& address, Session* pSession) {
+				if (pSession != &session)
+					return true;
+				found = address;
+				return false;
+			});
+			if (found) {
+				ERROR(session.name(), ' ', address, " found in address sessions collection with address ", found);
+				sessionsByAddress.erase(found);
 			}
 		}
 	}
@@ -91,16 +96,18 @@ void Sessions::removeByAddress(const SocketAddress& address, Session& session) {
 
 void Sessions::addByPeer(Session& session) {
 	if (session._sessionsOptions&SESSION_BYPEER) {
-		const auto& it = _sessionsByPeerId.emplace(session);
+		const auto& it = _sessionsByPeerId.emplace(session.peer.id, &session);
 		if (it.second)
 			return;
-		INFO(it.first->second->name(), " overloaded by ", session.name(), " (by peer id)");
-		const auto& itSession = _sessions.find(it.first->second->_id);
-		if (itSession == _sessions.end())
-			CRITIC("Overloaded ", it.first->second->name(), " impossible to find in sessions collection")
+		Session& overloaded(**it.first);
+		INFO(overloaded.name(), " overloaded by ", session.name(), " (by peer id)");
+		// erase while the key (overloaded.peer.id) is alive, and index again with the key of the new session
+		_sessionsByPeerId.erase(session.peer.id);
+		if (!_sessions.find(overloaded._id))
+			CRITIC("Overloaded ", overloaded.name(), " impossible to find in sessions collection")
 		else
-			remove(itSession, SESSION_BYADDRESS);
-		it.first->second = &session;
+			remove(overloaded, SESSION_BYADDRESS);
+		_sessionsByPeerId.emplace(session.peer.id, &session);
 	}
 }
 
@@ -108,19 +115,22 @@ void Sessions::removeByPeer(Session& session) {
 	if (session._sessionsOptions&SESSION_BYPEER) {
 		if (!_sessionsByPeerId.erase(session.peer.id)) {
 			ERROR(session.name(), ' ', String::Hex(session.peer.id, Entity::SIZE), " unfound in peer sessions collection");
-			for (auto it = _sessionsByPeerId.begin(); it != _sessionsByPeerId.end(); ++it) {
-				if (it->second == &session) {
-					ERROR(session.name(), ' ', String::Hex(session.peer.id, Entity::SIZE), " found in peer sessions collection with peerId ", it->first);
-					_sessionsByPeerId.erase(it);
-					break;
-				}
+			const UInt8* found(NULL);
+			_sessionsByPeerId.forEach([&session, &found](const UInt8* peerId, Session* pSession) {
+				if (pSession != &session)
+					return true;
+				found = peerId;
+				return false;
+			});
+			if (found) {
+				ERROR(session.name(), ' ', String::Hex(session.peer.id, Entity::SIZE), " found in peer sessions collection with peerId ", String::Hex(found, Entity::SIZE));
+				_sessionsByPeerId.erase(found);
 			}
 		}
 	}
 }
 
-void Sessions::remove(const map<UInt32, Session*>::iterator& it, SESSION_OPTIONS options) {
-	Session& session(*it->second);
+void Sessions::remove(Session& session, SESSION_OPTIONS options) {
 	DEBUG(session.name(), " deleted (client.id=", String::Hex(session.peer.id, Entity::SIZE),")");
 
 	if (options&SESSION_BYPEER)
@@ -132,25 +142,21 @@ void Sessions::remove(const map<UInt32, Session*>::iterator& it, SESSION_OPTIONS
 	// Here it means an obsolete session, we can kill it
 	session.kill(Session::ERROR_ZOMBIE);
 
-	_freeIds.emplace_back(session._id);
+	session.api.timer.set(session._onManage, 0);
+	_sessions.remove(session._id);
 	delete &session;
-	_sessions.erase(it);
 }
 
-
-void Sessions::manage() {
-	auto it = _sessions.begin();
-	while (it != _sessions.end()) {
-		Session& session(*it->second);
-		if (!session.died && session.manage())
-			session.flush();
-		if (session.died) {
-			auto itRemove(it++);
-			remove(itRemove, SESSION_BYPEER | SESSION_BYADDRESS);
-			continue;
-		}
-		++it;
-	}
+UInt32 Sessions::manage(Session& session) {
+	session._manageDelay = 0xFFFFFFFF; // can be reduced by Session::manageIn during manage
+	UInt32 delay = session.died ? 0 : session.manage();
+	if (delay)
+		session.flush();
+	if (!session.died) // next deadline returned by manage, MANAGE_PERIOD if manage has failed without to kill session (killing steps)
+		return min(delay ? delay : UInt32(Session::MANAGE_PERIOD), session._manageDelay);
+	// delete it here, OnTimer is not used by the timer after a 0 return
+	remove(session, SESSION_BYPEER | SESSION_BYADDRESS);
+	return 0;
 }
 
 
@@ -20,11 +20,14 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Publication.h"
 #include "Mona/Util.h"
 #include "Mona/Logs.h"
+#include "Mona/Metrics.h"
 
 using namespace std;
 
 namespace Mona {
 
+static Metrics::Counter Drops("mona_subscription_drops_total", "Media packets dropped by subscriptions (insufficient bandwidth or waiting key frame)");
+
 bool Subscription::MediaTrack::setLastTime(UInt32 time) {
 	if (_started && Util::Distance(lastTime, time) < 0) {
 		WARN("Non-monotonic ", typeid(self) == typeid(MediaTrack) ? "audio" : "video", " time ", time, ", packet ignored");
@@ -34,14 +37,14 @@ bool Subscription::MediaTrack::setLastTime(UInt32 time) {
 	return _started =true;
 }
 
-Subscription::Subscription(Media::Target& target) : pPublication(NULL), _pNextPublication(NULL), _target(target), _ejected(EJECTED_NONE),
+Subscription::Subscription(Media::Target& target) : pPublication(NULL), pOwner(NULL), _pNextPublication(NULL), _target(target), _ejected(EJECTED_NONE),
 	_flushable(0), audios(_audios), videos(_videos), datas(_datas), _streaming(0), _firstTime(true), _timeout(0), _startTime(0), _seekTime(0),
-	_audios(true), _videos(true), _datas(true), _timeoutMBRUP(10000), _medias(self), _updating(0), _duration(0), _paramVersion(0){
+	_audios(true), _videos(true), _datas(true), _timeoutMBRUP(10000), _medias(self), _updating(0), _duration(0), _from(false), _paramVersion(0), _sharedOnly(false), _gop(GOP_BURST) {
 }
 
-Subscription::Subscription(Media::TrackTarget& target) : pPublication(NULL), _pNextPublication(NULL), _target(target), _ejected(EJECTED_NONE),
+Subscription::Subscription(Media::TrackTarget& target) : pPublication(NULL), pOwner(NULL), _pNextPublication(NULL), _target(target), _ejected(EJECTED_NONE),
 	_flushable(0), audios(_audios), videos(_videos), datas(_datas), _streaming(0), _firstTime(true), _timeout(0), _startTime(0), _seekTime(0),
-	_audios(false), _videos(false), _datas(false), _timeoutMBRUP(10000), _medias(self), _updating(0), _duration(0), _paramVersion(0) {
+	_audios(false), _videos(false), _datas(false), _timeoutMBRUP(10000), _medias(self), _updating(0), _duration(0), _from(false), _paramVersion(0), _sharedOnly(false), _gop(GOP_BURST) {
 }
 
 Subscription::~Subscription() {
@@ -115,7 +118,13 @@ void Subscription::onParamChange(const string& key, const string* pValue) {
 	} else if (String::ICompare(key, "time") == 0) {
 		parseTime(pValue ? pValue->c_str() : NULL);
 	} else if (String::ICompare(key, "from") == 0) {
+		_from = pValue ? true : false;
 		parseFromTime(pValue ? pValue->c_str() : NULL);
+	} else if (String::ICompare(key, "gop") == 0) {
+		if (pValue && String::ICompare(*pValue, "live") == 0)
+			_gop = GOP_LIVE;
+		else
+			_gop = pValue && String::IsFalse(*pValue) ? GOP_NONE : GOP_BURST;
 	} else if (String::ICompare(key, "duration") == 0) {
 		_duration = 0;
 		if (pValue && String::ToNumber(*pValue, _duration))
@@ -136,13 +145,17 @@ void Subscription::onParamChange(const string& key, const string* pValue) {
 			setMediaSelection(pPublication ? &pPublication->videos : NULL, pValue, _videos);
 	}
 	Media::Properties::onParamChange(key, pValue);
+	if (_pMux && !shareable())
+		reset(); // parameters specific to this subscription, will continue with a private muxing
 }
 void Subscription::onParamClear() {
 	parseFromTime(NULL);
 	parseTime(NULL);
 	_duration = 0;
+	_from = false;
 	_audios.reliable = _videos.reliable = _datas.reliable = true;
 	_timeout = 0;
+	_gop = GOP_BURST;
 	_streams.clear();
 	setMediaSelection(pPublication ? &pPublication->audios : NULL, NULL, _audios);
 	setMediaSelection(pPublication ? &pPublication->videos : NULL, NULL, _videos);
@@ -198,7 +211,30 @@ bool Subscription::start() {
 		return false;
 	}
 
-	if (_pMediaWriter && !_onMediaWrite) {
+	// a GOP to replay live (decoded until live edge) requires its own muxing
+	if (_pMediaWriter && pPublication && !_pMux && shareable() && (_gop != GOP_LIVE || pPublication->gop().empty())) {
+		shared<MediaMux> pMux = pPublication->mux(_pMediaWriter->format());
+		deque<Packet> packets;
+		// join the muxing in progress, its header contains already metadata and codecs settings,
+		// and its GOP muxed is replayed in burst, if it has not the GOP (started after the key frame) continue with a private muxing
+		bool gop = _gop && !pPublication->gop().empty();
+		if (pMux && pMux->header(packets, gop ? pPublication->sequence() : 0)) {
+			_pMux = move(pMux);
+			if (gop)
+				_videos[1].waitKeyFrame = 0; // GOP replayed from its key frame, the next inter frames are decodable
+			_streaming.update();
+			_queueing.update();
+			_waitingFirstVideoSync = 0; // shared timeline, no sync to wait
+			if (pPublication->count() && !_target.writeProperties(*pPublication)) {
+				_ejected = EJECTED_ERROR;
+				return false;
+			}
+			writeMux(packets);
+			return !_ejected;
+		}
+	}
+
+	if (_pMediaWriter && !_sharedOnly && !_onMediaWrite) {
 		_onMediaWrite = [this](const Packet& packet) {
 			if(!writeToTarget(_datas, 0, Media::Data::TYPE_MEDIA, packet))
 				_ejected = EJECTED_ERROR;
@@ -265,6 +301,8 @@ bool Subscription::start(UInt8 track, Media::Data::Type type, const Packet& pack
 	// In first flush medias previous media before to progress timeline (setLastTime)
 	if (_pNextPublication && _medias.add(type, packet, track))
 		return false;
+	if (!_streaming)
+		replay();
 	return start(lastTime());
 }
 bool Subscription::start(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet) {
@@ -276,6 +314,8 @@ bool Subscription::start(UInt8 track, const Media::Audio::Tag& tag, const Packet
 	// In first flush medias previous media before to progress timeline (setLastTime)
 	if (_pNextPublication && _medias.add(tag, packet, track))
 		return false;
+	if (!_streaming)
+		replay();
 	return _audios.setLastTime(track, tag.time) && start(tag.time);
 }
 bool Subscription::start(UInt8 track, const Media::Video::Tag& tag, const Packet& packet) {
@@ -287,9 +327,46 @@ bool Subscription::start(UInt8 track, const Media::Video::Tag& tag, const Packet
 	// In first flush medias previous media before to progress timeline (setLastTime)
 	if (_pNextPublication && _medias.add(tag, packet, track))
 		return false;
+	if (!_streaming && tag.frame != Media::Video::FRAME_KEY)
+		replay(); // on a key frame starts directly on it, the GOP cached is the previous one
 	return _videos.setLastTime(track, tag.time) && start(tag.time);
 }
 
+void Subscription::replay() {
+	// GOP cached by publication to start on its key frame rather than to wait the next one
+	if (!pPublication || pPublication->gop().empty())
+		return;
+	const deque<unique<Media::Base>>& gop = pPublication->gop();
+	// a MBR switch joins the next publication on its live edge (see Medias)
+	auto mode = typeid(_target) == typeid(Medias) ? GOP_LIVE : _gop;
+	if (!mode)
+		return;
+	UInt32 edge = 0;
+	for (auto it = gop.rbegin(); it != gop.rend(); ++it) {
+		if ((*it)->type == Media::TYPE_VIDEO) {
+			edge = (*it)->time();
+			break;
+		}
+	}
+	if (_pFromTime && (mode == GOP_BURST || Util::Distance(*_pFromTime, edge) < 0))
+		return; // key frame before "from" time
+	if (!start() || _pMux || _ejected)
+		return; // shared muxing has its own timeline
+	DEBUG(name(), " subscription starts on GOP cached (", gop.size(), " medias", mode == GOP_LIVE ? ", live" : "", ")");
+	for (const unique<Media::Base>& pMedia : gop) {
+		if (mode == GOP_BURST)
+			writeMedia(*pMedia);
+		else if (pMedia->type == Media::TYPE_VIDEO) {
+			// just to decode until live edge
+			Media::Video::Tag tag(((const Media::Video&)*pMedia).tag);
+			tag.time = edge;
+			writeVideo(tag, *pMedia, pMedia->track);
+		}
+		if (_ejected)
+			return;
+	}
+}
+
 void Subscription::reset() {
 	if(_ejected) // else is a publication reset (smooth publication transition, key frame should come in first)
 		_waitingFirstVideoSync.update(); // to retablish audio/video sync!
@@ -303,7 +380,12 @@ void Subscription::reset() {
 	parseFromTime(getString("from")); // reset _pFromTime to its from value (cyclic algo)
 	_seekTime = 0;
 	clear(); 
-	if (_pMediaWriter) {
+	if (_pMux) {
+		if (!*_pMux) // publication end, deliver the last packets of the shared muxing
+			writeMux(*_pMux->endMedia());
+		_pMux.reset();
+	}
+	if (_onMediaWrite) {
 		_pMediaWriter->endMedia(_onMediaWrite);
 		_onMediaWrite = nullptr; // to call _pMediaWriter->begin just after reset (and not on MBR switch!)
 	}
@@ -390,13 +472,15 @@ void Subscription::writeProperties(const Media::Properties& properties) {
 
 	DEBUG(name()," subscription properties sent to ", TypeOf(_target))
 	if(_target.writeProperties(properties)) {
-		if (_pMediaWriter)
+		if (_pMux && pPublication)
+			writeMux(*_pMux->writeProperties(pPublication->sequence(), properties));
+		else if (_onMediaWrite)
 			_pMediaWriter->writeProperties(properties, _onMediaWrite);
 	} else
 		_ejected = EJECTED_ERROR;
 }
 
-void Subscription::writeData(Media::Data::Type type, const Packet& packet, UInt8 track) {
+void Subscription::writeData(Media::Data::Type type, const Packet& packet, UInt8 track, const Media::DataCache* pData) {
 	if (!start(track, type, packet) || !_datas.selected(track))
 		return;
 
@@ -422,14 +506,23 @@ void Subscription::writeData(Media::Data::Type type, const Packet& packet, UInt8
 		}
 		// if data is unreliable, drop the packet
 		++_datas.dropped;
+		if (Metrics::Enabled())
+			Drops.add();
 		WARN(TypeOf(_target), " data packet dropped, insufficient bandwidth to play ", name());
 		return;
 	}
 
-	if (_pMediaWriter)
+	if (_pMux)
+		writeMux(*_pMux->writeData(pPublication->sequence(), track, type, packet));
+	else if (_onMediaWrite)
 		_pMediaWriter->writeData(track, type, packet, _onMediaWrite);
-	else if(!writeToTarget(_datas, track, type, packet))
-		_ejected = EJECTED_ERROR;
+	else {
+		// conversion shared with the other subscriptions which expect the same serialization
+		Media::Data::Type dataType = pData ? _target.dataType() : Media::Data::TYPE_UNKNOWN;
+		const Packet& converted = dataType ? pData->convert(dataType) : Packet::Null();
+		if (!(converted ? writeToTarget(_datas, track, type, packet, converted) : writeToTarget(_datas, track, type, packet)))
+			_ejected = EJECTED_ERROR;
+	}
 }
 
 void Subscription::writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track) {
@@ -459,11 +552,16 @@ void Subscription::writeAudio(const Media::Audio::Tag& tag, const Packet& packet
 		if (!tag.isConfig) {
 			// if it's not config packet and audio is unreliable, drop the packet
 			++_audios.dropped;
+			if (Metrics::Enabled())
+				Drops.add();
 			WARN(TypeOf(_target), " audio packet dropped, insufficient bandwidth to play ", name());
 			return;
 		}
 	}
 
+	if (_pMux)
+		return writeMux(*_pMux->writeAudio(pPublication->sequence(), track, tag, packet)); // shared muxing has its own timeline
+
 	Media::Audio::Tag audio;
 	audio.channels = tag.channels;
 	audio.rate = tag.rate;
@@ -473,7 +571,7 @@ void Subscription::writeAudio(const Media::Audio::Tag& tag, const Packet& packet
 	if (pPublication && typeid(_target)!=typeid(Medias))
 		TRACE(pPublication->name(), " audio time, ", tag.time, "=>", audio.time, tag.isConfig ? " (7)" : " (1)");
 
-	if (_pMediaWriter)
+	if (_onMediaWrite)
 		_pMediaWriter->writeAudio(track, audio, packet, _onMediaWrite);
 	else if(!writeToTarget(_audios, track, audio, packet, tag.isConfig))
 		_ejected = EJECTED_ERROR;
@@ -507,6 +605,8 @@ void Subscription::writeVideo(const Media::Video::Tag& tag, const Packet& packet
 		} else if(pVideo && pVideo->waitKeyFrame) {
 			_medias.clear(); // remove audio between two inter frames
 			++_videos.dropped;
+			if (Metrics::Enabled())
+				Drops.add();
 			if (pVideo->waitKeyFrame > 1)
 				return;
 			pVideo->waitKeyFrame = 2;
@@ -526,6 +626,8 @@ void Subscription::writeVideo(const Media::Video::Tag& tag, const Packet& packet
 		if(!isConfig) {
 			// if it's not config packet and video is unreliable, drop the packet
 			++_videos.dropped;
+			if (Metrics::Enabled())
+				Drops.add();
 			WARN(TypeOf(_target), " video frame dropped, insufficient bandwidth to play ", name());
 			if(pVideo)
 				pVideo->waitKeyFrame = 1;
@@ -533,6 +635,9 @@ void Subscription::writeVideo(const Media::Video::Tag& tag, const Packet& packet
 		}
 	}
 
+	if (_pMux)
+		return writeMux(*_pMux->writeVideo(pPublication->sequence(), track, tag, packet)); // shared muxing has its own timeline
+
 	Media::Video::Tag video;
 	video.compositionOffset = tag.compositionOffset;
 	video.frame = tag.frame;
@@ -541,7 +646,7 @@ void Subscription::writeVideo(const Media::Video::Tag& tag, const Packet& packet
 	if (pPublication && typeid(_target) != typeid(Medias))
 		TRACE(pPublication->name(), " video time, ", tag.time, "=>", video.time, " (", (UInt8)video.frame, ")");
 
-	if (_pMediaWriter)
+	if (_onMediaWrite)
 		_pMediaWriter->writeVideo(track, video, packet, _onMediaWrite);
 	else if (!writeToTarget(_videos, track, video, packet, isConfig))
 		_ejected = EJECTED_ERROR;
@@ -575,15 +680,36 @@ UInt32 Subscription::scaleTime(UInt32 time, bool isConfig) {
 	return time - _startTime + _seekTime;
 }
 
-void Subscription::setFormat(const char* format) {
+void Subscription::setFormat(const char* format, bool sharedOnly) {
 	if (!format && !_pMediaWriter)
 		return;
 	reset(); // end in first to finish the previous format streaming => new format = new stream
 	_pMediaWriter = format ? MediaWriter::New(format) : nullptr;
-	if (format && !_pMediaWriter)
+	_sharedOnly = sharedOnly;
+	if (format && !_pMediaWriter && !sharedOnly)
 		WARN(TypeOf(_target), " subscription format ", format, " unknown or unsupported");
 }
 
+bool Subscription::shareable() const {
+	// shared muxing delivers all the tracks with its own timeline
+	return _audios.multiTracks && !_audios.pSelection && !_videos.pSelection && !_datas.pSelection &&
+		_streams.empty() && !_pNextPublication && !_duration && !_seekTime && !getString("time") && !getString("from");
+}
+
+bool Subscription::shardable() const {
+	// duration and from can reset (so call next), a next subscription writes in the Medias of an other subscription
+	return !_duration && !_from && _streams.empty() && !_pNextPublication && typeid(_target) != typeid(Medias);
+}
+
+void Subscription::writeMux(const deque<Packet>& packets) {
+	for (const Packet& packet : packets) {
+		if (!writeToTarget(_datas, 0, Media::Data::TYPE_MEDIA, packet)) {
+			_ejected = EJECTED_ERROR;
+			return;
+		}
+	}
+}
+
 void Subscription::flush() {
 	_flushable = 0;
 	_target.flush(); // keep flush free even if ejected (usefull for example for ServerAPI::WaitingSync)
@@ -640,6 +766,7 @@ void Subscription::Medias::setNext(Publication* pNextPublication) {
 	}
 	_aligning = false;
 	_pNextSubscription->pPublication = pNextPublication;
+	_pNextSubscription->pOwner = _subscription.pOwner ? _subscription.pOwner : &_subscription; // same shard than its subscription
 	if (!pNextPublication)
 		return;
 	UInt32 lastTime = _subscription.lastTime();
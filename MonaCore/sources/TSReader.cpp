@@ -22,6 +22,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/AVC.h"
 #include "Mona/ADTSReader.h"
 #include "Mona/MP3Reader.h"
+#include "Mona/Bytes.h"
 #include "Mona/Logs.h"
 
 using namespace std;
@@ -47,14 +48,16 @@ UInt32 TSReader::parse(Packet& buffer, Media::Source& source) {
 	do {
 
 		if(!_syncFound) {
-			while (input.read8()!=0x47) {
+			const UInt8* sync = Bytes::Find(input.current(), input.available(), 0x47);
+			if (sync != input.current()) {
 				if (!_syncError) {
 					WARN("TSReader 47 signature not found");
 					_syncError = true;
 				}
-				if (!input.available())
+				if (!sync)
 					return 0;
 			}
+			input.next(UInt32(sync - input.current()) + 1);
 			_syncFound = true;
 			_syncError = false;
 		}
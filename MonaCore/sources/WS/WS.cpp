@@ -18,6 +18,7 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/WS/WS.h"
 #include "Mona/Crypto.h"
+#include "Mona/Bytes.h"
 
 using namespace std;
 
@@ -58,12 +59,9 @@ BinaryWriter& WS::WriteKey(BinaryWriter& writer, const string& key) {
 }
 
 BinaryReader& WS::Unmask(BinaryReader& reader) {
-	UInt32 i;
 	const UInt8* mask(reader.current());
 	reader.next(4);
-	UInt8* bytes = BIN reader.current();
-	for(i=0;i<reader.available();++i)
-		bytes[i] ^= mask[i%4];
+	Bytes::Mask(BIN reader.current(), reader.available(), mask);
 	return reader;
 }
 
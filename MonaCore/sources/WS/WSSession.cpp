@@ -222,16 +222,23 @@ void WSSession::processMessage(Exception& ex, const Packet& message, bool isBina
 }
 
 
-bool WSSession::manage() {
-	if (!Session::manage())
-		return false;
-	if (peer && peer.pingTime.isElapsed(timeout/2)) {
-		writer.writePing(peer.connection);
-		peer.pingTime.update();
+UInt32 WSSession::manage() {
+	UInt32 delay = Session::manage();
+	if (!delay)
+		return 0;
+	if (peer) {
+		if (peer.pingTime.isElapsed(timeout/2)) {
+			writer.writePing(peer.connection);
+			peer.pingTime.update();
+		}
+		delay = min(delay, Remaining(peer.pingTime, max(timeout / 2, UInt32(MANAGE_PERIOD))));
 	}
+	if (_pPublication)
+		delay = min(delay, UInt32(MANAGE_PERIOD)); // flush
 	// check subscription
 	if (!_pSubscription)
-		return true;
+		return delay;
+	delay = min(delay, UInt32(MANAGE_PERIOD));
 	switch (_pSubscription->ejected()) {
 		case Subscription::EJECTED_BANDWITDH:
 			writer.writeInvocation("@unsubscribe").writeString(EXPAND("Insufficient bandwidth"));
@@ -239,10 +246,10 @@ bool WSSession::manage() {
 		case Subscription::EJECTED_ERROR:
 			writer.writeInvocation("@unsubscribe").writeString(EXPAND("Unknown error"));
 			break;
-		default: return true;// no ejected!
+		default: return delay;// no ejected!
 	}
 	unsubscribe();
-	return true;
+	return delay;
 }
 
 void WSSession::flush() {
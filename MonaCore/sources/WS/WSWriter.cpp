@@ -72,7 +72,7 @@ bool WSWriter::writeVideo(const Media::Video::Tag& tag, const Packet& packet, bo
 	return !closed();
 }
 
-bool WSWriter::writeData(Media::Data::Type type, const Packet& packet, bool reliable) {
+bool WSWriter::writeData(Media::Data::Type type, const Packet& packet, const Packet& converted, bool reliable) {
 	// Always JSON (exception for Data::TYPE_MEDIA)
 	// binary => Audio or Video
 	// JSON => Data from server/publication
@@ -81,7 +81,7 @@ bool WSWriter::writeData(Media::Data::Type type, const Packet& packet, bool reli
 		newSender(WS::TYPE_BINARY, packet);
 		return !closed();
 	}
-	DataWriter& writer(writeJSON(type, packet));
+	DataWriter& writer(converted ? writeJSON(converted) : writeJSON(type, packet)); // converted is already JSON
 	// @ => Come from publication (to avoid confusion with message from server write by user)
 	if (type == Media::Data::TYPE_TEXT)
 		writer.writeString(EXPAND("@text"));
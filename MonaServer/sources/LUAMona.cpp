@@ -21,6 +21,8 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/UDPSocket.h"
 #include "Mona/WS/WSClient.h"
 #include "Mona/SRT.h"
+#include "Mona/Metrics.h"
+#include "Mona/JSONReader.h"
 #include "LUAMap.h"
 #include "LUAIPAddress.h"
 #include "LUASocketAddress.h"
@@ -268,6 +270,16 @@ static int hmac(lua_State *pState) {
 	SCRIPT_CALLBACK_RETURN
 }
 
+static int metrics(lua_State *pState) {
+	SCRIPT_CALLBACK(ServerAPI, api)
+		shared<Buffer> pBuffer(SET);
+		Metrics::Write(*pBuffer, Metrics::FORMAT_JSON);
+		Packet packet(pBuffer);
+		ScriptWriter writer(pState);
+		JSONReader(packet).read(writer);
+	SCRIPT_CALLBACK_RETURN
+}
+
 template<> void Script::ObjInit(lua_State *pState, ServerAPI& api) {
 	SCRIPT_BEGIN(pState);
 		SCRIPT_DEFINE("__tab", AddObject<const Parameters>(pState, api));
@@ -320,6 +332,7 @@ template<> void Script::ObjInit(lua_State *pState, ServerAPI& api) {
 
 		SCRIPT_DEFINE("hash", &hash);
 		SCRIPT_DEFINE("hmac", &hmac);
+		SCRIPT_DEFINE_FUNCTION("metrics", &metrics);
 	SCRIPT_END;
 }
 template<> void Script::ObjClear(lua_State *pState, ServerAPI& api) {
@@ -28,7 +28,7 @@ using namespace std;
 namespace Mona {
 
 MonaServer::MonaServer(const Parameters& configs, TerminateSignal& terminateSignal) : _starting(false),
-	Server(configs.getNumber<UInt16>("cores")), _terminateSignal(terminateSignal), _dataPath(configs.getString("dataDir", "data/")) {
+	Server(configs.getNumber<UInt16>("cores"), configs.getNumber<UInt16, 1>("reactors")), _terminateSignal(terminateSignal), _dataPath(configs.getString("dataDir", "data/")) {
 
 }
 
@@ -18,6 +18,8 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/UnitTest.h"
 #include "Mona/BufferPool.h"
+#include "Mona/Metrics.h"
+#include <vector>
 
 using namespace Mona;
 using namespace std;
@@ -78,4 +80,51 @@ ADD_TEST(BufferPool) {
 	CHECK(buffer1.capacity() == 1024);
 }
 
+ADD_TEST(Magazines) {
+	Buffer::Allocator::Set<BufferPool>();
+
+	Buffer::Allocator::Stats before = Buffer::Allocator::ClassStats(7);
+	{
+		Buffer buffer(2000);
+		CHECK(buffer.capacity() == 2048);
+	}
+	{
+		Buffer buffer(2000); // in thread magazine now
+	}
+	Buffer::Allocator::Stats stats = Buffer::Allocator::ClassStats(7);
+	CHECK(stats.hits > before.hits && (stats.hits + stats.misses) == (before.hits + before.misses + 2) && stats.held >= 2048);
+	map<UInt32, Buffer::Allocator::Stats> threads;
+	Buffer::Allocator::ThreadStats(threads);
+	CHECK(threads.count(Thread::CurrentId()) && threads[Thread::CurrentId()].held >= 2048);
+	// exported by class and by thread
+	Buffer metrics;
+	Metrics::Write(metrics);
+	string text(STR metrics.data(), metrics.size());
+	CHECK(text.find("mona_buffers_hits{class=\"2048\"} ") != string::npos && text.find("mona_buffers_held_bytes{class=\"2048\"} ") != string::npos);
+	CHECK(text.find(String("mona_buffers_thread_held_bytes{thread=\"", Thread::CurrentId(), "\"} ")) != string::npos);
+
+	// buffers allocated by one thread and released by an other one
+	vector<shared<Buffer>> buffers;
+	vector<thread> workers;
+	mutex mutex;
+	for (UInt8 i = 0; i < 4; ++i) {
+		workers.emplace_back([&]() {
+			for (UInt32 i = 0; i < 10000; ++i) {
+				shared<Buffer> pBuffer(SET, (i % 2000) + 1);
+				lock_guard<std::mutex> lock(mutex);
+				if (buffers.size() > 100)
+					buffers.erase(buffers.begin()); // can be released by an other thread
+				buffers.emplace_back(move(pBuffer));
+			}
+		});
+	}
+	for (thread& worker : workers)
+		worker.join();
+	buffers.clear();
+	stats = Buffer::Allocator::ClassStats(7);
+	CHECK(stats.hits > before.hits);
+
+	Buffer::Allocator::Set(); // reset default Allocator
+}
+
 }
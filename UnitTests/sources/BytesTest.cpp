@@ -0,0 +1,236 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Bytes.h"
+#include "Mona/Crypto.h"
+#include "Mona/Stopwatch.h"
+#include <vector>
+
+using namespace Mona;
+using namespace std;
+
+namespace BytesTest {
+
+static const Bytes::Kernel Kernels[] = { Bytes::KERNEL_SCALAR, Bytes::KERNEL_SSE2, Bytes::KERNEL_AVX2, Bytes::KERNEL_AVX512 };
+
+static void Random(vector<UInt8>& data, UInt32 seed, UInt8 modulo = 0) {
+	for (UInt8& byte : data) {
+		seed = seed * 1103515245 + 12345;
+		byte = UInt8(seed >> 16);
+		if (modulo)
+			byte %= modulo;
+	}
+}
+
+ADD_TEST(Mask) {
+	Bytes::Kernel current = Bytes::Current();
+	const UInt8 mask[] = { 0x12, 0x34, 0x56, 0x78 };
+	vector<UInt8> data(300), expected;
+	for (Bytes::Kernel kernel : Kernels) {
+		if (!Bytes::Select(kernel))
+			continue;
+		for (UInt32 offset = 0; offset < 4; ++offset) {
+			for (UInt32 size = 0; size < (data.size() - offset); size += 7) {
+				Random(data, size);
+				expected = data;
+				for (UInt32 i = 0; i < size; ++i)
+					expected[offset + i] ^= mask[i % 4];
+				Bytes::Mask(data.data() + offset, size, mask);
+				CHECK(data == expected);
+			}
+		}
+	}
+	Bytes::Select(current);
+}
+
+ADD_TEST(Find) {
+	Bytes::Kernel current = Bytes::Current();
+	vector<UInt8> data(300);
+	Random(data, 1, 0x47); // without 0x47
+	for (Bytes::Kernel kernel : Kernels) {
+		if (!Bytes::Select(kernel))
+			continue;
+		CHECK(!Bytes::Find(data.data(), UInt32(data.size()), 0x47));
+		for (UInt32 position = 0; position < data.size(); ++position) {
+			data[position] = 0x47;
+			CHECK(Bytes::Find(data.data(), UInt32(data.size()), 0x47) == (data.data() + position));
+			CHECK(Bytes::Find(data.data() + position + 1, UInt32(data.size() - position - 1), 0x47) == NULL);
+			data[position] = 0;
+		}
+	}
+	Bytes::Select(current);
+}
+
+ADD_TEST(FindStartCode) {
+	Bytes::Kernel current = Bytes::Current();
+	vector<UInt8> data(300);
+	for (Bytes::Kernel kernel : Kernels) {
+		if (!Bytes::Select(kernel))
+			continue;
+		Random(data, 2, 3); // many 00 and 01 without start code to test the false positives
+		for (UInt32 i = 2; i < data.size(); ++i) {
+			if (!data[i - 2] && !data[i - 1] && data[i] == 1)
+				data[i] = 2;
+		}
+		CHECK(!Bytes::FindStartCode(data.data(), UInt32(data.size())));
+		for (UInt32 position = 0; (position + 3) <= data.size(); position += 5) {
+			vector<UInt8> nal(data);
+			nal[position] = nal[position + 1] = 0;
+			nal[position + 2] = 1;
+			// first start code can be before (00 00 created before position)
+			const UInt8* pFound = Bytes::FindStartCode(nal.data(), UInt32(nal.size()));
+			CHECK(pFound && pFound <= (nal.data() + position) && !pFound[0] && !pFound[1] && pFound[2] == 1);
+			CHECK(Bytes::FindStartCode(nal.data(), position + 2) == NULL || pFound < (nal.data() + position));
+		}
+	}
+	Bytes::Select(current);
+}
+
+// char by char with a string state, as a JSON parser
+static bool CharsIndexJSON(const vector<UInt8>& data, vector<UInt32>& indexes) {
+	bool inString(false), escaped(false), scalar(false);
+	for (UInt32 i = 0; i < data.size(); ++i) {
+		UInt8 c = data[i];
+		bool isEscaped(escaped);
+		escaped = !isEscaped && c == '\\';
+		if (c == '"' && !isEscaped) {
+			indexes.emplace_back(i);
+			inString = !inString;
+			scalar = false;
+		} else if (inString)
+			continue;
+		else if (strchr("{}[]:,", c)) {
+			indexes.emplace_back(i);
+			scalar = false;
+		} else if (isspace(c))
+			scalar = false;
+		else if (!scalar) {
+			indexes.emplace_back(i);
+			scalar = true;
+		}
+	}
+	return !inString;
+}
+
+ADD_TEST(IndexJSON) {
+	Bytes::Kernel current = Bytes::Current();
+	static const char Chars[] = "\"\"\\\\{}[]:, \t\nab1";
+	UInt32 count;
+	vector<UInt32> indexes(300);
+	const char* json = "{\"a\\\"b\":[1, true,{}],\"\\\\\":null}";
+	CHECK(Bytes::IndexJSON(BIN json, UInt32(strlen(json)), indexes.data(), count));
+	CHECK(count == 18 && indexes[1] == 1 && indexes[2] == 6 && indexes[3] == 7 && indexes[5] == 9 && indexes[7] == 12 && indexes[9] == 17 && indexes[14] == 24);
+	CHECK(!Bytes::IndexJSON(BIN "[\"abc\\\"]", 8, indexes.data(), count));
+
+	vector<UInt8> data(300);
+	for (Bytes::Kernel kernel : Kernels) {
+		if (!Bytes::Select(kernel))
+			continue;
+		for (UInt32 size = 0; size <= data.size(); size += 13) {
+			data.resize(size);
+			for (UInt32 seed = 0; seed < 8; ++seed) {
+				Random(data, size * 8 + seed, sizeof(Chars) - 1);
+				for (UInt8& byte : data)
+					byte = Chars[byte];
+				if (seed & 1) { // backslashes sequences over the 64 bytes blocks
+					for (UInt32 i = 60; i < size; i += 64)
+						memset(data.data() + i, '\\', min<UInt32>(seed, size - i));
+				}
+				vector<UInt32> expected;
+				bool terminated = CharsIndexJSON(data, expected);
+				CHECK(Bytes::IndexJSON(data.data(), size, indexes.data(), count) == terminated);
+				CHECK(count == expected.size() && equal(expected.begin(), expected.end(), indexes.begin()));
+			}
+		}
+	}
+	Bytes::Select(current);
+}
+
+// byte by byte with one table, as before slice-by-8
+static UInt32 TableCRC32(const UInt8* data, UInt32 size) {
+	static UInt32 Table[256];
+	if (!Table[1]) {
+		for (UInt32 i = 0; i < 256; ++i) {
+			UInt32 crc = i << 24;
+			for (UInt8 bit = 0; bit < 8; ++bit)
+				crc = (crc << 1) ^ (crc & 0x80000000 ? 0x04C11DB7 : 0);
+			Table[i] = crc;
+		}
+	}
+	UInt32 crc(0xFFFFFFFF);
+	while (size--)
+		crc = (crc << 8) ^ Table[(crc >> 24) ^ *data++];
+	return crc;
+}
+
+ADD_TEST(CRC32) {
+	// MPEG-2 CRC32 of "123456789" is 0x0376E6E7
+	CHECK(Bytes::CRC32(BIN "123456789", 9) == 0x0376E6E7 && Crypto::ComputeCRC32(BIN "123456789", 9) == 0x0376E6E7);
+	vector<UInt8> data(300);
+	Random(data, 3);
+	for (UInt32 size = 0; size <= data.size(); ++size) {
+		UInt32 crc = Bytes::CRC32(data.data(), size);
+		CHECK(crc == TableCRC32(data.data(), size));
+		CHECK(Bytes::CRC32(data.data() + size / 3, size - size / 3, Bytes::CRC32(data.data(), size / 3)) == crc);
+	}
+}
+
+ADD_TEST(Benchmark) {
+	Bytes::Kernel current = Bytes::Current();
+	static const UInt32 Size(1024 * 1024);
+	static const UInt32 Loops(256); // 256MB by kernel
+	vector<UInt8> data(Size);
+	Random(data, 4, 0x47); // no sync byte and no start code to scan all
+	for (UInt8& byte : data) {
+		if (!byte)
+			byte = 2;
+	}
+	const UInt8 mask[] = { 0x12, 0x34, 0x56, 0x78 };
+	Stopwatch chrono;
+	auto rate = [&chrono]() -> string { chrono.stop(); return String(String::Format<double>("%.2f", double(Size) * Loops / 1000000.0 / max(chrono.elapsed(), Int64(1)))); };
+	for (Bytes::Kernel kernel : Kernels) {
+		if (!Bytes::Select(kernel))
+			continue;
+		chrono.restart();
+		for (UInt32 i = 0; i < Loops; ++i)
+			Bytes::Mask(data.data(), Size, mask); // even loops, data unchanged
+		string masking = rate();
+		chrono.restart();
+		for (UInt32 i = 0; i < Loops; ++i)
+			CHECK(!Bytes::Find(data.data() + (i & 7), Size - 8, 0x47));
+		string sync = rate();
+		chrono.restart();
+		for (UInt32 i = 0; i < Loops; ++i)
+			CHECK(!Bytes::FindStartCode(data.data() + (i & 7), Size - 8));
+		NOTE(Bytes::KernelToString(kernel), " mask ", masking, "GB/s, sync ", sync, "GB/s, start code ", rate(), "GB/s");
+	}
+	Bytes::Select(current);
+	UInt32 crc(0);
+	chrono.restart();
+	for (UInt32 i = 0; i < Loops; ++i)
+		crc += TableCRC32(data.data() + (i & 7), Size - 8);
+	string table = rate();
+	chrono.restart();
+	for (UInt32 i = 0; i < Loops; ++i)
+		crc -= Bytes::CRC32(data.data() + (i & 7), Size - 8);
+	NOTE("CRC32 byte table ", table, "GB/s, slice-by-8 ", rate(), "GB/s");
+	CHECK(!crc);
+}
+
+}
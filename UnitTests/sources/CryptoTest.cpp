@@ -0,0 +1,91 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Crypto.h"
+#include "Mona/Util.h"
+#include <vector>
+
+using namespace Mona;
+using namespace std;
+
+namespace CryptoTest {
+
+static void Reference(const UInt8* key, UInt8* data, UInt32 size, bool encrypt) {
+	static const UInt8 IV[Crypto::AES::BLOCK_SIZE] = { 0 };
+	EVP_CIPHER_CTX* pContext = EVP_CIPHER_CTX_new();
+	EVP_CipherInit_ex(pContext, EVP_aes_128_cbc(), NULL, key, IV, encrypt ? 1 : 0);
+	EVP_CIPHER_CTX_set_padding(pContext, 0);
+	int temp;
+	EVP_CipherUpdate(pContext, data, &temp, data, size);
+	EVP_CIPHER_CTX_free(pContext);
+}
+
+static void Fill(UInt8* data, UInt32 size) {
+	while (size--)
+		*data++ = Util::Random<UInt8>();
+}
+
+ADD_TEST(AES) {
+	UInt8 key[Crypto::AES::KEY_SIZE];
+	Fill(key, sizeof(key));
+	Crypto::AES aes(key);
+	for (UInt32 size = 0; size <= 1200; size += Crypto::AES::BLOCK_SIZE) {
+		vector<UInt8> data(size), expected(size);
+		Fill(data.data(), size);
+		memcpy(expected.data(), data.data(), size);
+		Reference(key, expected.data(), size, true);
+		aes.encrypt(data.data(), size);
+		CHECK(data == expected);
+		Reference(key, expected.data(), size, false);
+		aes.decrypt(data.data(), size);
+		CHECK(data == expected);
+	}
+	// a copy keeps the key schedules
+	Crypto::AES copy(aes);
+	UInt8 block[Crypto::AES::BLOCK_SIZE] = { 0 }, expected[Crypto::AES::BLOCK_SIZE] = { 0 };
+	Reference(key, expected, sizeof(expected), true);
+	copy.encrypt(block, sizeof(block));
+	CHECK(memcmp(block, expected, sizeof(block)) == 0);
+}
+
+ADD_TEST(AESBatch) {
+	// more buffers than lanes, with different keys and sizes (and empty ones)
+	const UInt32 COUNT = Crypto::AES::LANES * 3 + 1;
+	UInt8 keys[COUNT][Crypto::AES::KEY_SIZE];
+	vector<unique<Crypto::AES>> aes;
+	vector<vector<UInt8>> datas(COUNT), expecteds(COUNT);
+	Crypto::AES::Job jobs[COUNT];
+	for (UInt32 i = 0; i < COUNT; ++i) {
+		Fill(keys[i], Crypto::AES::KEY_SIZE);
+		aes.emplace_back(new Crypto::AES(keys[i]));
+		UInt32 size = (i % 5) ? (Util::Random<UInt32>() % 75) * Crypto::AES::BLOCK_SIZE : 0;
+		datas[i].resize(size);
+		Fill(datas[i].data(), size);
+		expecteds[i] = datas[i];
+		Reference(keys[i], expecteds[i].data(), size, true);
+		jobs[i].pAES = aes.back().get();
+		jobs[i].data = datas[i].data();
+		jobs[i].size = size;
+	}
+	Crypto::AES::Encrypt(jobs, COUNT);
+	for (UInt32 i = 0; i < COUNT; ++i)
+		CHECK(datas[i] == expecteds[i]);
+}
+
+}
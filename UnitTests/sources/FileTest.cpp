@@ -17,6 +17,7 @@ details (or else see http://www.gnu.org/licenses/).
 */
 
 #include "Mona/UnitTest.h"
+#include "Mona/IOUring.h"
 #include "Mona/FileReader.h"
 #include "Mona/FileWriter.h"
 
@@ -101,7 +102,7 @@ ADD_TEST(FileReader) {
 	CHECK(handler.join(3));
 }
 
-ADD_TEST(FileWriter) {
+static void TestFileWriter() {
 	MainHandler handler;
 	IOFile		io(handler, _ThreadPool);
 	const char* name("temp.mona");
@@ -134,7 +135,29 @@ ADD_TEST(FileWriter) {
 	writer.close();
 
 	CHECK(handler.join(2)); // 2 writing step = 2 onFlush!
+
+	// many packets queued (grouped in vectored writes with io_uring)
+	writer.open(name);
+	for (UInt32 i = 0; i < 1000; ++i)
+		writer.write(salut);
+	io.join();
+	CHECK(writer->written() == 5000 && writer->size(true) == 5000);
+	writer.close();
+
 	CHECK(FileSystem::Delete(ex, name) && !ex);
 }
 
+ADD_TEST(FileWriter) {
+	TestFileWriter();
+}
+
+ADD_TEST(FileWriter_IOUring) {
+	if (!IOUring::Enable()) {
+		NOTE("io_uring unavailable");
+		return;
+	}
+	TestFileWriter();
+	IOUring::Enable(false);
+}
+
 }
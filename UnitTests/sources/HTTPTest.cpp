@@ -0,0 +1,138 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/HTTP/HTTPDecoder.h"
+#include "Mona/HTTP/HTTPCache.h"
+#include "Mona/Client.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace HTTPTest {
+
+static const char Request[] = "GET /live/stream.m3u8?token=6f1c2a HTTP/1.1\r\n"
+	"Host: 192.168.1.10:8080\r\n"
+	"Connection: keep-alive\r\n"
+	"Accept: */*\r\n"
+	"Cache-Control: no-cache\r\n"
+	"Cookie: session=8a7f6e5d4c3b2a19; theme = dark ;lang=en\r\n"
+	"\r\n";
+
+struct Decoder : HTTPDecoder {
+	Decoder(const Handler& handler) : HTTPDecoder(handler, "") {}
+	using HTTPDecoder::decode;
+};
+
+static UInt32 Decode(const string& request, const function<void(HTTP::Request&)>& onRequest) {
+	Signal signal;
+	Handler handler(signal);
+	shared<Socket> pSocket(SET, Socket::TYPE_STREAM);
+	SocketAddress address;
+	UInt32 requests(0);
+	Decoder::OnRequest onDecoded([&](HTTP::Request& request) {
+		++requests;
+		onRequest(request);
+	});
+	Decoder decoder(handler);
+	decoder.onRequest = onDecoded;
+	shared<Buffer> pBuffer(SET, request.data(), UInt32(request.size()));
+	decoder.decode(pBuffer, address, pSocket);
+	handler.flush();
+	return requests;
+}
+
+static string Fields(UInt32 count) {
+	string request("GET /live/stream.m3u8 HTTP/1.1\r\n");
+	for (UInt32 i = 0; i < count; ++i)
+		String::Append(request, "X-Field-", i, ": value", i, "\r\n");
+	return request += "\r\n";
+}
+
+ADD_TEST(FieldsLimit) {
+	// header limited to HTTP::Header::FIELDS fields
+	CHECK(Decode(Fields(HTTP::Header::FIELDS), [](HTTP::Request& request) {
+		CHECK(request && !request.ex);
+		string value;
+		CHECK(request->get("X-Field-63") && request.getString("X-Field-63", value) && value == "value63");
+	}) == 1);
+	// beyond the request is rejected (protocol error)
+	CHECK(Decode(Fields(HTTP::Header::FIELDS + 1), [](HTTP::Request& request) {
+		CHECK(request.ex && !request.count()); // exception => no params
+	}) == 1);
+}
+
+ADD_TEST(Parameters) {
+	// parameters materialized on access, from the views null terminated in the buffer received
+	CHECK(Decode(Request, [](HTTP::Request& request) {
+		CHECK(request && !request.ex);
+		CHECK(String::ICompare(request->get("host"), "192.168.1.10:8080") == 0);
+		string value;
+		CHECK(request.getString("Host", value) && value == "192.168.1.10:8080");
+		CHECK(request.getString("Cache-Control", value) && value == "no-cache");
+		CHECK(request.getString("session", value) && value == "8a7f6e5d4c3b2a19");
+		CHECK(request.getString("theme", value) && value == "dark");
+		CHECK(request.getString("lang", value) && value == "en");
+		CHECK(request.getNumber<double>("version") == 1.1);
+	}) == 1);
+}
+
+ADD_TEST(PeerProperties) {
+	// peer properties materialized just on first access (see HTTPSession)
+	CHECK(Decode(Request, [](HTTP::Request& request) {
+		shared<const HTTP::Header> pHeader(request);
+		Client::Properties properties;
+		properties.setString("old", "value");
+		UInt32 version = properties.version;
+		UInt32 fills(0);
+		properties.setParams([pHeader, &fills](Parameters& properties) { ++fills; pHeader->fill(properties); });
+		CHECK(!fills && properties.version != version);
+		string value;
+		CHECK(properties.getString("session", value) && value == "8a7f6e5d4c3b2a19" && !properties.hasKey("old"));
+		CHECK(properties.count() == request.count() && fills == 1);
+		// a property set before any access keeps the header ones
+		properties.setParams([pHeader, &fills](Parameters& properties) { ++fills; pHeader->fill(properties); });
+		properties.setString("theme", "light");
+		CHECK(fills == 2 && properties.count() == request.count());
+		CHECK(properties.getString("theme", value) && value == "light" && properties.getString("Host", value));
+	}) == 1);
+}
+
+ADD_TEST(CacheWatch) {
+	// file updates are queued on the main handler and can run after the cache deletion
+	Signal signal;
+	Handler handler(signal);
+	ThreadPool threadPool;
+	IOFile io(handler, threadPool);
+	Exception ex;
+	const char* name("temp.mona");
+	CHECK(File(name, File::MODE_WRITE).write(ex, EXPAND("Salut")) && !ex);
+	Path file(name);
+	shared<HTTPCache> pCache(SET, io, 0x10000);
+	pCache->add(file, Packet(EXPAND("Salut")), MIME::TYPE_TEXT, "plain");
+	CHECK(pCache->count() == 1 && pCache->get(file));
+	CHECK(signal.wait(14000)); // first watch
+	handler.flush();
+	CHECK(pCache->count() == 1); // file unchanged since its reading
+	CHECK(FileSystem::Delete(ex, name) && !ex);
+	CHECK(signal.wait(14000)); // deletion
+	pCache.reset();
+	handler.flush(); // update of a cache deleted
+}
+
+}
@@ -0,0 +1,159 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Handler.h"
+#include "Mona/ThreadQueue.h"
+#include "Mona/Stopwatch.h"
+#include <deque>
+#include <vector>
+
+using namespace Mona;
+using namespace std;
+
+namespace HandlerTest {
+
+static const UInt32 Producers(4);
+static const UInt32 Runs(50000);
+
+struct Counter : Runner {
+	Counter(atomic<UInt32>& count) : Runner("Counter"), _count(count) {}
+private:
+	bool run(Exception& ex) { ++_count; return true; }
+	atomic<UInt32>& _count;
+};
+
+template<typename QueueType>
+static Int64 Produce(QueueType& queue, atomic<UInt32>& count) {
+	Stopwatch chrono;
+	chrono.start();
+	vector<thread> producers;
+	for (UInt32 i = 0; i < Producers; ++i) {
+		producers.emplace_back([&queue, &count]() {
+			for (UInt32 i = 0; i < Runs; ++i)
+				queue.push(Slab::MakeShared<Counter>(count));
+		});
+	}
+	// consumer
+	UInt32 runs(0);
+	while (runs < (Producers*Runs)) {
+		shared<Runner> pRunner(queue.pop());
+		if (!pRunner)
+			continue;
+		pRunner->run('.', pRunner->name);
+		++runs;
+	}
+	for (thread& producer : producers)
+		producer.join();
+	chrono.stop();
+	return chrono.elapsed();
+}
+
+struct LockedQueue : virtual Object {
+	void push(shared<Runner>&& pRunner) {
+		lock_guard<mutex> lock(_mutex);
+		_runners.emplace_back(move(pRunner));
+	}
+	shared<Runner> pop() {
+		lock_guard<mutex> lock(_mutex);
+		if (_runners.empty())
+			return nullptr;
+		shared<Runner> pRunner(move(_runners.front()));
+		_runners.pop_front();
+		return pRunner;
+	}
+private:
+	mutex					_mutex;
+	deque<shared<Runner>>	_runners;
+};
+
+ADD_TEST(RunnerQueue) {
+	atomic<UInt32> count(0);
+	RunnerQueue queue;
+	Produce(queue, count);
+	CHECK(count == Producers*Runs && queue.empty() && !queue.pop());
+
+	queue.push(Slab::MakeShared<Counter>(count));
+	queue.push(Slab::MakeShared<Counter>(count));
+	CHECK(queue.size() == 2);
+	queue.clear();
+	CHECK(queue.empty() && count == Producers*Runs);
+}
+
+ADD_TEST(Handler) {
+	Signal signal;
+	Handler handler(signal);
+	atomic<UInt32> count(0);
+	vector<thread> producers;
+	for (UInt32 i = 0; i < Producers; ++i) {
+		producers.emplace_back([&handler, &count]() {
+			for (UInt32 i = 0; i < Runs; ++i)
+				handler.queue<Counter>(count);
+		});
+	}
+	UInt32 flushed(0);
+	while (flushed < (Producers*Runs)) {
+		signal.wait(1000);
+		flushed += handler.flush();
+	}
+	for (thread& producer : producers)
+		producer.join();
+	CHECK(flushed == Producers*Runs && count == flushed);
+
+	// last flush, no more queueing possible
+	CHECK(handler.tryQueue<Counter>(count));
+	CHECK(handler.flush(true) == 1 && count == (flushed + 1));
+	CHECK(!handler.tryQueue<Counter>(count) && !handler.flush());
+}
+
+ADD_TEST(ThreadQueue) {
+	atomic<UInt32> count(0);
+	{
+		ThreadQueue threadQueue;
+		vector<thread> producers;
+		for (UInt32 i = 0; i < Producers; ++i) {
+			producers.emplace_back([&threadQueue, &count]() {
+				for (UInt32 i = 0; i < Runs; ++i)
+					threadQueue.queue<Counter>(count);
+			});
+		}
+		for (thread& producer : producers)
+			producer.join();
+		while (count < (Producers*Runs))
+			Thread::Sleep(10);
+		threadQueue.stop();
+		CHECK(count == Producers*Runs);
+		// restart on queue after stop
+		threadQueue.queue<Counter>(count);
+		while (count == (Producers*Runs))
+			Thread::Sleep(10);
+	}
+	CHECK(count == (Producers*Runs + 1));
+}
+
+ADD_TEST(Benchmark) {
+	atomic<UInt32> count(0);
+	LockedQueue lockedQueue;
+	Int64 locked = Produce(lockedQueue, count);
+	RunnerQueue runnerQueue;
+	Int64 lockFree = Produce(runnerQueue, count);
+	CHECK(count == 2 * Producers*Runs);
+	NOTE(Producers, " producers x ", Runs, " runners, mutex+deque ", locked, "ms, lock-free RunnerQueue ", lockFree, "ms");
+}
+
+}
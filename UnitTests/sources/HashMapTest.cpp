@@ -0,0 +1,75 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/HashMap.h"
+#include "Mona/SocketAddress.h"
+#include <map>
+
+using namespace Mona;
+using namespace std;
+
+namespace HashMapTest {
+
+ADD_TEST(Random) {
+	// compare to std::map on random insertions and deletions (small keys range to get clusters and collisions)
+	HashMap<UInt32, UInt32> hashMap;
+	map<UInt32, UInt32> reference;
+	for (UInt32 i = 0; i < 100000; ++i) {
+		UInt32 key = Util::Random<UInt32>() % 5000;
+		if (Util::Random<UInt8>() & 1) {
+			auto result = hashMap.emplace(key, i);
+			CHECK(result.second == reference.emplace(key, i).second && *result.first == reference[key]);
+		} else
+			CHECK(hashMap.erase(key) == (reference.erase(key) > 0));
+		CHECK(hashMap.size() == reference.size());
+	}
+	for (UInt32 key = 0; key < 5000; ++key) {
+		UInt32* pValue = hashMap.find(key);
+		const auto& it = reference.find(key);
+		CHECK(it == reference.end() ? !pValue : (pValue && *pValue == it->second));
+	}
+	UInt32 count(0);
+	hashMap.forEach([&count, &reference](UInt32 key, UInt32 value) {
+		++count;
+		return reference[key] == value;
+	});
+	CHECK(count == reference.size());
+	CHECK(hashMap.capacity() >= hashMap.size() && (hashMap.size() <= hashMap.capacity() * 3 / 4));
+	hashMap.clear();
+	CHECK(hashMap.empty() && !hashMap.find(0));
+}
+
+ADD_TEST(SocketAddress) {
+	HashMap<SocketAddress, UInt32, SocketAddress::Hasher> hashMap;
+	Exception ex;
+	SocketAddress address;
+	for (UInt16 port = 1; port <= 1000; ++port) {
+		CHECK(address.set(ex, "192.168.1.1", port) && !ex);
+		CHECK(hashMap.emplace(address, port).second);
+		CHECK(address.set(ex, "::1", port) && !ex);
+		CHECK(hashMap.emplace(address, port + 1000).second);
+	}
+	CHECK(hashMap.size() == 2000);
+	CHECK(address.set(ex, "192.168.1.1", 500) && *hashMap.find(address) == 500);
+	CHECK(address.set(ex, "192.168.1.2", 500) && !hashMap.find(address));
+	CHECK(address.set(ex, "::1", 500) && *hashMap.find(address) == 1500);
+	CHECK(hashMap.erase(address) && !hashMap.find(address) && hashMap.size() == 1999);
+}
+
+}
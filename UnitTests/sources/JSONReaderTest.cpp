@@ -0,0 +1,251 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/JSONReader.h"
+#include "Mona/Bytes.h"
+#include <random>
+
+using namespace std;
+using namespace Mona;
+
+namespace JSONReaderTest {
+
+static const Bytes::Kernel Kernels[] = { Bytes::KERNEL_SCALAR, Bytes::KERNEL_SSE2, Bytes::KERNEL_AVX2, Bytes::KERNEL_AVX512 };
+
+// writes every call in a string to compare two readings
+struct TraceWriter : DataWriter {
+	string trace;
+	void	writePropertyName(const char* value) { String::Append(trace, "P(", value, ")"); }
+	void	writeNumber(double value) { String::Append(trace, "N(", value, ")"); }
+	void	writeString(const char* value, UInt32 size) { String::Append(trace, "S(", string(value, size), ")"); }
+	void	writeBoolean(bool value) { trace += value ? "T" : "F"; }
+	void	writeNull() { trace += "0"; }
+	UInt64	writeDate(const Date& date) { String::Append(trace, "D(", date.time(), ")"); return 0; }
+	UInt64	writeByte(const Packet& bytes) { String::Append(trace, "B(", string(STR bytes.data(), bytes.size()), ")"); return 0; }
+	UInt64	beginObject(const char* type) { String::Append(trace, "{", type ? type : ""); return 0; }
+	void	endObject() { trace += "}"; }
+	UInt64	beginArray(UInt32 size) { String::Append(trace, "[", size); return 0; }
+	void	endArray() { trace += "]"; }
+};
+
+// mode 0 reads all, mode 1 reads value by value, mode 2 skips some values (with or without nextType before) then reads all again
+static string Trace(JSONReader& reader, UInt8 mode) {
+	TraceWriter writer;
+	if (!mode)
+		reader.read(writer);
+	else if (mode == 1) {
+		while (reader.read(writer, 1))
+			String::Append(writer.trace, "|", reader->position(), "|");
+	} else {
+		UInt32 i = 0;
+		while (reader.available()) {
+			if (i % 3 == 1)
+				reader.nextType();
+			if (i % 3 == 2)
+				reader.read(writer, 1);
+			else
+				reader.next();
+			String::Append(writer.trace, "<", reader->position(), ">");
+			if (++i % 7 == 0) {
+				reader.next(2);
+				String::Append(writer.trace, "<<", reader->position(), ">>");
+			}
+		}
+		reader.reset();
+		writer.trace += '#';
+		reader.read(writer);
+	}
+	String::Append(writer.trace, "@", reader->position());
+	return writer.trace;
+}
+
+// compares the tape path with the char by char path in every mode
+static bool Compare(const string& json, bool skipping = true) {
+	for (UInt8 mode = 0; mode < 3; ++mode) {
+		if (mode == 2 && !skipping)
+			break; // a skipped value is not parsed, so can't stop on its error as the char by char path
+		Packet packet(json.data(), json.size());
+		JSONReader tape(packet, 0), chars(packet, 0xFFFFFFFF);
+		if (Trace(tape, mode) != Trace(chars, mode))
+			return false;
+		if (memcmp(packet.data(), json.data(), json.size()) != 0)
+			return false; // reading must not change the buffer
+	}
+	return true;
+}
+
+static mt19937 Random(42); // deterministic
+
+static void GenerateString(string& json) {
+	static const char* Samples[] = { "abc", "", "a\\\"b", "\\\\", "2020-01-02T03:04:05Z", "x,y}]", "__type", "h\xC3\xA9llo", "\\u00e9", "12", "true", "\\\"{[\\\"" };
+	String::Append(json, '"', Samples[Random() % 12], '"');
+}
+
+static void GenerateValue(string& json, UInt8 depth) {
+	static const char* Spaces[] = { "", "", "", " ", "\n\t", "  " };
+	json += Spaces[Random() % 6];
+	switch (Random() % (depth > 4 ? 4 : 7)) {
+		case 0:
+			GenerateString(json);
+			break;
+		case 1: {
+			static const char* Numbers[] = { "1", "-2.5", "0.125", "0", "123456789012" };
+			json += Numbers[Random() % 5];
+			break;
+		}
+		case 2:
+			json += Random() % 2 ? "true" : "false";
+			break;
+		case 3:
+			json += "null";
+			break;
+		case 4:
+		case 5: {
+			json += '{';
+			UInt32 count = Random() % 5;
+			if (count && !(Random() % 4)) {
+				json += count == 1 && Random() % 2 ? "\"__bin\":\"AAEC\"" : "\"__type\":\"MyType\""; // __bin alone, the char by char path skips wrongly the following properties
+				if (--count)
+					json += ',';
+			}
+			for (UInt32 i = 0; i < count; ++i) {
+				if (i)
+					json += ',';
+				GenerateString(json);
+				json += ':';
+				GenerateValue(json, depth + 1);
+			}
+			json += '}';
+			break;
+		}
+		default: {
+			json += '[';
+			UInt32 count = Random() % 5;
+			for (UInt32 i = 0; i < count; ++i) {
+				if (i)
+					json += ',';
+				GenerateValue(json, depth + 1);
+			}
+			json += ']';
+		}
+	}
+}
+
+
+ADD_TEST(Tape) {
+	Bytes::Kernel current = Bytes::Current();
+	for (Bytes::Kernel kernel : Kernels) {
+		if (!Bytes::Select(kernel))
+			continue;
+		CHECK(Compare("[]") && Compare("{}") && Compare("  [ \"a\" , {\"b\":[true,null]} ]  "));
+		CHECK(Compare("{\"__type\":\"T\",\"a\":1}") && Compare("{\"__bin\":\"AAEC\"}") && Compare("[{\"a\":\"2021-05-06\"}]"));
+		CHECK(Compare("[\"x\\\\\",\"\\\"]\\\"\",{\"}\":\"{\\\"\\\\\"},[[[[[[[[1]]]]]]]]]"));
+		for (UInt32 i = 0; i < 2000; ++i) {
+			string json(1, Random() % 2 ? '[' : '{');
+			UInt32 count = Random() % 6;
+			for (UInt32 j = 0; j < count; ++j) {
+				if (j)
+					json += ',';
+				if (json[0] == '{') {
+					GenerateString(json);
+					json += ':';
+				}
+				GenerateValue(json, 0);
+			}
+			json += json[0] == '[' ? ']' : '}';
+			CHECK(Compare(json));
+		}
+	}
+	Bytes::Select(current);
+}
+
+ADD_TEST(Skip) {
+	// value skipped from tape (jump) or char by char must finish on the same position
+	static const string JSON("[{\"a\":{\"b\":[1,{\"c\":\"}]\"}]},\"d\":[]},\"s\\\"]}\",[1,[2,[3]],{}],true,null,4,\"end\"]");
+	for (UInt32 tapeMinSize : { 0u, 0xFFFFFFFFu }) {
+		JSONReader reader(Packet(JSON.data(), JSON.size()), tapeMinSize);
+		CHECK(reader.isValid());
+		CHECK(reader.nextType() == DataReader::OTHER);
+		reader.next(); // object
+		string value;
+		CHECK(reader.readString(value) && value == "s\\\"]}"); // escape kept
+		reader.next(); // array
+		bool boolean(false);
+		CHECK(reader.readBoolean(boolean) && boolean);
+		CHECK(reader.nextType() == DataReader::NIL);
+		reader.next(2); // null and 4
+		value.clear();
+		CHECK(reader.readString(value) && value == "end");
+		CHECK(!reader.available());
+		reader.reset();
+		reader.next(6);
+		CHECK(reader.nextType() == DataReader::STRING);
+		reader.next(2); // one more than available
+		CHECK(!reader.available());
+	}
+	// an object at the root (buffer writable, property names are terminated in place on reading)
+	static const string ROOT("{\"a\":[1,2],\"b\":{\"c\":\"]\"}}");
+	for (UInt32 tapeMinSize : { 0u, 0xFFFFFFFFu }) {
+		JSONReader reader(Packet(ROOT.data(), ROOT.size()), tapeMinSize);
+		reader.next();
+		CHECK(!reader.available());
+	}
+	CHECK(Compare("[\"abc\",\"\\\"\",\"\\\\\",\"]\",\"}\"]"));
+	CHECK(Compare("[[],{},[[]],{\"a\":{}},[{},[]]]"));
+}
+
+ADD_TEST(Malformed) {
+	CHECK(!JSONReader(Packet(EXPAND("abc"))).isValid());
+	CHECK(!JSONReader(Packet(EXPAND("[1,2"))).isValid());
+	CHECK(!JSONReader(Packet(EXPAND("{\"a\":1"))).isValid());
+	CHECK(!JSONReader(Packet(EXPAND("[1] x"))).isValid());
+	// structure invalid inside: the tape is refused and the char by char path reports the error
+	static const char* Samples[] = { "[abc, 1]", "[[abc],2]", "{\"a\":{\"b\":xyz},\"c\":1}", "[1,,2]", "[1,2,]", "{\"a\":1,}", "{\"a\" 1}",
+		"[\"abc]", "{\"a\":1} {\"b\":2}", "[1] [2]", "[1 2]", "[tr ue]", "[{]}]", "{\"a\":[1,2}", "[\"a\"\"b\"]", "{\"a\":1:2}", "[\"__bin\"]", "{\"__type\":1}",
+		"[TRUE]", "{\"a\":Null}", "[1e3]" };
+	for (const char* json : Samples)
+		CHECK(Compare(json, false));
+	// mutations of valid JSON
+	Random.seed(24);
+	for (UInt32 i = 0; i < 2000; ++i) {
+		string json("[");
+		GenerateValue(json, 0);
+		json += ']';
+		for (UInt32 j = Random() % 3 + 1; j--;) {
+			UInt32 at = Random() % json.size();
+			char marker = ",:[]{}\" x"[Random() % 9];
+			switch (Random() % 3) {
+				case 0:
+					json.erase(at, 1);
+					break;
+				case 1:
+					json.insert(at, 1, marker);
+					break;
+				default:
+					json[at] = marker;
+			}
+			if (json.empty())
+				break;
+		}
+		CHECK(Compare(json, false));
+	}
+}
+
+
+}
@@ -0,0 +1,134 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Logs.h"
+#include <vector>
+
+using namespace Mona;
+using namespace std;
+
+namespace LogsTest {
+
+struct Entry {
+	Entry(UInt32 threadId, const string& message) : threadId(threadId), message(message) {}
+	UInt32 threadId;
+	string message;
+};
+static vector<Entry> Entries; // protected by the Logs mutex
+
+struct TestLogger : Logger {
+	bool log(LOG_LEVEL level, const Path& file, long line, const string& message) {
+		Entries.emplace_back(Logs::CurrentThreadId(), message);
+		return true;
+	}
+	bool dump(const string& header, const UInt8* data, UInt32 size) {
+		Entries.emplace_back(Logs::CurrentThreadId(), header);
+		return true;
+	}
+};
+
+struct Capture : virtual Object {
+	Capture() : _level(Logs::GetLevel()) {
+		Entries.clear();
+		Logs::RemoveLogger("console");
+		Logs::AddLogger<TestLogger>("test");
+		Logs::SetLevel(LOG_INFO);
+	}
+	~Capture() {
+		Logs::SetAsync(false);
+		Logs::SetRateLimit(0);
+		Logs::RemoveLogger("test");
+		Logs::AddLogger<ConsoleLogger>("console");
+		Logs::SetLevel(_level);
+	}
+private:
+	LOG_LEVEL _level;
+};
+
+static void Produce(UInt32 count, vector<UInt32>& threadIds) {
+	vector<thread> threads;
+	for (UInt8 i = 0; i < 2; ++i) {
+		threads.emplace_back([count, i, &threadIds]() {
+			threadIds[i] = Thread::CurrentId();
+			for (UInt32 n = 0; n < count; ++n)
+				INFO(n);
+		});
+	}
+	for (thread& thread : threads)
+		thread.join();
+	Logs::Flush();
+}
+
+ADD_TEST(Async) {
+	Capture capture;
+	Logs::SetAsync(true, 0x100000, Logs::OVERFLOW_BLOCK);
+	CHECK(Logs::Async());
+	vector<UInt32> threadIds(2, 0);
+	Produce(5000, threadIds);
+	// everything delivered, in order for each thread, with the thread id of the caller
+	vector<UInt32> next(2, 0);
+	for (const Entry& entry : Entries) {
+		UInt8 i = entry.threadId == threadIds[0] ? 0 : 1;
+		CHECK(entry.threadId == threadIds[i] && entry.message == String(next[i]++));
+	}
+	CHECK(next[0] == 5000 && next[1] == 5000);
+
+	Logs::SetAsync(false);
+	CHECK(!Logs::Async());
+	Entries.clear();
+	INFO("sync");
+	CHECK(Entries.size() == 1 && Entries.back().threadId == Thread::CurrentId());
+}
+
+ADD_TEST(Drop) {
+	Capture capture;
+	UInt64 dropped = Logs::Dropped();
+	Logs::SetAsync(true, 0x1000, Logs::OVERFLOW_DROP);
+	vector<UInt32> threadIds(2, 0);
+	Produce(5000, threadIds);
+	dropped = Logs::Dropped() - dropped;
+	UInt32 received(0);
+	bool reported(false);
+	for (const Entry& entry : Entries) {
+		if (entry.message.find("dropped") == string::npos)
+			++received;
+		else
+			reported = true;
+	}
+	CHECK(received + dropped == 10000 && reported == (dropped > 0));
+}
+
+ADD_TEST(RateLimit) {
+	Capture capture;
+	Logs::SetRateLimit(3);
+	for (UInt8 i = 0; i < 10; ++i) {
+		if (i == 9) // next second
+			Thread::Sleep(1100);
+		INFO("limited");
+	}
+	CHECK(Entries.size() >= 4 && Entries.size() < 10);
+	CHECK(Entries.back().message.find("similar logs suppressed") != string::npos);
+	// FATAL and CRITIC are never limited
+	Entries.clear();
+	for (UInt8 i = 0; i < 10; ++i)
+		CRITIC("critic");
+	CHECK(Entries.size() == 10);
+}
+
+}
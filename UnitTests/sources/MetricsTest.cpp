@@ -0,0 +1,118 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Metrics.h"
+#include <vector>
+
+using namespace Mona;
+using namespace std;
+
+namespace MetricsTest {
+
+ADD_TEST(Buckets) {
+	for (UInt64 value = 0; value < 16; ++value)
+		CHECK(Metrics::Histogram::Bucket(value) == value && Metrics::Histogram::BucketMax(UInt16(value)) == value);
+	UInt16 last = 0;
+	for (UInt64 value = 16; value < (1ull << 36); value += (value >> 5) + 1) {
+		UInt16 bucket = Metrics::Histogram::Bucket(value);
+		CHECK(bucket >= last && bucket < Metrics::Histogram::BUCKETS);
+		last = bucket;
+		UInt64 max = Metrics::Histogram::BucketMax(bucket);
+		CHECK(max >= value && (max - value) <= (value >> 3)); // 12.5% of precision
+	}
+	CHECK(Metrics::Histogram::Bucket(0xFFFFFFFFFFFFFFFFull) == Metrics::Histogram::BUCKETS - 1);
+}
+
+ADD_TEST(Histogram) {
+	Metrics::Histogram histogram("test_histogram", "Test histogram");
+	for (UInt64 value = 1; value <= 1000; ++value)
+		histogram.add(value);
+	Metrics::Histogram::Snapshot snapshot;
+	histogram.snapshot(snapshot);
+	CHECK(snapshot.count == 1000 && snapshot.sum == 500500 && snapshot.max == 1000);
+	UInt64 p50 = snapshot.percentile(0.5);
+	UInt64 p99 = snapshot.percentile(0.99);
+	CHECK(p50 >= 500 && p50 <= 563);
+	CHECK(p99 >= 990 && p99 <= 1000);
+	CHECK(snapshot.percentile(1) == 1000 && snapshot.percentile(0) == 1);
+}
+
+ADD_TEST(Threads) {
+	Metrics::Counter counter("test_counter", "Test counter");
+	Metrics::Histogram histogram("test_threads", NULL);
+	vector<thread> threads;
+	for (UInt8 i = 0; i < 4; ++i) {
+		threads.emplace_back([&counter, &histogram]() {
+			for (UInt32 i = 0; i < 100000; ++i) {
+				counter.add();
+				histogram.add(i);
+			}
+		});
+	}
+	for (thread& thread : threads)
+		thread.join();
+	CHECK(counter.value() == 400000);
+	Metrics::Histogram::Snapshot snapshot;
+	CHECK(histogram.snapshot(snapshot).count == 400000 && snapshot.max == 99999);
+}
+
+ADD_TEST(Write) {
+	Metrics::Gauge gauge("test_gauge", "Test gauge");
+	Metrics::Gauge probe("test_probe", "Test probe", []() { return 42; });
+	gauge.set(7);
+	gauge.add(-2);
+	CHECK(gauge.value() == 5 && probe.value() == 42);
+
+	Buffer buffer;
+	Metrics::Write(buffer);
+	string text(STR buffer.data(), buffer.size());
+	CHECK(text.find("# TYPE test_gauge gauge\ntest_gauge 5\n") != string::npos);
+	CHECK(text.find("test_probe 42\n") != string::npos);
+	CHECK(text.find("# TYPE mona_handler_wait_us summary\n") != string::npos);
+
+	buffer.clear();
+	Metrics::Write(buffer, Metrics::FORMAT_JSON);
+	text.assign(STR buffer.data(), buffer.size());
+	CHECK(text.front() == '{' && text.back() == '}');
+	CHECK(text.find("\"test_gauge\":5") != string::npos && text.find("\"test_probe\":42") != string::npos);
+
+	// labelled series
+	Metrics::Series series("test_series", "class", "Test series", [](const Metrics::Series::Add& add) {
+		add("16", 3);
+		add("32", 4);
+	}, true);
+	buffer.clear();
+	Metrics::Write(buffer);
+	text.assign(STR buffer.data(), buffer.size());
+	CHECK(text.find("# TYPE test_series counter\ntest_series{class=\"16\"} 3\ntest_series{class=\"32\"} 4\n") != string::npos);
+	CHECK(text.find("# TYPE mona_buffers_held_bytes gauge\n") != string::npos && text.find("# TYPE mona_buffers_thread_hits counter\n") != string::npos);
+	buffer.clear();
+	Metrics::Write(buffer, Metrics::FORMAT_JSON);
+	text.assign(STR buffer.data(), buffer.size());
+	CHECK(text.find("\"test_series\":{\"16\":3,\"32\":4}") != string::npos);
+
+	// local metric, not registered
+	Metrics::Histogram local(NULL, NULL);
+	local.add(5);
+	buffer.clear();
+	Metrics::Write(buffer, Metrics::FORMAT_JSON);
+	CHECK(buffer.size() == text.size() && memcmp(buffer.data(), text.data(), text.size()) == 0);
+}
+
+}
@@ -0,0 +1,290 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Publication.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace PublicationTest {
+
+static thread::id Main;
+
+struct Target : Media::Target, virtual Object {
+	Target() : audios(0), ends(0), pooled(false), errors(0) {}
+
+	UInt32	audios;
+	UInt32	ends;
+	bool	pooled; // written one time at less by a shard of the thread pool
+	UInt32	errors; // written by a shard while the subscription can end or switch
+
+	bool beginMedia(const string& name) { return check(); }
+	bool writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) { ++audios; return check(); }
+	bool endMedia() { ++ends; return check(); }
+	void flush() { check(); }
+
+	void subscribe(Subscription& subscription, Publication& publication) {
+		_pSubscription = &subscription;
+		((set<Subscription*>&)publication.subscriptions).emplace(&subscription);
+		subscription.pPublication = &publication;
+	}
+private:
+	bool check() {
+		if (this_thread::get_id() == Main)
+			return true;
+		pooled = true;
+		if (!_pSubscription->shardable())
+			++errors;
+		return true;
+	}
+	Subscription* _pSubscription;
+};
+
+ADD_TEST(ShardsDurationAndMBR) {
+	Main = this_thread::get_id();
+	ThreadPool threadPool(3);
+	Publication low("low", threadPool), high("high", threadPool);
+	low.setNumber("shards", 4);
+	high.setNumber("shards", 4);
+	low.start();
+	high.start();
+	CHECK(low.shards() == 4 && high.shards() == 4);
+
+	// viewers spread on shards
+	vector<Target> targets(8);
+	deque<Subscription> subscriptions;
+	for (Target& target : targets) {
+		subscriptions.emplace_back(target);
+		target.subscribe(subscriptions.back(), low);
+	}
+	// a subscription which ends after 100ms (reset 10 seconds after)
+	Target durationTarget;
+	Subscription duration(durationTarget);
+	duration.setNumber("duration", 100);
+	durationTarget.subscribe(duration, low);
+	// a MBR subscription which switches from low to high
+	Target mbrTarget;
+	Subscription mbr(mbrTarget);
+	mbr.setString("mbr", "low|high");
+	mbrTarget.subscribe(mbr, low);
+	UInt32 nexts(0);
+	mbr.onNext = [&](Publication& publication) {
+		// like ServerAPI, changes publications subscriptions
+		CHECK(this_thread::get_id() == Main);
+		((set<Subscription*>&)mbr.pPublication->subscriptions).erase(&mbr);
+		mbr.pPublication = &publication;
+		++nexts;
+	};
+
+	Media::Audio::Tag tag(Media::Audio::CODEC_AAC);
+	tag.rate = 44100;
+	tag.channels = 2;
+	shared<Buffer> pBuffer(SET, 64);
+	Packet packet(pBuffer);
+	for (UInt32 time = 0; time <= 12000; time += 20) {
+		if (time == 1000) {
+			// MBR switch (see ServerAPI onMBR)
+			((set<Subscription*>&)high.subscriptions).emplace(&mbr);
+			CHECK(!mbr.setNext(&high));
+			CHECK(!mbr.shardable());
+		}
+		tag.time = time;
+		low.writeAudio(tag, packet);
+		high.writeAudio(tag, packet);
+		low.flush();
+		high.flush();
+	}
+
+	CHECK(nexts == 1 && mbr.pPublication == &high);
+	CHECK(low.subscriptions.find(&mbr) == low.subscriptions.end());
+	CHECK(mbrTarget.audios > 550 && !mbrTarget.errors);
+	CHECK(durationTarget.ends && durationTarget.audios < 20 && !durationTarget.errors);
+	bool pooled(false);
+	for (const Target& target : targets) {
+		CHECK(target.audios == 601 && !target.errors);
+		pooled |= target.pooled;
+	}
+	CHECK(pooled);
+
+	// release
+	low.stop();
+	high.stop();
+	for (Subscription& subscription : subscriptions)
+		subscription.pPublication = NULL;
+	duration.pPublication = mbr.pPublication = NULL;
+	((set<Subscription*>&)low.subscriptions).clear();
+	((set<Subscription*>&)high.subscriptions).clear();
+}
+
+struct Relay : Media::Target, virtual Object {
+	Relay(Publication& publication) : publication(publication), nested(false) {}
+	Publication& publication;
+	bool		 nested;
+	bool beginMedia(const string& name) { return true; }
+	bool writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, bool reliable) {
+		if (this_thread::get_id() != Main)
+			nested = true;
+		publication.writeAudio(tag, packet, track);
+		return true;
+	}
+	void flush() { publication.flush(); }
+};
+
+ADD_TEST(NestedFanOut) {
+	Main = this_thread::get_id();
+	ThreadPool threadPool(2);
+	Publication source("source", threadPool);
+	source.setNumber("shards", 3);
+	source.start();
+	// relays written by shards of the pool, each one fans out to its own sharded publication
+	deque<Publication> publications;
+	deque<Relay> relays;
+	deque<Subscription> subscriptions;
+	vector<Target> targets(32);
+	for (UInt8 i = 0; i < 8; ++i) {
+		publications.emplace_back(String("relay", i), threadPool);
+		Publication& publication(publications.back());
+		publication.setNumber("shards", 3);
+		publication.start();
+		relays.emplace_back(publication);
+		subscriptions.emplace_back(relays.back());
+		((set<Subscription*>&)source.subscriptions).emplace(&subscriptions.back());
+		subscriptions.back().pPublication = &source;
+		for (UInt8 j = 0; j < 4; ++j) {
+			Target& target(targets[i * 4 + j]);
+			subscriptions.emplace_back(target);
+			target.subscribe(subscriptions.back(), publication);
+		}
+	}
+
+	Media::Audio::Tag tag(Media::Audio::CODEC_AAC);
+	tag.rate = 44100;
+	tag.channels = 2;
+	shared<Buffer> pBuffer(SET, 64);
+	Packet packet(pBuffer);
+	for (UInt32 time = 0; time < 2000; time += 20) {
+		tag.time = time;
+		source.writeAudio(tag, packet);
+		source.flush();
+	}
+
+	bool nested(false);
+	for (const Relay& relay : relays)
+		nested |= relay.nested;
+	CHECK(nested);
+	for (const Target& target : targets)
+		CHECK(target.audios == 100 && !target.errors);
+
+	// release
+	source.stop();
+	for (Publication& publication : publications) {
+		publication.stop();
+		((set<Subscription*>&)publication.subscriptions).clear();
+	}
+	for (Subscription& subscription : subscriptions)
+		subscription.pPublication = NULL;
+	((set<Subscription*>&)source.subscriptions).clear();
+}
+
+struct MuxTarget : Media::Target, virtual Object {
+	string stream;
+	bool beginMedia(const string& name) { return true; }
+	bool writeData(UInt8 track, Media::Data::Type type, const Packet& packet, bool reliable) {
+		if (type == Media::Data::TYPE_MEDIA)
+			stream.append(STR packet.data(), packet.size());
+		return true;
+	}
+};
+
+ADD_TEST(SharedMuxSameData) {
+	ThreadPool threadPool(1);
+	Publication publication("mux", threadPool);
+	publication.start();
+	MuxTarget targets[2];
+	deque<Subscription> subscriptions;
+	for (MuxTarget& target : targets) {
+		subscriptions.emplace_back(target);
+		subscriptions.back().setFormat("flv");
+		((set<Subscription*>&)publication.subscriptions).emplace(&subscriptions.back());
+		subscriptions.back().pPublication = &publication;
+	}
+	// two cue points in a row, same buffer recycled with the same size => muxed two times
+	shared<Buffer> pBuffer(SET);
+	Buffer& buffer(BinaryWriter(*pBuffer).write8(2).write16(10).write(EXPAND("onCuePoint")).buffer());
+	Packet packet(pBuffer);
+	publication.writeData(Media::Data::TYPE_AMF, packet);
+	memcpy(buffer.data() + 3, EXPAND("onCueAgain"));
+	publication.writeData(Media::Data::TYPE_AMF, packet);
+	CHECK(publication.mux("flv").use_count() == 3); // shared by the 2 subscriptions
+	for (const MuxTarget& target : targets)
+		CHECK(target.stream.find("onCuePoint") != string::npos && target.stream.find("onCueAgain") != string::npos);
+
+	publication.stop();
+	for (Subscription& subscription : subscriptions)
+		subscription.pPublication = NULL;
+	((set<Subscription*>&)publication.subscriptions).clear();
+}
+
+ADD_TEST(SharedMuxGOP) {
+	ThreadPool threadPool(1);
+	Publication publication("gop", threadPool);
+	publication.setString("gop", "true");
+	publication.start();
+	MuxTarget targets[3];
+	deque<Subscription> subscriptions;
+	auto subscribe = [&](MuxTarget& target) {
+		subscriptions.emplace_back(target);
+		subscriptions.back().setFormat("flv");
+		((set<Subscription*>&)publication.subscriptions).emplace(&subscriptions.back());
+		subscriptions.back().pPublication = &publication;
+	};
+	auto write = [&](Media::Video::Frame frame, const char* data, UInt32 time) {
+		Media::Video::Tag tag(Media::Video::CODEC_VP6);
+		tag.frame = frame;
+		tag.time = time;
+		shared<Buffer> pBuffer(SET, data, UInt32(strlen(data)));
+		publication.writeVideo(tag, Packet(pBuffer));
+	};
+	subscribe(targets[0]);
+	write(Media::Video::FRAME_KEY, "key-frame-1", 0);
+	write(Media::Video::FRAME_INTER, "inter-frame-1", 40);
+	// joins in the middle of the GOP, the shared muxing replays it
+	subscribe(targets[1]);
+	write(Media::Video::FRAME_INTER, "inter-frame-2", 80);
+	// joins on a key frame, starts directly on it without the previous GOP
+	subscribe(targets[2]);
+	write(Media::Video::FRAME_KEY, "key-frame-2", 120);
+	CHECK(publication.mux("flv").use_count() == 4); // shared by the 3 subscriptions
+
+	for (const char* data : { "key-frame-1", "inter-frame-1", "inter-frame-2", "key-frame-2" }) {
+		for (UInt8 i = 0; i < 2; ++i) {
+			size_t found = targets[i].stream.find(data);
+			CHECK(found != string::npos && targets[i].stream.find(data, found + 1) == string::npos);
+		}
+	}
+	CHECK(targets[1].stream.find("key-frame-1") < targets[1].stream.find("inter-frame-2"));
+	CHECK(targets[2].stream.find("frame-1") == string::npos && targets[2].stream.find("inter-frame-2") == string::npos && targets[2].stream.find("key-frame-2") != string::npos);
+
+	publication.stop();
+	for (Subscription& subscription : subscriptions)
+		subscription.pPublication = NULL;
+	((set<Subscription*>&)publication.subscriptions).clear();
+}
+
+}
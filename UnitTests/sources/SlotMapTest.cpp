@@ -0,0 +1,65 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/SlotMap.h"
+#include <map>
+
+using namespace Mona;
+using namespace std;
+
+namespace SlotMapTest {
+
+ADD_TEST(Generations) {
+	SlotMap<UInt32> slotMap;
+	UInt32 id1 = slotMap.add(1);
+	UInt32 id2 = slotMap.add(2);
+	CHECK(id1 && id2 && id1 != id2 && slotMap.size() == 2);
+	CHECK(*slotMap.find(id1) == 1 && *slotMap.find(id2) == 2 && !slotMap.find(0));
+	CHECK(slotMap.remove(id1) && !slotMap.remove(id1) && !slotMap.find(id1));
+	// dense storage: last value moved in the hole
+	CHECK(slotMap.size() == 1 && slotMap[0] == 2 && slotMap.id(0) == id2);
+	// slot reused with a new generation, stale id finds nothing
+	UInt32 id3 = slotMap.add(3);
+	CHECK((id3 & SlotMap<UInt32>::INDEX_MASK) == (id1 & SlotMap<UInt32>::INDEX_MASK) && id3 != id1);
+	CHECK(!slotMap.find(id1) && *slotMap.find(id3) == 3);
+}
+
+ADD_TEST(Random) {
+	SlotMap<UInt32> slotMap;
+	map<UInt32, UInt32> reference; // id => value
+	for (UInt32 i = 0; i < 100000; ++i) {
+		if (reference.empty() || (Util::Random<UInt8>() & 1)) {
+			UInt32 id = slotMap.add(i);
+			CHECK(id && reference.emplace(id, i).second);
+		} else {
+			auto it = reference.lower_bound(Util::Random<UInt32>());
+			if (it == reference.end())
+				it = reference.begin();
+			CHECK(slotMap.remove(it->first));
+			reference.erase(it);
+		}
+	}
+	CHECK(slotMap.size() == reference.size());
+	for (UInt32 i = 0; i < slotMap.size(); ++i)
+		CHECK(reference[slotMap.id(i)] == slotMap[i]);
+	for (const auto& it : reference)
+		CHECK(*slotMap.find(it.first) == it.second);
+}
+
+}
@@ -17,6 +17,7 @@ details (or else see http://www.gnu.org/licenses/).
 */
 
 #include "Mona/UnitTest.h"
+#include "Mona/IOUring.h"
 #include "Mona/TCPClient.h"
 #include "Mona/TCPServer.h"
 #include "Mona/UDPSocket.h"
@@ -113,6 +114,19 @@ ADD_TEST(UDP_Blocking) {
 	CHECK(client.receive(ex, buffer, sizeof(buffer)) == 21 && !ex&& memcmp(buffer, EXPAND("hi mathieu and thomas")) == 0);
 	CHECK(UInt32(client.receive(ex, buffer, sizeof(buffer)))==_Short0Data.size() && !ex && memcmp(buffer,_Short0Data.data(),_Short0Data.size())==0)
 
+#if defined(MSG_WAITFORONE)
+	// batch reception, a datagram bigger than its buffer is dropped
+	CHECK(client.send(ex, EXPAND("hi mathieu and thomas")) == 21 && !ex);
+	CHECK(client.send(ex, buffer, 3000) == 3000 && !ex);
+	CHECK(client.send(ex, EXPAND("hi mathieu and thomas")) == 21 && !ex);
+	shared<Buffer> pBuffers[3] = { shared<Buffer>(SET, 2048), shared<Buffer>(SET, 2048), shared<Buffer>(SET, 2048) };
+	SocketAddress addresses[3];
+	CHECK(server.receiveFrom(ex, pBuffers, addresses, 3) == 2 && ex.cast<Ex::Net::Socket>().code == NET_EMSGSIZE);
+	ex = nullptr;
+	for (UInt8 i = 0; i < 2; ++i)
+		CHECK(pBuffers[i]->size() == 21 && memcmp(pBuffers[i]->data(), EXPAND("hi mathieu and thomas")) == 0 && addresses[i] == client.address());
+#endif
+
 	CHECK(client.connect(ex, SocketAddress::Wildcard()) && !ex && !client.peerAddress())
 }
 
@@ -254,6 +268,16 @@ struct UDPEchoClient :  UDPSocket {
 		Exception ex;
 		CHECK(UDPSocket::send(ex, _packets.back()) && !ex);
 	}
+	void send(const void* data, UInt32 size, UInt8 count) {
+		// several datagrams in a row
+		vector<const Packet*> packets;
+		while (count--) {
+			_packets.emplace_back(Packet(data, size - count));
+			packets.emplace_back(&_packets.back());
+		}
+		Exception ex;
+		CHECK(self->write(ex, packets.data(), packets.size(), SocketAddress::Wildcard()) >= 0 && !ex);
+	}
 
 private:
 	deque<Packet>  _packets;
@@ -283,6 +307,8 @@ ADD_TEST(UDP_NonBlocking) {
 	client.send(_Short0Data.c_str(), _Short0Data.size());
 	client.send(NULL, 0);
 	CHECK(handler.join([&client]()->bool { return !client.echoing();}));
+	client.send(_Short0Data.c_str(), _Short0Data.size(), 32);
+	CHECK(handler.join([&client]()->bool { return !client.echoing(); }));
 
 	client.disconnect();
 	CHECK(!client.connected() && !client->peerAddress());
@@ -335,6 +361,15 @@ struct TCPEchoClient : TCPClient {
 		_packets.emplace_back(Packet(data, size));
 		CHECK(send(ex, _packets.back()) && !ex);
 	}
+	void echo(const void* data, UInt32 size, UInt8 count) {
+		// several packets gathered
+		vector<const Packet*> packets;
+		while (count--) {
+			_packets.emplace_back(Packet(data, size - count));
+			packets.emplace_back(&_packets.back());
+		}
+		CHECK(self->write(ex, packets.data(), packets.size()) >= 0 && !ex);
+	}
 
 private:
 	deque<Packet>	_packets;
@@ -395,6 +430,7 @@ void TestTCPNonBlocking(const shared<TLS>& pClientTLS = nullptr, const shared<TL
 	CHECK(client.connect(ex, target) && !ex && client->peerAddress() == target);
 	client.echo(EXPAND("hi mathieu and thomas"));
 	client.echo(_Long0Data.c_str(), _Long0Data.size());
+	client.echo(_Short0Data.c_str(), _Short0Data.size(), 32);
 	CHECK(handler.join([&]()->bool { return client.connected() && !client.echoing(); } ));
 
 	CHECK(server.count() == 1 && (*server.begin())->connected() && (**server.begin())->peerAddress() == client->address() && client->peerAddress() == (**server.begin())->address())
@@ -437,7 +473,7 @@ ADD_TEST(TCP_SSL_NonBlocking) {
 }
 
 
-ADD_TEST(TestTCPLoad) {
+void TestTCPLoad(const string& bigData = string()) {
 	Exception ex;
 	MainHandler	 handler;
 	IOSocket io(handler, _ThreadPool);
@@ -451,6 +487,8 @@ ADD_TEST(TestTCPLoad) {
 	CHECK(client.connect(ex, target) && !ex && client->peerAddress() == target);
 	for (int i = 0; i < 500; ++i)
 		client.echo(_Short0Data.c_str(), _Short0Data.size());
+	if (!bigData.empty())
+		client.echo(bigData.data(), bigData.size());
 	CHECK(handler.join([&]()->bool { return client.connected() && !client.echoing(); }));
 
 	CHECK(server.count() == 1 && (*server.begin())->connected() && (**server.begin())->peerAddress() == client->address() && client->peerAddress() == (**server.begin())->address())
@@ -467,4 +505,73 @@ ADD_TEST(TestTCPLoad) {
 	CHECK(!io.subscribers());
 }
 
+ADD_TEST(TestTCPLoad) {
+	TestTCPLoad();
+}
+
+void TestTCPReactors() {
+	Exception ex;
+	MainHandler	 handler;
+	IOSocket io(handler, _ThreadPool, "IOSocket", 0); // one reactor by thread
+
+	TCPEchoServer   server(io);
+	CHECK(!server.running() && server.start(ex) && !ex && server.running());
+
+	SocketAddress target(IPAddress::Loopback(), server->address().port());
+	deque<unique<TCPEchoClient>> clients;
+	for (UInt8 i = 0; i < 8; ++i) {
+		clients.emplace_back(new TCPEchoClient(io));
+		TCPEchoClient& client(*clients.back());
+		CHECK(client.connect(ex, target) && !ex && client->peerAddress() == target);
+		client.echo(_Short0Data.c_str(), _Short0Data.size());
+	}
+	CHECK(handler.join([&]()->bool {
+		for (const unique<TCPEchoClient>& pClient : clients) {
+			if (!pClient->connected() || pClient->echoing())
+				return false;
+		}
+		return true;
+	}));
+	CHECK(server.count() == clients.size());
+
+	for (const unique<TCPEchoClient>& pClient : clients) {
+		pClient->disconnect();
+		CHECK(!pClient->connected() && !pClient->ex);
+	}
+	clients.clear();
+
+	server.stop();
+	CHECK(!server.running());
+	CHECK(handler.join([&server]()->bool { return !server.count(); }));
+
+	_ThreadPool.join();
+	handler.flush(true);
+	CHECK(!io.subscribers());
+}
+
+ADD_TEST(TCP_Reactors) {
+	TestTCPReactors();
+}
+
+ADD_TEST(TCP_IOUring) {
+	if (!IOUring::Enable()) {
+		NOTE("io_uring unavailable");
+		return;
+	}
+	TestTCPNonBlocking();
+	// TLS sockets stay on readable events and recv calls
+	Exception ex;
+	shared<TLS> pClientTLS, pServerTLS;
+	CHECK(TLS::Create(ex, pClientTLS) && !ex);
+	CHECK(TLS::Create(ex, "cert.pem", "key.pem", pServerTLS) && !ex);
+	TestTCPNonBlocking(pClientTLS, pServerTLS);
+	// data spread over several provided buffers (echo client accumulates it, so lower than the socket buffer maximum)
+	string bigData(0x20000, '\0');
+	for (UInt32 i = 0; i < bigData.size(); ++i)
+		bigData[i] = char(i * 7);
+	TestTCPLoad(bigData);
+	TestTCPReactors();
+	IOUring::Enable(false);
+}
+
 }
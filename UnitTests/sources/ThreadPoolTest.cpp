@@ -0,0 +1,96 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/ThreadPool.h"
+#include <vector>
+
+using namespace Mona;
+using namespace std;
+
+namespace ThreadPoolTest {
+
+struct Sequence : Runner {
+	Sequence(UInt32& sequence, UInt32 value, atomic<UInt32>& errors, UInt32 duration=0) : Runner("Sequence"), _sequence(sequence), _value(value), _errors(errors), _duration(duration) {}
+private:
+	bool run(Exception& ex) {
+		if (_duration)
+			Thread::Sleep(_duration);
+		if (_sequence++ != _value)
+			++_errors;
+		return true;
+	}
+	UInt32&			_sequence;
+	UInt32			_value;
+	atomic<UInt32>&	_errors;
+	UInt32			_duration;
+};
+
+ADD_TEST(Strands) {
+	ThreadPool threadPool(4);
+	CHECK(threadPool.threads() == 4 && threadPool.strands() == 4 * ThreadPool::STRANDS_PER_THREAD);
+
+	// order kept on each strand, even if runners are queued from different threads
+	static const UInt32 Runs(10000);
+	atomic<UInt32> errors(0);
+	vector<UInt32> sequences(threadPool.strands(), 0);
+	vector<thread> producers;
+	for (UInt16 i = 0; i < 4; ++i) {
+		producers.emplace_back([&threadPool, &sequences, &errors, i]() {
+			for (UInt32 value = 0; value < Runs; ++value) {
+				for (UInt16 track = 1 + i; track <= sequences.size(); track += 4) {
+					UInt16 thread(track);
+					threadPool.queue<Sequence>(thread, sequences[track - 1], value, errors);
+				}
+			}
+		});
+	}
+	for (thread& producer : producers)
+		producer.join();
+	while (threadPool.join()) {}
+	CHECK(!errors);
+	UInt64 runs(0);
+	for (UInt16 i = 0; i < threadPool.threads(); ++i) {
+		ThreadPool::Stats stats = threadPool.stats(i);
+		CHECK(!stats.queueing);
+		runs += stats.runs;
+	}
+	CHECK(runs == Runs*threadPool.strands());
+	for (UInt32 sequence : sequences)
+		CHECK(sequence == Runs);
+}
+
+ADD_TEST(Stealing) {
+	ThreadPool threadPool(2);
+	atomic<UInt32> errors(0);
+	UInt32 slow(0), fast(0);
+	// strands 1 and 3 are on the first worker
+	UInt16 thread(1);
+	threadPool.queue<Sequence>(thread, slow, 0, errors, 200);
+	thread = 3;
+	threadPool.queue<Sequence>(thread, fast, 0, errors);
+	UInt32 wait(0);
+	while (!threadPool.stats(1).runs && wait++ < 100)
+		Thread::Sleep(1);
+	// runned by the second worker without to wait the slow runner
+	CHECK(!slow && threadPool.stats(1).steals == 1);
+	while (threadPool.join()) {}
+	CHECK(!errors && slow == 1 && fast == 1);
+}
+
+}
@@ -20,6 +20,9 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Stopwatch.h"
 #include "Mona/Timer.h"
 #include "Mona/Thread.h"
+#include <deque>
+#include <set>
+#include <map>
 
 using namespace Mona;
 using namespace std;
@@ -71,4 +74,93 @@ ADD_TEST(All) {
 	CHECK(!timer.count() && !timer.raise())
 }
 
+static const UInt32 Timers(1000000);
+
+// previous Timer implementation (std::map of std::set by raising time) to compare
+struct MapTimer : virtual Object {
+	struct OnTimer : std::function<UInt32(UInt32)>, virtual Object {
+		template<typename FunctionType>
+		OnTimer(FunctionType&& function) : nextRaising(0), std::function<UInt32(UInt32)>(std::move(function)) {}
+		Int64 nextRaising;
+	};
+	void set(OnTimer& onTimer, UInt32 timeout) {
+		if (onTimer.nextRaising) {
+			const auto& it = _timers.find(onTimer.nextRaising);
+			it->second->erase(&onTimer);
+			if (it->second->empty())
+				_timers.erase(it);
+			onTimer.nextRaising = 0;
+		}
+		if (timeout) {
+			auto& pTimers(_timers[onTimer.nextRaising = Time::Now() + timeout]);
+			if (!pTimers)
+				pTimers.set();
+			pTimers->emplace(&onTimer);
+		}
+	}
+	UInt32 raise() {
+		while (!_timers.empty()) {
+			const auto& it(_timers.begin());
+			Int64 waiting(it->first - Time::Now());
+			if (waiting > 0)
+				return UInt32(waiting);
+			auto pTimers(move(it->second));
+			_timers.erase(it);
+			for (OnTimer* pTimer : *pTimers) {
+				pTimer->nextRaising = 0;
+				UInt32 timeout = (*pTimer)(UInt32(-waiting));
+				if (timeout)
+					set(*pTimer, timeout);
+			}
+		}
+		return 0;
+	}
+private:
+	std::map<Int64, shared<std::set<OnTimer*>>>	_timers;
+};
+
+template<typename TimerType, typename OnTimerType>
+static void Measure(TimerType& timer, deque<OnTimerType>& onTimers, Int64& set, Int64& rearm, Int64& raise) {
+	Stopwatch chrono;
+	UInt32 random(1);
+	chrono.start();
+	for (OnTimerType& onTimer : onTimers)
+		timer.set(onTimer, (random = random * 1103515245 + 12345) % 60000 + 20);
+	set = chrono.elapsed();
+	chrono.restart();
+	for (OnTimerType& onTimer : onTimers)
+		timer.set(onTimer, (random = random * 1103515245 + 12345) % 60000 + 20);
+	rearm = chrono.elapsed();
+	// all expire in 16ms
+	for (OnTimerType& onTimer : onTimers)
+		timer.set(onTimer, (random = random * 1103515245 + 12345) % 16 + 1);
+	Thread::Sleep(20);
+	chrono.restart();
+	timer.raise();
+	raise = chrono.elapsed();
+}
+
+ADD_TEST(Benchmark) {
+	UInt32 raised(0);
+	Int64 wheel[3], map[3];
+	{
+		Timer timer;
+		deque<Timer::OnTimer> onTimers;
+		for (UInt32 i = 0; i < Timers; ++i)
+			onTimers.emplace_back([&raised](UInt32 delay) { ++raised; return 0; });
+		Measure(timer, onTimers, wheel[0], wheel[1], wheel[2]);
+		CHECK(!timer.count() && !timer.raise());
+	}
+	CHECK(raised == Timers);
+	{
+		MapTimer timer;
+		deque<MapTimer::OnTimer> onTimers;
+		for (UInt32 i = 0; i < Timers; ++i)
+			onTimers.emplace_back([&raised](UInt32 delay) { ++raised; return 0; });
+		Measure(timer, onTimers, map[0], map[1], map[2]);
+	}
+	CHECK(raised == 2 * Timers);
+	NOTE(Timers, " timers, set/re-arm/raise: std::map ", map[0], "/", map[1], "/", map[2], "ms, timing wheel ", wheel[0], "/", wheel[1], "/", wheel[2], "ms");
+}
+
 }